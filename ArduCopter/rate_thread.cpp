@@ -187,6 +187,9 @@ void Copter::rate_controller_thread()
     uint32_t last_rtdt_log_ms = now_ms;
 #endif
     uint32_t last_notch_sample_ms = now_ms;
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+    uint32_t last_timing_stats_ms = now_ms;
+#endif
     bool was_using_rate_thread = false;
     bool notify_fixed_rate_active = true;
     bool was_armed = false;
@@ -263,6 +266,9 @@ void Copter::rate_controller_thread()
         // it is important not to drop samples otherwise the filtering will be fubar
         // there is no need to output to the motors more than once for every batch of samples
         attitude_control->rate_controller_run_dt(gyro + ahrs.get_gyro_drift(), sensor_dt);
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+        ins.fast_rate_stage_complete(AP_InertialSensor::FastRateStage::RATE);
+#endif
 
 #ifdef RATE_LOOP_TIMING_DEBUG
         rate_controller_time_us += AP_HAL::micros() - rate_now_us;
@@ -274,6 +280,9 @@ void Copter::rate_controller_thread()
             main_loop_count = 0;
         }
         motors_output(main_loop_count == 0);
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+        ins.fast_rate_stage_complete(AP_InertialSensor::FastRateStage::MOTORS);
+#endif
 
         // process filter updates
         if (run_decimated_callback(rates.filter_rate, filter_loop_count)) {
@@ -294,6 +303,13 @@ void Copter::rate_controller_thread()
         }
 #endif
 
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+        if (now_ms - last_timing_stats_ms >= 1000) {    // 1 Hz
+            ins.update_fast_rate_timing();
+            last_timing_stats_ms = now_ms;
+        }
+#endif
+
 #ifdef RATE_LOOP_TIMING_DEBUG
         motor_output_us += AP_HAL::micros() - rate_now_us;
         rate_now_us = AP_HAL::micros();
@@ -12457,6 +12457,37 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
 
         return current_log_filepath
 
+    def test_replay_parallel_lanes_bit(self):
+        # the lanes run concurrently on the EKF3 lane pool while Replay
+        # runs them one after another, so this checks the threaded
+        # result matches the sequential one
+        # SITL has two IMUs by default; the third needs an accel
+        # calibration before it can be used.  test_replay_gps_bit reboots
+        # before flying so the IMU count takes effect
+        self.set_parameters({
+            "EK3_OPTIONS": 16,
+            "EK3_IMU_MASK": 7,
+            "SIM_IMU_COUNT": 3,
+            "INS_ACC3OFFS_X": 0.001,
+            "INS_ACC3OFFS_Y": 0.001,
+            "INS_ACC3OFFS_Z": 0.001,
+        })
+        current_log_filepath = self.test_replay_gps_bit()
+
+        # make sure all three lanes ran, or this is no different to the
+        # two lane GPS bit
+        dfreader = self.dfreader_for_path(current_log_filepath)
+        cores = set()
+        while len(cores) < 3:
+            m = dfreader.recv_match(type='XKF1')
+            if m is None:
+                break
+            cores.add(m.C)
+        if len(cores) != 3:
+            raise NotAchievedException("Expected 3 EKF3 lanes in log, got %s" % sorted(cores))
+
+        return current_log_filepath
+
     def test_replay_gps_yaw_bit(self):
         self.load_default_params_file("copter-gps-for-yaw.parm")
         self.set_parameters({
@@ -12949,6 +12980,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
 
         bits = [
             ('GPS', self.test_replay_gps_bit),
+            ('ParallelLanes', self.test_replay_parallel_lanes_bit),
             ('GPSForYaw', self.test_replay_gps_yaw_bit),
             ('WindAndAirspeed', self.test_replay_wind_and_airspeed_bit),
             ('BodyOdom', self.test_replay_body_odom_bit),
@@ -17714,6 +17746,7 @@ return update, 1000
             self.GPSBlendingAffinity,
             self.DataFlash,
             self.DataFlashErase,
+            self.DataFlashHighRate,
             self.Callisto,
             self.PerfInfo,
             self.ModeAllowsEntryWhenNoPilotInput,
@@ -6332,12 +6332,64 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
         )
         self.disarm_vehicle()
 
+    def MissionJumpTags_cached_tags(self, target_system=1, target_component=1):
+        '''jump tags are looked up in a table which must follow the mission
+        as it is rewritten or truncated'''
+        self.start_subtest("Check jump tags follow mission changes")
+        mission = [
+            self.mission_home_point(),
+            self.mission_anonymous_waypoint(),
+            self.mission_anonymous_waypoint(),
+            self.mission_jump_tag(5),
+            self.mission_anonymous_waypoint(),
+            self.mission_anonymous_waypoint(),
+        ]
+        self.renumber_mission_items(mission)
+        self.check_mission_upload_download(mission)
+        self.run_cmd(mavutil.mavlink.MAV_CMD_DO_JUMP_TAG, p1=5)
+        self.assert_current_waypoint(4)
+
+        self.progress("Moving the tag")
+        mission = [
+            self.mission_home_point(),
+            self.mission_anonymous_waypoint(),
+            self.mission_do_jump_tag(5),
+            self.mission_anonymous_waypoint(),
+            self.mission_anonymous_waypoint(),
+            self.mission_jump_tag(5),
+            self.mission_anonymous_waypoint(),
+        ]
+        self.renumber_mission_items(mission)
+        self.check_mission_upload_download(mission)
+        self.run_cmd(mavutil.mavlink.MAV_CMD_DO_JUMP_TAG, p1=5)
+        self.assert_current_waypoint(6)
+
+        self.progress("Truncating the mission with MIS_TOTAL")
+        self.set_parameter("BRD_OPTIONS", 1 << 2)  # allow setting internal parameters
+        self.set_parameter("MIS_TOTAL", 5)
+        self.run_cmd(
+            mavutil.mavlink.MAV_CMD_DO_JUMP_TAG,
+            p1=5,
+            want_result=mavutil.mavlink.MAV_RESULT_FAILED
+        )
+        self.set_parameter("MIS_TOTAL", len(mission))
+        self.run_cmd(mavutil.mavlink.MAV_CMD_DO_JUMP_TAG, p1=5)
+        self.assert_current_waypoint(6)
+
+        self.progress("Running DO_JUMP_TAG from the mission")
+        self.change_mode('AUTO')
+        self.arm_vehicle()
+        self.set_current_waypoint(2, check_afterwards=False)
+        self.wait_current_waypoint(6)
+        self.disarm_vehicle(force=True)
+
     def MissionJumpTags(self):
         '''test MAV_CMD_JUMP_TAG'''
         self.wait_ready_to_arm()
         self.MissionJumpTags_missing_jump_target()
         self.MissionJumpTags_do_jump_to_bad_tag()
         self.MissionJumpTags_jump_tag_at_end_of_mission()
+        self.MissionJumpTags_cached_tags()
 
     def AltResetBadGPS(self):
         '''Tests the handling of poor GPS lock pre-arm alt resets'''
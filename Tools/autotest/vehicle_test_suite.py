@@ -11189,6 +11189,69 @@ Also, ignores heartbeats not from our target system'''
         mavproxy.send("log erase\n")
         mavproxy.expect("Chip erase complete")
 
+    def DataFlashHighRate(self):
+        """Test logging everything to the dataflash chip loses and corrupts no pages"""
+        # the simulated chip reports busy for as long as a real chip
+        # would while programming and erasing, and panics if sent
+        # anything but a status read while busy, so this exercises
+        # writing pages and erasing ahead around the busy chip
+        self.set_parameters({
+            "LOG_DISARMED": 0,
+            "LOG_BACKEND_TYPE": 4,
+            "LOG_BITMASK": 131071,
+            "LOG_BLK_RATEMAX": 0,
+            "SIM_SPEEDUP": 1,  # there's a wallclock-time thread involved!
+        })
+        self.reboot_sitl()
+
+        mavproxy = self.start_mavproxy()
+
+        mavproxy.send("module load log\n")
+        mavproxy.send("log erase\n")
+        mavproxy.expect("Chip erase complete")
+
+        self.set_autodisarm_delay(0)
+        self.wait_ready_to_arm()
+        self.context_collect('STATUSTEXT')
+        self.arm_vehicle()
+        # long enough to erase ahead across several blocks, short
+        # enough not to fill the chip
+        self.delay_sim_time(10, reason="log data to accumulate")
+        self.disarm_vehicle()
+        self.delay_sim_time(15, reason="Allow log persistence to finish")
+        if self.statustext_in_collections('Chip full'):
+            raise NotAchievedException("Chip filled; log is not complete")
+
+        filename = "logs/dataflash-log-highrate.BIN"
+        mavproxy.send("log download 1 %s\n" % filename)
+        mavproxy.expect("Finished downloading", timeout=120)
+
+        # a corrupted page shows up as a bad header
+        self.validate_log_file(filename)
+        self.assert_log_dsf_no_drops(filename)
+
+        # a lost page shows up as a gap in the IMU samples
+        dfreader = self.dfreader_for_path(filename)
+        last_us = None
+        samples = 0
+        while True:
+            m = dfreader.recv_match(type='IMU', condition='IMU.I==0')
+            if m is None:
+                break
+            samples += 1
+            if last_us is not None:
+                dt_us = m.TimeUS - last_us
+                if dt_us <= 0 or dt_us > 100000:
+                    raise NotAchievedException("IMU samples %uus apart at %uus" % (dt_us, m.TimeUS))
+            last_us = m.TimeUS
+        self.progress("%u IMU samples without gaps" % samples)
+        if samples == 0:
+            raise NotAchievedException("No IMU samples in log")
+
+        mavproxy.send("log erase\n")
+        mavproxy.expect("Chip erase complete")
+        self.stop_mavproxy(mavproxy)
+
     def ArmFeatures(self):
         '''Arm features'''
         # TEST ARMING/DISARM
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+
+'''
+measure MAVLink FTP burst read throughput
+
+Downloads a file on several FTP sessions at once, as a GCS would
+when fetching logs, terrain and scripts together, and reports the
+throughput of each session and the total. Gaps left by lost packets
+are filled with ReadFile requests once the burst reads reach the end
+of the file. At the end @SYS/ftp.txt is fetched to show the vehicle's
+view of each session.
+
+For SITL started with --out=udpin... or the default UDP output:
+
+  ./Tools/scripts/ftp_burst_throughput.py --sessions 3 @SYS/storage.bin
+
+AP_FLAKE8_CLEAN
+'''
+
+import argparse
+import struct
+import time
+
+from pymavlink import mavutil
+
+OP_TerminateSession = 1
+OP_ResetSessions = 2
+OP_OpenFileRO = 4
+OP_ReadFile = 5
+OP_BurstReadFile = 15
+OP_Ack = 128
+OP_Nack = 129
+
+ERR_EndOfFile = 6
+
+MAX_PAYLOAD = 239
+HDR = struct.Struct("<HBBBBBBI")
+
+
+class Session(object):
+    '''download of one file on one FTP session'''
+
+    def __init__(self, session_id, path):
+        self.session_id = session_id
+        self.path = path
+        self.seq = 0
+        self.file_size = None
+        self.chunks = {}
+        self.received = 0
+        self.burst_offset = 0
+        self.gaps = []
+        self.gap_requests = 0
+        self.last_request = None
+        self.last_rx = time.time()
+        self.start = None
+        self.finish = None
+        self.done = False
+
+    def next_gap(self):
+        '''return the first offset not yet received, or None'''
+        ofs = 0
+        for chunk_ofs in sorted(self.chunks.keys()):
+            if chunk_ofs > ofs:
+                return ofs
+            ofs = max(ofs, chunk_ofs + len(self.chunks[chunk_ofs]))
+        if ofs < self.file_size:
+            return ofs
+        return None
+
+
+class FTPThroughput(object):
+    def __init__(self, master, target_system, target_component):
+        self.master = master
+        self.target_system = target_system
+        self.target_component = target_component
+
+    def send(self, session, opcode, size=0, offset=0, payload=b''):
+        session.seq = (session.seq + 1) % 65536
+        hdr = HDR.pack(session.seq, session.session_id, opcode, size, 0, 0, 0, offset)
+        data = bytearray(hdr + payload)
+        data.extend(bytearray(251 - len(data)))
+        session.last_request = (opcode, size, offset, payload)
+        self.master.mav.file_transfer_protocol_send(0, self.target_system, self.target_component, data)
+
+    def resend(self, session):
+        opcode, size, offset, payload = session.last_request
+        self.send(session, opcode, size=size, offset=offset, payload=payload)
+
+    def open(self, session):
+        path = session.path.encode('utf-8')
+        self.send(session, OP_OpenFileRO, size=len(path), payload=path)
+
+    def handle_reply(self, session, m):
+        (seq, _, opcode, size, req_opcode, burst_complete, _, offset) = HDR.unpack(bytearray(m.payload[0:12]))
+        data = bytes(bytearray(m.payload[12:12+size]))
+        session.last_rx = time.time()
+        session.seq = seq
+
+        if req_opcode == OP_OpenFileRO:
+            if opcode != OP_Ack:
+                raise Exception("session %u: failed to open %s" % (session.session_id, session.path))
+            session.file_size = struct.unpack("<I", data[:4])[0]
+            session.start = time.time()
+            self.send(session, OP_BurstReadFile, size=MAX_PAYLOAD, offset=0)
+            return
+
+        if req_opcode in (OP_BurstReadFile, OP_ReadFile) and opcode == OP_Ack:
+            if offset not in session.chunks:
+                session.chunks[offset] = data
+                session.received += len(data)
+            session.burst_offset = max(session.burst_offset, offset + len(data))
+            if req_opcode == OP_ReadFile or burst_complete:
+                self.request_more(session)
+            return
+
+        if opcode == OP_Nack and len(data) > 0 and data[0] == ERR_EndOfFile:
+            if req_opcode == OP_BurstReadFile:
+                session.file_size = min(session.file_size, session.burst_offset)
+            self.request_more(session)
+            return
+
+        if req_opcode == OP_TerminateSession:
+            return
+
+        raise Exception("session %u: unexpected reply opcode=%u req=%u" % (session.session_id, opcode, req_opcode))
+
+    def request_more(self, session):
+        '''continue the burst, fill gaps, or finish'''
+        if session.burst_offset < session.file_size:
+            self.send(session, OP_BurstReadFile, size=MAX_PAYLOAD, offset=session.burst_offset)
+            return
+        gap = session.next_gap()
+        if gap is not None:
+            session.gap_requests += 1
+            self.send(session, OP_ReadFile, size=MAX_PAYLOAD, offset=gap)
+            return
+        session.finish = time.time()
+        session.done = True
+        self.send(session, OP_TerminateSession)
+
+    def run(self, sessions, timeout):
+        self.master.mav.file_transfer_protocol_send(
+            0, self.target_system, self.target_component,
+            bytearray(HDR.pack(0, 0, OP_ResetSessions, 0, 0, 0, 0, 0)) + bytearray(251 - HDR.size))
+        time.sleep(0.5)
+        by_id = {}
+        for s in sessions:
+            by_id[s.session_id] = s
+            self.open(s)
+        start = time.time()
+        while not all(s.done for s in sessions):
+            if time.time() - start > timeout:
+                raise Exception("timed out")
+            m = self.master.recv_match(type='FILE_TRANSFER_PROTOCOL', blocking=True, timeout=0.1)
+            if m is not None:
+                session = by_id.get(m.payload[2])
+                if session is not None and not session.done:
+                    self.handle_reply(session, m)
+            now = time.time()
+            for s in sessions:
+                if not s.done and now - s.last_rx > 1.0:
+                    # the request or the end of a burst was lost
+                    s.last_rx = now
+                    self.resend(s)
+
+    def fetch(self, path, timeout=10):
+        '''fetch a small file on a single session'''
+        s = Session(0, path)
+        self.run([s], timeout)
+        return b''.join(s.chunks[ofs] for ofs in sorted(s.chunks.keys()))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument("--device", default="udpin:127.0.0.1:14550", help="MAVLink connection")
+    parser.add_argument("--sessions", type=int, default=1, help="number of concurrent sessions")
+    parser.add_argument("--timeout", type=float, default=300, help="timeout in seconds")
+    parser.add_argument("path", nargs='+', help="files to download, shared between sessions")
+    args = parser.parse_args()
+
+    master = mavutil.mavlink_connection(args.device, source_system=250)
+    master.wait_heartbeat()
+    ftp = FTPThroughput(master, master.target_system, master.target_component)
+
+    sessions = [Session(i, args.path[i % len(args.path)]) for i in range(args.sessions)]
+    start = time.time()
+    ftp.run(sessions, args.timeout)
+    elapsed = time.time() - start
+
+    total = 0
+    for s in sessions:
+        dt = max(s.finish - s.start, 0.001)
+        total += s.received
+        print("session %u: %s %u bytes in %.2fs %.1f kB/s gap requests %u" % (
+            s.session_id, s.path, s.received, dt, s.received / dt / 1024, s.gap_requests))
+    print("total: %u bytes in %.2fs %.1f kB/s" % (total, elapsed, total / elapsed / 1024))
+
+    print(ftp.fetch('@SYS/ftp.txt').decode('utf-8', errors='replace'))
+
+
+if __name__ == '__main__':
+    main()
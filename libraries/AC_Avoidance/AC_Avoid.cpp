@@ -1241,7 +1241,7 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
 
     AP_Proximity &_proximity = *proximity;
     // get total number of obstacles
-    const uint8_t obstacle_num = _proximity.get_obstacle_count();
+    const uint16_t obstacle_num = _proximity.get_obstacle_count();
     if (obstacle_num == 0) {
         // no obstacles
         return;
@@ -1270,14 +1270,10 @@ void AC_Avoid::adjust_velocity_proximity(float kP, float accel_cmss, Vector3f &d
         stopping_point_plus_margin_neu_cm = safe_vel_neu_cms * ((2.0f + margin_cm + get_stopping_distance(kP, accel_cmss, speed_cms)) / speed_cms);
     }
 
-    for (uint8_t i = 0; i<obstacle_num; i++) {
-        // get obstacle from proximity library
-        Vector3f vector_to_obstacle_neu;
-        if (!_proximity.get_obstacle(i, vector_to_obstacle_neu)) {
-            // this one is not valid
-            continue;
-        }
-
+    // only valid obstacles are visited so the cost of this loop depends on the
+    // number of obstacles seen rather than the resolution of the boundary
+    Vector3f vector_to_obstacle_neu;
+    for (uint16_t i = 0; _proximity.get_next_obstacle(i, vector_to_obstacle_neu); i++) {
         const float dist_to_boundary_cm = vector_to_obstacle_neu.length();
         if (is_zero(dist_to_boundary_cm)) {
             continue;
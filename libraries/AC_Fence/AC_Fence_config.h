@@ -23,3 +23,15 @@
 #ifndef AC_POLYFENCE_CIRCLE_INT_SUPPORT_ENABLED
 #define AC_POLYFENCE_CIRCLE_INT_SUPPORT_ENABLED 1
 #endif  // AC_POLYFENCE_CIRCLE_INT_SUPPORT_ENABLED
+
+// index fence polygons when they are loaded so breach checks on large
+// fences don't have to walk every edge
+#ifndef AC_POLYFENCE_POLYGON_INDEX_ENABLED
+#define AC_POLYFENCE_POLYGON_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif  // AC_POLYFENCE_POLYGON_INDEX_ENABLED
+
+// keep a copy of the fence index and the polygon offsets from origin
+// at the end of fence storage so fences load without rescanning
+#ifndef AC_POLYFENCE_STORAGE_CACHE_ENABLED
+#define AC_POLYFENCE_STORAGE_CACHE_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif  // AC_POLYFENCE_STORAGE_CACHE_ENABLED
@@ -0,0 +1,68 @@
+#include "AC_PolyFenceCache.h"
+
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+
+#include <AP_Math/crc.h>
+
+void AC_PolyFenceCache::seal(Header &hdr, uint32_t payload_crc)
+{
+    hdr.magic = MAGIC;
+    hdr.version = VERSION;
+    hdr.crc = crc_crc32(payload_crc, (const uint8_t *)&hdr, offsetof(Header, crc));
+}
+
+bool AC_PolyFenceCache::check_layout(const Header &hdr, uint16_t storage_size, uint16_t &payload_offset, uint16_t &payload_length)
+{
+    if (hdr.magic != MAGIC ||
+        hdr.version != VERSION ||
+        hdr.num_fences == 0 ||
+        storage_size < sizeof(Header)) {
+        return false;
+    }
+    const uint16_t header_offset = storage_size - sizeof(Header);
+    const uint32_t length = hdr.num_fences * sizeof(Entry) + hdr.num_points * sizeof(Vector2f);
+    if (length > header_offset) {
+        return false;
+    }
+    payload_offset = header_offset - length;
+    payload_length = length;
+    // the fence must end before the cache starts
+    return hdr.eos_offset >= 4 && hdr.eos_offset < payload_offset;
+}
+
+bool AC_PolyFenceCache::check_crc(const Header &hdr, uint32_t payload_crc)
+{
+    return crc_crc32(payload_crc, (const uint8_t *)&hdr, offsetof(Header, crc)) == hdr.crc;
+}
+
+Vector2f AC_PolyFenceCache::offset_from_ref(const Vector2l &ref, const Vector2l &point)
+{
+    // the east offset is not scaled for latitude, that depends on the
+    // origin so is done by offsets_to_origin()
+    return Vector2f((point.x - ref.x) * LATLON_TO_CM,
+                    Location::diff_longitude(point.y, ref.y) * LATLON_TO_CM);
+}
+
+/*
+  Location::get_distance_NE() scales the east offset by the longitude
+  scale at the mid latitude of the origin and the point.  That is
+  linearised about the mid latitude of the origin and the reference,
+  leaving one multiply-add for each point
+ */
+void AC_PolyFenceCache::offsets_to_origin(const Location &origin, const Vector2l &ref, Vector2f *offsets, uint16_t count)
+{
+    const float ref_north = (ref.x - origin.lat) * LATLON_TO_CM;
+    const float ref_east = Location::diff_longitude(ref.y, origin.lng) * LATLON_TO_CM;
+    const int32_t mid_lat = (origin.lat + ref.x) / 2;
+    const float scale = Location::longitude_scale(mid_lat);
+    // change in scale for each cm north of the reference; the mid
+    // latitude moves half as far
+    const float scale_per_cm = -sinf(mid_lat * (1.0e-7f * DEG_TO_RAD)) * (0.5e-7f * DEG_TO_RAD / LATLON_TO_CM);
+    for (uint16_t i=0; i<count; i++) {
+        const float north = offsets[i].x;
+        offsets[i].x = ref_north + north;
+        offsets[i].y = (ref_east + offsets[i].y) * (scale + scale_per_cm * north);
+    }
+}
+
+#endif  // AC_POLYFENCE_STORAGE_CACHE_ENABLED
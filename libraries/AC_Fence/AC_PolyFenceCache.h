@@ -0,0 +1,68 @@
+#pragma once
+
+#include "AC_Fence_config.h"
+#include <AP_Common/AP_Common.h>
+#include <AP_Common/Location.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+  AC_PolyFenceCache - layout of the copy of the fence index and of the
+  polygon point and return point offsets which AC_PolyFence_loader
+  keeps in the free space at the end of fence storage
+
+  The cache ends with a Header in the last bytes of fence storage.  It
+  is preceded by the cached offsets and before those an Entry for
+  each fence in the loader's index.
+
+  The offsets are from a reference point which is part of the fence
+  (the first point loaded), not from the EKF origin, so the cache only
+  changes when the fence does.  The east offsets are kept unscaled for
+  latitude; offsets_to_origin() translates them to the origin and
+  applies a longitude scale linearised about the reference, which
+  matches converting each point from the origin to within a few
+  millimetres for a fence and origin kilometres apart.
+ */
+class AC_PolyFenceCache
+{
+public:
+    static constexpr uint8_t MAGIC = 0x7c;
+    static constexpr uint8_t VERSION = 2;
+
+    struct PACKED Entry {
+        uint8_t type;
+        uint16_t count;
+        uint16_t storage_offset;
+    };
+
+    struct PACKED Header {
+        uint8_t magic;
+        uint8_t version;
+        uint16_t eos_offset;    // offset of the end-of-storage marker
+        uint16_t num_fences;
+        uint16_t num_items;
+        uint16_t num_points;    // count of cached offsets
+        int32_t ref_lat;        // point the offsets are from
+        int32_t ref_lng;
+        uint32_t fence_crc;     // crc32 of storage up to eos_offset
+        uint32_t crc;           // crc32 of the cache, must be last
+    };
+
+    // set the magic, version and crc of a header for a cache whose
+    // entries and offsets have a crc32 of payload_crc
+    static void seal(Header &hdr, uint32_t payload_crc);
+
+    // check a header read from the end of storage_size bytes of fence
+    // storage, and find where its entries start and the length of the
+    // entries and offsets.  The crcs still need checking
+    static bool check_layout(const Header &hdr, uint16_t storage_size, uint16_t &payload_offset, uint16_t &payload_length) WARN_IF_UNUSED;
+
+    // true if hdr was sealed over entries and offsets with a crc32 of
+    // payload_crc
+    static bool check_crc(const Header &hdr, uint32_t payload_crc) WARN_IF_UNUSED;
+
+    // offset in cm of point from ref
+    static Vector2f offset_from_ref(const Vector2l &ref, const Vector2l &point);
+
+    // turn count offsets from ref into offsets from origin
+    static void offsets_to_origin(const Location &origin, const Vector2l &ref, Vector2f *offsets, uint16_t count);
+};
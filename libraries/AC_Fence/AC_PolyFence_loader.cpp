@@ -30,6 +30,11 @@ extern const AP_HAL::HAL& hal;
 
 static StorageAccess fence_storage(StorageManager::StorageFence);
 
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+using FenceCacheEntry = AC_PolyFenceCache::Entry;
+using FenceCacheHeader = AC_PolyFenceCache::Header;
+#endif  // AC_POLYFENCE_STORAGE_CACHE_ENABLED
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
 #define AC_FENCE_SDCARD_FILENAME "APM/fence.stg"
 #else
@@ -253,9 +258,9 @@ bool AC_PolyFence_loader::breached(const Location& loc, float& distance_outside_
     // check we are inside each inclusion zone:
     for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
         const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
-        bool valid_distance = Polygon_closest_distance_point(boundary.points, boundary.count, scaled_pos, fence_direction);
+        bool valid_distance = boundary.index.closest_distance_point(scaled_pos, fence_direction);
         float distance = fence_direction.length() * 0.01f; // convert back to meters
-        if (Polygon_outside(pos, boundary.points_lla, boundary.count)) {
+        if (boundary.index.outside(pos)) {
             num_inclusion_outside++;
             if (valid_distance) {
                 if (is_positive(distance_outside_fence)) {
@@ -272,9 +277,9 @@ bool AC_PolyFence_loader::breached(const Location& loc, float& distance_outside_
     // check we are outside each exclusion zone:
     for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
         const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
-        bool valid_distance = Polygon_closest_distance_point(boundary.points, boundary.count, scaled_pos, fence_direction);
+        bool valid_distance = boundary.index.closest_distance_point(scaled_pos, fence_direction);
         float distance = fence_direction.length() * 0.01f; // convert back to meters
-        if (!Polygon_outside(pos, boundary.points_lla, boundary.count)) {
+        if (!boundary.index.outside(pos)) {
             if (valid_distance) {
                 distance_outside_fence = distance;
             } else {
@@ -374,18 +379,22 @@ bool AC_PolyFence_loader::scale_latlon_from_origin(const Location &origin, const
     return true;
 }
 
-bool AC_PolyFence_loader::read_polygon_from_storage(const Location &origin, uint16_t &read_offset, const uint8_t vertex_count, Vector2f *&next_storage_point, Vector2l *&next_storage_point_lla)
+bool AC_PolyFence_loader::read_polygon_from_storage(const Location &origin, uint16_t &read_offset, const uint8_t vertex_count, Vector2f *&next_storage_point, Vector2l *&next_storage_point_lla, bool transform)
 {
+    // the points are stored as consecutive lat/lon pairs, as
+    // write_latlon_to_storage() writes them
+    static_assert(sizeof(Vector2l) == 8, "Vector2l must match storage layout");
+    if (!fence_storage.read_block(next_storage_point_lla, read_offset, vertex_count * sizeof(Vector2l))) {
+        return false;
+    }
+    read_offset += vertex_count * sizeof(Vector2l);
+
     for (uint8_t i=0; i<vertex_count; i++) {
-        // read from storage to lat/lon
-        if (!read_latlon_from_storage(read_offset, *next_storage_point_lla)) {
-            return false;
-        }
         // convert lat/lon to position in cm from origin
-        if (!scale_latlon_from_origin(origin, *next_storage_point_lla, *next_storage_point)) {
+        if (transform && !scale_latlon_from_origin(origin, *next_storage_point_lla, *next_storage_point)) {
             return false;
         }
-        
+
         next_storage_point_lla++;
         next_storage_point++;
     }
@@ -547,6 +556,14 @@ bool AC_PolyFence_loader::index_eeprom()
         }
     }
 
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+    void_index();
+    if (read_cached_index()) {
+        _load_attempted = false;
+        return true;
+    }
+#endif
+
     if (!count_eeprom_fences()) {
         return false;
     }
@@ -693,19 +710,25 @@ bool AC_PolyFence_loader::load_from_storage()
         return true;
     }
 
-    { // allocate array to hold offsets-from-origin
-        const uint16_t count = sum_of_polygon_point_counts_and_returnpoint();
-        Debug("Fence: Allocating %u bytes for points",
-              (unsigned)(count * sizeof(Vector2f)));
-        _loaded_offsets_from_origin = NEW_NOTHROW Vector2f[count];
-        _loaded_points_lla = NEW_NOTHROW Vector2l[count];
-        if (_loaded_offsets_from_origin == nullptr || _loaded_points_lla == nullptr) {
-            unload();
-            get_loaded_fence_semaphore().give();
-            return false;
-        }
+    // allocate array to hold offsets-from-origin
+    const uint16_t num_points = sum_of_polygon_point_counts_and_returnpoint();
+    Debug("Fence: Allocating %u bytes for points",
+          (unsigned)(num_points * sizeof(Vector2f)));
+    _loaded_offsets_from_origin = NEW_NOTHROW Vector2f[num_points];
+    _loaded_points_lla = NEW_NOTHROW Vector2l[num_points];
+    if (_loaded_offsets_from_origin == nullptr || _loaded_points_lla == nullptr) {
+        unload();
+        get_loaded_fence_semaphore().give();
+        return false;
     }
 
+    // the offsets are in storage if the fence has been loaded before
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+    const bool offsets_cached = read_cached_offsets(loaded_origin, _loaded_offsets_from_origin, num_points);
+#else
+    const bool offsets_cached = false;
+#endif
+
     // FIXME: find some way of factoring out all of these allocation routines.
 
     { // allocate storage for inclusion polyfences:
@@ -794,11 +817,12 @@ bool AC_PolyFence_loader::load_from_storage()
                 break;
             }
             storage_offset += 1; // skip vertex count
-            if (!read_polygon_from_storage(loaded_origin, storage_offset, index.count, next_storage_point, next_storage_point_lla)) {
+            if (!read_polygon_from_storage(loaded_origin, storage_offset, index.count, next_storage_point, next_storage_point_lla, !offsets_cached)) {
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AC_Fence: polygon read failed");
                 storage_valid = false;
                 break;
             }
+            boundary.index.build(boundary.points_lla, boundary.points, boundary.count);
             _num_loaded_inclusion_boundaries++;
             break;
         }
@@ -813,11 +837,12 @@ bool AC_PolyFence_loader::load_from_storage()
                 break;
             }
             storage_offset += 1; // skip vertex count
-            if (!read_polygon_from_storage(loaded_origin, storage_offset, index.count, next_storage_point, next_storage_point_lla)) {
+            if (!read_polygon_from_storage(loaded_origin, storage_offset, index.count, next_storage_point, next_storage_point_lla, !offsets_cached)) {
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AC_Fence: polygon read failed");
                 storage_valid = false;
                 break;
             }
+            boundary.index.build(boundary.points_lla, boundary.points, boundary.count);
             _num_loaded_exclusion_boundaries++;
             break;
         }
@@ -923,7 +948,7 @@ bool AC_PolyFence_loader::load_from_storage()
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "PolyFence: latlon read failed");
                 break;
             }
-            if (!scale_latlon_from_origin(loaded_origin, *next_storage_point_lla, *next_storage_point)) {
+            if (!offsets_cached && !scale_latlon_from_origin(loaded_origin, *next_storage_point_lla, *next_storage_point)) {
                 storage_valid = false;
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "PolyFence: latlon read failed");
                 break;
@@ -940,6 +965,14 @@ bool AC_PolyFence_loader::load_from_storage()
         return false;
     }
 
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+    // the cached offsets don't depend on the origin, so this only
+    // writes after the fence has changed
+    if (!offsets_cached) {
+        write_cache(_loaded_points_lla, num_points);
+    }
+#endif
+
     _load_time_ms = AP_HAL::millis();
 
     get_loaded_fence_semaphore().give();
@@ -1380,6 +1413,153 @@ bool AC_PolyFence_loader::write_eos_to_storage(uint16_t &offset)
     return true;
 }
 
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+bool AC_PolyFence_loader::storage_crc(uint16_t offset, uint16_t length, uint32_t &crc) const
+{
+    uint8_t buf[64];
+    while (length > 0) {
+        const uint16_t n = MIN(length, sizeof(buf));
+        if (!fence_storage.read_block(buf, offset, n)) {
+            return false;
+        }
+        crc = crc_crc32(crc, buf, n);
+        offset += n;
+        length -= n;
+    }
+    return true;
+}
+
+bool AC_PolyFence_loader::read_cached_index()
+{
+    const uint16_t size = fence_storage.size();
+    if (size < sizeof(FenceCacheHeader)) {
+        return false;
+    }
+    const uint16_t header_offset = size - sizeof(FenceCacheHeader);
+    FenceCacheHeader hdr;
+    if (!fence_storage.read_block(&hdr, header_offset, sizeof(hdr))) {
+        return false;
+    }
+    uint16_t payload_offset;
+    uint16_t payload_length;
+    if (!AC_PolyFenceCache::check_layout(hdr, size, payload_offset, payload_length) ||
+        (AC_PolyFenceType)fence_storage.read_uint8(hdr.eos_offset) != AC_PolyFenceType::END_OF_STORAGE) {
+        return false;
+    }
+
+    // the cache must be intact and for the fence now in storage
+    uint32_t crc = 0;
+    if (!storage_crc(payload_offset, payload_length, crc)) {
+        return false;
+    }
+    uint32_t fence_crc = 0;
+    if (!AC_PolyFenceCache::check_crc(hdr, crc) ||
+        !storage_crc(0, hdr.eos_offset + 1, fence_crc) ||
+        fence_crc != hdr.fence_crc) {
+        return false;
+    }
+
+    Debug("Fence: Allocating %u bytes for index",
+          (unsigned)(hdr.num_fences*sizeof(FenceIndex)));
+    _index = NEW_NOTHROW FenceIndex[hdr.num_fences];
+    if (_index == nullptr) {
+        return false;
+    }
+    uint16_t offset = payload_offset;
+    for (uint16_t i=0; i<hdr.num_fences; i++) {
+        FenceCacheEntry entry;
+        if (!fence_storage.read_block(&entry, offset, sizeof(entry)) ||
+            entry.storage_offset >= hdr.eos_offset) {
+            void_index();
+            return false;
+        }
+        offset += sizeof(entry);
+        _index[i].type = (AC_PolyFenceType)entry.type;
+        _index[i].count = entry.count;
+        _index[i].storage_offset = entry.storage_offset;
+    }
+
+    _num_fences = hdr.num_fences;
+    _eeprom_fence_count = hdr.num_fences;
+    _eeprom_item_count = hdr.num_items;
+    _eos_offset = hdr.eos_offset;
+
+    _cache_offsets_offset = offset;
+    _cache_num_points = hdr.num_points;
+    _cache_ref = Vector2l(hdr.ref_lat, hdr.ref_lng);
+    return true;
+}
+
+bool AC_PolyFence_loader::read_cached_offsets(const Location &origin, Vector2f *offsets, uint16_t count) const
+{
+    if (_cache_offsets_offset == 0 ||
+        _cache_num_points != count ||
+        !fence_storage.read_block(offsets, _cache_offsets_offset, count * sizeof(Vector2f))) {
+        return false;
+    }
+    AC_PolyFenceCache::offsets_to_origin(origin, _cache_ref, offsets, count);
+    return true;
+}
+
+void AC_PolyFence_loader::write_cache(const Vector2l *points_lla, uint16_t count)
+{
+    const uint16_t size = fence_storage.size();
+    const uint32_t payload_length = _num_fences * sizeof(FenceCacheEntry) + count * sizeof(Vector2f);
+    if (_index == nullptr || _num_fences == 0 ||
+        uint32_t(_eos_offset) + 1 + payload_length + sizeof(FenceCacheHeader) > size) {
+        // no room after the fence; loading will scan storage
+        return;
+    }
+    const uint16_t header_offset = size - sizeof(FenceCacheHeader);
+    const uint16_t payload_offset = header_offset - payload_length;
+
+    // invalidate the old cache until the new one is complete
+    fence_storage.write_uint8(header_offset, 0);
+    _cache_offsets_offset = 0;
+
+    uint16_t offset = payload_offset;
+    for (uint16_t i=0; i<_num_fences; i++) {
+        const FenceCacheEntry entry {
+            uint8_t(_index[i].type),
+            _index[i].count,
+            _index[i].storage_offset,
+        };
+        fence_storage.write_block(offset, &entry, sizeof(entry));
+        offset += sizeof(entry);
+    }
+    // the offsets are from the first point so they stay valid when
+    // the origin changes
+    const uint16_t offsets_offset = offset;
+    const Vector2l ref = count > 0 ? points_lla[0] : Vector2l();
+    for (uint16_t i=0; i<count; i++) {
+        const Vector2f ofs = AC_PolyFenceCache::offset_from_ref(ref, points_lla[i]);
+        fence_storage.write_block(offset, &ofs, sizeof(ofs));
+        offset += sizeof(ofs);
+    }
+
+    FenceCacheHeader hdr {};
+    hdr.eos_offset = _eos_offset;
+    hdr.num_fences = _num_fences;
+    hdr.num_items = _eeprom_item_count;
+    hdr.num_points = count;
+    hdr.ref_lat = ref.x;
+    hdr.ref_lng = ref.y;
+    uint32_t fence_crc = 0;
+    uint32_t crc = 0;
+    if (!storage_crc(0, _eos_offset + 1, fence_crc) ||
+        !storage_crc(payload_offset, payload_length, crc)) {
+        return;
+    }
+    hdr.fence_crc = fence_crc;
+    AC_PolyFenceCache::seal(hdr, crc);
+    fence_storage.write_block(header_offset, &hdr, sizeof(hdr));
+
+    _cache_offsets_offset = offsets_offset;
+    _cache_num_points = count;
+    _cache_ref = ref;
+}
+#endif  // AC_POLYFENCE_STORAGE_CACHE_ENABLED
+
 void AC_PolyFence_loader::update()
 {
     if (!load_from_storage()) {
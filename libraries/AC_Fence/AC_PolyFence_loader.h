@@ -52,6 +52,8 @@ public:
 #include <AP_Common/AP_Common.h>
 #include <AP_Common/Location.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
+#include "AC_PolygonIndex.h"
+#include "AC_PolyFenceCache.h"
 
 class AC_PolyFence_loader
 {
@@ -237,6 +239,9 @@ private:
         _index = nullptr;
         _index_attempted = false;
         _indexed = false;
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+        _cache_offsets_offset = 0;
+#endif
     }
 
     // check_indexed - read eeprom and create index if the index does
@@ -306,6 +311,7 @@ private:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         Vector2l *points_lla; // pointer into the _loaded_points_lla array
         uint8_t count; // count of points in the boundary
+        AC_PolygonIndex index; // acceleration structure over points and points_lla
     };
     InclusionBoundary *_loaded_inclusion_boundary;
 
@@ -316,6 +322,7 @@ private:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         Vector2l *points_lla; // pointer into the _loaded_points_lla_lla array
         uint8_t count; // count of points in the boundary
+        AC_PolygonIndex index; // acceleration structure over points and points_lla
     };
     ExclusionBoundary *_loaded_exclusion_boundary;
 
@@ -375,12 +382,15 @@ private:
     // read_polygon_from_storage - reads vertex_count
     // latitude/longitude points from offset in permanent storage,
     // transforms them into an offset-from-origin and deposits the
-    // results into next_storage_point.
+    // results into next_storage_point.  If transform is false
+    // next_storage_point already holds the offsets and is only
+    // advanced
     bool read_polygon_from_storage(const Location &origin,
                                    uint16_t &read_offset,
                                    const uint8_t vertex_count,
                                    Vector2f *&next_storage_point,
-                                   Vector2l *&next_storage_point_lla) WARN_IF_UNUSED;
+                                   Vector2l *&next_storage_point_lla,
+                                   bool transform) WARN_IF_UNUSED;
 
     // primitives to write parts of fencepoints out:
     bool write_type_to_storage(uint16_t &offset, AC_PolyFenceType type) WARN_IF_UNUSED;
@@ -390,6 +400,41 @@ private:
     // methods to write specific types of fencepoint out:
     bool write_eos_to_storage(uint16_t &offset);
 
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+    /*
+     * Storage cache - a copy of _index and of the offsets of the
+     * polygon points and return point from the first point, kept at
+     * the end of fence storage after the fence items; see
+     * AC_PolyFenceCache.  It is only used if its CRC matches and it
+     * was written for the fence currently in storage, so anything
+     * overwriting it or changing the fence makes it fall back to
+     * scanning storage
+     */
+
+    // read_cached_index - fill in _index from the storage cache.
+    // Returns false if there is no valid cache for the fence in
+    // storage
+    bool read_cached_index() WARN_IF_UNUSED;
+
+    // read_cached_offsets - read count offsets from the storage cache
+    // and translate them to offsets-from-origin
+    bool read_cached_offsets(const Location &origin, Vector2f *offsets, uint16_t count) const WARN_IF_UNUSED;
+
+    // write_cache - save _index and the offsets of count loaded points
+    // from the first of them to the storage cache, if there is room
+    void write_cache(const Vector2l *points_lla, uint16_t count);
+
+    // storage_crc - continue crc over length bytes of fence storage
+    // from offset
+    bool storage_crc(uint16_t offset, uint16_t length, uint32_t &crc) const WARN_IF_UNUSED;
+
+    // storage offset of the cached offsets, zero if the cache is not
+    // valid
+    uint16_t _cache_offsets_offset;
+    uint16_t _cache_num_points;
+    Vector2l _cache_ref;
+#endif  // AC_POLYFENCE_STORAGE_CACHE_ENABLED
+
     // _total - reference to FENCE_TOTAL parameter.  This is used
     // solely for compatibility with the FENCE_POINT protocol
     AP_Int8 &_total;
@@ -0,0 +1,389 @@
+#include "AC_PolygonIndex.h"
+
+/*
+  build the index for a polygon
+ */
+bool AC_PolygonIndex::build(const Vector2l *points_lla, const Vector2f *points, uint8_t count)
+{
+    clear();
+
+    _points_lla = points_lla;
+    _points = points;
+    _count = count;
+
+    // a closing point adds a zero length edge which can never be
+    // crossed or be closest, so it is left out of the index
+    _num_edges_lla = count;
+    if (Polygon_complete(points_lla, count) && count > 0) {
+        _num_edges_lla--;
+    }
+    _num_edges = count;
+    if (Polygon_complete(points, count) && count > 0) {
+        _num_edges--;
+    }
+
+#if AC_POLYFENCE_POLYGON_INDEX_ENABLED
+    if (_num_edges_lla < 3 || _num_edges < 3) {
+        // queries fall back to the polygon functions
+        return false;
+    }
+
+    _min_lla = _max_lla = points_lla[0];
+    _min = _max = points[0];
+    for (uint8_t i=1; i<_num_edges_lla; i++) {
+        _min_lla.x = MIN(_min_lla.x, points_lla[i].x);
+        _min_lla.y = MIN(_min_lla.y, points_lla[i].y);
+        _max_lla.x = MAX(_max_lla.x, points_lla[i].x);
+        _max_lla.y = MAX(_max_lla.y, points_lla[i].y);
+    }
+    for (uint8_t i=1; i<_num_edges; i++) {
+        _min.x = MIN(_min.x, points[i].x);
+        _min.y = MIN(_min.y, points[i].y);
+        _max.x = MAX(_max.x, points[i].x);
+        _max.y = MAX(_max.y, points[i].y);
+    }
+
+    if (!build_slabs()) {
+        clear();
+        return false;
+    }
+    // walking the edges of a small polygon is quicker than
+    // searching a grid
+    if (_num_edges >= MIN_GRID_EDGES && !build_grid()) {
+        clear();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif  // AC_POLYFENCE_POLYGON_INDEX_ENABLED
+}
+
+void AC_PolygonIndex::clear()
+{
+    delete[] _slab_start;
+    _slab_start = nullptr;
+    delete[] _slab_edges;
+    _slab_edges = nullptr;
+    delete[] _cell_start;
+    _cell_start = nullptr;
+    delete[] _cell_edges;
+    _cell_edges = nullptr;
+}
+
+uint16_t AC_PolygonIndex::memory_used() const
+{
+    if (!indexed()) {
+        return 0;
+    }
+    uint16_t ret = (_num_slabs + 1) * sizeof(uint16_t) + _slab_start[_num_slabs];
+    if (_cell_edges != nullptr) {
+        const uint16_t num_cells = _grid_size * _grid_size;
+        ret += (num_cells + 1) * sizeof(uint16_t) + _cell_start[num_cells];
+    }
+    return ret;
+}
+
+/*
+  return true if pos is outside the polygon.  Only the edges in the
+  slab holding pos can straddle it, and the crossing test for each is
+  the one Polygon_outside() uses
+ */
+bool AC_PolygonIndex::outside(const Vector2l &pos) const
+{
+#if AC_POLYFENCE_POLYGON_INDEX_ENABLED
+    if (indexed()) {
+        return outside_indexed(pos);
+    }
+#endif
+    return Polygon_outside(pos, _points_lla, _count);
+}
+
+#if AC_POLYFENCE_POLYGON_INDEX_ENABLED
+bool AC_PolygonIndex::outside_indexed(const Vector2l &pos) const
+{
+    // no edge straddles a point outside [min,max) in longitude, and
+    // a point outside the polygon's latitudes crosses every
+    // straddling edge or none of them, which is an even number
+    if (pos.y < _min_lla.y || pos.y >= _max_lla.y ||
+        pos.x < _min_lla.x || pos.x > _max_lla.x) {
+        return true;
+    }
+
+    const uint8_t slab = slab_of(pos.y);
+    bool outside = true;
+    for (uint16_t i=_slab_start[slab]; i<_slab_start[slab+1]; i++) {
+        const uint8_t e = _slab_edges[i];
+        const uint8_t e2 = (e + 1 == _num_edges_lla) ? 0 : e + 1;
+        if (Polygon_edge_crosses(pos, _points_lla[e], _points_lla[e2])) {
+            outside = !outside;
+        }
+    }
+    return outside;
+}
+#endif  // AC_POLYFENCE_POLYGON_INDEX_ENABLED
+
+/*
+  find the vector from p to the closest point on the polygon.  Cells
+  are searched in rings around the cell holding p, stopping once the
+  cells not yet searched are further away than the closest edge found
+  so far.  Well outside the grid every cell is about the same distance
+  away so nothing is pruned, and walking the polygon is quicker
+ */
+bool AC_PolygonIndex::closest_distance_point(const Vector2f &p, Vector2f &closest) const
+{
+#if AC_POLYFENCE_POLYGON_INDEX_ENABLED
+    if (_cell_edges != nullptr &&
+        p.x >= _min.x - _grid_margin && p.x <= _max.x + _grid_margin &&
+        p.y >= _min.y - _grid_margin && p.y <= _max.y + _grid_margin) {
+        return closest_distance_point_indexed(p, closest);
+    }
+#endif
+    return Polygon_closest_distance_point(_points, _count, p, closest);
+}
+
+#if AC_POLYFENCE_POLYGON_INDEX_ENABLED
+bool AC_PolygonIndex::closest_distance_point_indexed(const Vector2f &p, Vector2f &closest) const
+{
+    const int16_t cx = cell_of(p.x, _min.x, _cell_size.x);
+    const int16_t cy = cell_of(p.y, _min.y, _cell_size.y);
+    const int16_t grid_size = _grid_size;
+
+    // edges can be in several cells, only look at each one once
+    uint32_t visited[256/32] {};
+
+    float closest_sq = FLT_MAX;
+    int16_t closest_edge = -1;
+    Vector2f best_v;
+
+    for (int16_t r=0; r<grid_size; r++) {
+        if (r > 0 && unvisited_distance_sq(p, cx, cy, r) >= closest_sq) {
+            break;
+        }
+        for (int16_t y=cy-r; y<=cy+r; y++) {
+            if (y < 0 || y >= grid_size) {
+                continue;
+            }
+            // the top and bottom rows of the ring are complete, the
+            // rest only have their ends
+            const int16_t step = (y == cy-r || y == cy+r) ? 1 : MAX(2*r, 1);
+            for (int16_t x=cx-r; x<=cx+r; x+=step) {
+                if (x < 0 || x >= grid_size) {
+                    continue;
+                }
+                const uint16_t cell = y * grid_size + x;
+                for (uint16_t i=_cell_start[cell]; i<_cell_start[cell+1]; i++) {
+                    const uint8_t e = _cell_edges[i];
+                    const uint32_t mask = 1U << (e & 31);
+                    if (visited[e >> 5] & mask) {
+                        continue;
+                    }
+                    visited[e >> 5] |= mask;
+                    const uint8_t e2 = (e + 1 == _num_edges) ? 0 : e + 1;
+                    const Vector2f v = Vector2f::closest_point(p, _points[e], _points[e2]) - p;
+                    const float vsq = v.length_squared();
+                    // ties go to the lowest edge as they would when
+                    // walking the polygon in order
+                    if (vsq < closest_sq || (vsq == closest_sq && e < closest_edge)) {
+                        closest_sq = vsq;
+                        closest_edge = e;
+                        best_v = v;
+                    }
+                }
+            }
+        }
+    }
+
+    if (closest_edge < 0 || is_equal(closest_sq, FLT_MAX)) {
+        return false;
+    }
+    closest = best_v;
+    return true;
+}
+
+/*
+  return a lower bound on the squared distance from p to any cell
+  outside the first r rings around cell (cx,cy), or FLT_MAX if there
+  are none.  Those cells are covered by four strips along the sides
+  of the grid; the outer edges of the grid are open as cell_of()
+  clamps to them
+ */
+float AC_PolygonIndex::unvisited_distance_sq(const Vector2f &p, int16_t cx, int16_t cy, int16_t r) const
+{
+    const int16_t last = _grid_size - 1;
+    const struct {
+        int16_t x0, x1, y0, y1;
+    } strips[] {
+        { int16_t(cx + r), last, 0, last },
+        { 0, int16_t(cx - r), 0, last },
+        { 0, last, int16_t(cy + r), last },
+        { 0, last, 0, int16_t(cy - r) },
+    };
+    float ret = FLT_MAX;
+    for (const auto &strip : strips) {
+        if (strip.x0 > strip.x1 || strip.y0 > strip.y1) {
+            continue;
+        }
+        float dx = 0, dy = 0;
+        if (strip.x0 > 0) {
+            dx = MAX(dx, _min.x + strip.x0 * _cell_size.x - p.x);
+        }
+        if (strip.x1 < last) {
+            dx = MAX(dx, p.x - (_min.x + (strip.x1 + 1) * _cell_size.x));
+        }
+        if (strip.y0 > 0) {
+            dy = MAX(dy, _min.y + strip.y0 * _cell_size.y - p.y);
+        }
+        if (strip.y1 < last) {
+            dy = MAX(dy, p.y - (_min.y + (strip.y1 + 1) * _cell_size.y));
+        }
+        // allow for rounding in cell_of() putting an edge in the
+        // next cell along
+        dx = MAX(dx - _rounding_margin, 0);
+        dy = MAX(dy - _rounding_margin, 0);
+        ret = MIN(ret, sq(dx) + sq(dy));
+    }
+    return ret;
+}
+
+uint8_t AC_PolygonIndex::slab_of(int32_t lng) const
+{
+    return (int64_t(lng) - _min_lla.y) / _slab_height;
+}
+
+uint8_t AC_PolygonIndex::cell_of(float v, float origin, float size) const
+{
+    const float f = (v - origin) / size;
+    if (!(f > 0)) {
+        return 0;
+    }
+    if (f >= _grid_size) {
+        return _grid_size - 1;
+    }
+    return uint8_t(f);
+}
+
+void AC_PolygonIndex::cell_range(float lo, float hi, float origin, float size, uint8_t &first, uint8_t &last) const
+{
+    first = cell_of(MIN(lo, hi), origin, size);
+    last = cell_of(MAX(lo, hi), origin, size);
+}
+
+/*
+  split the polygon into slabs of longitude.  An edge is in every slab
+  which holds a longitude it straddles, using the half open range
+  Polygon_outside() uses
+ */
+bool AC_PolygonIndex::build_slabs()
+{
+    _num_slabs = constrain_int16(_num_edges_lla / 4, 1, MAX_SLABS);
+    const int64_t range = int64_t(_max_lla.y) - _min_lla.y;
+    _slab_height = range / _num_slabs + 1;
+
+    _slab_start = NEW_NOTHROW uint16_t[_num_slabs + 1] {};
+    if (_slab_start == nullptr) {
+        return false;
+    }
+
+    // count the edges in each slab, then fill them in
+    for (uint8_t pass=0; pass<2; pass++) {
+        if (pass == 1) {
+            uint16_t total = 0;
+            for (uint8_t s=0; s<=_num_slabs; s++) {
+                const uint16_t n = _slab_start[s];
+                _slab_start[s] = total;
+                total += n;
+            }
+            _slab_edges = NEW_NOTHROW uint8_t[MAX(total, 1)];
+            if (_slab_edges == nullptr) {
+                return false;
+            }
+        }
+        for (uint8_t e=0; e<_num_edges_lla; e++) {
+            const Vector2l &a = _points_lla[e];
+            const Vector2l &b = _points_lla[(e + 1 == _num_edges_lla) ? 0 : e + 1];
+            if (a.y == b.y) {
+                // horizontal edges never straddle a point
+                continue;
+            }
+            const uint8_t first = slab_of(MIN(a.y, b.y));
+            const uint8_t last = slab_of(MAX(a.y, b.y) - 1);
+            for (uint8_t s=first; s<=last; s++) {
+                if (pass == 0) {
+                    _slab_start[s]++;
+                } else {
+                    _slab_edges[_slab_start[s]++] = e;
+                }
+            }
+        }
+        if (pass == 1) {
+            // the fill moved each start along to the next slab
+            for (uint8_t s=_num_slabs; s>0; s--) {
+                _slab_start[s] = _slab_start[s-1];
+            }
+            _slab_start[0] = 0;
+        }
+    }
+    return true;
+}
+
+/*
+  bucket the edges into a square grid over the polygon's bounding
+  box.  An edge is in every cell its bounding box overlaps
+ */
+bool AC_PolygonIndex::build_grid()
+{
+    _grid_size = constrain_int16(sqrtf(_num_edges * 0.5f), 1, MAX_GRID);
+    _cell_size.x = MAX((_max.x - _min.x) / _grid_size, 1.0f);
+    _cell_size.y = MAX((_max.y - _min.y) / _grid_size, 1.0f);
+    const uint16_t num_cells = _grid_size * _grid_size;
+    const float scale = MAX(MAX(fabsf(_min.x), fabsf(_max.x)), MAX(fabsf(_min.y), fabsf(_max.y)));
+    _rounding_margin = scale * 1.0e-5f + 1.0e-3f;
+    _grid_margin = MAX(_max.x - _min.x, _max.y - _min.y) * 0.25f;
+
+    _cell_start = NEW_NOTHROW uint16_t[num_cells + 1] {};
+    if (_cell_start == nullptr) {
+        return false;
+    }
+
+    for (uint8_t pass=0; pass<2; pass++) {
+        if (pass == 1) {
+            uint16_t total = 0;
+            for (uint16_t c=0; c<=num_cells; c++) {
+                const uint16_t n = _cell_start[c];
+                _cell_start[c] = total;
+                total += n;
+            }
+            _cell_edges = NEW_NOTHROW uint8_t[total];
+            if (_cell_edges == nullptr) {
+                return false;
+            }
+        }
+        for (uint8_t e=0; e<_num_edges; e++) {
+            const Vector2f &a = _points[e];
+            const Vector2f &b = _points[(e + 1 == _num_edges) ? 0 : e + 1];
+            uint8_t x0, x1, y0, y1;
+            cell_range(a.x, b.x, _min.x, _cell_size.x, x0, x1);
+            cell_range(a.y, b.y, _min.y, _cell_size.y, y0, y1);
+            for (uint8_t y=y0; y<=y1; y++) {
+                for (uint8_t x=x0; x<=x1; x++) {
+                    const uint16_t c = y * _grid_size + x;
+                    if (pass == 0) {
+                        _cell_start[c]++;
+                    } else {
+                        _cell_edges[_cell_start[c]++] = e;
+                    }
+                }
+            }
+        }
+        if (pass == 1) {
+            for (uint16_t c=num_cells; c>0; c--) {
+                _cell_start[c] = _cell_start[c-1];
+            }
+            _cell_start[0] = 0;
+        }
+    }
+    return true;
+}
+
+#endif  // AC_POLYFENCE_POLYGON_INDEX_ENABLED
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "AC_Fence_config.h"
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+  AC_PolygonIndex - acceleration structure for a single fence polygon
+
+  The polygon is indexed twice when it is loaded:
+
+  - the latitude/longitude edges are split into slabs of longitude,
+    each slab holding the edges which span it, so an inside/outside
+    test only looks at the edges which can cross a ray at the test
+    point's longitude
+
+  - the offset-from-origin vertices of larger polygons are bucketed
+    into a coarse grid so the closest edge to a point near the polygon
+    can be found by searching outwards from the point's cell, stopping
+    once no unvisited cell can hold a closer edge
+
+  The polygon's bounding box alone answers the inside test for
+  vehicles away from the polygon.
+
+  Query results are identical to Polygon_outside() and
+  Polygon_closest_distance_point() on the same points.  If the index
+  could not be allocated the queries fall back to those functions.
+ */
+class AC_PolygonIndex
+{
+public:
+    AC_PolygonIndex() {}
+    ~AC_PolygonIndex() { clear(); }
+
+    CLASS_NO_COPY(AC_PolygonIndex);
+
+    // build the index for a polygon.  The points must remain valid
+    // for as long as the index is used.  Returns false if the index
+    // could not be allocated; queries still work in that case
+    bool build(const Vector2l *points_lla, const Vector2f *points, uint8_t count);
+
+    // free the index
+    void clear();
+
+    // true if the index structures were allocated
+    bool indexed() const { return _slab_edges != nullptr; }
+
+    // returns true if pos (lat/lng) is outside the polygon, as
+    // Polygon_outside()
+    bool outside(const Vector2l &pos) const;
+
+    // fills in closest with the vector from p to the closest point on
+    // the polygon boundary (offsets from origin in cm), as
+    // Polygon_closest_distance_point().  Returns false if there is
+    // no closest point
+    bool closest_distance_point(const Vector2f &p, Vector2f &closest) const;
+
+    // approximate number of bytes allocated for the index
+    uint16_t memory_used() const;
+
+private:
+    // maximum number of longitude slabs and grid cells per side
+    static constexpr uint8_t MAX_SLABS = 32;
+    static constexpr uint8_t MAX_GRID = 8;
+
+    // polygons with fewer edges are not gridded
+    static constexpr uint8_t MIN_GRID_EDGES = 64;
+
+    const Vector2l *_points_lla = nullptr;
+    const Vector2f *_points = nullptr;
+    uint8_t _count = 0;
+
+    // number of edges once any closing point is removed
+    uint8_t _num_edges_lla;
+    uint8_t _num_edges;
+
+    // bounding boxes of the polygon
+    Vector2l _min_lla;
+    Vector2l _max_lla;
+    Vector2f _min;
+    Vector2f _max;
+
+    // longitude slabs, each _slab_height wide starting at _min_lla.y
+    uint8_t _num_slabs;
+    uint32_t _slab_height;
+
+    // grid cells of _cell_size starting at _min
+    uint8_t _grid_size;
+    Vector2f _cell_size;
+    float _rounding_margin;
+    // points further than this outside the grid skip the search
+    float _grid_margin;
+
+    // start offsets into the edge arrays for each slab and cell, with
+    // a final entry holding the total
+    uint16_t *_slab_start = nullptr;
+    uint16_t *_cell_start = nullptr;
+
+    // edge indexes, edge i runs from vertex i to vertex i+1
+    uint8_t *_slab_edges = nullptr;
+    uint8_t *_cell_edges = nullptr;
+
+    bool outside_indexed(const Vector2l &pos) const;
+    bool closest_distance_point_indexed(const Vector2f &p, Vector2f &closest) const;
+    float unvisited_distance_sq(const Vector2f &p, int16_t cx, int16_t cy, int16_t r) const;
+    uint8_t slab_of(int32_t lng) const;
+    void cell_range(float lo, float hi, float origin, float size, uint8_t &first, uint8_t &last) const;
+    uint8_t cell_of(float v, float origin, float size) const;
+    bool build_slabs();
+    bool build_grid();
+};
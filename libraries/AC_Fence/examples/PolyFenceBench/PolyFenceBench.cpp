@@ -0,0 +1,182 @@
+//
+// Benchmark of polygon fence breach checks
+//
+// Builds synthetic fences of the size a large survey or airspace
+// fence reaches - a 255 point inclusion boundary with a growing number
+// of 200 point star shaped exclusion zones inside it - and times the
+// checks AC_PolyFence_loader::breached() makes for every polygon, first
+// by walking the polygons and then through AC_PolygonIndex. Every
+// polygon is large enough to be gridded. Any query where the two
+// disagree is counted as a mismatch and fails the test.
+//
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Common/Location.h>
+#include <AC_Fence/AC_PolygonIndex.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t max_polygons = 65;
+static const uint8_t inclusion_points = 255;
+static const uint8_t star_points = 200;
+static const float inclusion_radius_m = 2000;
+static const float star_radius_m = 60;
+static const uint16_t num_queries = 2000;
+
+struct Polygon {
+    Vector2l *points_lla;
+    Vector2f *points;
+    uint8_t count;
+    AC_PolygonIndex index;
+};
+
+static Polygon *polygons;
+static Location origin;
+static Vector2l *query_lla;
+static Vector2f *query_cm;
+
+static float random_float(float lo, float hi)
+{
+    return lo + (hi - lo) * (get_random16() / 65535.0f);
+}
+
+// a polygon around centre with a radius for each vertex
+static void make_polygon(Polygon &poly, const Vector2f &centre_m, uint8_t count, float radius_m, bool star)
+{
+    poly.count = count;
+    poly.points_lla = NEW_NOTHROW Vector2l[count];
+    poly.points = NEW_NOTHROW Vector2f[count];
+    if (poly.points_lla == nullptr || poly.points == nullptr) {
+        AP_HAL::panic("FATAL: out of memory");
+    }
+    for (uint8_t i=0; i<count; i++) {
+        const float angle = M_2PI * i / count;
+        float r = radius_m;
+        if (star) {
+            r *= (i & 1) ? 0.4f : 1.0f;
+        } else {
+            r *= random_float(0.85f, 1.0f);
+        }
+        Location loc = origin;
+        loc.offset(centre_m.x + r * cosf(angle), centre_m.y + r * sinf(angle));
+        poly.points_lla[i] = Vector2l(loc.lat, loc.lng);
+        poly.points[i] = origin.get_distance_NE(loc) * 100.0f;
+    }
+    poly.index.build(poly.points_lla, poly.points, poly.count);
+}
+
+static uint32_t run(uint16_t num_polygons)
+{
+    uint32_t bytes = 0;
+    for (uint16_t p=0; p<num_polygons; p++) {
+        bytes += polygons[p].index.memory_used();
+    }
+
+    uint32_t outside_plain = 0;
+    const uint64_t t0 = AP_HAL::micros64();
+    for (uint16_t q=0; q<num_queries; q++) {
+        for (uint16_t p=0; p<num_polygons; p++) {
+            const Polygon &poly = polygons[p];
+            Vector2f closest;
+            UNUSED_RESULT(Polygon_closest_distance_point(poly.points, poly.count, query_cm[q], closest));
+            if (Polygon_outside(query_lla[q], poly.points_lla, poly.count)) {
+                outside_plain++;
+            }
+        }
+    }
+    const uint64_t t1 = AP_HAL::micros64();
+
+    uint32_t outside_indexed = 0;
+    for (uint16_t q=0; q<num_queries; q++) {
+        for (uint16_t p=0; p<num_polygons; p++) {
+            const Polygon &poly = polygons[p];
+            Vector2f closest;
+            UNUSED_RESULT(poly.index.closest_distance_point(query_cm[q], closest));
+            if (poly.index.outside(query_lla[q])) {
+                outside_indexed++;
+            }
+        }
+    }
+    const uint64_t t2 = AP_HAL::micros64();
+
+    // count individual disagreements outside the timed loops
+    uint32_t mismatches = 0;
+    for (uint16_t q=0; q<num_queries; q++) {
+        for (uint16_t p=0; p<num_polygons; p++) {
+            const Polygon &poly = polygons[p];
+            Vector2f c1, c2;
+            const bool v1 = Polygon_closest_distance_point(poly.points, poly.count, query_cm[q], c1);
+            const bool v2 = poly.index.closest_distance_point(query_cm[q], c2);
+            if (v1 != v2 || (v1 && c1 != c2) ||
+                Polygon_outside(query_lla[q], poly.points_lla, poly.count) != poly.index.outside(query_lla[q])) {
+                mismatches++;
+            }
+        }
+    }
+
+    hal.console->printf("%3u polygons: plain %.1fus/check indexed %.1fus/check index %u bytes, %u/%u outside, %u mismatches\n",
+                        unsigned(num_polygons),
+                        double(t1 - t0) / num_queries,
+                        double(t2 - t1) / num_queries,
+                        unsigned(bytes),
+                        unsigned(outside_plain),
+                        unsigned(outside_indexed),
+                        unsigned(mismatches));
+    return mismatches;
+}
+
+void setup(void)
+{
+    hal.console->printf("Polygon fence benchmark\n");
+
+    origin.lat = -353632610;
+    origin.lng = 1491652300;
+
+    polygons = NEW_NOTHROW Polygon[max_polygons];
+    query_lla = NEW_NOTHROW Vector2l[num_queries];
+    query_cm = NEW_NOTHROW Vector2f[num_queries];
+    if (polygons == nullptr || query_lla == nullptr || query_cm == nullptr) {
+        AP_HAL::panic("FATAL: out of memory");
+    }
+
+    // the inclusion boundary, then exclusions scattered inside it
+    make_polygon(polygons[0], Vector2f(), inclusion_points, inclusion_radius_m, false);
+    for (uint16_t p=1; p<max_polygons; p++) {
+        const float limit = inclusion_radius_m * 0.6f;
+        const Vector2f centre(random_float(-limit, limit), random_float(-limit, limit));
+        make_polygon(polygons[p], centre, star_points, star_radius_m, true);
+    }
+
+    // vehicle positions in and around the fence
+    for (uint16_t q=0; q<num_queries; q++) {
+        const float limit = inclusion_radius_m * 1.2f;
+        Location loc = origin;
+        loc.offset(random_float(-limit, limit), random_float(-limit, limit));
+        query_lla[q] = Vector2l(loc.lat, loc.lng);
+        query_cm[q] = origin.get_distance_NE(loc) * 100.0f;
+    }
+}
+
+void loop(void)
+{
+    static const uint16_t fence_sizes[] { 1, 9, 17, 33, 65 };
+    uint32_t mismatches = 0;
+    for (const uint16_t n : fence_sizes) {
+        mismatches += run(n);
+    }
+
+    while (true) {
+        if (mismatches != 0) {
+            hal.console->printf("TEST FAILED: %u mismatches\n", unsigned(mismatches));
+        } else {
+            hal.console->printf("TEST PASSED\n");
+        }
+        hal.scheduler->delay(20000);
+    }
+}
+
+AP_HAL_MAIN();
@@ -0,0 +1,144 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+#include <AC_Fence/AC_PolyFenceCache.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AC_POLYFENCE_STORAGE_CACHE_ENABLED
+
+using Header = AC_PolyFenceCache::Header;
+using Entry = AC_PolyFenceCache::Entry;
+
+static const uint16_t storage_size = 4096;
+
+static Header make_header(uint16_t num_fences, uint16_t num_points)
+{
+    Header hdr {};
+    hdr.eos_offset = 200;
+    hdr.num_fences = num_fences;
+    hdr.num_items = 40;
+    hdr.num_points = num_points;
+    hdr.ref_lat = -353632610;
+    hdr.ref_lng = 1491652300;
+    hdr.fence_crc = 0x12345678;
+    AC_PolyFenceCache::seal(hdr, 0xcafef00d);
+    return hdr;
+}
+
+TEST(AC_PolyFenceCache, Crc)
+{
+    Header hdr = make_header(3, 30);
+    EXPECT_EQ(hdr.magic, AC_PolyFenceCache::MAGIC);
+    EXPECT_EQ(hdr.version, AC_PolyFenceCache::VERSION);
+    EXPECT_TRUE(AC_PolyFenceCache::check_crc(hdr, 0xcafef00d));
+
+    // a different payload or any change to the header fails
+    EXPECT_FALSE(AC_PolyFenceCache::check_crc(hdr, 0xcafef00e));
+    hdr.ref_lng++;
+    EXPECT_FALSE(AC_PolyFenceCache::check_crc(hdr, 0xcafef00d));
+    hdr.ref_lng--;
+    hdr.fence_crc ^= 1;
+    EXPECT_FALSE(AC_PolyFenceCache::check_crc(hdr, 0xcafef00d));
+    hdr.fence_crc ^= 1;
+    EXPECT_TRUE(AC_PolyFenceCache::check_crc(hdr, 0xcafef00d));
+}
+
+TEST(AC_PolyFenceCache, Layout)
+{
+    uint16_t payload_offset = 0;
+    uint16_t payload_length = 0;
+
+    Header hdr = make_header(3, 30);
+    EXPECT_TRUE(AC_PolyFenceCache::check_layout(hdr, storage_size, payload_offset, payload_length));
+    EXPECT_EQ(payload_length, 3 * sizeof(Entry) + 30 * sizeof(Vector2f));
+    EXPECT_EQ(payload_offset + payload_length + sizeof(Header), storage_size);
+
+    // version 1 caches held offsets from the origin
+    hdr.version = 1;
+    EXPECT_FALSE(AC_PolyFenceCache::check_layout(hdr, storage_size, payload_offset, payload_length));
+    hdr = make_header(3, 30);
+    hdr.magic = 0;
+    EXPECT_FALSE(AC_PolyFenceCache::check_layout(hdr, storage_size, payload_offset, payload_length));
+
+    // no fences
+    hdr = make_header(0, 0);
+    EXPECT_FALSE(AC_PolyFenceCache::check_layout(hdr, storage_size, payload_offset, payload_length));
+
+    // more than fits in storage
+    hdr = make_header(3, 600);
+    EXPECT_FALSE(AC_PolyFenceCache::check_layout(hdr, storage_size, payload_offset, payload_length));
+    EXPECT_FALSE(AC_PolyFenceCache::check_layout(make_header(3, 30), sizeof(Header) - 1, payload_offset, payload_length));
+
+    // the fence would run into the cache
+    hdr = make_header(3, 30);
+    const uint16_t start = storage_size - sizeof(Header) - (3 * sizeof(Entry) + 30 * sizeof(Vector2f));
+    hdr.eos_offset = start;
+    EXPECT_FALSE(AC_PolyFenceCache::check_layout(hdr, storage_size, payload_offset, payload_length));
+    hdr.eos_offset = start - 1;
+    EXPECT_TRUE(AC_PolyFenceCache::check_layout(hdr, storage_size, payload_offset, payload_length));
+    hdr.eos_offset = 3;
+    EXPECT_FALSE(AC_PolyFenceCache::check_layout(hdr, storage_size, payload_offset, payload_length));
+}
+
+/*
+  offsets cached from the first point and translated to an origin
+  must match converting each point from that origin
+ */
+static void check_translation(int32_t lat, int32_t lng, float fence_radius_m, float origin_distance_m, float tolerance_cm)
+{
+    Location centre;
+    centre.lat = lat;
+    centre.lng = lng;
+
+    const uint8_t count = 100;
+    Vector2l points[count];
+    for (uint8_t i=0; i<count; i++) {
+        const float angle = M_2PI * i / count;
+        Location loc = centre;
+        loc.offset(fence_radius_m * cosf(angle), fence_radius_m * sinf(angle));
+        points[i] = Vector2l(loc.lat, loc.lng);
+    }
+
+    // the cache contents do not depend on the origin
+    Vector2f cached[count];
+    for (uint8_t i=0; i<count; i++) {
+        cached[i] = AC_PolyFenceCache::offset_from_ref(points[0], points[i]);
+    }
+
+    for (const float bearing : { 0.0f, 45.0f, 90.0f, 200.0f }) {
+        Location origin = centre;
+        origin.offset_bearing(bearing, origin_distance_m);
+
+        Vector2f offsets[count];
+        memcpy(offsets, cached, sizeof(offsets));
+        AC_PolyFenceCache::offsets_to_origin(origin, points[0], offsets, count);
+
+        for (uint8_t i=0; i<count; i++) {
+            Location loc;
+            loc.lat = points[i].x;
+            loc.lng = points[i].y;
+            const Vector2f direct = origin.get_distance_NE(loc) * 100.0f;
+            EXPECT_NEAR(direct.x, offsets[i].x, tolerance_cm);
+            EXPECT_NEAR(direct.y, offsets[i].y, tolerance_cm);
+        }
+    }
+}
+
+TEST(AC_PolyFenceCache, Translation)
+{
+    // the first point is the origin
+    check_translation(-353632610, 1491652300, 2000, 0, 0.1f);
+
+    // a field sized fence with the origin nearby
+    check_translation(-353632610, 1491652300, 500, 200, 0.1f);
+    check_translation(600000000, 100000000, 500, 200, 0.1f);
+
+    // an airspace sized fence and a distant origin
+    check_translation(-353632610, 1491652300, 5000, 5000, 0.5f);
+    check_translation(600000000, 100000000, 5000, 5000, 0.5f);
+}
+
+#endif  // AC_POLYFENCE_STORAGE_CACHE_ENABLED
+
+AP_GTEST_MAIN()
@@ -0,0 +1,195 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+#include <AC_Fence/AC_PolygonIndex.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AC_POLYFENCE_POLYGON_INDEX_ENABLED
+
+// deterministic pseudo-random numbers so failures can be reproduced
+static uint32_t rand_state = 1;
+static float random_float(float lo, float hi)
+{
+    rand_state = rand_state * 1664525U + 1013904223U;
+    return lo + (hi - lo) * ((rand_state >> 8) / float(1U << 24));
+}
+
+/*
+  a polygon in both forms the index takes.  The lat/lng points are
+  scaled copies of the cm offsets so the two share a shape
+ */
+struct TestPolygon {
+    Vector2l points_lla[256];
+    Vector2f points[256];
+    uint8_t count;
+
+    void add(const Vector2f &p) {
+        points[count] = p;
+        points_lla[count] = Vector2l(p.x * 10, p.y * 10);
+        count++;
+    }
+    void close() {
+        add(points[0]);
+    }
+    Vector2l lla(const Vector2f &p) const {
+        return Vector2l(p.x * 10, p.y * 10);
+    }
+};
+
+// a star with radius alternating between radius and radius*inner
+static void make_star(TestPolygon &poly, uint8_t count, float radius, float inner)
+{
+    poly.count = 0;
+    for (uint8_t i=0; i<count; i++) {
+        const float angle = M_2PI * i / count;
+        const float r = (i & 1) ? radius * inner : radius;
+        poly.add(Vector2f(r * cosf(angle), r * sinf(angle)));
+    }
+}
+
+// check a query against the unindexed polygon functions
+static void check_point(const TestPolygon &poly, const AC_PolygonIndex &index, const Vector2f &p)
+{
+    EXPECT_EQ(Polygon_outside(poly.lla(p), poly.points_lla, poly.count),
+              index.outside(poly.lla(p))) << "outside at " << p.x << "," << p.y;
+
+    Vector2f c1, c2;
+    const bool v1 = Polygon_closest_distance_point(poly.points, poly.count, p, c1);
+    const bool v2 = index.closest_distance_point(p, c2);
+    EXPECT_EQ(v1, v2);
+    if (v1 && v2) {
+        EXPECT_EQ(c1, c2) << "closest at " << p.x << "," << p.y;
+    }
+}
+
+// check random points over an area scale times the polygon's extent
+static void check_random(const TestPolygon &poly, const AC_PolygonIndex &index, float extent, float scale, uint16_t n)
+{
+    for (uint16_t i=0; i<n; i++) {
+        const float lim = extent * scale;
+        check_point(poly, index, Vector2f(random_float(-lim, lim), random_float(-lim, lim)));
+    }
+}
+
+TEST(AC_PolygonIndex, Unclosed)
+{
+    TestPolygon poly;
+    make_star(poly, 200, 100000, 0.6f);
+    AC_PolygonIndex index;
+    EXPECT_TRUE(index.build(poly.points_lla, poly.points, poly.count));
+    EXPECT_TRUE(index.indexed());
+    EXPECT_GT(index.memory_used(), 0);
+    check_random(poly, index, 100000, 1.2f, 5000);
+}
+
+TEST(AC_PolygonIndex, Closed)
+{
+    TestPolygon poly;
+    make_star(poly, 200, 100000, 0.6f);
+    poly.close();
+    AC_PolygonIndex index;
+    EXPECT_TRUE(index.build(poly.points_lla, poly.points, poly.count));
+    check_random(poly, index, 100000, 1.2f, 5000);
+
+    // the closing point is in the middle of a run of vertices for
+    // the same shape, so its edges must still be found
+    for (uint8_t i=0; i<poly.count; i++) {
+        check_point(poly, index, poly.points[i] * 1.01f);
+        check_point(poly, index, poly.points[i] * 0.99f);
+    }
+}
+
+TEST(AC_PolygonIndex, OutsideBoundingBox)
+{
+    TestPolygon poly;
+    make_star(poly, 250, 50000, 0.8f);
+    AC_PolygonIndex index;
+    EXPECT_TRUE(index.build(poly.points_lla, poly.points, poly.count));
+
+    // just outside the grid cell_of() clamps to the edge cells, well
+    // outside it the polygon is walked instead
+    check_random(poly, index, 50000, 10.0f, 2000);
+    check_random(poly, index, 50000, 1.5f, 2000);
+    for (const float d : { 50001.0f, 60000.0f, 200000.0f, 5.0e6f }) {
+        check_point(poly, index, Vector2f(d, 0));
+        check_point(poly, index, Vector2f(-d, 0));
+        check_point(poly, index, Vector2f(0, d));
+        check_point(poly, index, Vector2f(0, -d));
+        check_point(poly, index, Vector2f(d, d));
+        check_point(poly, index, Vector2f(-d, d));
+    }
+}
+
+/*
+  the ring search stops once unvisited_distance_sq() says no unsearched
+  cell can be closer than the best edge so far.  A ring with a deep
+  notch leaves the cells around the centre empty, so the closest edge
+  is several rings out and often diagonal from the query.  Queries
+  on cell boundaries check the rounding margin
+ */
+TEST(AC_PolygonIndex, RingSearchStop)
+{
+    TestPolygon poly;
+    poly.count = 0;
+    const uint8_t n = 180;
+    for (uint8_t i=0; i<n; i++) {
+        const float angle = M_2PI * i / n;
+        // a narrow spike reaches in towards the centre
+        const float r = (i == n/4) ? 5000 : 100000;
+        poly.add(Vector2f(r * cosf(angle), r * sinf(angle)));
+    }
+    AC_PolygonIndex index;
+    EXPECT_TRUE(index.build(poly.points_lla, poly.points, poly.count));
+
+    // the grid is square over the bounding box, so a lattice with a
+    // step that divides every cell lands on each cell boundary
+    Vector2f bmin = poly.points[0], bmax = poly.points[0];
+    for (uint8_t i=1; i<poly.count; i++) {
+        bmin.x = MIN(bmin.x, poly.points[i].x);
+        bmin.y = MIN(bmin.y, poly.points[i].y);
+        bmax.x = MAX(bmax.x, poly.points[i].x);
+        bmax.y = MAX(bmax.y, poly.points[i].y);
+    }
+    const uint8_t steps = 8*8;
+    for (uint8_t ix=0; ix<=steps; ix++) {
+        for (uint8_t iy=0; iy<=steps; iy++) {
+            const Vector2f p(bmin.x + (bmax.x - bmin.x) * ix / steps,
+                             bmin.y + (bmax.y - bmin.y) * iy / steps);
+            check_point(poly, index, p);
+        }
+    }
+
+    // inside the ring, where the nearest edge is always some rings out
+    check_random(poly, index, 100000, 0.7f, 5000);
+}
+
+TEST(AC_PolygonIndex, SmallPolygon)
+{
+    // too few edges for a grid, the slabs still answer outside()
+    TestPolygon poly;
+    make_star(poly, 32, 1000, 0.4f);
+    poly.close();
+    AC_PolygonIndex index;
+    EXPECT_TRUE(index.build(poly.points_lla, poly.points, poly.count));
+    EXPECT_TRUE(index.indexed());
+    check_random(poly, index, 1000, 1.5f, 2000);
+}
+
+TEST(AC_PolygonIndex, Degenerate)
+{
+    // fewer than three edges falls back to the polygon functions
+    TestPolygon poly;
+    poly.count = 0;
+    poly.add(Vector2f(0, 0));
+    poly.add(Vector2f(1000, 0));
+    AC_PolygonIndex index;
+    EXPECT_FALSE(index.build(poly.points_lla, poly.points, poly.count));
+    EXPECT_FALSE(index.indexed());
+    EXPECT_EQ(index.memory_used(), 0);
+    check_random(poly, index, 1000, 1.5f, 200);
+}
+
+#endif  // AC_POLYFENCE_POLYGON_INDEX_ENABLED
+
+AP_GTEST_MAIN()
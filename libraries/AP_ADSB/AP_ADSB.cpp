@@ -41,6 +41,7 @@
 
 #define VEHICLE_TIMEOUT_MS              5000   // if no updates in this time, drop it from the list
 #define ADSB_SQUAWK_OCTAL_DEFAULT       1200
+#define ADSB_THREAT_HORIZON_S           60     // how far ahead to look for the closest approach of a vehicle
 
 #ifndef ADSB_VEHICLE_LIST_SIZE_DEFAULT
     #define ADSB_VEHICLE_LIST_SIZE_DEFAULT  25
@@ -176,6 +177,13 @@ const AP_Param::GroupInfo AP_ADSB::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  15, AP_ADSB, _options, 0),
 
+    // @Param: LIST_THREATS
+    // @DisplayName: ADSB vehicle threat list size
+    // @Description: Number of vehicles in the ADSB vehicle list that are passed to collision avoidance and sent to the GCS in the SRx_ADSB stream. Vehicles are ranked by how close they are predicted to come to this vehicle in the next minute, assuming both keep their current velocity, and only the most threatening are used. The special vehicle (ADSB_ICAO_SPECL) is always used. A value of 0 uses all vehicles in the list.
+    // @Range: 0 100
+    // @User: Advanced
+    AP_GROUPINFO("LIST_THREATS",  16, AP_ADSB, in_state.list_threats, 0),
+
     AP_GROUPEND
 };
 
@@ -204,15 +212,46 @@ void AP_ADSB::init(void)
         // sanity check param
         in_state.list_size_param.set(constrain_int16(in_state.list_size_param, 1, INT16_MAX));
 
-        in_state.vehicle_list = NEW_NOTHROW adsb_vehicle_t[in_state.list_size_param];
+        const uint16_t list_size = in_state.list_size_param;
+
+        // the hash table is kept at most half full so probe sequences stay short
+        uint32_t table_size = 1;
+        while (table_size < 2U * list_size) {
+            table_size <<= 1;
+        }
 
-        if (in_state.vehicle_list == nullptr) {
+        in_state.vehicle_list = NEW_NOTHROW adsb_vehicle_t[list_size];
+        in_state.icao_table = NEW_NOTHROW uint16_t[table_size];
+        in_state.threat_order = NEW_NOTHROW uint16_t[list_size];
+        in_state.threat_rank = NEW_NOTHROW uint16_t[list_size];
+        in_state.threat_score = NEW_NOTHROW float[list_size];
+
+        if (in_state.vehicle_list == nullptr ||
+            in_state.icao_table == nullptr ||
+            in_state.threat_order == nullptr ||
+            in_state.threat_rank == nullptr ||
+            in_state.threat_score == nullptr) {
             // dynamic RAM allocation of in_state.vehicle_list[] failed
+            delete[] in_state.vehicle_list;
+            delete[] in_state.icao_table;
+            delete[] in_state.threat_order;
+            delete[] in_state.threat_rank;
+            delete[] in_state.threat_score;
+            in_state.vehicle_list = nullptr;
+            in_state.icao_table = nullptr;
+            in_state.threat_order = nullptr;
+            in_state.threat_rank = nullptr;
+            in_state.threat_score = nullptr;
             _init_failed = true; // this keeps us from constantly trying to init forever in main update
             GCS_SEND_TEXT(MAV_SEVERITY_INFO, "ADSB: Unable to initialize ADSB vehicle list");
             return;
         }
-        in_state.list_size_allocated = in_state.list_size_param;
+        memset(in_state.icao_table, 0, table_size * sizeof(uint16_t));
+        for (uint16_t i = 0; i < list_size; i++) {
+            in_state.threat_rank[i] = THREAT_UNRANKED;
+        }
+        in_state.icao_table_mask = table_size - 1;
+        in_state.list_size_allocated = list_size;
     }
 
     if (detected_num_instances == 0) {
@@ -396,6 +435,8 @@ void AP_ADSB::update(const AP_ADSB::Loc &loc)
         }
     }
 
+    update_threat_order();
+
     if (out_state.cfg.squawk_octal_param != out_state.cfg.squawk_octal) {
         // param changed, check that it's a valid octal
         if (!is_valid_callsign(out_state.cfg.squawk_octal_param)) {
@@ -492,11 +533,25 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
         in_state.furthest_vehicle_distance = 0;
         in_state.furthest_vehicle_index = 0;
     }
-    if (index != (in_state.vehicle_count-1)) {
-        in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
+    icao_remove(in_state.vehicle_list[index].info.ICAO_address);
+    threat_unrank(index);
+
+    const uint16_t last = in_state.vehicle_count-1;
+    if (index != last) {
+        in_state.vehicle_list[index] = in_state.vehicle_list[last];
+        icao_move(in_state.vehicle_list[index].info.ICAO_address, index);
+        const uint16_t rank = in_state.threat_rank[last];
+        in_state.threat_rank[index] = rank;
+        in_state.threat_rank[last] = THREAT_UNRANKED;
+        if (rank != THREAT_UNRANKED) {
+            in_state.threat_order[rank] = index;
+        }
+        if (in_state.furthest_vehicle_index == last) {
+            in_state.furthest_vehicle_index = index;
+        }
     }
     // TODO: is memset needed? When we decrement the index we essentially forget about it
-    memset(&in_state.vehicle_list[in_state.vehicle_count-1], 0, sizeof(adsb_vehicle_t));
+    memset(&in_state.vehicle_list[last], 0, sizeof(adsb_vehicle_t));
     in_state.vehicle_count--;
 }
 
@@ -507,8 +562,14 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
-    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
+    if (in_state.icao_table == nullptr) {
+        // not initialised
+        return false;
+    }
+    const uint32_t icao = vehicle.info.ICAO_address;
+    for (uint16_t slot = icao_hash(icao); in_state.icao_table[slot] != 0; slot = (slot + 1) & in_state.icao_table_mask) {
+        const uint16_t i = in_state.icao_table[slot] - 1;
+        if (in_state.vehicle_list[i].info.ICAO_address == icao) {
             *index = i;
             return true;
         }
@@ -516,6 +577,195 @@ bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
     return false;
 }
 
+/*
+ * home slot of an ICAO address in the hash table. Fibonacci hashing
+ * spreads the sequential addresses that blocks of aircraft are
+ * often allocated
+ */
+uint16_t AP_ADSB::icao_hash(uint32_t icao) const
+{
+    return ((icao * 2654435761U) >> 16) & in_state.icao_table_mask;
+}
+
+/*
+ * add an ICAO address stored at a list index to the hash table. The
+ * address must not already be in the table
+ */
+void AP_ADSB::icao_insert(uint32_t icao, uint16_t index)
+{
+    uint16_t slot = icao_hash(icao);
+    while (in_state.icao_table[slot] != 0) {
+        slot = (slot + 1) & in_state.icao_table_mask;
+    }
+    in_state.icao_table[slot] = index + 1;
+}
+
+/*
+ * remove an ICAO address from the hash table, shifting back any
+ * entries further along the probe sequence so no tombstones are needed
+ */
+void AP_ADSB::icao_remove(uint32_t icao)
+{
+    const uint16_t mask = in_state.icao_table_mask;
+    uint16_t slot = icao_hash(icao);
+    while (true) {
+        const uint16_t entry = in_state.icao_table[slot];
+        if (entry == 0) {
+            // not in the table
+            return;
+        }
+        if (in_state.vehicle_list[entry-1].info.ICAO_address == icao) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    uint16_t hole = slot;
+    for (slot = (slot + 1) & mask; in_state.icao_table[slot] != 0; slot = (slot + 1) & mask) {
+        const uint16_t entry = in_state.icao_table[slot];
+        const uint16_t home = icao_hash(in_state.vehicle_list[entry-1].info.ICAO_address);
+        // move the entry into the hole unless its home lies cyclically in (hole, slot]
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            in_state.icao_table[hole] = entry;
+            hole = slot;
+        }
+    }
+    in_state.icao_table[hole] = 0;
+}
+
+/*
+ * update the list index of an ICAO address already in the hash table
+ */
+void AP_ADSB::icao_move(uint32_t icao, uint16_t new_index)
+{
+    for (uint16_t slot = icao_hash(icao); in_state.icao_table[slot] != 0; slot = (slot + 1) & in_state.icao_table_mask) {
+        const uint16_t i = in_state.icao_table[slot] - 1;
+        if (i != new_index && in_state.vehicle_list[i].info.ICAO_address == icao) {
+            in_state.icao_table[slot] = new_index + 1;
+            return;
+        }
+    }
+}
+
+/*
+ * predict the distance in meters between us and a vehicle at their
+ * closest approach within ADSB_THREAT_HORIZON_S, assuming both keep
+ * their current velocity
+ */
+float AP_ADSB::predicted_miss_distance(const adsb_vehicle_t &vehicle) const
+{
+    const Vector3f rel_pos = _my_loc.get_distance_NED(get_location(vehicle));
+
+    Vector3f vel;
+    if ((vehicle.info.flags & (ADSB_FLAGS_VALID_HEADING | ADSB_FLAGS_VALID_VELOCITY)) == (ADSB_FLAGS_VALID_HEADING | ADSB_FLAGS_VALID_VELOCITY)) {
+        const float heading_rad = radians(vehicle.info.heading * 0.01f);
+        const float speed = vehicle.info.hor_velocity * 0.01f;
+        vel.x = cosf(heading_rad) * speed;
+        vel.y = sinf(heading_rad) * speed;
+    }
+    if (vehicle.info.flags & ADSB_FLAGS_VERTICAL_VELOCITY_VALID) {
+        vel.z = -vehicle.info.ver_velocity * 0.01f;
+    }
+    const Vector3f rel_vel = vel - _my_loc.vel_ned;
+
+    float t = 0;
+    const float rel_speed_sq = rel_vel.length_squared();
+    if (is_positive(rel_speed_sq)) {
+        t = constrain_float(-(rel_pos * rel_vel) / rel_speed_sq, 0, ADSB_THREAT_HORIZON_S);
+    }
+    return (rel_pos + rel_vel * t).length();
+}
+
+/*
+ * rank the vehicles in the list by predicted closest approach, keeping
+ * the ADSB_LIST_THREATS most threatening. The special vehicle always
+ * ranks first
+ */
+void AP_ADSB::update_threat_order()
+{
+    for (uint16_t r = 0; r < in_state.threat_count; r++) {
+        in_state.threat_rank[in_state.threat_order[r]] = THREAT_UNRANKED;
+    }
+    in_state.threat_count = 0;
+    in_state.threat_miss_distance_max = FLT_MAX;
+
+    in_state.threat_ordering = in_state.list_threats > 0 && !_my_loc.is_zero();
+    if (!in_state.threat_ordering) {
+        return;
+    }
+
+    // insertion into a list of the best N, scores are kept alongside
+    // the order so they are only calculated once
+    const uint16_t max_threats = MIN(uint16_t(in_state.list_threats.get()), in_state.list_size_allocated);
+    float *score = in_state.threat_score;
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
+        const adsb_vehicle_t &vehicle = in_state.vehicle_list[i];
+        const float miss_distance = is_special_vehicle(vehicle.info.ICAO_address) ? -1 : predicted_miss_distance(vehicle);
+        uint16_t pos;
+        if (count < max_threats) {
+            pos = count++;
+        } else if (miss_distance < score[count-1]) {
+            pos = count-1;
+        } else {
+            continue;
+        }
+        while (pos > 0 && score[pos-1] > miss_distance) {
+            score[pos] = score[pos-1];
+            in_state.threat_order[pos] = in_state.threat_order[pos-1];
+            pos--;
+        }
+        score[pos] = miss_distance;
+        in_state.threat_order[pos] = i;
+    }
+
+    for (uint16_t r = 0; r < count; r++) {
+        in_state.threat_rank[in_state.threat_order[r]] = r;
+    }
+    in_state.threat_count = count;
+    if (count == max_threats) {
+        in_state.threat_miss_distance_max = score[count-1];
+    }
+}
+
+/*
+ * remove a list index from the threat order
+ */
+void AP_ADSB::threat_unrank(uint16_t index)
+{
+    const uint16_t rank = in_state.threat_rank[index];
+    if (rank == THREAT_UNRANKED) {
+        return;
+    }
+    for (uint16_t r = rank; r+1 < in_state.threat_count; r++) {
+        in_state.threat_order[r] = in_state.threat_order[r+1];
+        in_state.threat_score[r] = in_state.threat_score[r+1];
+        in_state.threat_rank[in_state.threat_order[r]] = r;
+    }
+    in_state.threat_count--;
+    in_state.threat_rank[index] = THREAT_UNRANKED;
+    // there is a free place in the order until the next update, so
+    // let any vehicle through rather than risk missing a threat
+    in_state.threat_miss_distance_max = FLT_MAX;
+}
+
+/*
+ * true if a vehicle should be passed on to avoidance. index is the
+ * vehicle's position in the list, or out of range if it is not in it
+ */
+bool AP_ADSB::is_priority_threat(const adsb_vehicle_t &vehicle, uint16_t index) const
+{
+    if (!in_state.threat_ordering || is_special_vehicle(vehicle.info.ICAO_address)) {
+        return true;
+    }
+    if (index < in_state.vehicle_count && in_state.threat_rank[index] != THREAT_UNRANKED) {
+        return true;
+    }
+    // unranked vehicles are forwarded as soon as they would make the
+    // order, rather than waiting for the next update
+    return predicted_miss_distance(vehicle) <= in_state.threat_miss_distance_max;
+}
+
 /*
  * Update the vehicle list. If the vehicle is already in the
  * list then it will update it, otherwise it will be added.
@@ -561,7 +811,8 @@ void AP_ADSB::handle_adsb_vehicle(const adsb_vehicle_t &vehicle)
     } else if (in_state.vehicle_count < in_state.list_size_allocated) {
 
         // not found and there's room, add it to the end of the list
-        set_vehicle(in_state.vehicle_count, vehicle);
+        index = in_state.vehicle_count;
+        set_vehicle(index, vehicle);
         in_state.vehicle_count++;
 
     } else {
@@ -580,7 +831,8 @@ void AP_ADSB::handle_adsb_vehicle(const adsb_vehicle_t &vehicle)
 
             if (my_loc_distance_to_vehicle < in_state.furthest_vehicle_distance) { // is closer than the furthest
                 // replace with the furthest vehicle
-                set_vehicle(in_state.furthest_vehicle_index, vehicle);
+                index = in_state.furthest_vehicle_index;
+                set_vehicle(index, vehicle);
 
                 // in_state.furthest_vehicle_index is now invalid because the vehicle was overwritten, need
                 // to run determine_furthest_aircraft() to determine a new one next time
@@ -596,7 +848,7 @@ void AP_ADSB::handle_adsb_vehicle(const adsb_vehicle_t &vehicle)
             ADSB_FLAGS_VALID_HEADING |
             ADSB_FLAGS_VALID_VELOCITY;
 
-    if (vehicle.info.flags & required_flags_avoidance) {
+    if ((vehicle.info.flags & required_flags_avoidance) && is_priority_threat(vehicle, index)) {
         push_sample(vehicle); // note that set_vehicle modifies vehicle
     }
 }
@@ -610,6 +862,16 @@ void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
         // out of range
         return;
     }
+    const uint32_t icao = vehicle.info.ICAO_address;
+    if (index >= in_state.vehicle_count) {
+        // new entry at the end of the list
+        icao_insert(icao, index);
+    } else if (in_state.vehicle_list[index].info.ICAO_address != icao) {
+        // replacing a different vehicle
+        icao_remove(in_state.vehicle_list[index].info.ICAO_address);
+        threat_unrank(index);
+        icao_insert(icao, index);
+    }
     in_state.vehicle_list[index] = vehicle;
 
 #if HAL_LOGGING_ENABLED
@@ -625,7 +887,11 @@ void AP_ADSB::send_adsb_vehicle(const mavlink_channel_t chan)
 
     uint32_t now = AP_HAL::millis();
 
-    if (in_state.send_index[chan] >= in_state.vehicle_count) {
+    // the vehicle list is walked rather than the threat order, which
+    // is re-sorted between calls, so a pass sends each vehicle once
+    uint16_t &send_index = in_state.send_index[chan];
+
+    if (send_index >= in_state.vehicle_count) {
         // we've finished a list
         if (now - in_state.send_start_ms[chan] < 1000) {
             // too soon to start a new one
@@ -633,13 +899,20 @@ void AP_ADSB::send_adsb_vehicle(const mavlink_channel_t chan)
         } else {
             // start new list
             in_state.send_start_ms[chan] = now;
-            in_state.send_index[chan] = 0;
+            send_index = 0;
+        }
+    }
+
+    // only the most threatening vehicles are sent when they are ranked
+    if (in_state.threat_ordering) {
+        while (send_index < in_state.vehicle_count && in_state.threat_rank[send_index] == THREAT_UNRANKED) {
+            send_index++;
         }
     }
 
-    if (in_state.send_index[chan] < in_state.vehicle_count) {
-        mavlink_adsb_vehicle_t vehicle = in_state.vehicle_list[in_state.send_index[chan]].info;
-        in_state.send_index[chan]++;
+    if (send_index < in_state.vehicle_count) {
+        mavlink_adsb_vehicle_t vehicle = in_state.vehicle_list[send_index].info;
+        send_index++;
 
         mavlink_msg_adsb_vehicle_send(chan,
             vehicle.ICAO_address,
@@ -236,6 +236,24 @@ private:
     // return index of given vehicle if ICAO_ADDRESS matches. return -1 if no match
     bool find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const;
 
+    // ICAO address hash table maintenance
+    uint16_t icao_hash(uint32_t icao) const;
+    void icao_insert(uint32_t icao, uint16_t index);
+    void icao_remove(uint32_t icao);
+    void icao_move(uint32_t icao, uint16_t new_index);
+
+    // predicted distance in meters to a vehicle at closest approach
+    float predicted_miss_distance(const adsb_vehicle_t &vehicle) const;
+
+    // rank vehicles by predicted closest approach
+    void update_threat_order();
+
+    // remove a list index from the threat order
+    void threat_unrank(uint16_t index);
+
+    // true if the vehicle should be passed on to avoidance
+    bool is_priority_threat(const adsb_vehicle_t &vehicle, uint16_t index) const;
+
     // remove a vehicle from the list
     void delete_vehicle(const uint16_t index);
 
@@ -276,6 +294,21 @@ private:
         uint16_t    furthest_vehicle_index;
         float       furthest_vehicle_distance;
 
+        // open addressing hash of ICAO address to list index + 1, 0 is an empty slot
+        uint16_t    *icao_table;
+        uint16_t    icao_table_mask;
+
+        // list indices of the most threatening vehicles, ordered by
+        // predicted distance at closest approach, and the rank of
+        // each list index in that order (THREAT_UNRANKED if not ranked)
+        AP_Int16    list_threats;
+        uint16_t    *threat_order;
+        uint16_t    *threat_rank;
+        float       *threat_score;              // predicted miss distance of each rank
+        uint16_t    threat_count;
+        float       threat_miss_distance_max;   // miss distance of the least threatening ranked vehicle
+        bool        threat_ordering;            // true if only ranked vehicles are forwarded
+
         // streamrate stuff
         uint32_t    send_start_ms[MAVLINK_COMM_NUM_BUFFERS];
         uint16_t    send_index[MAVLINK_COMM_NUM_BUFFERS];
@@ -335,6 +368,8 @@ private:
 
     AP_Int32 _options;
 
+    static const uint16_t THREAT_UNRANKED = UINT16_MAX;
+
     static const uint8_t _max_samples = 30;
     ObjectBuffer<adsb_vehicle_t> _samples{_max_samples};
 
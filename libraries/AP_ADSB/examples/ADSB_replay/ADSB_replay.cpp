@@ -0,0 +1,232 @@
+/*
+  ADSB replay benchmark
+
+  generates traffic the way the SITL ADSB simulator (SIM_ADSB) does,
+  with a large number of aircraft spread around the vehicle each
+  reporting once a second, and replays it through the ADSB vehicle
+  list. Reports the time taken per report and how many reports are
+  passed on to avoidance for several ADSB_LIST_THREATS settings
+ */
+
+#include <AP_ADSB/AP_ADSB.h>
+#include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static AP_SerialManager serial_manager;
+AP_BoardConfig board_config;
+
+void setup();
+void loop();
+
+#define REPLAY_VEHICLES         200     // matches SIM_ADSB's maximum plane count
+#define REPLAY_RADIUS_M         10000   // SIM_ADSB_RADIUS
+#define REPLAY_ALTITUDE_M       1000    // SIM_ADSB_ALT
+#define REPLAY_DURATION_S       300     // simulated time to replay
+#define REPLAY_UPDATE_HZ        10      // rate the vehicle calls AP_ADSB::update()
+#define REPLAY_LIST_SIZE        100     // ADSB_LIST_MAX
+
+// ADSB_LIST_THREATS values to benchmark
+static const int16_t list_threats[] { 0, 20, 5 };
+
+struct ReplayVehicle {
+    uint32_t ICAO_address;
+    Vector3f position;  // NED from origin
+    Vector3f velocity;  // NED
+    ADSB_EMITTER_TYPE type;
+};
+
+struct BenchResult {
+    uint32_t reports;
+    uint64_t handle_total_us;
+    uint32_t handle_max_us;
+    uint64_t update_total_us;
+    uint32_t update_max_us;
+    uint32_t avoidance_samples;     // reports passed on to avoidance
+    uint32_t tracked;               // vehicles found by ICAO lookup at the end
+};
+
+static ReplayVehicle vehicles[REPLAY_VEHICLES];
+static Location origin;
+
+// normally distributed random number, as Aircraft::rand_normal()
+static float rand_normal(float mean, float stddev)
+{
+    const float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    const float u2 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    return mean + stddev * sqrtf(-2.0f * logf(u1)) * cosf(M_2PI * u2);
+}
+
+// spawn a vehicle the same way as SIM_ADSB
+static void spawn(ReplayVehicle &v)
+{
+    v.ICAO_address = uint32_t(rand() % 10000);
+    v.position.x = rand_normal(0, REPLAY_RADIUS_M);
+    v.position.y = rand_normal(0, REPLAY_RADIUS_M);
+    v.position.z = -REPLAY_ALTITUDE_M;
+
+    float vel_min = 5, vel_max = 20;
+    if (v.position.length() > 500) {
+        vel_min *= 3;
+        vel_max *= 3;
+    }
+    v.type = (ADSB_EMITTER_TYPE)(rand() % (ADSB_EMITTER_TYPE_POINT_OBSTACLE + 1));
+    v.velocity.zero();
+    if (v.type != ADSB_EMITTER_TYPE_POINT_OBSTACLE) {
+        v.velocity.x = rand_normal(vel_min, vel_max);
+        v.velocity.y = rand_normal(vel_min, vel_max);
+        if (v.type < ADSB_EMITTER_TYPE_EMERGENCY_SURFACE) {
+            v.velocity.z = rand_normal(-3, 3);
+        }
+    }
+}
+
+// fill in an ADSB_VEHICLE report as SIM_ADSB does
+static void make_report(const ReplayVehicle &v, AP_ADSB::adsb_vehicle_t &report)
+{
+    Location loc = origin;
+    loc.offset(v.position.x, v.position.y);
+
+    report = {};
+    report.info.ICAO_address = v.ICAO_address;
+    report.info.lat = loc.lat;
+    report.info.lon = loc.lng;
+    report.info.altitude_type = ADSB_ALTITUDE_TYPE_PRESSURE_QNH;
+    report.info.altitude = -v.position.z * 1000;
+    report.info.heading = wrap_360_cd(100 * degrees(atan2f(v.velocity.y, v.velocity.x)));
+    report.info.hor_velocity = v.velocity.xy().length() * 100;
+    report.info.ver_velocity = -v.velocity.z * 100;
+    snprintf(report.info.callsign, sizeof(report.info.callsign), "SIM%u", unsigned(v.ICAO_address));
+    report.info.emitter_type = v.type;
+    report.info.tslc = 1;
+    report.info.flags =
+        ADSB_FLAGS_VALID_COORDS |
+        ADSB_FLAGS_VALID_ALTITUDE |
+        ADSB_FLAGS_VALID_HEADING |
+        ADSB_FLAGS_VALID_VELOCITY |
+        ADSB_FLAGS_VALID_CALLSIGN |
+        ADSB_FLAGS_VALID_SQUAWK |
+        ADSB_FLAGS_SIMULATED |
+        ADSB_FLAGS_VERTICAL_VELOCITY_VALID |
+        ADSB_FLAGS_BARO_VALID;
+    report.info.squawk = 1200;
+    report.last_update_ms = AP_HAL::millis();
+}
+
+static void run_benchmark(AP_ADSB &adsb, int16_t threats, BenchResult &res)
+{
+    AP_Param::set_object_value(&adsb, AP_ADSB::var_info, "LIST_THREATS", threats);
+
+    // same traffic for every run
+    srand(1);
+    for (auto &v : vehicles) {
+        spawn(v);
+    }
+
+    // our vehicle flies north east through the traffic
+    AP_ADSB::Loc loc {};
+    loc.lat = origin.lat;
+    loc.lng = origin.lng;
+    loc.alt = REPLAY_ALTITUDE_M * 100;
+    loc.fix_type = AP_GPS_FixType::FIX_3D;
+    loc.vel_ned = Vector3f{15, 15, 0};
+    Vector3f my_position{0, 0, -REPLAY_ALTITUDE_M};
+
+    res = {};
+    const float dt = 1.0f / REPLAY_UPDATE_HZ;
+    for (uint32_t step = 0; step < REPLAY_DURATION_S * REPLAY_UPDATE_HZ; step++) {
+        my_position += loc.vel_ned * dt;
+        Location my_loc = origin;
+        my_loc.offset(my_position.x, my_position.y);
+        loc.lat = my_loc.lat;
+        loc.lng = my_loc.lng;
+
+        uint32_t start_us = AP_HAL::micros();
+        adsb.update(loc);
+        uint32_t dt_us = AP_HAL::micros() - start_us;
+        res.update_total_us += dt_us;
+        res.update_max_us = MAX(res.update_max_us, dt_us);
+
+        // each vehicle reports once a second, spread across the updates
+        for (uint16_t i = step % REPLAY_UPDATE_HZ; i < REPLAY_VEHICLES; i += REPLAY_UPDATE_HZ) {
+            ReplayVehicle &v = vehicles[i];
+            v.position += v.velocity * REPLAY_UPDATE_HZ * dt;
+            if (v.position.z > 0) {
+                spawn(v);
+            }
+            AP_ADSB::adsb_vehicle_t report;
+            make_report(v, report);
+
+            start_us = AP_HAL::micros();
+            adsb.handle_adsb_vehicle(report);
+            dt_us = AP_HAL::micros() - start_us;
+            res.reports++;
+            res.handle_total_us += dt_us;
+            res.handle_max_us = MAX(res.handle_max_us, dt_us);
+        }
+
+        // drain the samples as AP_Avoidance would
+        AP_ADSB::adsb_vehicle_t sample;
+        while (adsb.next_sample(sample)) {
+            res.avoidance_samples++;
+        }
+    }
+
+    for (const auto &v : vehicles) {
+        AP_ADSB::adsb_vehicle_t found;
+        if (adsb.get_vehicle_by_ICAO(v.ICAO_address, found)) {
+            res.tracked++;
+        }
+    }
+}
+
+void setup()
+{
+    hal.console->printf("ADSB replay benchmark\n");
+    board_config.init();
+    serial_manager.init();
+    origin.lat = -353632620;
+    origin.lng = 1491652370;
+    origin.alt = 0;
+}
+
+void loop()
+{
+    static bool done;
+    if (!hal.console->is_initialized() || done) {
+        hal.scheduler->delay(100);
+        return;
+    }
+    done = true;
+
+    // allocated so that it starts zeroed like a vehicle's ADSB object
+    AP_ADSB *adsb = NEW_NOTHROW AP_ADSB();
+    if (adsb == nullptr) {
+        AP_HAL::panic("out of memory");
+    }
+    AP_Param::set_object_value(adsb, AP_ADSB::var_info, "TYPE", float(AP_ADSB::Type::uAvionix_MAVLink));
+    AP_Param::set_object_value(adsb, AP_ADSB::var_info, "LIST_MAX", REPLAY_LIST_SIZE);
+    AP_Param::set_object_value(adsb, AP_ADSB::var_info, "LIST_RADIUS", 0);
+
+    hal.console->printf("--------------------\n");
+    hal.console->printf("%7s %8s %10s %10s %10s %10s %9s %7s\n",
+                        "threats", "reports", "handle_avg", "handle_max", "update_avg", "update_max", "avoidance", "tracked");
+    for (const int16_t threats : list_threats) {
+        BenchResult res;
+        run_benchmark(*adsb, threats, res);
+        const uint32_t updates = REPLAY_DURATION_S * REPLAY_UPDATE_HZ;
+        hal.console->printf("%7d %8u %8.2fus %8uus %8.2fus %8uus %9u %7u\n",
+                            int(threats),
+                            unsigned(res.reports),
+                            res.reports > 0 ? double(res.handle_total_us) / res.reports : 0.0,
+                            unsigned(res.handle_max_us),
+                            double(res.update_total_us) / updates,
+                            unsigned(res.update_max_us),
+                            unsigned(res.avoidance_samples),
+                            unsigned(res.tracked));
+    }
+}
+
+AP_HAL_MAIN();
@@ -401,6 +401,7 @@ void AP_BattMonitor_DroneCAN::set_powered_state(bool power_on)
         if (mppt_outputenable_client == nullptr) {
             return;
         }
+        _ap_dronecan->get_canard_iface().handlers_changed();
     }
     mppt_outputenable_client->request(_node_id, request);
 }
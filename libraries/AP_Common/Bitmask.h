@@ -151,6 +151,24 @@ public:
         return -1;
     }
 
+    // return first bit set at or after start, or -1 if none set
+    int16_t next_set(uint16_t start) const {
+        if (start >= NUMBITS) {
+            return -1;
+        }
+        uint16_t i = start/32;
+        uint32_t word = bits[i] & (0xffffffffU << (start & 0x1f));
+        while (true) {
+            if (word != 0) {
+                return i*32 + __builtin_ffs(word) - 1;
+            }
+            if (++i >= NUMWORDS) {
+                return -1;
+            }
+            word = bits[i];
+        }
+    }
+
     // return number of bits available
     uint16_t size() const {
         return NUMBITS;
@@ -23,6 +23,7 @@
 # endif // AP_DDS_ARM_SERVER_ENABLED
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <AP_Common/AP_FWVersion.h>
+#include <AP_Common/ExpandingString.h>
 #include <AP_ExternalControl/AP_ExternalControl_config.h>
 
 #if AP_DDS_ARM_SERVER_ENABLED
@@ -55,44 +56,13 @@
 
 // Enable DDS at runtime by default
 static constexpr uint8_t ENABLED_BY_DEFAULT = 1;
-#if AP_DDS_TIME_PUB_ENABLED
-static constexpr uint16_t DELAY_TIME_TOPIC_MS = AP_DDS_DELAY_TIME_TOPIC_MS;
-#endif // AP_DDS_TIME_PUB_ENABLED
-#if AP_DDS_BATTERY_STATE_PUB_ENABLED
-static constexpr uint16_t DELAY_BATTERY_STATE_TOPIC_MS = AP_DDS_DELAY_BATTERY_STATE_TOPIC_MS;
-#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
-#if AP_DDS_IMU_PUB_ENABLED
-static constexpr uint16_t DELAY_IMU_TOPIC_MS = AP_DDS_DELAY_IMU_TOPIC_MS;
-#endif // AP_DDS_IMU_PUB_ENABLED
-#if AP_DDS_LOCAL_POSE_PUB_ENABLED
-static constexpr uint16_t DELAY_LOCAL_POSE_TOPIC_MS = AP_DDS_DELAY_LOCAL_POSE_TOPIC_MS;
-#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
-#if AP_DDS_LOCAL_VEL_PUB_ENABLED
-static constexpr uint16_t DELAY_LOCAL_VELOCITY_TOPIC_MS = AP_DDS_DELAY_LOCAL_VELOCITY_TOPIC_MS;
-#endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
-#if AP_DDS_AIRSPEED_PUB_ENABLED
-static constexpr uint16_t DELAY_AIRSPEED_TOPIC_MS = AP_DDS_DELAY_AIRSPEED_TOPIC_MS;
-#endif // AP_DDS_AIRSPEED_PUB_ENABLED
-#if AP_DDS_RC_PUB_ENABLED
-static constexpr uint16_t DELAY_RC_TOPIC_MS = AP_DDS_DELAY_RC_TOPIC_MS;
-#endif // AP_DDS_RC_PUB_ENABLED
-#if AP_DDS_GEOPOSE_PUB_ENABLED
-static constexpr uint16_t DELAY_GEO_POSE_TOPIC_MS = AP_DDS_DELAY_GEO_POSE_TOPIC_MS;
-#endif // AP_DDS_GEOPOSE_PUB_ENABLED
-#if AP_DDS_GOAL_PUB_ENABLED
-static constexpr uint16_t DELAY_GOAL_TOPIC_MS = AP_DDS_DELAY_GOAL_TOPIC_MS ;
-#endif // AP_DDS_GOAL_PUB_ENABLED
-#if AP_DDS_CLOCK_PUB_ENABLED
-static constexpr uint16_t DELAY_CLOCK_TOPIC_MS =AP_DDS_DELAY_CLOCK_TOPIC_MS;
-#endif // AP_DDS_CLOCK_PUB_ENABLED
-#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-static constexpr uint16_t DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS = AP_DDS_DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS;
-#endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 static constexpr uint16_t DELAY_PING_MS = 500;
 #if AP_DDS_STATUS_PUB_ENABLED
 static constexpr uint16_t DELAY_STATUS_TOPIC_MS = AP_DDS_DELAY_STATUS_TOPIC_MS;
 #endif // AP_DDS_STATUS_PUB_ENABLED
 
+AP_DDS_Client *AP_DDS_Client::_singleton;
+
 // Define the subscriber data members, which are static class scope.
 // If these are created on the stack in the subscriber,
 // the AP_DDS_Client::on_topic frame size is exceeded.
@@ -185,9 +155,168 @@ const AP_Param::GroupInfo AP_DDS_Client::var_info[] {
     // @User: Standard
     AP_GROUPINFO("_USE_NS", 7, AP_DDS_Client, use_ns, 0),
 
+#if AP_DDS_TIME_PUB_ENABLED
+    // @Param: _RATE_TIME
+    // @DisplayName: DDS time topic rate
+    // @Description: Rate at which the time topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_TIME", 8, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::TIME)], 1000 / AP_DDS_DELAY_TIME_TOPIC_MS),
+#endif // AP_DDS_TIME_PUB_ENABLED
+
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED
+    // @Param: _RATE_BATT
+    // @DisplayName: DDS battery state topic rate
+    // @Description: Rate at which the battery state topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_BATT", 9, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::BATTERY_STATE)], 1000 / AP_DDS_DELAY_BATTERY_STATE_TOPIC_MS),
+#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
+
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+    // @Param: _RATE_LPOSE
+    // @DisplayName: DDS local pose topic rate
+    // @Description: Rate at which the local pose topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_LPOSE", 10, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::LOCAL_POSE)], 1000 / AP_DDS_DELAY_LOCAL_POSE_TOPIC_MS),
+#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
+
+#if AP_DDS_LOCAL_VEL_PUB_ENABLED
+    // @Param: _RATE_LVEL
+    // @DisplayName: DDS local velocity topic rate
+    // @Description: Rate at which the local velocity topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_LVEL", 11, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::LOCAL_VELOCITY)], 1000 / AP_DDS_DELAY_LOCAL_VELOCITY_TOPIC_MS),
+#endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
+
+#if AP_DDS_AIRSPEED_PUB_ENABLED
+    // @Param: _RATE_ASPD
+    // @DisplayName: DDS airspeed topic rate
+    // @Description: Rate at which the airspeed topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_ASPD", 12, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::AIRSPEED)], 1000 / AP_DDS_DELAY_AIRSPEED_TOPIC_MS),
+#endif // AP_DDS_AIRSPEED_PUB_ENABLED
+
+#if AP_DDS_RC_PUB_ENABLED
+    // @Param: _RATE_RC
+    // @DisplayName: DDS RC topic rate
+    // @Description: Rate at which the RC topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_RC", 13, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::RC)], 1000 / AP_DDS_DELAY_RC_TOPIC_MS),
+#endif // AP_DDS_RC_PUB_ENABLED
+
+#if AP_DDS_IMU_PUB_ENABLED
+    // @Param: _RATE_IMU
+    // @DisplayName: DDS IMU topic rate
+    // @Description: Rate at which the IMU topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_IMU", 14, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::IMU)], 1000 / AP_DDS_DELAY_IMU_TOPIC_MS),
+#endif // AP_DDS_IMU_PUB_ENABLED
+
+#if AP_DDS_GEOPOSE_PUB_ENABLED
+    // @Param: _RATE_GPOSE
+    // @DisplayName: DDS geographic pose topic rate
+    // @Description: Rate at which the geographic pose topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_GPOSE", 15, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::GEOPOSE)], 1000 / AP_DDS_DELAY_GEO_POSE_TOPIC_MS),
+#endif // AP_DDS_GEOPOSE_PUB_ENABLED
+
+#if AP_DDS_CLOCK_PUB_ENABLED
+    // @Param: _RATE_CLOCK
+    // @DisplayName: DDS clock topic rate
+    // @Description: Rate at which the clock topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_CLOCK", 16, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::CLOCK)], 1000 / AP_DDS_DELAY_CLOCK_TOPIC_MS),
+#endif // AP_DDS_CLOCK_PUB_ENABLED
+
+#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+    // @Param: _RATE_ORIGIN
+    // @DisplayName: DDS GPS global origin topic rate
+    // @Description: Rate at which the GPS global origin topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_ORIGIN", 17, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::GPS_GLOBAL_ORIGIN)], 1000 / AP_DDS_DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS),
+#endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+
+#if AP_DDS_GOAL_PUB_ENABLED
+    // @Param: _RATE_GOAL
+    // @DisplayName: DDS goal topic rate
+    // @Description: Rate at which the goal topic is published. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_GOAL", 18, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::GOAL)], 1000 / AP_DDS_DELAY_GOAL_TOPIC_MS),
+#endif // AP_DDS_GOAL_PUB_ENABLED
+
+#if AP_DDS_STATUS_PUB_ENABLED
+    // @Param: _RATE_STATUS
+    // @DisplayName: DDS status topic rate
+    // @Description: Rate at which the status topic is checked for changes, and published if it has changed. Set to 0 to disable the topic.
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_STATUS", 19, AP_DDS_Client, pub_rate_hz[uint8_t(PubIndex::STATUS)], 1000 / AP_DDS_DELAY_STATUS_TOPIC_MS),
+#endif // AP_DDS_STATUS_PUB_ENABLED
+
     AP_GROUPEND
 };
 
+const char *const AP_DDS_Client::pub_names[] {
+#if AP_DDS_TIME_PUB_ENABLED
+    "time",
+#endif // AP_DDS_TIME_PUB_ENABLED
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED
+    "battery_state",
+#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+    "local_pose",
+#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
+#if AP_DDS_LOCAL_VEL_PUB_ENABLED
+    "local_velocity",
+#endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
+#if AP_DDS_AIRSPEED_PUB_ENABLED
+    "airspeed",
+#endif // AP_DDS_AIRSPEED_PUB_ENABLED
+#if AP_DDS_RC_PUB_ENABLED
+    "rc",
+#endif // AP_DDS_RC_PUB_ENABLED
+#if AP_DDS_IMU_PUB_ENABLED
+    "imu",
+#endif // AP_DDS_IMU_PUB_ENABLED
+#if AP_DDS_GEOPOSE_PUB_ENABLED
+    "geopose",
+#endif // AP_DDS_GEOPOSE_PUB_ENABLED
+#if AP_DDS_CLOCK_PUB_ENABLED
+    "clock",
+#endif // AP_DDS_CLOCK_PUB_ENABLED
+#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+    "gps_global_origin",
+#endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+#if AP_DDS_GOAL_PUB_ENABLED
+    "goal",
+#endif // AP_DDS_GOAL_PUB_ENABLED
+#if AP_DDS_STATUS_PUB_ENABLED
+    "status",
+#endif // AP_DDS_STATUS_PUB_ENABLED
+};
+
 #if AP_DDS_STATIC_TF_PUB_ENABLED | AP_DDS_LOCAL_POSE_PUB_ENABLED | AP_DDS_GEOPOSE_PUB_ENABLED | AP_DDS_IMU_PUB_ENABLED
 static void initialize(geometry_msgs_msg_Quaternion& q)
 {
@@ -795,6 +924,8 @@ bool AP_DDS_Client::start(void)
     AP_Param::setup_object_defaults(this, var_info);
     AP_Param::load_object_from_eeprom(this, var_info);
 
+    _singleton = this;
+
     if (enabled == 0) {
         return true;
     }
@@ -1320,6 +1451,7 @@ void AP_DDS_Client::main_loop(void)
         }
         connected = true;
         GCS_SEND_TEXT(MAV_SEVERITY_INFO, "%s Initialization passed", msg_prefix);
+        reset_pub_schedule();
 
 #if AP_DDS_STATIC_TF_PUB_ENABLED
         populate_static_transforms(tx_static_transforms_topic);
@@ -1641,345 +1773,344 @@ bool AP_DDS_Client::create()
     return true;
 }
 
-void AP_DDS_Client::write_time_topic()
+template <typename T>
+bool AP_DDS_Client::write_topic(TopicIndex index, const T &msg,
+                                uint32_t (*size_of_topic)(const T*, uint32_t),
+                                bool (*serialize_topic)(ucdrBuffer*, const T*))
 {
     WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = builtin_interfaces_msg_Time_size_of_topic(&time_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::TIME_PUB)].dw_id, &ub, topic_size);
-        const bool success = builtin_interfaces_msg_Time_serialize_topic(&ub, &time_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: XRCE_Client failed to serialize");
-        }
+    if (!connected) {
+        return false;
+    }
+    // the message is serialized in place in the output stream buffer,
+    // if there is no room in the stream it is dropped without being
+    // serialized
+    ucdrBuffer ub {};
+    const uint32_t topic_size = size_of_topic(&msg, 0);
+    if (uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(index)].dw_id, &ub, topic_size) == UXR_INVALID_REQUEST_ID) {
+        return false;
     }
+    // TODO sometimes serialization fails on bootup. Determine why.
+    return serialize_topic(&ub, &msg);
+}
+
+bool AP_DDS_Client::write_time_topic()
+{
+    return write_topic(TopicIndex::TIME_PUB, time_topic, builtin_interfaces_msg_Time_size_of_topic, builtin_interfaces_msg_Time_serialize_topic);
 }
 
 #if AP_DDS_NAVSATFIX_PUB_ENABLED
-void AP_DDS_Client::write_nav_sat_fix_topic()
+bool AP_DDS_Client::write_nav_sat_fix_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = sensor_msgs_msg_NavSatFix_size_of_topic(&nav_sat_fix_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::NAV_SAT_FIX_PUB)].dw_id, &ub, topic_size);
-        const bool success = sensor_msgs_msg_NavSatFix_serialize_topic(&ub, &nav_sat_fix_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::NAV_SAT_FIX_PUB, nav_sat_fix_topic, sensor_msgs_msg_NavSatFix_size_of_topic, sensor_msgs_msg_NavSatFix_serialize_topic);
 }
 #endif // AP_DDS_NAVSATFIX_PUB_ENABLED
 
 #if AP_DDS_STATIC_TF_PUB_ENABLED
-void AP_DDS_Client::write_static_transforms()
+bool AP_DDS_Client::write_static_transforms()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = tf2_msgs_msg_TFMessage_size_of_topic(&tx_static_transforms_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB)].dw_id, &ub, topic_size);
-        const bool success = tf2_msgs_msg_TFMessage_serialize_topic(&ub, &tx_static_transforms_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::STATIC_TRANSFORMS_PUB, tx_static_transforms_topic, tf2_msgs_msg_TFMessage_size_of_topic, tf2_msgs_msg_TFMessage_serialize_topic);
 }
 #endif // AP_DDS_STATIC_TF_PUB_ENABLED
 
 #if AP_DDS_BATTERY_STATE_PUB_ENABLED
-void AP_DDS_Client::write_battery_state_topic()
+bool AP_DDS_Client::write_battery_state_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = sensor_msgs_msg_BatteryState_size_of_topic(&battery_state_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::BATTERY_STATE_PUB)].dw_id, &ub, topic_size);
-        const bool success = sensor_msgs_msg_BatteryState_serialize_topic(&ub, &battery_state_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::BATTERY_STATE_PUB, battery_state_topic, sensor_msgs_msg_BatteryState_size_of_topic, sensor_msgs_msg_BatteryState_serialize_topic);
 }
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
-void AP_DDS_Client::write_local_pose_topic()
+bool AP_DDS_Client::write_local_pose_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geometry_msgs_msg_PoseStamped_size_of_topic(&local_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_POSE_PUB)].dw_id, &ub, topic_size);
-        const bool success = geometry_msgs_msg_PoseStamped_serialize_topic(&ub, &local_pose_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::LOCAL_POSE_PUB, local_pose_topic, geometry_msgs_msg_PoseStamped_size_of_topic, geometry_msgs_msg_PoseStamped_serialize_topic);
 }
 #endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
 
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
-void AP_DDS_Client::write_tx_local_velocity_topic()
+bool AP_DDS_Client::write_tx_local_velocity_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geometry_msgs_msg_TwistStamped_size_of_topic(&tx_local_velocity_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_VELOCITY_PUB)].dw_id, &ub, topic_size);
-        const bool success = geometry_msgs_msg_TwistStamped_serialize_topic(&ub, &tx_local_velocity_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::LOCAL_VELOCITY_PUB, tx_local_velocity_topic, geometry_msgs_msg_TwistStamped_size_of_topic, geometry_msgs_msg_TwistStamped_serialize_topic);
 }
 #endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
 #if AP_DDS_AIRSPEED_PUB_ENABLED
-void AP_DDS_Client::write_tx_local_airspeed_topic()
+bool AP_DDS_Client::write_tx_local_airspeed_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = ardupilot_msgs_msg_Airspeed_size_of_topic(&tx_local_airspeed_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_AIRSPEED_PUB)].dw_id, &ub, topic_size);
-        const bool success = ardupilot_msgs_msg_Airspeed_serialize_topic(&ub, &tx_local_airspeed_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::LOCAL_AIRSPEED_PUB, tx_local_airspeed_topic, ardupilot_msgs_msg_Airspeed_size_of_topic, ardupilot_msgs_msg_Airspeed_serialize_topic);
 }
 #endif // AP_DDS_AIRSPEED_PUB_ENABLED
 #if AP_DDS_RC_PUB_ENABLED
-void AP_DDS_Client::write_tx_local_rc_topic()
+bool AP_DDS_Client::write_tx_local_rc_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = ardupilot_msgs_msg_Rc_size_of_topic(&tx_local_rc_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_RC_PUB)].dw_id, &ub, topic_size);
-        const bool success = ardupilot_msgs_msg_Rc_serialize_topic(&ub, &tx_local_rc_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
-        }
-    }
+    return write_topic(TopicIndex::LOCAL_RC_PUB, tx_local_rc_topic, ardupilot_msgs_msg_Rc_size_of_topic, ardupilot_msgs_msg_Rc_serialize_topic);
 }
 #endif // AP_DDS_RC_PUB_ENABLED
 #if AP_DDS_IMU_PUB_ENABLED
-void AP_DDS_Client::write_imu_topic()
+bool AP_DDS_Client::write_imu_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = sensor_msgs_msg_Imu_size_of_topic(&imu_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::IMU_PUB)].dw_id, &ub, topic_size);
-        const bool success = sensor_msgs_msg_Imu_serialize_topic(&ub, &imu_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::IMU_PUB, imu_topic, sensor_msgs_msg_Imu_size_of_topic, sensor_msgs_msg_Imu_serialize_topic);
 }
 #endif // AP_DDS_IMU_PUB_ENABLED
 
 #if AP_DDS_GEOPOSE_PUB_ENABLED
-void AP_DDS_Client::write_geo_pose_topic()
+bool AP_DDS_Client::write_geo_pose_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geographic_msgs_msg_GeoPoseStamped_size_of_topic(&geo_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GEOPOSE_PUB)].dw_id, &ub, topic_size);
-        const bool success = geographic_msgs_msg_GeoPoseStamped_serialize_topic(&ub, &geo_pose_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::GEOPOSE_PUB, geo_pose_topic, geographic_msgs_msg_GeoPoseStamped_size_of_topic, geographic_msgs_msg_GeoPoseStamped_serialize_topic);
 }
 #endif // AP_DDS_GEOPOSE_PUB_ENABLED
 
 #if AP_DDS_CLOCK_PUB_ENABLED
-void AP_DDS_Client::write_clock_topic()
+bool AP_DDS_Client::write_clock_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = rosgraph_msgs_msg_Clock_size_of_topic(&clock_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::CLOCK_PUB)].dw_id, &ub, topic_size);
-        const bool success = rosgraph_msgs_msg_Clock_serialize_topic(&ub, &clock_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::CLOCK_PUB, clock_topic, rosgraph_msgs_msg_Clock_size_of_topic, rosgraph_msgs_msg_Clock_serialize_topic);
 }
 #endif // AP_DDS_CLOCK_PUB_ENABLED
 
 #if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-void AP_DDS_Client::write_gps_global_origin_topic()
+bool AP_DDS_Client::write_gps_global_origin_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geographic_msgs_msg_GeoPointStamped_size_of_topic(&gps_global_origin_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB)].dw_id, &ub, topic_size);
-        const bool success = geographic_msgs_msg_GeoPointStamped_serialize_topic(&ub, &gps_global_origin_topic);
-        if (!success) {
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::GPS_GLOBAL_ORIGIN_PUB, gps_global_origin_topic, geographic_msgs_msg_GeoPointStamped_size_of_topic, geographic_msgs_msg_GeoPointStamped_serialize_topic);
 }
 #endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 
 #if AP_DDS_GOAL_PUB_ENABLED
-void AP_DDS_Client::write_goal_topic()
+bool AP_DDS_Client::write_goal_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = geographic_msgs_msg_GeoPointStamped_size_of_topic(&goal_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GOAL_PUB)].dw_id, &ub, topic_size);
-        const bool success = geographic_msgs_msg_GeoPointStamped_serialize_topic(&ub, &goal_topic);
-        if (!success) {
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::GOAL_PUB, goal_topic, geographic_msgs_msg_GeoPointStamped_size_of_topic, geographic_msgs_msg_GeoPointStamped_serialize_topic);
 }
 #endif // AP_DDS_GOAL_PUB_ENABLED
 
 #if AP_DDS_STATUS_PUB_ENABLED
-void AP_DDS_Client::write_status_topic()
+bool AP_DDS_Client::write_status_topic()
 {
-    WITH_SEMAPHORE(csem);
-    if (connected) {
-        ucdrBuffer ub {};
-        const uint32_t topic_size = ardupilot_msgs_msg_Status_size_of_topic(&status_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::STATUS_PUB)].dw_id, &ub, topic_size);
-        const bool success = ardupilot_msgs_msg_Status_serialize_topic(&ub, &status_topic);
-        if (!success) {
-            // TODO sometimes serialization fails on bootup. Determine why.
-            // AP_HAL::panic("FATAL: DDS_Client failed to serialize");
-        }
-    }
+    return write_topic(TopicIndex::STATUS_PUB, status_topic, ardupilot_msgs_msg_Status_size_of_topic, ardupilot_msgs_msg_Status_serialize_topic);
 }
 #endif // AP_DDS_STATUS_PUB_ENABLED
 
-void AP_DDS_Client::update()
+/*
+  spread the first publication of each topic over successive updates,
+  so that topics with the same rate keep falling in different updates
+ */
+void AP_DDS_Client::reset_pub_schedule()
 {
     WITH_SEMAPHORE(csem);
-    const auto cur_time_ms = AP_HAL::millis64();
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i = 0; i < NUM_PUBS; i++) {
+        pub_state[i].next_us = now_us + i * AP_DDS_PUB_STAGGER_US;
+    }
+}
+
+/*
+  return true if a publisher is due. The next due time advances by
+  whole periods so the publication rate does not drift with the update
+  rate, unless the publisher has fallen more than a period behind.
+  At most AP_DDS_MAX_PUBS_PER_UPDATE publications are made in each
+  update, any others that are due are held back to the next update
+ */
+bool AP_DDS_Client::pub_due(PubIndex index)
+{
+    auto &state = pub_state[uint8_t(index)];
+    const int16_t rate_hz = pub_rate_hz[uint8_t(index)];
+    if (rate_hz <= 0) {
+        return false;
+    }
+    const uint64_t now_us = AP_HAL::micros64();
+    if (now_us < state.next_us) {
+        return false;
+    }
+    if (pubs_this_update >= AP_DDS_MAX_PUBS_PER_UPDATE) {
+        state.deferred++;
+        return false;
+    }
+    pubs_this_update++;
+
+    state.runs++;
+    const uint32_t late_us = MIN(now_us - state.next_us, UINT32_MAX);
+    state.late_max_us = MAX(state.late_max_us, late_us);
+    state.late_total_us += late_us;
 
+    const uint32_t period_us = 1000000U / MIN(rate_hz, 1000);
+    state.next_us += period_us;
+    if (state.next_us <= now_us) {
+        state.next_us = now_us + period_us;
+    }
+    pub_start_us = now_us;
+    return true;
+}
+
+void AP_DDS_Client::pub_done(PubIndex index, bool written)
+{
+    auto &state = pub_state[uint8_t(index)];
+    if (written) {
+        state.published++;
+    } else {
+        state.dropped++;
+    }
+    const uint32_t write_us = AP_HAL::micros64() - pub_start_us;
+    state.write_max_us = MAX(state.write_max_us, write_us);
+    state.write_total_us += write_us;
+}
+
+/*
+  sample and write a periodic publication that pub_due() has started
+ */
+void AP_DDS_Client::publish(PubIndex index)
+{
+    switch (index) {
 #if AP_DDS_TIME_PUB_ENABLED
-    if (cur_time_ms - last_time_time_ms > DELAY_TIME_TOPIC_MS) {
+    case PubIndex::TIME:
         update_topic(time_topic);
-        last_time_time_ms = cur_time_ms;
-        write_time_topic();
-    }
+        pub_done(PubIndex::TIME, write_time_topic());
+        break;
 #endif // AP_DDS_TIME_PUB_ENABLED
-#if AP_DDS_NAVSATFIX_PUB_ENABLED
-    for (uint8_t gps_instance = 0; gps_instance < GPS_MAX_INSTANCES; gps_instance++) {
-        if (update_topic(nav_sat_fix_topic, gps_instance)) {
-            write_nav_sat_fix_topic();
-        }
-    }
-#endif // AP_DDS_NAVSATFIX_PUB_ENABLED
 #if AP_DDS_BATTERY_STATE_PUB_ENABLED
-    if (cur_time_ms - last_battery_state_time_ms > DELAY_BATTERY_STATE_TOPIC_MS) {
-        for (uint8_t battery_instance = 0; battery_instance < AP_BATT_MONITOR_MAX_INSTANCES; battery_instance++) {
-            update_topic(battery_state_topic, battery_instance);
-            if (battery_state_topic.present) {
-                write_battery_state_topic();
+    case PubIndex::BATTERY_STATE:
+        {
+            // one publication covers every battery, it is dropped if
+            // any of them could not be written
+            bool any_present = false;
+            bool written = true;
+            for (uint8_t battery_instance = 0; battery_instance < AP_BATT_MONITOR_MAX_INSTANCES; battery_instance++) {
+                update_topic(battery_state_topic, battery_instance);
+                if (battery_state_topic.present) {
+                    any_present = true;
+                    written &= write_battery_state_topic();
+                }
+            }
+            if (any_present) {
+                pub_done(PubIndex::BATTERY_STATE, written);
             }
         }
-        last_battery_state_time_ms = cur_time_ms;
-    }
+        break;
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
-    if (cur_time_ms - last_local_pose_time_ms > DELAY_LOCAL_POSE_TOPIC_MS) {
+    case PubIndex::LOCAL_POSE:
         update_topic(local_pose_topic);
-        last_local_pose_time_ms = cur_time_ms;
-        write_local_pose_topic();
-    }
+        pub_done(PubIndex::LOCAL_POSE, write_local_pose_topic());
+        break;
 #endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
-    if (cur_time_ms - last_local_velocity_time_ms > DELAY_LOCAL_VELOCITY_TOPIC_MS) {
+    case PubIndex::LOCAL_VELOCITY:
         update_topic(tx_local_velocity_topic);
-        last_local_velocity_time_ms = cur_time_ms;
-        write_tx_local_velocity_topic();
-    }
+        pub_done(PubIndex::LOCAL_VELOCITY, write_tx_local_velocity_topic());
+        break;
 #endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
 #if AP_DDS_AIRSPEED_PUB_ENABLED
-    if (cur_time_ms - last_airspeed_time_ms > DELAY_AIRSPEED_TOPIC_MS) {
-        last_airspeed_time_ms = cur_time_ms;
+    case PubIndex::AIRSPEED:
         if (update_topic(tx_local_airspeed_topic)) {
-            write_tx_local_airspeed_topic();
+            pub_done(PubIndex::AIRSPEED, write_tx_local_airspeed_topic());
         }
-    }
+        break;
 #endif // AP_DDS_AIRSPEED_PUB_ENABLED
 #if AP_DDS_RC_PUB_ENABLED
-    if (cur_time_ms - last_rc_time_ms > DELAY_RC_TOPIC_MS) {
-        last_rc_time_ms = cur_time_ms;
+    case PubIndex::RC:
         if (update_topic(tx_local_rc_topic)) {
-            write_tx_local_rc_topic();
+            pub_done(PubIndex::RC, write_tx_local_rc_topic());
         }
-    }
+        break;
 #endif // AP_DDS_RC_PUB_ENABLED
 #if AP_DDS_IMU_PUB_ENABLED
-    if (cur_time_ms - last_imu_time_ms > DELAY_IMU_TOPIC_MS) {
+    case PubIndex::IMU:
         update_topic(imu_topic);
-        last_imu_time_ms = cur_time_ms;
-        write_imu_topic();
-    }
+        pub_done(PubIndex::IMU, write_imu_topic());
+        break;
 #endif // AP_DDS_IMU_PUB_ENABLED
 #if AP_DDS_GEOPOSE_PUB_ENABLED
-    if (cur_time_ms - last_geo_pose_time_ms > DELAY_GEO_POSE_TOPIC_MS) {
+    case PubIndex::GEOPOSE:
         update_topic(geo_pose_topic);
-        last_geo_pose_time_ms = cur_time_ms;
-        write_geo_pose_topic();
-    }
+        pub_done(PubIndex::GEOPOSE, write_geo_pose_topic());
+        break;
 #endif // AP_DDS_GEOPOSE_PUB_ENABLED
 #if AP_DDS_CLOCK_PUB_ENABLED
-    if (cur_time_ms - last_clock_time_ms > DELAY_CLOCK_TOPIC_MS) {
+    case PubIndex::CLOCK:
         update_topic(clock_topic);
-        last_clock_time_ms = cur_time_ms;
-        write_clock_topic();
-    }
+        pub_done(PubIndex::CLOCK, write_clock_topic());
+        break;
 #endif // AP_DDS_CLOCK_PUB_ENABLED
 #if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
-    if (cur_time_ms - last_gps_global_origin_time_ms > DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS) {
+    case PubIndex::GPS_GLOBAL_ORIGIN:
         update_topic(gps_global_origin_topic);
-        last_gps_global_origin_time_ms = cur_time_ms;
-        write_gps_global_origin_topic();
-    }
+        pub_done(PubIndex::GPS_GLOBAL_ORIGIN, write_gps_global_origin_topic());
+        break;
 #endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 #if AP_DDS_GOAL_PUB_ENABLED
-    if (cur_time_ms - last_goal_time_ms > DELAY_GOAL_TOPIC_MS) {
+    case PubIndex::GOAL:
         if (update_topic_goal(goal_topic)) {
-            write_goal_topic();
+            pub_done(PubIndex::GOAL, write_goal_topic());
         }
-        last_goal_time_ms = cur_time_ms;
-    }
+        break;
 #endif // AP_DDS_GOAL_PUB_ENABLED
 #if AP_DDS_STATUS_PUB_ENABLED
-    if (cur_time_ms - last_status_check_time_ms > DELAY_STATUS_TOPIC_MS) {
+    case PubIndex::STATUS:
         if (update_topic(status_topic)) {
-            write_status_topic();
+            pub_done(PubIndex::STATUS, write_status_topic());
         }
-        last_status_check_time_ms = cur_time_ms;
-    }
+        break;
 #endif // AP_DDS_STATUS_PUB_ENABLED
+    case PubIndex::COUNT:
+        break;
+    }
+}
+
+void AP_DDS_Client::update()
+{
+    WITH_SEMAPHORE(csem);
+    pubs_this_update = 0;
+
+#if AP_DDS_NAVSATFIX_PUB_ENABLED
+    for (uint8_t gps_instance = 0; gps_instance < GPS_MAX_INSTANCES; gps_instance++) {
+        if (update_topic(nav_sat_fix_topic, gps_instance)) {
+            write_nav_sat_fix_topic();
+        }
+    }
+#endif // AP_DDS_NAVSATFIX_PUB_ENABLED
+
+    // rotate the publisher checked first so that when more are due
+    // than AP_DDS_MAX_PUBS_PER_UPDATE allows it is not always the
+    // same ones which are held back
+    uint8_t next = pub_first;
+    for (uint8_t i = 0; i < NUM_PUBS; i++) {
+        if (pub_due(PubIndex(next))) {
+            publish(PubIndex(next));
+        }
+        if (++next >= NUM_PUBS) {
+            next = 0;
+        }
+    }
+    if (++pub_first >= NUM_PUBS) {
+        pub_first = 0;
+    }
 
     status_ok = uxr_run_session_time(&session, 1);
 }
 
+/*
+  report the rate, message counts, lateness and write time of each
+  periodic publisher
+ */
+void AP_DDS_Client::topic_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(csem);
+    str.printf("DDS %s\n", connected ? "connected" : "disconnected");
+    str.printf("%-18s %5s %8s %6s %6s %8s %8s %8s %8s\n",
+               "topic", "rate", "sent", "drop", "defer", "lateAvg", "lateMax", "writeAvg", "writeMax");
+    for (uint8_t i = 0; i < NUM_PUBS; i++) {
+        const auto &state = pub_state[i];
+        const uint32_t runs = MAX(state.runs, 1U);
+        const uint32_t writes = MAX(state.published + state.dropped, 1U);
+        str.printf("%-18s %5d %8u %6u %6u %8u %8u %8u %8u\n",
+                   pub_names[i],
+                   int(pub_rate_hz[i].get()),
+                   unsigned(state.published),
+                   unsigned(state.dropped),
+                   unsigned(state.deferred),
+                   unsigned(state.late_total_us / runs),
+                   unsigned(state.late_max_us),
+                   unsigned(state.write_total_us / writes),
+                   unsigned(state.write_max_us));
+    }
+}
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
 extern "C" {
     int clock_gettime(clockid_t clockid, struct timespec *ts);
@@ -81,6 +81,9 @@
 
 extern const AP_HAL::HAL& hal;
 
+// defined in AP_DDS_Topic_Table.h
+enum class TopicIndex : uint8_t;
+
 class AP_DDS_Client
 {
 
@@ -102,83 +105,65 @@ private:
 
 #if AP_DDS_TIME_PUB_ENABLED
     builtin_interfaces_msg_Time time_topic;
-    // The last ms timestamp AP_DDS wrote a Time message
-    uint64_t last_time_time_ms;
     //! @brief Serialize the current time state and publish to the IO stream(s)
-    void write_time_topic();
+    bool write_time_topic();
     static void update_topic(builtin_interfaces_msg_Time& msg);
 #endif // AP_DDS_TIME_PUB_ENABLED
 
 #if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
     geographic_msgs_msg_GeoPointStamped gps_global_origin_topic;
-    // The last ms timestamp AP_DDS wrote a gps global origin message
-    uint64_t last_gps_global_origin_time_ms;
     //! @brief Serialize the current gps global origin and publish to the IO stream(s)
-    void write_gps_global_origin_topic();
+    bool write_gps_global_origin_topic();
     static void update_topic(geographic_msgs_msg_GeoPointStamped& msg);
 # endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
 
 #if AP_DDS_GOAL_PUB_ENABLED
     geographic_msgs_msg_GeoPointStamped goal_topic;
-    // The last ms timestamp AP_DDS wrote a goal message
-    uint64_t last_goal_time_ms;
     //! @brief Serialize the current goal and publish to the IO stream(s)
-    void write_goal_topic();
+    bool write_goal_topic();
     bool update_topic_goal(geographic_msgs_msg_GeoPointStamped& msg);
     geographic_msgs_msg_GeoPointStamped prev_goal_msg;
 #endif // AP_DDS_GOAL_PUB_ENABLED
 
 #if AP_DDS_GEOPOSE_PUB_ENABLED
     geographic_msgs_msg_GeoPoseStamped geo_pose_topic;
-    // The last ms timestamp AP_DDS wrote a GeoPose message
-    uint64_t last_geo_pose_time_ms;
     //! @brief Serialize the current geo_pose and publish to the IO stream(s)
-    void write_geo_pose_topic();
+    bool write_geo_pose_topic();
     static void update_topic(geographic_msgs_msg_GeoPoseStamped& msg);
 #endif // AP_DDS_GEOPOSE_PUB_ENABLED
 
 #if AP_DDS_LOCAL_POSE_PUB_ENABLED
     geometry_msgs_msg_PoseStamped local_pose_topic;
-    // The last ms timestamp AP_DDS wrote a Local Pose message
-    uint64_t last_local_pose_time_ms;
     //! @brief Serialize the current local_pose and publish to the IO stream(s)
-    void write_local_pose_topic();
+    bool write_local_pose_topic();
     static void update_topic(geometry_msgs_msg_PoseStamped& msg);
 #endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
 
 #if AP_DDS_LOCAL_VEL_PUB_ENABLED
     geometry_msgs_msg_TwistStamped tx_local_velocity_topic;
-    // The last ms timestamp AP_DDS wrote a Local Velocity message
-    uint64_t last_local_velocity_time_ms;
     //! @brief Serialize the current local velocity and publish to the IO stream(s)
-    void write_tx_local_velocity_topic();
+    bool write_tx_local_velocity_topic();
     static void update_topic(geometry_msgs_msg_TwistStamped& msg);
 #endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
 
 #if AP_DDS_AIRSPEED_PUB_ENABLED
     ardupilot_msgs_msg_Airspeed tx_local_airspeed_topic;
-    // The last ms timestamp AP_DDS wrote a airspeed message
-    uint64_t last_airspeed_time_ms;
     //! @brief Serialize the current local airspeed and publish to the IO stream(s)
-    void write_tx_local_airspeed_topic();
+    bool write_tx_local_airspeed_topic();
     static bool update_topic(ardupilot_msgs_msg_Airspeed& msg);
 #endif //AP_DDS_AIRSPEED_PUB_ENABLED
 
 #if AP_DDS_RC_PUB_ENABLED
     ardupilot_msgs_msg_Rc tx_local_rc_topic;
-    // The last ms timestamp AP_DDS wrote a rc message
-    uint64_t last_rc_time_ms;
     //! @brief Serialize the current local rc and publish to the IO stream(s)
-    void write_tx_local_rc_topic();
+    bool write_tx_local_rc_topic();
     static bool update_topic(ardupilot_msgs_msg_Rc& msg);
 #endif //AP_DDS_RC_PUB_ENABLED
 
 #if AP_DDS_BATTERY_STATE_PUB_ENABLED
     sensor_msgs_msg_BatteryState battery_state_topic;
-    // The last ms timestamp AP_DDS wrote a BatteryState message
-    uint64_t last_battery_state_time_ms;
     //! @brief Serialize the current nav_sat_fix state and publish it to the IO stream(s)
-    void write_battery_state_topic();
+    bool write_battery_state_topic();
     static void update_topic(sensor_msgs_msg_BatteryState& msg, const uint8_t instance);
 #endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
 
@@ -187,25 +172,21 @@ private:
     // The last ms timestamp AP_DDS wrote a NavSatFix message
     uint64_t last_nav_sat_fix_time_ms[GPS_MAX_INSTANCES];
     //! @brief Serialize the current nav_sat_fix state and publish to the IO stream(s)
-    void write_nav_sat_fix_topic();
+    bool write_nav_sat_fix_topic();
     bool update_topic(sensor_msgs_msg_NavSatFix& msg, const uint8_t instance) WARN_IF_UNUSED;
 #endif // AP_DDS_NAVSATFIX_PUB_ENABLED
 
 #if AP_DDS_IMU_PUB_ENABLED
     sensor_msgs_msg_Imu imu_topic;
-    // The last ms timestamp AP_DDS wrote an IMU message
-    uint64_t last_imu_time_ms;
     static void update_topic(sensor_msgs_msg_Imu& msg);
     //! @brief Serialize the current IMU data and publish to the IO stream(s)
-    void write_imu_topic();
+    bool write_imu_topic();
 #endif // AP_DDS_IMU_PUB_ENABLED
 
 #if AP_DDS_CLOCK_PUB_ENABLED
     rosgraph_msgs_msg_Clock clock_topic;
-    // The last ms timestamp AP_DDS wrote a Clock message
-    uint64_t last_clock_time_ms;
     //! @brief Serialize the current clock and publish to the IO stream(s)
-    void write_clock_topic();
+    bool write_clock_topic();
     static void update_topic(rosgraph_msgs_msg_Clock& msg);
 #endif // AP_DDS_CLOCK_PUB_ENABLED
 
@@ -219,23 +200,104 @@ private:
 #if AP_DDS_STATUS_PUB_ENABLED
     ardupilot_msgs_msg_Status status_topic;
     bool update_topic(ardupilot_msgs_msg_Status& msg);
-    // The last ms timestamps AP_DDS wrote/checked/published a status message
-    uint64_t last_status_check_time_ms;
+    // The last ms timestamp AP_DDS published a status message
     uint64_t last_status_publish_time_ms;
     // last status values;
     ardupilot_msgs_msg_Status last_status_msg_;
     //! @brief Serialize the current status and publish to the IO stream(s)
-    void write_status_topic();
+    bool write_status_topic();
 #endif // AP_DDS_STATUS_PUB_ENABLED
 
 #if AP_DDS_STATIC_TF_PUB_ENABLED
     // outgoing transforms
     tf2_msgs_msg_TFMessage tx_static_transforms_topic;
     //! @brief Serialize the static transforms and publish to the IO stream(s)
-    void write_static_transforms();
+    bool write_static_transforms();
     static void populate_static_transforms(tf2_msgs_msg_TFMessage& msg);
 #endif // AP_DDS_STATIC_TF_PUB_ENABLED
 
+    //! @brief Serialize a topic straight into the reliable output stream
+    //! @return True if the topic was queued, false if the stream was full or serialization failed
+    template <typename T>
+    bool write_topic(TopicIndex index, const T &msg,
+                     uint32_t (*size_of_topic)(const T*, uint32_t),
+                     bool (*serialize_topic)(ucdrBuffer*, const T*));
+
+    // periodic publishers, run by the topic scheduler at the rates
+    // given by the DDS_RATE_* parameters
+    enum class PubIndex : uint8_t {
+#if AP_DDS_TIME_PUB_ENABLED
+        TIME,
+#endif // AP_DDS_TIME_PUB_ENABLED
+#if AP_DDS_BATTERY_STATE_PUB_ENABLED
+        BATTERY_STATE,
+#endif // AP_DDS_BATTERY_STATE_PUB_ENABLED
+#if AP_DDS_LOCAL_POSE_PUB_ENABLED
+        LOCAL_POSE,
+#endif // AP_DDS_LOCAL_POSE_PUB_ENABLED
+#if AP_DDS_LOCAL_VEL_PUB_ENABLED
+        LOCAL_VELOCITY,
+#endif // AP_DDS_LOCAL_VEL_PUB_ENABLED
+#if AP_DDS_AIRSPEED_PUB_ENABLED
+        AIRSPEED,
+#endif // AP_DDS_AIRSPEED_PUB_ENABLED
+#if AP_DDS_RC_PUB_ENABLED
+        RC,
+#endif // AP_DDS_RC_PUB_ENABLED
+#if AP_DDS_IMU_PUB_ENABLED
+        IMU,
+#endif // AP_DDS_IMU_PUB_ENABLED
+#if AP_DDS_GEOPOSE_PUB_ENABLED
+        GEOPOSE,
+#endif // AP_DDS_GEOPOSE_PUB_ENABLED
+#if AP_DDS_CLOCK_PUB_ENABLED
+        CLOCK,
+#endif // AP_DDS_CLOCK_PUB_ENABLED
+#if AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+        GPS_GLOBAL_ORIGIN,
+#endif // AP_DDS_GPS_GLOBAL_ORIGIN_PUB_ENABLED
+#if AP_DDS_GOAL_PUB_ENABLED
+        GOAL,
+#endif // AP_DDS_GOAL_PUB_ENABLED
+#if AP_DDS_STATUS_PUB_ENABLED
+        STATUS,
+#endif // AP_DDS_STATUS_PUB_ENABLED
+        COUNT
+    };
+    static constexpr uint8_t NUM_PUBS = uint8_t(PubIndex::COUNT);
+    static const char *const pub_names[NUM_PUBS];
+
+    // publication rates in Hz, zero disables the publisher
+    AP_Int16 pub_rate_hz[NUM_PUBS];
+
+    // schedule and statistics for each periodic publisher
+    struct {
+        uint64_t next_us;           // time the next publication is due
+        uint32_t runs;              // times the publisher has run
+        uint32_t published;         // publications queued to the output stream
+        uint32_t dropped;           // publications lost to a full output stream
+        uint32_t deferred;          // updates a due publication was held back by the per-update limit
+        uint32_t late_max_us;       // longest delay from due time to publication
+        uint64_t late_total_us;
+        uint32_t write_max_us;      // longest time to sample and serialize
+        uint64_t write_total_us;
+    } pub_state[NUM_PUBS];
+
+    // publications started in the current update() and the start time of the current one
+    uint8_t pubs_this_update;
+    uint64_t pub_start_us;
+    // publisher checked first in the next update()
+    uint8_t pub_first;
+
+    //! @brief Stagger the publishers so topics with equal rates fall in different updates
+    void reset_pub_schedule();
+    //! @brief Check whether a publisher is due, and if so start its publication
+    bool pub_due(PubIndex index);
+    //! @brief Record the result of writing a publication started by pub_due()
+    void pub_done(PubIndex index, bool written);
+    //! @brief Sample and write a periodic publication
+    void publish(PubIndex index);
+
 #if AP_DDS_JOY_SUB_ENABLED
     // incoming joystick data
     static sensor_msgs_msg_Joy rx_joy_topic;
@@ -325,6 +387,8 @@ private:
 
     static void dds_format_name(char* buf, const char* dds_prefix, uint8_t sysid, const char* name, bool use_sysid_ns);
 
+    static AP_DDS_Client *_singleton;
+
 
 public:
     ~AP_DDS_Client();
@@ -348,6 +412,11 @@ public:
     //! @brief Update the internally stored DDS messages with latest data
     void update();
 
+    //! @brief Report per-topic publication statistics
+    void topic_info(class ExpandingString &str);
+
+    static AP_DDS_Client *get_singleton() { return _singleton; }
+
     //! @brief GCS message prefix
     static constexpr const char* msg_prefix = "DDS:";
 
@@ -129,6 +129,18 @@
 #ifndef AP_DDS_DELAY_GOAL_TOPIC_MS
 #define AP_DDS_DELAY_GOAL_TOPIC_MS  200
 #endif
+
+// maximum number of periodic topics published in each update, topics
+// beyond this are held back to the next update
+#ifndef AP_DDS_MAX_PUBS_PER_UPDATE
+#define AP_DDS_MAX_PUBS_PER_UPDATE 4
+#endif
+
+// offset between the first publication of each periodic topic
+#ifndef AP_DDS_PUB_STAGGER_US
+#define AP_DDS_PUB_STAGGER_US 1000
+#endif
+
 #ifndef AP_DDS_STATUS_PUB_ENABLED
 #define AP_DDS_STATUS_PUB_ENABLED 1
 #endif
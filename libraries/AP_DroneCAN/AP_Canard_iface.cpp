@@ -9,9 +9,20 @@
 extern const AP_HAL::HAL& hal;
 #include <canard.h>
 #include <AP_CANManager/AP_CANSensor.h>
+#include <AP_Common/ExpandingString.h>
 
 #define DEBUG_PKTS 0
 
+// how often the handler list is re-checked for a cached message type,
+// as a backstop for handlers added or removed at runtime without a
+// call to handlers_changed()
+#define DISPATCH_RECHECK_MS 1000
+
+// window over which message rates are calculated
+#define MSG_RATE_WINDOW_MS 1000
+
+static_assert((AP_DRONECAN_DISPATCH_TABLE_SIZE & (AP_DRONECAN_DISPATCH_TABLE_SIZE-1)) == 0, "AP_DRONECAN_DISPATCH_TABLE_SIZE must be a power of 2");
+
 #define CANARD_MSG_TYPE_FROM_ID(x)                         ((uint16_t)(((x) >> 8U)  & 0xFFFFU))
 
 DEFINE_HANDLER_LIST_HEADS();
@@ -96,6 +107,7 @@ bool CanardInterface::broadcast(const Canard::Transfer &bcast_transfer) {
 #endif
     };
     // do canard broadcast
+    const uint32_t start_us = AP_HAL::micros();
     int16_t ret = canardBroadcastObj(&canard, &tx_transfer);
 #if AP_TEST_DRONECAN_DRIVERS
     if (this == &test_iface) {
@@ -106,6 +118,7 @@ bool CanardInterface::broadcast(const Canard::Transfer &bcast_transfer) {
         protocol_stats.tx_errors++;
     } else {
         protocol_stats.tx_frames += ret;
+        count_tx_transfer(bcast_transfer, AP_HAL::micros() - start_us);
     }
     return ret > 0;
 }
@@ -133,11 +146,13 @@ bool CanardInterface::request(uint8_t destination_node_id, const Canard::Transfe
 #endif
     };
     // do canard request
+    const uint32_t start_us = AP_HAL::micros();
     int16_t ret = canardRequestOrRespondObj(&canard, destination_node_id, &tx_transfer);
     if (ret <= 0) {
         protocol_stats.tx_errors++;
     } else {
         protocol_stats.tx_frames += ret;
+        count_tx_transfer(req_transfer, AP_HAL::micros() - start_us);
     }
     return ret > 0;
 }
@@ -165,18 +180,30 @@ bool CanardInterface::respond(uint8_t destination_node_id, const Canard::Transfe
 #endif
     };
     // do canard respond
+    const uint32_t start_us = AP_HAL::micros();
     int16_t ret = canardRequestOrRespondObj(&canard, destination_node_id, &tx_transfer);
     if (ret <= 0) {
         protocol_stats.tx_errors++;
     } else {
         protocol_stats.tx_frames += ret;
+        count_tx_transfer(res_transfer, AP_HAL::micros() - start_us);
     }
     return ret > 0;
 }
 
 void CanardInterface::onTransferReception(CanardInstance* ins, CanardRxTransfer* transfer) {
     CanardInterface* iface = (CanardInterface*) ins->user_reference;
+    const uint32_t start_us = AP_HAL::micros();
     iface->handle_message(*transfer);
+    const uint32_t dt_us = AP_HAL::micros() - start_us;
+
+    MsgTypeEntry *e = find_msg_type(iface->rx_types, transfer->data_type_id, transfer->transfer_type);
+    if (e != nullptr && e->state == MSG_TYPE_ACCEPT) {
+        e->transfers++;
+        e->window_count += (e->window_count < UINT16_MAX);
+        e->handler_us += dt_us;
+        e->handler_max_us = MAX(e->handler_max_us, MIN(dt_us, uint32_t(UINT16_MAX)));
+    }
 }
 
 bool CanardInterface::shouldAcceptTransfer(const CanardInstance* ins,
@@ -185,7 +212,158 @@ bool CanardInterface::shouldAcceptTransfer(const CanardInstance* ins,
                                            CanardTransferType transfer_type,
                                            uint8_t source_node_id) {
     CanardInterface* iface = (CanardInterface*) ins->user_reference;
-    return iface->accept_message(data_type_id, transfer_type, *out_data_type_signature);
+    return iface->accept_transfer(data_type_id, transfer_type, *out_data_type_signature);
+}
+
+/*
+  find the entry for a message type in a message type table. Returns
+  the empty slot the type should go in if it is not in the table, or
+  nullptr if the table is full
+ */
+CanardInterface::MsgTypeEntry *CanardInterface::find_msg_type(MsgTypeEntry *table, uint16_t data_type_id, uint8_t transfer_type)
+{
+    const uint32_t key = (uint32_t(data_type_id) << 2) | transfer_type;
+    const uint16_t mask = AP_DRONECAN_DISPATCH_TABLE_SIZE - 1;
+    uint16_t idx = ((key * 2654435761U) >> 16) & mask;
+    for (uint16_t i = 0; i < AP_DRONECAN_DISPATCH_TABLE_SIZE; i++) {
+        MsgTypeEntry &e = table[idx];
+        if (e.state == MSG_TYPE_EMPTY ||
+            (e.data_type_id == data_type_id && e.transfer_type == transfer_type)) {
+            return &e;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return nullptr;
+}
+
+/*
+  check if we have a handler for an incoming transfer, using the
+  message type table to avoid walking the handler list for every
+  transfer. Types nobody handles are cached as rejected, so unwanted
+  traffic is dropped without a walk too. Entries are looked up again
+  after handlers_changed() and every DISPATCH_RECHECK_MS. Called with
+  _sem_rx held
+ */
+bool CanardInterface::accept_transfer(uint16_t data_type_id, CanardTransferType transfer_type, uint64_t &signature)
+{
+    MsgTypeEntry *e = find_msg_type(rx_types, data_type_id, transfer_type);
+    if (e == nullptr) {
+        // table is full, fall back to the handler list
+        return accept_message(data_type_id, transfer_type, signature);
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (e->state != MSG_TYPE_EMPTY &&
+        e->handler_gen == rx_handler_gen &&
+        now_ms - e->checked_ms < DISPATCH_RECHECK_MS) {
+        if (e->state != MSG_TYPE_ACCEPT) {
+            return false;
+        }
+        signature = e->signature;
+        return true;
+    }
+    uint64_t type_signature = 0;
+    const bool accept = accept_message(data_type_id, transfer_type, type_signature);
+    e->data_type_id = data_type_id;
+    e->transfer_type = transfer_type;
+    e->state = accept ? MSG_TYPE_ACCEPT : MSG_TYPE_REJECT;
+    e->signature = type_signature;
+    e->checked_ms = now_ms;
+    e->handler_gen = rx_handler_gen;
+    if (!accept) {
+        return false;
+    }
+    signature = type_signature;
+    return true;
+}
+
+/*
+  forget the cached handler lookups, so a handler registered at
+  runtime gets the next transfer of its type
+ */
+void CanardInterface::handlers_changed(void)
+{
+    WITH_SEMAPHORE(_sem_rx);
+    rx_handler_gen++;
+}
+
+/*
+  account for a transfer queued for sending. Called with _sem_tx held
+ */
+void CanardInterface::count_tx_transfer(const Canard::Transfer &transfer, uint32_t dt_us)
+{
+    MsgTypeEntry *e = find_msg_type(tx_types, transfer.data_type_id, transfer.transfer_type);
+    if (e == nullptr) {
+        return;
+    }
+    if (e->state == MSG_TYPE_EMPTY) {
+        e->data_type_id = transfer.data_type_id;
+        e->transfer_type = transfer.transfer_type;
+        e->signature = transfer.data_type_signature;
+        e->state = MSG_TYPE_TX;
+    }
+    e->transfers++;
+    e->window_count += (e->window_count < UINT16_MAX);
+    e->handler_us += dt_us;
+    e->handler_max_us = MAX(e->handler_max_us, MIN(dt_us, uint32_t(UINT16_MAX)));
+}
+
+/*
+  update per message type rates. Called with _sem_rx and _sem_tx held
+ */
+void CanardInterface::update_msg_rates(uint32_t now_ms)
+{
+    const uint32_t dt_ms = now_ms - msg_rate_window_ms;
+    if (dt_ms < MSG_RATE_WINDOW_MS) {
+        return;
+    }
+    msg_rate_window_ms = now_ms;
+    MsgTypeEntry *tables[] { rx_types, tx_types };
+    for (MsgTypeEntry *table : tables) {
+        for (uint16_t i = 0; i < AP_DRONECAN_DISPATCH_TABLE_SIZE; i++) {
+            MsgTypeEntry &e = table[i];
+            e.rate = MIN((uint32_t(e.window_count) * 1000U + dt_ms/2) / dt_ms, uint32_t(UINT16_MAX));
+            e.window_count = 0;
+        }
+    }
+}
+
+/*
+  print one message type table
+ */
+void CanardInterface::msg_table_info(ExpandingString &str, const char *name, MsgTypeEntry *table)
+{
+    // indexed by CanardTransferType
+    static const char *type_names[] = { "RES", "REQ", "MSG" };
+    str.printf("%-3s %5s %5s %9s %6s %6s\n", name, "id", "rate", "count", "avg", "max");
+    for (uint16_t i = 0; i < AP_DRONECAN_DISPATCH_TABLE_SIZE; i++) {
+        const MsgTypeEntry &e = table[i];
+        if (e.state == MSG_TYPE_EMPTY || e.transfers == 0) {
+            continue;
+        }
+        str.printf("%-3s %5u %5u %9u %6u %6u\n",
+                   e.transfer_type < ARRAY_SIZE(type_names) ? type_names[e.transfer_type] : "?",
+                   unsigned(e.data_type_id),
+                   unsigned(e.rate),
+                   unsigned(e.transfers),
+                   unsigned(e.handler_us / e.transfers),
+                   unsigned(e.handler_max_us));
+    }
+}
+
+/*
+  report per message type transfer rates and the time spent handling
+  received transfers and encoding transmitted transfers, in microseconds
+ */
+void CanardInterface::msg_stats_info(ExpandingString &str)
+{
+    {
+        WITH_SEMAPHORE(_sem_rx);
+        msg_table_info(str, "RX", rx_types);
+    }
+    {
+        WITH_SEMAPHORE(_sem_tx);
+        msg_table_info(str, "TX", tx_types);
+    }
 }
 
 #if AP_TEST_DRONECAN_DRIVERS
@@ -218,8 +396,9 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
         // we need to ensure that this is not optimized
         volatile const auto *stats = ifaces[iface]->get_statistics();
         uint64_t last_transmit_us = stats==nullptr?0:stats->last_transmit_us;
+        const uint64_t now_us = AP_HAL::micros64();
         bool iface_down = true;
-        if (stats == nullptr || (AP_HAL::micros64() - last_transmit_us) < 200000UL) {
+        if (stats == nullptr || (now_us - last_transmit_us) < 200000UL) {
             /*
             We were not able to queue the frame for
             sending. Only mark the send as failing if the
@@ -227,56 +406,61 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
             active if it has had successful transmits for some time.
             */
             iface_down = false;
-        } 
-        // scan through list of pending transfers
-        while (true) {
-            auto txf = &txq->frame;
-            if (raw_commands_only &&
-                CANARD_MSG_TYPE_FROM_ID(txf->id) != UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_ID &&
-                CANARD_MSG_TYPE_FROM_ID(txf->id) != COM_HOBBYWING_ESC_RAWCOMMAND_ID) {
-                // look at next transfer
-                txq = txq->next;
-                if (txq == nullptr) {
-                    break;
+        }
+        // scan through list of pending transfers, handing frames to
+        // the interface in batches
+        while (txq != nullptr) {
+            CanardCANFrame *batch[AP_DRONECAN_FRAME_BATCH];
+            AP_HAL::CANFrame txmsg[AP_DRONECAN_FRAME_BATCH];
+            uint64_t deadline_us[AP_DRONECAN_FRAME_BATCH];
+            uint8_t num_frames = 0;
+            for (; txq != nullptr && num_frames < AP_DRONECAN_FRAME_BATCH; txq = txq->next) {
+                auto txf = &txq->frame;
+                if (raw_commands_only &&
+                    CANARD_MSG_TYPE_FROM_ID(txf->id) != UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_ID &&
+                    CANARD_MSG_TYPE_FROM_ID(txf->id) != COM_HOBBYWING_ESC_RAWCOMMAND_ID) {
+                    continue;
                 }
-                continue;
-            }
-            AP_HAL::CANFrame txmsg {};
-            txmsg.dlc = AP_HAL::CANFrame::dataLengthToDlc(txf->data_len);
-            memcpy(txmsg.data, txf->data, txf->data_len);
-            txmsg.id = (txf->id | AP_HAL::CANFrame::FlagEFF);
+                if (!(txf->iface_mask & (1U<<iface)) || now_us >= txf->deadline_usec) {
+                    continue;
+                }
+                AP_HAL::CANFrame &msg = txmsg[num_frames];
+                msg = AP_HAL::CANFrame{};
+                msg.dlc = AP_HAL::CANFrame::dataLengthToDlc(txf->data_len);
+                memcpy(msg.data, txf->data, txf->data_len);
+                msg.id = (txf->id | AP_HAL::CANFrame::FlagEFF);
 #if HAL_CANFD_SUPPORTED
-            txmsg.canfd = txf->canfd;
+                msg.canfd = txf->canfd;
 #endif
+                deadline_us[num_frames] = txf->deadline_usec;
+                batch[num_frames++] = txf;
+            }
+            if (num_frames == 0) {
+                break;
+            }
+
             bool write = true;
             bool read = false;
-            ifaces[iface]->select(read, write, &txmsg, 0);
-            if (!write) {
-                // if there is no space then we need to start from the
-                // top of the queue, so wait for the next loop
+            ifaces[iface]->select(read, write, &txmsg[0], 0);
+            int16_t sent = 0;
+            if (write) {
+                sent = MAX(ifaces[iface]->send_frames(txmsg, deadline_us, num_frames, 0), 0);
+            }
+            // clear the mask for frames we have sent
+            for (uint8_t i = 0; i < sent; i++) {
+                batch[i]->iface_mask &= ~(1U<<iface);
+            }
+            if (sent < num_frames) {
                 if (!iface_down) {
+                    // if there is no space then we need to start from
+                    // the top of the queue, so wait for the next loop
                     break;
-                } else {
-                    txf->iface_mask &= ~(1U<<iface);
                 }
-            } else if ((txf->iface_mask & (1U<<iface)) && (AP_HAL::micros64() < txf->deadline_usec)) {
-                // try sending to interfaces, clearing the mask if we succeed
-                if (ifaces[iface]->send(txmsg, txf->deadline_usec, 0) > 0) {
-                    txf->iface_mask &= ~(1U<<iface);
-                } else {
-                    // if we fail to send then we try sending on next interface
-                    if (!iface_down) {
-                        break;
-                    } else {
-                        txf->iface_mask &= ~(1U<<iface);
-                    }
+                // interface is down, drop the frames for this interface
+                for (uint8_t i = sent; i < num_frames; i++) {
+                    batch[i]->iface_mask &= ~(1U<<iface);
                 }
             }
-            // look at next transfer
-            txq = txq->next;
-            if (txq == nullptr) {
-                break;
-            }
         }
     }
 
@@ -326,7 +510,9 @@ void CanardInterface::update_rx_protocol_stats(int16_t res)
 }
 
 void CanardInterface::processRx() {
-    AP_HAL::CANFrame rxmsg;
+    AP_HAL::CANFrame rxmsg[AP_DRONECAN_FRAME_BATCH];
+    uint64_t timestamp[AP_DRONECAN_FRAME_BATCH];
+    AP_HAL::CANIface::CanIOFlags flags[AP_DRONECAN_FRAME_BATCH];
     for (uint8_t i=0; i<num_ifaces; i++) {
         while(true) {
             if (ifaces[i] == NULL) {
@@ -338,36 +524,39 @@ void CanardInterface::processRx() {
             if (!read_select) { // No data pending
                 break;
             }
-            CanardCANFrame rx_frame {};
 
             //palToggleLine(HAL_GPIO_PIN_LED);
-            uint64_t timestamp;
-            AP_HAL::CANIface::CanIOFlags flags;
-            if (ifaces[i]->receive(rxmsg, timestamp, flags) <= 0) {
+            const int16_t num_frames = ifaces[i]->receive_frames(rxmsg, timestamp, flags, AP_DRONECAN_FRAME_BATCH);
+            if (num_frames <= 0) {
                 break;
             }
 
-            if (!rxmsg.isExtended()) {
-                // 11 bit frame, see if we have a handler
-                if (aux_11bit_driver != nullptr) {
-                    aux_11bit_driver->handle_frame(rxmsg);
+            for (uint8_t f = 0; f < num_frames; f++) {
+                if (!rxmsg[f].isExtended() && aux_11bit_driver != nullptr) {
+                    // 11 bit frame, see if we have a handler
+                    aux_11bit_driver->handle_frame(rxmsg[f]);
                 }
-                continue;
             }
 
-            rx_frame.data_len = AP_HAL::CANFrame::dlcToDataLength(rxmsg.dlc);
-            memcpy(rx_frame.data, rxmsg.data, rx_frame.data_len);
+            // feed the batch to libcanard under one lock
+            WITH_SEMAPHORE(_sem_rx);
+            for (uint8_t f = 0; f < num_frames; f++) {
+                const AP_HAL::CANFrame &msg = rxmsg[f];
+                if (!msg.isExtended()) {
+                    continue;
+                }
+
+                CanardCANFrame rx_frame {};
+                rx_frame.data_len = AP_HAL::CANFrame::dlcToDataLength(msg.dlc);
+                memcpy(rx_frame.data, msg.data, rx_frame.data_len);
 #if HAL_CANFD_SUPPORTED
-            rx_frame.canfd = rxmsg.canfd;
+                rx_frame.canfd = msg.canfd;
 #endif
-            rx_frame.id = rxmsg.id;
+                rx_frame.id = msg.id;
 #if CANARD_MULTI_IFACE
-            rx_frame.iface_id = i;
+                rx_frame.iface_id = i;
 #endif
-            {
-                WITH_SEMAPHORE(_sem_rx);
-
-                const int16_t res = canardHandleRxFrame(&canard, &rx_frame, timestamp);
+                const int16_t res = canardHandleRxFrame(&canard, &rx_frame, timestamp[f]);
                 if (res == -CANARD_ERROR_RX_MISSED_START) {
                     // this might remaining frames from a message that we don't accept, so check
                     uint64_t dummy_signature;
@@ -404,6 +593,7 @@ void CanardInterface::process(uint32_t duration_ms) {
             WITH_SEMAPHORE(_sem_rx);
             WITH_SEMAPHORE(_sem_tx);
             canardCleanupStaleTransfers(&canard, AP_HAL::micros64());
+            update_msg_rates(AP_HAL::millis());
         }
         const uint64_t now = AP_HAL::micros64();
         if (now < deadline) {
@@ -6,6 +6,24 @@
 
 class AP_DroneCAN;
 class CANSensor;
+class ExpandingString;
+
+#ifndef AP_DRONECAN_DISPATCH_TABLE_SIZE
+#if HAL_PROGRAM_SIZE_LIMIT_KB > 1024
+#define AP_DRONECAN_DISPATCH_TABLE_SIZE 64
+#else
+#define AP_DRONECAN_DISPATCH_TABLE_SIZE 32
+#endif
+#endif
+
+// number of frames moved between the CAN interface and libcanard per batch
+#ifndef AP_DRONECAN_FRAME_BATCH
+#if HAL_CANFD_SUPPORTED
+#define AP_DRONECAN_FRAME_BATCH 4
+#else
+#define AP_DRONECAN_FRAME_BATCH 8
+#endif
+#endif
 
 class CanardInterface : public Canard::Interface {
     friend class AP_DroneCAN;
@@ -68,6 +86,13 @@ public:
     // get reference to the semaphore that is held during message receive
     HAL_Semaphore &get_sem_rx(void) { return _sem_rx; }
 
+    // per message type transfer rates and handler time
+    void msg_stats_info(ExpandingString &str);
+
+    // must be called after registering a handler on this interface
+    // once transfers are being received
+    void handlers_changed(void);
+
 private:
     CanardInstance canard;
     AP_HAL::CANIface* ifaces[HAL_NUM_CAN_IFACES];
@@ -85,5 +110,43 @@ private:
 
     // auxillary 11 bit CANSensor
     CANSensor *aux_11bit_driver;
+
+    /*
+      table of message types seen on this interface, keyed by data
+      type id and transfer type. Holds the result of the handler list
+      lookup for incoming transfers along with per type statistics.
+     */
+    struct MsgTypeEntry {
+        uint64_t signature;
+        uint32_t transfers;         // total transfers
+        uint32_t handler_us;        // total time spent in the message handler
+        uint32_t checked_ms;        // time the handler list was last checked
+        uint16_t data_type_id;
+        uint16_t window_count;      // transfers in the current rate window
+        uint16_t rate;              // transfers per second over the last window
+        uint16_t handler_max_us;    // longest time spent in the message handler
+        uint8_t transfer_type;
+        uint8_t state;
+        uint8_t handler_gen;        // rx_handler_gen when last looked up
+    };
+    enum MsgTypeState : uint8_t {
+        MSG_TYPE_EMPTY = 0,
+        MSG_TYPE_REJECT,
+        MSG_TYPE_ACCEPT,
+        MSG_TYPE_TX,
+    };
+    // received message types, protected by _sem_rx
+    MsgTypeEntry rx_types[AP_DRONECAN_DISPATCH_TABLE_SIZE];
+    // transmitted message types, protected by _sem_tx
+    MsgTypeEntry tx_types[AP_DRONECAN_DISPATCH_TABLE_SIZE];
+    uint32_t msg_rate_window_ms;
+    // bumped by handlers_changed() to invalidate cached lookups
+    uint8_t rx_handler_gen;
+
+    static MsgTypeEntry *find_msg_type(MsgTypeEntry *table, uint16_t data_type_id, uint8_t transfer_type);
+    bool accept_transfer(uint16_t data_type_id, CanardTransferType transfer_type, uint64_t &signature);
+    void count_tx_transfer(const Canard::Transfer &transfer, uint32_t dt_us);
+    void update_msg_rates(uint32_t now_ms);
+    static void msg_table_info(ExpandingString &str, const char *name, MsgTypeEntry *table);
 };
 #endif // HAL_ENABLE_DRONECAN_DRIVERS
@@ -505,6 +505,10 @@ void AP_DroneCAN::init(uint8_t driver_index)
     serial.init(this);
 #endif
 
+    // frames were received while spinning for discovery, before the
+    // serial tunnel subscribed
+    canard_iface.handlers_changed();
+
     _initialized = true;
 }
 
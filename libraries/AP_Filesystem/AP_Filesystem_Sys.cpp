@@ -26,6 +26,17 @@
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_InertialSensor/AP_InertialSensor_rate_config.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#if HAL_ENABLE_DRONECAN_DRIVERS
+#include <AP_DroneCAN/AP_DroneCAN.h>
+#endif
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_DDS/AP_DDS_Client.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_FTP.h>
+#include <AP_GPS/AP_GPS.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -40,15 +51,40 @@ static const SysFileList sysfs_file_list[] = {
     {"memory.txt"},
     {"uarts.txt"},
     {"timers.txt"},
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+    {"fastrate.txt"},
+#endif
 #if HAL_NUM_CAN_IFACES > 0
     {"can0_stats.txt"},
     {"can1_stats.txt"},
 #endif
+#if HAL_ENABLE_DRONECAN_DRIVERS
+    {"dronecan.txt"},
+#endif
+#if AP_AHRS_NAVEKF3_ENABLED
+    {"ekf3.txt"},
+#endif
+#if HAL_LOGGING_ENABLED
+    {"logger.txt"},
+#endif
+#if AP_DDS_ENABLED
+    {"dds.txt"},
+#endif
+#if AP_MAVLINK_FTP_ENABLED
+    {"ftp.txt"},
+#endif
+#if HAL_GCS_ENABLED
+    {"routes.txt"},
+#endif
+#if AP_GPS_ENABLED
+    {"rtcm.txt"},
+#endif
 #if !defined(HAL_BOOTLOADER_BUILD) && (defined(STM32F7) || defined(STM32H7))
     {"persistent.parm"},
 #endif
     {"crash_dump.bin"},
     {"storage.bin"},
+    {"storage.txt"},
 #if AP_FILESYSTEM_SYS_FLASH_ENABLED
     {"flash.bin"},
 #endif
@@ -117,6 +153,11 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
     if (strcmp(fname, "timers.txt") == 0) {
         hal.util->timer_info(*r.str);
     }
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+    if (strcmp(fname, "fastrate.txt") == 0) {
+        AP::ins().fast_rate_timing_info(*r.str);
+    }
+#endif
 #if HAL_NUM_CAN_IFACES > 0
     int8_t can_stats_num = -1;
     if (strcmp(fname, "can0_stats.txt") == 0) {
@@ -129,6 +170,50 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
             hal.can[can_stats_num]->get_stats(*r.str);
         }
     }
+#endif
+#if HAL_ENABLE_DRONECAN_DRIVERS
+    if (strcmp(fname, "dronecan.txt") == 0) {
+        for (uint8_t i = 0; i < HAL_MAX_CAN_PROTOCOL_DRIVERS; i++) {
+            AP_DroneCAN *dronecan = AP_DroneCAN::get_dronecan(i);
+            if (dronecan != nullptr) {
+                r.str->printf("DroneCAN%u\n", unsigned(i+1));
+                dronecan->get_canard_iface().msg_stats_info(*r.str);
+            }
+        }
+    }
+#endif
+#if AP_AHRS_NAVEKF3_ENABLED
+    if (strcmp(fname, "ekf3.txt") == 0) {
+        AP::ahrs().ekf3.EKF3.buffer_info(*r.str);
+    }
+#endif
+#if HAL_LOGGING_ENABLED
+    if (strcmp(fname, "logger.txt") == 0) {
+        AP::logger().io_info(*r.str);
+    }
+#endif
+#if AP_DDS_ENABLED
+    if (strcmp(fname, "dds.txt") == 0) {
+        AP_DDS_Client *dds = AP_DDS_Client::get_singleton();
+        if (dds != nullptr) {
+            dds->topic_info(*r.str);
+        }
+    }
+#endif
+#if AP_MAVLINK_FTP_ENABLED
+    if (strcmp(fname, "ftp.txt") == 0) {
+        GCS_FTP::ftp_info(*r.str);
+    }
+#endif
+#if HAL_GCS_ENABLED
+    if (strcmp(fname, "routes.txt") == 0) {
+        GCS_MAVLINK::routing_info(*r.str);
+    }
+#endif
+#if AP_GPS_ENABLED
+    if (strcmp(fname, "rtcm.txt") == 0) {
+        AP::gps().rtcm_info(*r.str);
+    }
 #endif
     if (strcmp(fname, "persistent.parm") == 0) {
         hal.util->load_persistent_params(*r.str);
@@ -147,6 +232,9 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
             r.str->set_buffer((char*)ptr, size, size);
         }
     }
+    if (strcmp(fname, "storage.txt") == 0) {
+        hal.storage->storage_info(*r.str);
+    }
 #if AP_FILESYSTEM_SYS_FLASH_ENABLED
     if (strcmp(fname, "flash.bin") == 0) {
         void *ptr = (void*)0x08000000;
@@ -35,13 +35,15 @@ AP_FlashStorage::AP_FlashStorage(uint8_t *_mem_buffer,
                                  FlashWrite _flash_write,
                                  FlashRead _flash_read,
                                  FlashErase _flash_erase,
-                                 FlashEraseOK _flash_erase_ok) :
+                                 FlashEraseOK _flash_erase_ok,
+                                 uint8_t _num_sectors) :
     mem_buffer(_mem_buffer),
     flash_sector_size(_flash_sector_size),
     flash_write(_flash_write),
     flash_read(_flash_read),
     flash_erase(_flash_erase),
-    flash_erase_ok(_flash_erase_ok) {}
+    flash_erase_ok(_flash_erase_ok),
+    num_sectors(constrain_int16(_num_sectors, 2, 32)) {}
 
 // initialise storage
 bool AP_FlashStorage::init(void)
@@ -51,89 +53,172 @@ bool AP_FlashStorage::init(void)
     // start with empty memory buffer
     memset(mem_buffer, 0, storage_size);
 
-    // find state of sectors
-    struct sector_header header[2];
+    // find the full and in-use sectors, if any
+    int8_t full = -1;
+    int8_t in_use = -1;
+    // sectors without a valid header
+    uint32_t unformatted = 0;
 
     // read headers and possibly initialise if bad signature
-    for (uint8_t i=0; i<2; i++) {
-        if (!flash_read(i, 0, (uint8_t *)&header[i], sizeof(header[i]))) {
+    for (uint8_t i=0; i<num_sectors; i++) {
+        struct sector_header header;
+        if (!flash_read(i, 0, (uint8_t *)&header, sizeof(header))) {
             return false;
         }
-        bool bad_header = !header[i].signature_ok();
-        enum SectorState state = header[i].get_state();
+        bool bad_header = !header.signature_ok();
+        enum SectorState state = header.get_state();
         if (state != SECTOR_STATE_AVAILABLE &&
             state != SECTOR_STATE_IN_USE &&
             state != SECTOR_STATE_FULL) {
             bad_header = true;
         }
 
-        // initialise if bad header
+        // sort out sectors with a bad header once we know whether
+        // the others hold data
         if (bad_header) {
-            return erase_all();
+            unformatted |= 1U << i;
+            continue;
         }
-    }
-
-    // work out the first sector to read from using sector states
-    enum SectorState states[2] {header[0].get_state(), header[1].get_state()};
-    uint8_t first_sector;
 
-    if (states[0] == states[1]) {
-        if (states[0] != SECTOR_STATE_AVAILABLE) {
-            return erase_all();
-        }
-        first_sector = 0;
-    } else if (states[0] == SECTOR_STATE_FULL) {
-        first_sector = 0;
-    } else if (states[1] == SECTOR_STATE_FULL) {
-        first_sector = 1;
-    } else if (states[0] == SECTOR_STATE_IN_USE) {
-        first_sector = 0;
-    } else if (states[1] == SECTOR_STATE_IN_USE) {
-        first_sector = 1;
-    } else {
-        // doesn't matter which is first
-        first_sector = 0;
-    }
-
-    // load data from any current sectors
-    for (uint8_t i=0; i<2; i++) {
-        uint8_t sector = (first_sector + i) & 1;
-        if (states[sector] == SECTOR_STATE_IN_USE ||
-            states[sector] == SECTOR_STATE_FULL) {
-            if (!load_sector(sector)) {
+        // there can only be one sector in each of the full and in-use states
+        if (state == SECTOR_STATE_FULL) {
+            if (full != -1) {
                 return erase_all();
             }
+            full = i;
+        } else if (state == SECTOR_STATE_IN_USE) {
+            if (in_use != -1) {
+                return erase_all();
+            }
+            in_use = i;
         }
     }
 
-    // clear any write error
-    write_error = false;
-    reserved_space = 0;
-    
-    // if the first sector is full then write out all data so we can erase it
-    if (states[first_sector] == SECTOR_STATE_FULL) {
-        current_sector = first_sector ^ 1;
-        if (!write_all()) {
-            return erase_all();
-        }
+    if (in_use == -1 && full == -1) {
+        // no data
+        return erase_all();
     }
 
-    // erase any sectors marked full
-    for (uint8_t i=0; i<2; i++) {
-        if (states[i] == SECTOR_STATE_FULL) {
+    // format any sectors added to the ring, e.g. when the storage was
+    // given more sectors, and any sector whose erase after compaction
+    // was interrupted. The data is all in the other sectors
+    for (uint8_t i=0; i<num_sectors; i++) {
+        if ((unformatted & (1U << i)) != 0) {
+            debug("formatting sector %u\n", i);
             if (!erase_sector(i, true)) {
                 return false;
             }
         }
     }
 
+    if (in_use == -1) {
+        // we lost power part way through switch_sectors(), after
+        // marking the full sector but before marking the next one in use
+        in_use = next_sector(full);
+        struct sector_header header;
+        header.set_state(SECTOR_STATE_IN_USE);
+        if (!flash_write(in_use, 0, (const uint8_t *)&header, sizeof(header))) {
+            return false;
+        }
+    }
+
+    // load data from the full sector first as the in-use sector has
+    // the newer data, keeping track of which blocks are only in the
+    // full sector
+    BlockMask *stale_blocks = nullptr;
+    if (full != -1) {
+        stale_blocks = NEW_NOTHROW BlockMask;
+        if (!load_sector(full, stale_blocks, true)) {
+            delete stale_blocks;
+            return erase_all();
+        }
+    }
+    if (!load_sector(in_use, stale_blocks, false)) {
+        delete stale_blocks;
+        return erase_all();
+    }
+    current_sector = in_use;
+
+    // clear any write error
+    write_error = false;
     reserved_space = 0;
-    
+    full_sector = -1;
+    compacting = false;
+
+    if (full != -1) {
+        // resume copying forward the full sector in update() from
+        // the first non-zero block that is only in the full sector
+        full_sector = full;
+        compacting = true;
+        compact_offset = 0;
+        if (stale_blocks != nullptr) {
+            compact_offset = storage_size;
+            for (uint16_t b=0; b<num_blocks; b++) {
+                const uint16_t ofs = b*block_size;
+                if (stale_blocks->get(b) && !all_zero(ofs, MIN(block_size, storage_size-ofs))) {
+                    compact_offset = (ofs / max_write) * max_write;
+                    break;
+                }
+            }
+            delete stale_blocks;
+        }
+        reserved_space = reserve_for(compact_offset);
+    }
+
     // ready to use
     return true;
 }
 
+/*
+  copy forward the next non-zero block of data from the full sector
+ */
+bool AP_FlashStorage::compact_step(void)
+{
+    // local variable needed to overcome problem with MIN() macro and -O0
+    const uint8_t max_write_local = max_write;
+    while (compact_offset < storage_size) {
+        const uint16_t ofs = compact_offset;
+        const uint8_t n = MIN(max_write_local, storage_size-ofs);
+        if (all_zero(ofs, n)) {
+            // zero data doesn't need to be stored
+            compact_offset += n;
+            reserved_space = reserve_for(compact_offset);
+            continue;
+        }
+        // this block may use the space reserved for it
+        reserved_space = reserve_for(ofs + n);
+        if (!write(ofs, n)) {
+            reserved_space = reserve_for(ofs);
+            return false;
+        }
+        compact_offset += n;
+        return true;
+    }
+    debug("compaction of sector %d done\n", full_sector);
+    compacting = false;
+    reserved_space = 0;
+    return true;
+}
 
+/*
+  copy forward one block of the full sector's data, or erase it once
+  all data has been copied and erasing is allowed
+ */
+void AP_FlashStorage::update(void)
+{
+    if (write_error || full_sector == -1) {
+        return;
+    }
+    if (compacting) {
+        // only one block per call to keep latency down
+        compact_step();
+        return;
+    }
+    // all data in the full sector is now superseded
+    if (flash_erase_ok() && erase_sector(full_sector, true)) {
+        full_sector = -1;
+    }
+}
 
 // switch full sector - should only be called when safe to have CPU
 // offline for considerable periods as an erase will be needed
@@ -160,15 +245,28 @@ bool AP_FlashStorage::protected_switch_full_sector(void)
 {
     // clear any write error
     write_error = false;
-    reserved_space = 0;
-    
-    if (!write_all()) {
-        return false;
+
+    if (full_sector == -1) {
+        // the next sector isn't available. All data is in the current
+        // sector so we can erase it and switch
+        if (!erase_sector(next_sector(current_sector), true)) {
+            return false;
+        }
+        return switch_sectors();
+    }
+
+    // finish copying forward the full sector's data, which always
+    // fits in the space reserved for it
+    while (compacting) {
+        if (!compact_step()) {
+            return false;
+        }
     }
 
-    if (!erase_sector(current_sector ^ 1, true)) {
+    if (!erase_sector(full_sector, true)) {
         return false;
     }
+    full_sector = -1;
 
     return switch_sectors();
 }
@@ -189,9 +287,7 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
         }
 #endif
 
-        const uint32_t space_available = flash_sector_size - write_offset;
-        const uint32_t space_required = sizeof(struct block_header) + max_write + reserved_space;
-        if (space_available < space_required) {
+        if (!have_space(reserved_space)) {
             if (!switch_sectors()) {
                 if (!flash_erase_ok()) {
                     return false;
@@ -261,7 +357,7 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
 /*
   load all data from a flash sector into mem_buffer
  */
-bool AP_FlashStorage::load_sector(uint8_t sector)
+bool AP_FlashStorage::load_sector(uint8_t sector, BlockMask *stale_blocks, bool stale)
 {
     uint32_t ofs = sizeof(sector_header);
     while (ofs < flash_sector_size - sizeof(struct block_header)) {
@@ -302,6 +398,15 @@ bool AP_FlashStorage::load_sector(uint8_t sector)
             if (!flash_read(sector, ofs+sizeof(header), &mem_buffer[block_ofs], block_nbytes)) {
                 return false;
             }
+            if (stale_blocks != nullptr) {
+                for (uint8_t i=0; i<=header.num_blocks_minus_one; i++) {
+                    if (stale) {
+                        stale_blocks->set(header.block_num + i);
+                    } else {
+                        stale_blocks->clear(header.block_num + i);
+                    }
+                }
+            }
             //debug("read at %u for %u\n", block_ofs, block_nbytes);
             ofs += block_nbytes + sizeof(header);
             break;
@@ -339,20 +444,22 @@ bool AP_FlashStorage::erase_sector(uint8_t sector, bool mark_available)
 }
 
 /*
-  erase both sectors
+  erase all sectors
  */
 bool AP_FlashStorage::erase_all(void)
 {
     write_error = false;
+    reserved_space = 0;
+    full_sector = -1;
+    compacting = false;
 
     current_sector = 0;
     write_offset = sizeof(struct sector_header);
     
-    if (!erase_sector(0, current_sector!=0)) {
-        return false;
-    }
-    if (!erase_sector(1, current_sector!=1)) {
-        return false;
+    for (uint8_t i=0; i<num_sectors; i++) {
+        if (!erase_sector(i, current_sector!=i)) {
+            return false;
+        }
     }
     
     // mark current sector as in-use
@@ -395,15 +502,15 @@ bool AP_FlashStorage::all_zero(uint16_t ofs, uint16_t size)
 // switch to next sector for writing
 bool AP_FlashStorage::switch_sectors(void)
 {
-    if (reserved_space != 0) {
-        // other sector is already full
-        debug("both sectors are full\n");
+    if (full_sector != -1) {
+        // the previous sector hasn't been erased yet
+        debug("sector %d is still full\n", full_sector);
         return false;
     }
 
     struct sector_header header;
 
-    uint8_t new_sector = current_sector ^ 1;
+    uint8_t new_sector = next_sector(current_sector);
     debug("switching to sector %u\n", new_sector);
     
     // check sector is available
@@ -435,11 +542,15 @@ bool AP_FlashStorage::switch_sectors(void)
         return false;
     }
 
-    // switch sectors
+    // switch sectors, and start copying forward the data in the
+    // sector we have just filled
+    full_sector = current_sector;
+    compacting = true;
+    compact_offset = 0;
     current_sector = new_sector;
         
-    // we need to reserve some space in next sector to ensure we can successfully do a
-    // full write out on init()
+    // we need to reserve some space in next sector to ensure we can
+    // copy forward all of the data
     reserved_space = reserve_size;
     
     write_offset = sizeof(header);
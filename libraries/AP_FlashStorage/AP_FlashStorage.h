@@ -33,11 +33,22 @@
     aren't then caller can aggregate multiple sectors. Designed for
     128k flash sectors with 16k storage size.
 
-  - assumes two flash sectors are available
+  - assumes at least two flash sectors are available. Sectors are used
+    in turn as a ring, so giving the storage more sectors spreads the
+    erase cycles over more of the flash
+
+  - at most one sector is full and one in use at any time. After
+    switching sectors the live data from the full sector is copied
+    forward a block at a time by update(), after which the full sector
+    can be erased. Space is reserved in the in-use sector for the data
+    still to be copied, so compaction can always finish, and init()
+    resumes it from the first block whose newest copy is still in the
+    full sector rather than rewriting all of storage
  */
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/Bitmask.h>
 
 /*
   we support 4 different types of flash which have different restrictions
@@ -110,7 +121,8 @@ public:
                     FlashWrite flash_write,     // function to write to flash
                     FlashRead flash_read,       // function to read from flash
                     FlashErase flash_erase,     // function to erase flash
-                    FlashEraseOK flash_erase_ok); // function to check if erasing allowed
+                    FlashEraseOK flash_erase_ok, // function to check if erasing allowed
+                    uint8_t num_sectors=2);     // number of flash sectors to use
 
     // initialise storage, filling mem_buffer with current contents
     bool init(void);
@@ -130,6 +142,11 @@ public:
     // write some data to storage from mem_buffer
     bool write(uint16_t offset, uint16_t length) WARN_IF_UNUSED;
 
+    // do a step of background compaction of the full sector, erasing
+    // it once its data has been copied forward and erasing is
+    // allowed. Should be called regularly while storage is idle
+    void update(void);
+
     // fixed storage size
     static const uint16_t storage_size = HAL_STORAGE_SIZE;
     
@@ -140,12 +157,20 @@ private:
     FlashRead flash_read;
     FlashErase flash_erase;
     FlashEraseOK flash_erase_ok;
+    const uint8_t num_sectors;
 
     uint8_t current_sector;
     uint32_t write_offset;
     uint32_t reserved_space;
     bool write_error;
 
+    // sector awaiting compaction and erase, or -1 if none
+    int8_t full_sector = -1;
+    // true while data from full_sector is being copied forward, with
+    // compact_offset the next storage offset to copy
+    bool compacting;
+    uint16_t compact_offset;
+
     // 24 bit signature
 #if AP_FLASHSTORAGE_TYPE == AP_FLASHSTORAGE_TYPE_F4
     static const uint32_t signature = 0x51685B;
@@ -215,10 +240,21 @@ private:
     };
 
     // amount of space needed to write full storage
-    static const uint32_t reserve_size = (storage_size / max_write) * (sizeof(block_header) + max_write) + max_write;
-        
-    // load data from a sector
-    bool load_sector(uint8_t sector) WARN_IF_UNUSED;
+    static const uint32_t reserve_size = ((storage_size + max_write - 1) / max_write) * (sizeof(block_header) + max_write) + max_write;
+
+    // amount of space needed to write storage from offset to the end
+    static uint32_t reserve_for(uint16_t offset) {
+        return ((storage_size - offset + max_write - 1) / max_write) * (sizeof(block_header) + max_write) + max_write;
+    }
+
+    // per block flags used by init() to find data only held in the full sector
+    typedef Bitmask<num_blocks> BlockMask;
+
+    // load data from a sector, setting or clearing the blocks found in stale_blocks if not null
+    bool load_sector(uint8_t sector, BlockMask *stale_blocks, bool stale) WARN_IF_UNUSED;
+
+    // copy forward the next block of data from the full sector
+    bool compact_step(void);
 
     // erase a sector and write header
     bool erase_sector(uint8_t sector, bool mark_available) WARN_IF_UNUSED;
@@ -235,6 +271,17 @@ private:
     // switch to next sector for writing
     bool switch_sectors(void) WARN_IF_UNUSED;
 
+    // next sector in the ring
+    uint8_t next_sector(uint8_t sector) const {
+        return (sector + 1) % num_sectors;
+    }
+
+    // true if there is space in the current sector to write a block
+    // while keeping extra bytes free
+    bool have_space(uint32_t extra) const {
+        return flash_sector_size - write_offset >= sizeof(struct block_header) + max_write + extra;
+    }
+
     // _switch_full_sector is protected by switch_full_sector to avoid
     // an infinite recursion problem; switch_full_sector calls
     // write() which can call switch_full_sector.  This has been seen
@@ -0,0 +1,397 @@
+//
+// Simulation of AP_FlashStorage under a long parameter write workload
+//
+// Reports the time taken by init(), the flash time spent inside each
+// write() and update() call and the erase count of each sector, for
+// two and four sector rings. Without calls to update() the full
+// sector is only compacted when write() needs to switch sectors.
+// Also checks that growing a two sector ring to four keeps the data.
+// Flash time is modelled from typical STM32F4 program and erase times
+//
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_FlashStorage/AP_FlashStorage.h>
+#include <stdio.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// number of writes simulated for each configuration
+static const uint32_t num_writes = 2000000;
+
+// typical STM32F4 flash timings, x32 parallelism
+static const float program_us_per_byte = 4;
+static const float erase_ms_per_kbyte = 8;
+
+// write() or update() calls using more flash time than this count as a stall
+static const uint32_t stall_us = 10000;
+
+class FlashSim : public AP_HAL::HAL::Callbacks {
+public:
+    // HAL::Callbacks implementation.
+    void setup() override;
+    void loop() override;
+
+private:
+    static const uint32_t flash_sector_size = 128U * 1024U;
+    static const uint8_t max_sectors = 4;
+
+    uint8_t mem_buffer[AP_FlashStorage::storage_size];
+    uint8_t mem_mirror[AP_FlashStorage::storage_size];
+
+    // flash sectors
+    uint8_t *flash[max_sectors];
+    uint8_t num_sectors;
+
+    // statistics for the current configuration
+    struct {
+        uint64_t flash_us;      // modelled flash time
+        uint64_t bytes_programmed;
+        uint64_t bytes_requested;
+        uint32_t erases[max_sectors];
+        uint32_t max_write_us;
+        uint32_t max_update_us;
+        uint32_t write_stalls;
+        uint32_t write_failures;
+        uint32_t update_stalls;
+        uint32_t max_init_us;
+        uint64_t total_init_us;
+        uint32_t inits;
+    } stats;
+
+    bool erase_ok;
+
+    // range written while the storage was full, to be retried
+    uint16_t pending_start;
+    uint16_t pending_end;
+
+    bool flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
+    bool flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
+    bool flash_erase(uint8_t sector);
+    bool flash_erase_ok(void);
+
+    AP_FlashStorage *create(uint8_t sectors);
+    void run(uint8_t sectors, bool compaction);
+    void grow(void);
+    void write(AP_FlashStorage &storage, uint16_t offset, const uint8_t *data, uint16_t length);
+    void update(AP_FlashStorage &storage);
+    bool flush_pending(AP_FlashStorage &storage);
+    void check_init(AP_FlashStorage &storage);
+};
+
+bool FlashSim::flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length)
+{
+    if (sector >= num_sectors || offset + length > flash_sector_size) {
+        AP_HAL::panic("FATAL: write to sector %u at offset %u length %u",
+                      (unsigned)sector,
+                      (unsigned)offset,
+                      (unsigned)length);
+    }
+    uint8_t *b = &flash[sector][offset];
+    for (uint16_t i=0; i<length; i++) {
+        // flash can only clear bits
+        if (data[i] & ~b[i]) {
+            AP_HAL::panic("FATAL: invalid write at %u:%u 0x%02x 0x%02x",
+                          (unsigned)sector,
+                          unsigned(offset+i),
+                          b[i],
+                          data[i]);
+        }
+        b[i] &= data[i];
+    }
+    stats.flash_us += length * program_us_per_byte;
+    stats.bytes_programmed += length;
+    return true;
+}
+
+bool FlashSim::flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length)
+{
+    if (sector >= num_sectors || offset + length > flash_sector_size) {
+        AP_HAL::panic("FATAL: read from sector %u at offset %u length %u",
+                      (unsigned)sector,
+                      (unsigned)offset,
+                      (unsigned)length);
+    }
+    memcpy(data, &flash[sector][offset], length);
+    return true;
+}
+
+bool FlashSim::flash_erase(uint8_t sector)
+{
+    if (sector >= num_sectors) {
+        AP_HAL::panic("FATAL: erase sector %u", (unsigned)sector);
+    }
+    memset(&flash[sector][0], 0xFF, flash_sector_size);
+    stats.flash_us += (flash_sector_size / 1024) * erase_ms_per_kbyte * 1000;
+    stats.erases[sector]++;
+    return true;
+}
+
+bool FlashSim::flash_erase_ok(void)
+{
+    return erase_ok;
+}
+
+// write to storage and mem_mirror
+void FlashSim::write(AP_FlashStorage &storage, uint16_t offset, const uint8_t *data, uint16_t length)
+{
+    memcpy(&mem_mirror[offset], data, length);
+    memcpy(&mem_buffer[offset], data, length);
+    stats.bytes_requested += length;
+    const uint64_t flash_us0 = stats.flash_us;
+    if (!flush_pending(storage) || !storage.write(offset, length)) {
+        // the HAL keeps the data dirty and tries again later
+        if (erase_ok) {
+            AP_HAL::panic("FATAL: failed to write at %u for %u", offset, length);
+        }
+        stats.write_failures++;
+        if (pending_end == 0) {
+            pending_start = offset;
+        }
+        pending_start = MIN(pending_start, offset);
+        pending_end = MAX(pending_end, offset+length);
+    }
+    const uint32_t dt = stats.flash_us - flash_us0;
+    stats.max_write_us = MAX(stats.max_write_us, dt);
+    if (dt > stall_us) {
+        stats.write_stalls++;
+    }
+}
+
+// retry writing data that failed while storage was full
+bool FlashSim::flush_pending(AP_FlashStorage &storage)
+{
+    if (pending_end == 0) {
+        return true;
+    }
+    if (!storage.write(pending_start, pending_end - pending_start)) {
+        return false;
+    }
+    pending_start = pending_end = 0;
+    return true;
+}
+
+// background update, as called by the HAL while storage is idle
+void FlashSim::update(AP_FlashStorage &storage)
+{
+    const uint64_t flash_us0 = stats.flash_us;
+    storage.update();
+    const uint32_t dt = stats.flash_us - flash_us0;
+    stats.max_update_us = MAX(stats.max_update_us, dt);
+    if (dt > stall_us) {
+        stats.update_stalls++;
+    }
+}
+
+// re-initialise from flash and check the contents match
+void FlashSim::check_init(AP_FlashStorage &storage)
+{
+    if (!flush_pending(storage)) {
+        AP_HAL::panic("FATAL: failed to flush before init");
+    }
+    memset(mem_buffer, 0, sizeof(mem_buffer));
+    const uint64_t flash_us0 = stats.flash_us;
+    const uint64_t t0 = AP_HAL::micros64();
+    if (!storage.init()) {
+        AP_HAL::panic("FATAL: init failed");
+    }
+    // host time for the replay plus modelled time for any flash writes and erases
+    const uint32_t dt = (AP_HAL::micros64() - t0) + (stats.flash_us - flash_us0);
+    stats.max_init_us = MAX(stats.max_init_us, dt);
+    stats.total_init_us += dt;
+    stats.inits++;
+    if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
+        AP_HAL::panic("FATAL: data mis-match after init");
+    }
+}
+
+// a storage object using the first sectors of the simulated flash
+AP_FlashStorage *FlashSim::create(uint8_t sectors)
+{
+    num_sectors = sectors;
+    AP_FlashStorage *storage = NEW_NOTHROW AP_FlashStorage(mem_buffer,
+            flash_sector_size,
+            FUNCTOR_BIND_MEMBER(&FlashSim::flash_write, bool, uint8_t, uint32_t, const uint8_t *, uint16_t),
+            FUNCTOR_BIND_MEMBER(&FlashSim::flash_read, bool, uint8_t, uint32_t, uint8_t *, uint16_t),
+            FUNCTOR_BIND_MEMBER(&FlashSim::flash_erase, bool, uint8_t),
+            FUNCTOR_BIND_MEMBER(&FlashSim::flash_erase_ok, bool),
+            sectors);
+    if (storage == nullptr) {
+        AP_HAL::panic("FATAL: out of memory");
+    }
+    return storage;
+}
+
+void FlashSim::run(uint8_t sectors, bool compaction)
+{
+    memset(&stats, 0, sizeof(stats));
+    pending_start = pending_end = 0;
+    memset(mem_mirror, 0, sizeof(mem_mirror));
+    for (uint8_t i=0; i<sectors; i++) {
+        memset(flash[i], 0xFF, flash_sector_size);
+    }
+
+    AP_FlashStorage *storage_ptr = create(sectors);
+    AP_FlashStorage &storage = *storage_ptr;
+
+    erase_ok = true;
+    if (!storage.init()) {
+        AP_HAL::panic("FATAL: first init failed");
+    }
+
+    // parameters are spread over the first half of storage, with
+    // missions and fences uploaded into the second half
+    const uint16_t param_area = sizeof(mem_buffer) / 2;
+    const uint16_t num_params = param_area / 8;
+
+    for (uint32_t i=0; i<num_writes; i++) {
+        // most parameter changes are made on the ground, with a
+        // few made in flight when erases are not allowed
+        erase_ok = (i % 6000) >= 1000;
+
+        uint8_t data[64];
+        if (i % 100000 == 99999) {
+            // upload a mission in 64 byte blocks
+            const uint16_t len = MIN(4096U, sizeof(mem_buffer) - param_area);
+            for (uint16_t ofs=0; ofs<len; ofs += sizeof(data)) {
+                for (uint8_t j=0; j<sizeof(data); j++) {
+                    data[j] = get_random16();
+                }
+                write(storage, param_area + ofs, data, sizeof(data));
+            }
+        } else {
+            // save a parameter value
+            const uint16_t ofs = (get_random16() % num_params) * 8;
+            const uint8_t len = 4 + (get_random16() & 3);
+            for (uint8_t j=0; j<len; j++) {
+                data[j] = get_random16();
+            }
+            write(storage, ofs, data, len);
+        }
+
+        if (compaction) {
+            update(storage);
+        }
+
+        if (i % 500000 == 499999 && erase_ok) {
+            check_init(storage);
+        }
+    }
+
+    erase_ok = true;
+    check_init(storage);
+
+    uint32_t min_erases = UINT32_MAX, max_erases = 0;
+    for (uint8_t i=0; i<num_sectors; i++) {
+        min_erases = MIN(min_erases, stats.erases[i]);
+        max_erases = MAX(max_erases, stats.erases[i]);
+    }
+    hal.console->printf("%u sectors, compaction %s\n",
+                        (unsigned)num_sectors, compaction?"in update()":"on sector switch");
+    hal.console->printf("  writes=%u requested=%llu programmed=%llu amplification=%.1f\n",
+                        (unsigned)num_writes,
+                        (unsigned long long)stats.bytes_requested,
+                        (unsigned long long)stats.bytes_programmed,
+                        double(stats.bytes_programmed) / stats.bytes_requested);
+    hal.console->printf("  erases per sector min=%u max=%u\n",
+                        (unsigned)min_erases, (unsigned)max_erases);
+    hal.console->printf("  write() max=%.1fms stalls=%u failures=%u\n",
+                        stats.max_write_us*0.001, (unsigned)stats.write_stalls,
+                        (unsigned)stats.write_failures);
+    hal.console->printf("  update() max=%.1fms stalls=%u\n",
+                        stats.max_update_us*0.001, (unsigned)stats.update_stalls);
+    hal.console->printf("  init() avg=%.1fms max=%.1fms\n",
+                        stats.total_init_us*0.001/stats.inits, stats.max_init_us*0.001);
+
+    delete storage_ptr;
+}
+
+/*
+  fill a two sector ring until it has switched sectors a few times,
+  then open the same flash as a four sector ring. The new sectors hold
+  whatever was in flash before and must be formatted without losing
+  the data in the old ones
+ */
+void FlashSim::grow(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    pending_start = pending_end = 0;
+    memset(mem_mirror, 0, sizeof(mem_mirror));
+    for (uint8_t i=0; i<max_sectors; i++) {
+        for (uint32_t j=0; j<flash_sector_size; j++) {
+            flash[i][j] = (i < 2) ? 0xFF : get_random16();
+        }
+    }
+    erase_ok = true;
+
+    // parameter writes only, as in run()
+    const uint16_t num_params = sizeof(mem_buffer) / 2 / 8;
+
+    for (uint8_t switches=0; switches<2; switches++) {
+        AP_FlashStorage *storage = create(2);
+        if (switches == 0 && !storage->init()) {
+            AP_HAL::panic("FATAL: first init failed");
+        }
+        if (switches > 0) {
+            check_init(*storage);
+        }
+        // stop part way through a sector on the second pass so the
+        // grown ring starts with a full sector still to compact
+        const uint32_t writes = switches == 0 ? 20000 : 5000;
+        for (uint32_t i=0; i<writes; i++) {
+            uint8_t data[8];
+            const uint16_t ofs = (get_random16() % num_params) * sizeof(data);
+            for (uint8_t j=0; j<sizeof(data); j++) {
+                data[j] = get_random16();
+            }
+            write(*storage, ofs, data, sizeof(data));
+        }
+        delete storage;
+    }
+
+    AP_FlashStorage *storage = create(4);
+    check_init(*storage);
+    for (uint32_t i=0; i<100000; i++) {
+        uint8_t data[8];
+        const uint16_t ofs = (get_random16() % num_params) * sizeof(data);
+        for (uint8_t j=0; j<sizeof(data); j++) {
+            data[j] = get_random16();
+        }
+        write(*storage, ofs, data, sizeof(data));
+        update(*storage);
+    }
+    check_init(*storage);
+    hal.console->printf("grew 2 to 4 sectors, erases per sector %u %u %u %u\n",
+                        (unsigned)stats.erases[0], (unsigned)stats.erases[1],
+                        (unsigned)stats.erases[2], (unsigned)stats.erases[3]);
+    delete storage;
+}
+
+void FlashSim::setup(void)
+{
+    hal.console->printf("AP_FlashStorage simulation\n");
+}
+
+void FlashSim::loop(void)
+{
+    for (uint8_t i=0; i<max_sectors; i++) {
+        flash[i] = (uint8_t *)malloc(flash_sector_size);
+        if (flash[i] == nullptr) {
+            AP_HAL::panic("FATAL: out of memory");
+        }
+    }
+
+    run(2, false);
+    run(2, true);
+    run(4, true);
+    grow();
+
+    while (true) {
+        hal.console->printf("TEST PASSED\n");
+        hal.scheduler->delay(20000);
+    }
+}
+
+FlashSim flashsim;
+
+AP_HAL_MAIN_CALLBACKS(&flashsim);
@@ -19,6 +19,7 @@
 #include "AP_GPS.h"
 
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/ExpandingString.h>
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Notify/AP_Notify.h>
@@ -56,9 +57,7 @@
 #include <AP_Logger/AP_Logger.h>
 #include "AP_GPS_FixType.h"
 
-#if AP_GPS_RTCM_DECODE_ENABLED
 #include "RTCM3_Parser.h"
-#endif
 
 #if !AP_GPS_BLENDED_ENABLED
 #if defined(GPS_BLENDED_INSTANCE)
@@ -214,8 +213,8 @@ const AP_Param::GroupInfo AP_GPS::var_info[] = {
 #if AP_GPS_BLENDED_ENABLED
     // @Param: _BLEND_MASK
     // @DisplayName: Multi GPS Blending Mask
-    // @Description: Determines which of the accuracy measures Horizontal position, Vertical Position and Speed are used to calculate the weighting on each GPS receiver when soft switching has been selected by setting GPS_AUTO_SWITCH to 2(Blend)
-    // @Bitmask: 0:Horiz Pos,1:Vert Pos,2:Speed
+    // @Description: Determines which of the accuracy measures Horizontal position, Vertical Position and Speed are used to calculate the weighting on each GPS receiver when soft switching has been selected by setting GPS_AUTO_SWITCH to 2(Blend). With Latency compensation set, the solution from each receiver is predicted forward using its velocity to the time of the newest measurement before blending, allowing for receivers running at different rates or with different lags
+    // @Bitmask: 0:Horiz Pos,1:Vert Pos,2:Speed,3:Latency compensation
     // @User: Advanced
     AP_GROUPINFO("_BLEND_MASK", 20, AP_GPS, _blend_mask, 5),
 
@@ -231,7 +230,7 @@ const AP_Param::GroupInfo AP_GPS::var_info[] = {
     // @Param: _DRV_OPTIONS
     // @DisplayName: driver options
     // @Description: Additional backend specific options
-    // @Bitmask: 0:Use UART2 for moving baseline on ublox,1:Use base station for GPS yaw on SBF,2:Use baudrate 115200 on ublox,3:Use dedicated CAN port b/w GPSes for moving baseline,4:Use ellipsoid height instead of AMSL, 5:Override GPS satellite health of L5 band from L1 health, 6:Enable RTCM full parse even for a single channel, 7:Disable automatic full RTCM parsing when RTCM seen on more than one channel, 8:Force UBlox Config Get/Set for configuration then automatic configuration for Serial GPSes only
+    // @Bitmask: 0:Use UART2 for moving baseline on ublox,1:Use base station for GPS yaw on SBF,2:Use baudrate 115200 on ublox,3:Use dedicated CAN port b/w GPSes for moving baseline,4:Use ellipsoid height instead of AMSL, 5:Override GPS satellite health of L5 band from L1 health, 6:Enable RTCM full parse even for a single channel, 7:Disable automatic full RTCM parsing when RTCM seen on more than one channel, 8:Force UBlox Config Get/Set for configuration then automatic configuration for Serial GPSes only, 9:Only inject RTCM observations and ephemerides for the constellations enabled in GPSn_GNSS_MODE
     // @User: Advanced
     AP_GROUPINFO("_DRV_OPTIONS", 22, AP_GPS, _driver_options, 0),
 
@@ -1327,6 +1326,17 @@ void AP_GPS::lock_port(uint8_t instance, bool lock)
 // Inject a packet of raw binary to a GPS
 void AP_GPS::inject_data(const uint8_t *data, uint16_t len)
 {
+    // RTCMv3 packets can only be filtered if the block is made up of
+    // whole packets
+    bool filter = option_set(DriverOptions::RTCMFilterByGNSSMode);
+    for (uint16_t ofs=0; filter && ofs<len; ) {
+        const uint16_t pkt_len = RTCM3_Parser::packet_len(&data[ofs], len-ofs);
+        if (pkt_len == 0) {
+            filter = false;
+        }
+        ofs += pkt_len;
+    }
+
     //Support broadcasting to all GPSes.
     if (_inject_to == GPS_RTK_INJECT_TO_ALL) {
         for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
@@ -1334,8 +1344,14 @@ void AP_GPS::inject_data(const uint8_t *data, uint16_t len)
                 // we don't externally inject to moving baseline rover
                 continue;
             }
-            inject_data(i, data, len);
+            if (filter) {
+                inject_rtcm_filtered(i, data, len);
+            } else {
+                inject_data(i, data, len);
+            }
         }
+    } else if (filter) {
+        inject_rtcm_filtered(_inject_to, data, len);
     } else {
         inject_data(_inject_to, data, len);
     }
@@ -1345,6 +1361,76 @@ void AP_GPS::inject_data(uint8_t instance, const uint8_t *data, uint16_t len)
 {
     if (instance < GPS_MAX_RECEIVERS && drivers[instance] != nullptr) {
         drivers[instance]->inject_data(data, len);
+        rtcm_stats.receiver[instance].bytes += len;
+        rtcm_stats.receiver[instance].last_ms = AP_HAL::millis();
+    }
+}
+
+/*
+  inject the RTCMv3 packets in a block of whole packets that are for
+  the constellations enabled in GNSS_MODE, or that apply to all
+  constellations. Runs of wanted packets are written together
+ */
+void AP_GPS::inject_rtcm_filtered(uint8_t instance, const uint8_t *data, uint16_t len)
+{
+    if (instance >= GPS_MAX_RECEIVERS) {
+        return;
+    }
+    const uint16_t gnss_mode = params[instance].gnss_mode;
+    if (gnss_mode == 0) {
+        // receiver is using its own constellation config
+        inject_data(instance, data, len);
+        return;
+    }
+    uint16_t run_start = 0;
+    uint16_t run_len = 0;
+    for (uint16_t ofs=0; ofs<len; ) {
+        // the packets have already been checked
+        const uint16_t pkt_len = (((data[ofs+1]<<8) | data[ofs+2]) & 0x3ff) + 6;
+        const uint16_t mask = RTCM3_Parser::gnss_mask(RTCM3_Parser::packet_id(&data[ofs]));
+        if (mask == 0 || (mask & gnss_mode) != 0) {
+            if (run_len == 0) {
+                run_start = ofs;
+            }
+            run_len += pkt_len;
+        } else {
+            if (run_len > 0) {
+                inject_data(instance, &data[run_start], run_len);
+                run_len = 0;
+            }
+            rtcm_stats.receiver[instance].bytes_filtered += pkt_len;
+        }
+        ofs += pkt_len;
+    }
+    if (run_len > 0) {
+        inject_data(instance, &data[run_start], run_len);
+    }
+}
+
+/*
+  report RTCM re-assembly and injection statistics
+ */
+void AP_GPS::rtcm_info(ExpandingString &str) const
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    str.printf("fragments used=%u discarded=%u duplicate=%u\n",
+               unsigned(rtcm_stats.fragments_used),
+               unsigned(rtcm_stats.fragments_discarded),
+               unsigned(rtcm_stats.fragments_duplicate));
+    str.printf("blocks=%u latency avg=%ums max=%ums\n",
+               unsigned(rtcm_stats.blocks),
+               unsigned(rtcm_stats.blocks ? rtcm_stats.latency_sum_ms / rtcm_stats.blocks : 0),
+               unsigned(rtcm_stats.latency_max_ms));
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        const auto &r = rtcm_stats.receiver[i];
+        if (r.last_ms == 0) {
+            continue;
+        }
+        str.printf("GPS%u bytes=%u filtered=%u age=%ums\n",
+                   unsigned(i+1),
+                   unsigned(r.bytes),
+                   unsigned(r.bytes_filtered),
+                   unsigned(now_ms - r.last_ms));
     }
 }
 
@@ -1528,34 +1614,63 @@ void AP_GPS::handle_gps_rtcm_fragment(uint8_t flags, const uint8_t *data, uint8_
 
     const uint8_t fragment = (flags >> 1U) & 0x03;
     const uint8_t sequence = (flags >> 3U) & 0x1F;
-    uint8_t* start_of_fragment_in_buffer = &rtcm_buffer->buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN * (uint16_t)fragment];
-    bool should_clear_previous_fragments = false;
+    const uint32_t now_ms = AP_HAL::millis();
+
+    // find the slot for this sequence number, or the least recently
+    // used slot, preferring slots which have been injected
+    auto *slot = &rtcm_buffer->slots[0];
+    bool found = false;
+    for (auto &s : rtcm_buffer->slots) {
+        if ((s.fragments_received != 0 || s.injected) && s.sequence == sequence) {
+            slot = &s;
+            found = true;
+            break;
+        }
+        const bool s_busy = s.fragments_received != 0;
+        const bool slot_busy = slot->fragments_received != 0;
+        if ((slot_busy && !s_busy) ||
+            (slot_busy == s_busy && now_ms - s.last_ms > now_ms - slot->last_ms)) {
+            slot = &s;
+        }
+    }
+
+    uint8_t* start_of_fragment_in_buffer = &slot->buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN * (uint16_t)fragment];
+    bool should_clear_previous_fragments = !found;
 
-    if (rtcm_buffer->fragments_received) {
-        const bool sequence_nr_changed = rtcm_buffer->sequence != sequence;
-        const bool seen_this_fragment_index = rtcm_buffer->fragments_received & (1U << fragment);
+    if (found) {
+        const bool seen_this_fragment_index = slot->injected || (slot->fragments_received & (1U << fragment));
+        const uint16_t fragment_end = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*fragment + len;
 
-        // check whether this is a duplicate fragment. If it is, we can
+        // check whether this is a duplicate fragment, either of a
+        // block being re-assembled or of a block already injected
+        // which has arrived over another link. If it is, we can
         // return early.
-        if (!sequence_nr_changed && seen_this_fragment_index && !memcmp(start_of_fragment_in_buffer, data, len)) {
+        if (seen_this_fragment_index &&
+            (!slot->injected || fragment_end <= slot->total_length) &&
+            !memcmp(start_of_fragment_in_buffer, data, len)) {
+            rtcm_stats.fragments_duplicate++;
+            slot->last_ms = now_ms;
             return;
         }
 
         // not a duplicate
-        should_clear_previous_fragments = sequence_nr_changed || seen_this_fragment_index;
+        should_clear_previous_fragments = seen_this_fragment_index;
     }
 
     if (should_clear_previous_fragments) {
         // we have one or more partial fragments already received
         // which conflict with the new fragment, discard previous fragments
-        rtcm_buffer->fragment_count = 0;
-        rtcm_stats.fragments_discarded += __builtin_popcount(rtcm_buffer->fragments_received);
-        rtcm_buffer->fragments_received = 0;
+        slot->fragment_count = 0;
+        rtcm_stats.fragments_discarded += __builtin_popcount(slot->fragments_received);
+        slot->fragments_received = 0;
+        slot->injected = false;
+        slot->first_ms = now_ms;
     }
 
     // add this fragment
-    rtcm_buffer->sequence = sequence;
-    rtcm_buffer->fragments_received |= (1U << fragment);
+    slot->sequence = sequence;
+    slot->fragments_received |= (1U << fragment);
+    slot->last_ms = now_ms;
 
     // copy the data
     memcpy(start_of_fragment_in_buffer, data, len);
@@ -1565,23 +1680,28 @@ void AP_GPS::handle_gps_rtcm_fragment(uint8_t flags, const uint8_t *data, uint8_
     // block of RTCM data of an exact multiple of the buffer size you
     // need to send a final packet of zero length
     if (len < MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN) {
-        rtcm_buffer->fragment_count = fragment+1;
-        rtcm_buffer->total_length = (MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*fragment) + len;
-    } else if (rtcm_buffer->fragments_received == 0x0F) {
+        slot->fragment_count = fragment+1;
+        slot->total_length = (MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*fragment) + len;
+    } else if (slot->fragments_received == 0x0F) {
         // special case of 4 full fragments
-        rtcm_buffer->fragment_count = 4;
-        rtcm_buffer->total_length = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4;
+        slot->fragment_count = 4;
+        slot->total_length = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4;
     }
 
 
     // see if we have all fragments
-    if (rtcm_buffer->fragment_count != 0 &&
-        rtcm_buffer->fragments_received == (1U << rtcm_buffer->fragment_count) - 1) {
+    if (slot->fragment_count != 0 &&
+        slot->fragments_received == (1U << slot->fragment_count) - 1) {
         // we have them all, inject
-        rtcm_stats.fragments_used += __builtin_popcount(rtcm_buffer->fragments_received);
-        inject_data(rtcm_buffer->buffer, rtcm_buffer->total_length);
-        rtcm_buffer->fragment_count = 0;
-        rtcm_buffer->fragments_received = 0;
+        rtcm_stats.fragments_used += __builtin_popcount(slot->fragments_received);
+        const uint32_t latency_ms = now_ms - slot->first_ms;
+        rtcm_stats.blocks++;
+        rtcm_stats.latency_sum_ms += latency_ms;
+        rtcm_stats.latency_max_ms = MAX(rtcm_stats.latency_max_ms, MIN(latency_ms, UINT16_MAX));
+        inject_data(slot->buffer, slot->total_length);
+        slot->fragment_count = 0;
+        slot->fragments_received = 0;
+        slot->injected = true;
     }
 }
 
@@ -601,6 +601,9 @@ public:
     // Inject a packet of raw binary to a GPS
     void inject_data(const uint8_t *data, uint16_t len);
 
+    // report RTCM re-assembly and injection statistics
+    void rtcm_info(class ExpandingString &str) const;
+
 protected:
 
     // configuration parameters
@@ -630,7 +633,8 @@ protected:
         GPSL5HealthOverride = (1U << 5),
         AlwaysRTCMDecode = (1U << 6),
         DisableRTCMDecode = (1U << 7),
-        ForceUBXConfigV2 = (1U << 8U)
+        ForceUBXConfigV2 = (1U << 8U),
+        RTCMFilterByGNSSMode = (1U << 9U),
     };
 
     // check if an option is set
@@ -732,18 +736,36 @@ private:
       is successfully reassembled it is injected into all active GPS
       backends. This assumes we don't want more than 4*180=720 bytes
       in a RTCM data block
+
+      Each slot re-assembles a block with one sequence number, and
+      keeps the block once it has been injected so the same block
+      arriving over another link can be discarded
      */
     struct rtcm_buffer {
-        uint8_t fragments_received;
-        uint8_t sequence;
-        uint8_t fragment_count;
-        uint16_t total_length;
-        uint8_t buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4];
+        struct {
+            uint8_t fragments_received;
+            uint8_t sequence;
+            uint8_t fragment_count;
+            bool injected;
+            uint16_t total_length;
+            uint32_t first_ms; // time of the first fragment
+            uint32_t last_ms;  // time of the latest fragment
+            uint8_t buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4];
+        } slots[AP_GPS_RTCM_REASSEMBLY_SLOTS];
     } *rtcm_buffer;
 
     struct {
         uint16_t fragments_used;
         uint16_t fragments_discarded;
+        uint32_t fragments_duplicate;
+        uint32_t blocks;
+        uint32_t latency_sum_ms; // first to last fragment of each block
+        uint16_t latency_max_ms;
+        struct {
+            uint32_t bytes;
+            uint32_t bytes_filtered;
+            uint32_t last_ms;
+        } receiver[GPS_MAX_RECEIVERS];
     } rtcm_stats;
 
     // re-assemble GPS_RTCM_DATA message
@@ -753,6 +775,9 @@ private:
     //Inject a packet of raw binary to a GPS
     void inject_data(uint8_t instance, const uint8_t *data, uint16_t len);
 
+    // inject the RTCMv3 packets in a block for the constellations a GPS uses
+    void inject_rtcm_filtered(uint8_t instance, const uint8_t *data, uint16_t len);
+
 #if AP_GPS_BLENDED_ENABLED
     bool _output_is_blended; // true when a blended GPS solution being output
 #endif
@@ -8,6 +8,11 @@
 #define BLEND_MASK_USE_HPOS_ACC     1
 #define BLEND_MASK_USE_VPOS_ACC     2
 #define BLEND_MASK_USE_SPD_ACC      4
+#define BLEND_MASK_USE_LAG_COMP     8
+
+// longest time a receiver solution is predicted forward when
+// compensating for latency
+#define BLEND_MAX_PREDICT_MS 500
 
 #define BLEND_COUNTER_FAILURE_INCREMENT 10
 
@@ -16,12 +21,16 @@
 */
 bool AP_GPS_Blended::_calc_weights(void)
 {
-    static_assert(GPS_MAX_RECEIVERS == 2, "GPS blending only currently works with 2 receivers");
-    // Note that the early quit below relies upon exactly 2 instances
-    // The time delta calculations below also rely upon every instance being currently detected and being parsed
-
-    // exit immediately if not enough receivers to do blending
-    if (gps.state[0].status <= AP_GPS_FixType::NONE || gps.state[1].status <= AP_GPS_FixType::NONE) {
+    // blend the receivers that have a fix, of which there must be at
+    // least two. The time delta calculations below rely upon those
+    // receivers being parsed
+    uint8_t num_receivers = 0;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (gps.state[i].status > AP_GPS_FixType::NONE) {
+            num_receivers++;
+        }
+    }
+    if (num_receivers < 2) {
         return false;
     }
 
@@ -30,6 +39,9 @@ bool AP_GPS_Blended::_calc_weights(void)
     uint32_t min_ms = -1; // oldest non-zero system time of arrival of a GPS message
     uint32_t max_rate_ms = 0; // largest update interval of a GPS receiver
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (gps.state[i].status <= AP_GPS_FixType::NONE) {
+            continue;
+        }
         // Find largest and smallest times
         if (gps.state[i].last_gps_time_ms > max_ms) {
             max_ms = gps.state[i].last_gps_time_ms;
@@ -240,14 +252,54 @@ void AP_GPS_Blended::calc_state(void)
     timing.last_fix_time_ms = 0;
     timing.last_message_time_ms = 0;
 
-    if (gps.state[0].have_undulation) {
-        state.have_undulation = true;
-        state.undulation = gps.state[0].undulation;
-    } else if (gps.state[1].have_undulation) {
-        state.have_undulation = true;
-        state.undulation = gps.state[1].undulation;
-    } else {
-        state.have_undulation = false;
+    state.have_undulation = false;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (gps.state[i].have_undulation) {
+            state.have_undulation = true;
+            state.undulation = gps.state[i].undulation;
+            break;
+        }
+    }
+
+    /*
+      each receiver's solution was measured at its fix time less its
+      lag. When compensating for latency each solution is moved
+      forward along its velocity to the newest measurement time, so
+      receivers running at different rates or with different lags are
+      blended at a common epoch
+     */
+    const bool lag_comp = (gps._blend_mask & BLEND_MASK_USE_LAG_COMP) != 0;
+    float lag_sec[GPS_MAX_RECEIVERS] {};
+    uint32_t meas_ms[GPS_MAX_RECEIVERS] {};
+    uint32_t epoch_ms = 0;
+    bool have_epoch = false;
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        if (_blend_weights[i] <= 0.0f) {
+            continue;
+        }
+        gps.get_lag(i, lag_sec[i]);
+        meas_ms[i] = gps.timing[i].last_fix_time_ms - uint32_t(lag_sec[i] * 1000);
+        if (!have_epoch || int32_t(meas_ms[i] - epoch_ms) > 0) {
+            epoch_ms = meas_ms[i];
+            have_epoch = true;
+        }
+    }
+    Location locations[GPS_MAX_RECEIVERS];
+    uint32_t time_week_ms[GPS_MAX_RECEIVERS];
+    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+        locations[i] = gps.state[i].location;
+        time_week_ms[i] = gps.state[i].time_week_ms;
+        if (!lag_comp || _blend_weights[i] <= 0.0f) {
+            continue;
+        }
+        const uint32_t predict_ms = constrain_int32(int32_t(epoch_ms - meas_ms[i]), 0, BLEND_MAX_PREDICT_MS);
+        const float dt = predict_ms * 0.001f;
+        const Vector3f &vel = gps.state[i].velocity;
+        locations[i].offset(vel.x * dt, vel.y * dt);
+        if (gps.state[i].have_vertical_velocity) {
+            locations[i].offset_up_cm(int32_t(-vel.z * dt * 100));
+        }
+        time_week_ms[i] += predict_ms;
     }
 
     // combine the states into a blended solution
@@ -319,7 +371,7 @@ void AP_GPS_Blended::calc_state(void)
         if (_blend_weights[i] > best_weight) {
             best_weight = _blend_weights[i];
             best_index = i;
-            state.location = gps.state[i].location;
+            state.location = locations[i];
         }
     }
 
@@ -329,8 +381,8 @@ void AP_GPS_Blended::calc_state(void)
     blended_NE_offset_m.zero();
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         if (_blend_weights[i] > 0.0f && i != best_index) {
-            blended_NE_offset_m += state.location.get_distance_NE(gps.state[i].location) * _blend_weights[i];
-            blended_alt_offset_cm += (float)(gps.state[i].location.alt - state.location.alt) * _blend_weights[i];
+            blended_NE_offset_m += state.location.get_distance_NE(locations[i]) * _blend_weights[i];
+            blended_alt_offset_cm += (float)(locations[i].alt - state.location.alt) * _blend_weights[i];
         }
     }
 
@@ -360,7 +412,7 @@ void AP_GPS_Blended::calc_state(void)
     if (!weeks_consistent) {
         // use data from highest weighted sensor
         state.time_week = gps.state[best_index].time_week;
-        state.time_week_ms = gps.state[best_index].time_week_ms;
+        state.time_week_ms = time_week_ms[best_index];
     } else {
         // use week number from highest weighting GPS (they should all have the same week number)
         state.time_week = gps.state[best_index].time_week;
@@ -368,26 +420,31 @@ void AP_GPS_Blended::calc_state(void)
         double temp_time_0 = 0.0;
         for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
             if (_blend_weights[i] > 0.0f) {
-                temp_time_0 += (double)gps.state[i].time_week_ms * (double)_blend_weights[i];
+                temp_time_0 += (double)time_week_ms[i] * (double)_blend_weights[i];
             }
         }
         state.time_week_ms = (uint32_t)temp_time_0;
     }
 
-    // calculate a blended value for the timing data and lag
-    double temp_time_1 = 0.0;
-    double temp_time_2 = 0.0;
-    for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
-        if (_blend_weights[i] > 0.0f) {
-            temp_time_1 += (double)gps.timing[i].last_fix_time_ms * (double) _blend_weights[i];
-            temp_time_2 += (double)gps.timing[i].last_message_time_ms * (double)_blend_weights[i];
-            float gps_lag_sec = 0;
-            gps.get_lag(i, gps_lag_sec);
-            _blended_lag_sec += gps_lag_sec * _blend_weights[i];
+    if (lag_comp) {
+        // keep the newest fix and message times so the blended
+        // solution is new whenever any receiver has a new fix, with
+        // a lag giving the common epoch it was predicted to
+        _blended_lag_sec = (timing.last_fix_time_ms - epoch_ms) * 0.001f;
+    } else {
+        // calculate a blended value for the timing data and lag
+        double temp_time_1 = 0.0;
+        double temp_time_2 = 0.0;
+        for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
+            if (_blend_weights[i] > 0.0f) {
+                temp_time_1 += (double)gps.timing[i].last_fix_time_ms * (double) _blend_weights[i];
+                temp_time_2 += (double)gps.timing[i].last_message_time_ms * (double)_blend_weights[i];
+                _blended_lag_sec += lag_sec[i] * _blend_weights[i];
+            }
         }
+        timing.last_fix_time_ms = (uint32_t)temp_time_1;
+        timing.last_message_time_ms = (uint32_t)temp_time_2;
     }
-    timing.last_fix_time_ms = (uint32_t)temp_time_1;
-    timing.last_message_time_ms = (uint32_t)temp_time_2;
 
 #if HAL_LOGGING_ENABLED
     if (timing.last_message_time_ms > last_blended_message_time_ms &&
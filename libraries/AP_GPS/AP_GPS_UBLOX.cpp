@@ -580,20 +580,31 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    const uint16_t numc = MIN(port->available(), 8192U);
-    for (uint16_t i = 0; i < numc; i++) {        // Process bytes received
-
-        // read the next byte
-        uint8_t data;
-        if (!port->read(data)) {
-            break;
-        }
+    uint16_t budget = MIN(port->available(), 8192U);
+    while (true) {
+        if (_rx_block.ofs >= _rx_block.len) {
+            // read the next block of bytes from the uart
+            if (budget == 0) {
+                break;
+            }
+            const ssize_t n = port->read(_rx_block.buf, MIN(budget, sizeof(_rx_block.buf)));
+            if (n <= 0) {
+                break;
+            }
+            budget -= n;
+            _rx_block.ofs = 0;
+            _rx_block.len = n;
 #if AP_GPS_DEBUG_LOGGING_ENABLED
-        log_data(&data, 1);
+            log_data(_rx_block.buf, n);
 #endif
+        }
 
 #if GPS_MOVING_BASELINE
         if (rtcm3_parser) {
+            // the RTCMv3 parser needs to see every byte, and we stop
+            // at the end of a RTCMv3 packet leaving the rest of the
+            // block for the next call
+            const uint8_t data = _rx_block.buf[_rx_block.ofs++];
             if (rtcm3_parser->read(data)) {
                 // we've found a RTCMv3 packet. We stop parsing at
                 // this point and reset u-blox parse state. We need to
@@ -603,149 +614,207 @@ AP_GPS_UBLOX::read(void)
                 _step = 0;
                 break;
             }
+            if (_parse_byte(data)) {
+                parsed = true;
+            }
+            continue;
         }
 #endif
 
-	reset:
-#if AP_GPS_UBLOX_CFGV2_ENABLED
-        if (_step == 0) {
-            // reset the valget state machine
-            _cfg_v2.process_valget_complete(false);
+        if (_parse_block(&_rx_block.buf[_rx_block.ofs], _rx_block.len - _rx_block.ofs)) {
+            parsed = true;
         }
-#endif
-        switch(_step) {
-
-        // Message preamble detection
-        //
-        // If we fail to match any of the expected bytes, we reset
-        // the state machine and re-consider the failed byte as
-        // the first byte of the preamble.  This improves our
-        // chances of recovering from a mismatch and makes it less
-        // likely that we will be fooled by the preamble appearing
-        // as data in some other message.
-        //
-        case 1:
-            if (PREAMBLE2 == data) {
-                _step++;
+        _rx_block.ofs = _rx_block.len;
+    }
+    return parsed;
+}
+
+/*
+  process a block of bytes. Bytes between messages are skipped with a
+  search for the preamble and the payload of a message is copied and
+  checksummed as a block, leaving the state machine for the header
+  and checksum bytes. Returns true if a navigation message was parsed
+ */
+bool AP_GPS_UBLOX::_parse_block(const uint8_t *data, uint16_t len)
+{
+    bool parsed = false;
+    while (len > 0) {
+        if (_step == 0) {
+            const uint8_t *p = (const uint8_t *)memchr(data, PREAMBLE1, len);
+            if (p == nullptr) {
                 break;
             }
-            _step = 0;
-            Debug("reset %u", __LINE__);
-            FALLTHROUGH;
-        case 0:
-            if(PREAMBLE1 == data)
-                _step++;
-            break;
-
-        // Message header processing
-        //
-        // We sniff the class and message ID to decide whether we
-        // are going to gather the message bytes or just discard
-        // them.
-        //
-        // We always collect the length so that we can avoid being
-        // fooled by preamble bytes in messages.
-        //
-        case 2:
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;                       // reset the checksum accumulators
-            break;
-        case 3:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _msg_id = data;
-            break;
-        case 4:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _payload_length = data;                     // payload length low byte
-            break;
-        case 5:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-
-            _payload_length += (uint16_t)(data<<8);
-            if ((_payload_length > sizeof(_buffer))
+            len -= p - data;
+            data = p;
+        } else if (_step == 6
 #if AP_GPS_UBLOX_CFGV2_ENABLED
-            && !(_class == CLASS_CFG || _msg_id == MSG_CFG_VALGET)
+                   && !(_class == CLASS_CFG && _msg_id == MSG_CFG_VALGET)
 #endif
             ) {
-                Debug("large payload %u", (unsigned)_payload_length);
-                // assume any payload bigger then what we know about is noise
-                _payload_length = 0;
-                _step = 0;
-				goto reset;
+            const uint16_t n = MIN(len, uint16_t(_payload_length - _payload_counter));
+            if (_payload_counter < sizeof(_buffer)) {
+                memcpy(&_buffer[_payload_counter], data, MIN(n, sizeof(_buffer) - _payload_counter));
             }
-            _payload_counter = 0;                       // prepare to receive payload
-            if (_payload_length == 0) {
-                // bypass payload and go straight to checksum
+            _update_checksum(data, n, _ck_a, _ck_b);
+            _payload_counter += n;
+            if (_payload_counter == _payload_length) {
                 _step++;
             }
-            break;
+            data += n;
+            len -= n;
+            continue;
+        }
+        if (_parse_byte(*data)) {
+            parsed = true;
+        }
+        data++;
+        len--;
+    }
+    return parsed;
+}
 
-        // Receive message data
-        //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
+/*
+  process a byte through the state machine, returning true if a
+  navigation message was parsed
+ */
+bool AP_GPS_UBLOX::_parse_byte(uint8_t data)
+{
+	reset:
 #if AP_GPS_UBLOX_CFGV2_ENABLED
-            if (_class == CLASS_CFG && _msg_id == MSG_CFG_VALGET) {
-                CFGv2_Debug("V2 VALGET byte %u/%u: 0x%02x\n", (unsigned)_payload_counter, (unsigned)_payload_length, data);
-                _cfg_v2.process_valget_byte(data);
-            }
+    if (_step == 0) {
+        // reset the valget state machine
+        _cfg_v2.process_valget_complete(false);
+    }
 #endif
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
-                _step++;
+    switch(_step) {
+
+    // Message preamble detection
+    //
+    // If we fail to match any of the expected bytes, we reset
+    // the state machine and re-consider the failed byte as
+    // the first byte of the preamble.  This improves our
+    // chances of recovering from a mismatch and makes it less
+    // likely that we will be fooled by the preamble appearing
+    // as data in some other message.
+    //
+    case 1:
+        if (PREAMBLE2 == data) {
+            _step++;
             break;
-
-        // Checksum and message processing
-        //
-        case 7:
+        }
+        _step = 0;
+        Debug("reset %u", __LINE__);
+        FALLTHROUGH;
+    case 0:
+        if(PREAMBLE1 == data)
             _step++;
-            if (_ck_a != data) {
-                Debug("bad cka %x should be %x", data, _ck_a);
-                _step = 0;
+        break;
+
+    // Message header processing
+    //
+    // We sniff the class and message ID to decide whether we
+    // are going to gather the message bytes or just discard
+    // them.
+    //
+    // We always collect the length so that we can avoid being
+    // fooled by preamble bytes in messages.
+    //
+    case 2:
+        _step++;
+        _class = data;
+        _ck_b = _ck_a = data;                       // reset the checksum accumulators
+        break;
+    case 3:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _msg_id = data;
+        break;
+    case 4:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+        _payload_length = data;                     // payload length low byte
+        break;
+    case 5:
+        _step++;
+        _ck_b += (_ck_a += data);                   // checksum byte
+
+        _payload_length += (uint16_t)(data<<8);
+        if ((_payload_length > sizeof(_buffer))
 #if AP_GPS_UBLOX_CFGV2_ENABLED
-                if (_class == CLASS_CFG && _msg_id == MSG_CFG_VALGET) {
-                    _cfg_v2.process_valget_complete(false);
-                }
+        && !(_class == CLASS_CFG || _msg_id == MSG_CFG_VALGET)
 #endif
-				goto reset;
-            }
-            break;
-        case 8:
+        ) {
+            Debug("large payload %u", (unsigned)_payload_length);
+            // assume any payload bigger then what we know about is noise
+            _payload_length = 0;
             _step = 0;
-            if (_ck_b != data) {
-                Debug("bad ckb %x should be %x", data, _ck_b);
+				goto reset;
+        }
+        _payload_counter = 0;                       // prepare to receive payload
+        if (_payload_length == 0) {
+            // bypass payload and go straight to checksum
+            _step++;
+        }
+        break;
+
+    // Receive message data
+    //
+    case 6:
+        _ck_b += (_ck_a += data);                   // checksum byte
 #if AP_GPS_UBLOX_CFGV2_ENABLED
-                if (_class == CLASS_CFG && _msg_id == MSG_CFG_VALGET) {
-                    _cfg_v2.process_valget_complete(false);
-                }
+        if (_class == CLASS_CFG && _msg_id == MSG_CFG_VALGET) {
+            CFGv2_Debug("V2 VALGET byte %u/%u: 0x%02x\n", (unsigned)_payload_counter, (unsigned)_payload_length, data);
+            _cfg_v2.process_valget_byte(data);
+        }
 #endif
-                break;                                                  // bad checksum
-            }
+        if (_payload_counter < sizeof(_buffer)) {
+            _buffer[_payload_counter] = data;
+        }
+        if (++_payload_counter == _payload_length)
+            _step++;
+        break;
 
-#if GPS_MOVING_BASELINE
-            if (rtcm3_parser) {
-                // this is a uBlox packet, discard any partial RTCMv3 state
-                rtcm3_parser->reset();
+    // Checksum and message processing
+    //
+    case 7:
+        _step++;
+        if (_ck_a != data) {
+            Debug("bad cka %x should be %x", data, _ck_a);
+            _step = 0;
+#if AP_GPS_UBLOX_CFGV2_ENABLED
+            if (_class == CLASS_CFG && _msg_id == MSG_CFG_VALGET) {
+                _cfg_v2.process_valget_complete(false);
             }
 #endif
+				goto reset;
+        }
+        break;
+    case 8:
+        _step = 0;
+        if (_ck_b != data) {
+            Debug("bad ckb %x should be %x", data, _ck_b);
 #if AP_GPS_UBLOX_CFGV2_ENABLED
             if (_class == CLASS_CFG && _msg_id == MSG_CFG_VALGET) {
-                _cfg_v2.process_valget_complete(true);
+                _cfg_v2.process_valget_complete(false);
             }
 #endif
-            if (_parse_gps()) {
-                parsed = true;
-            }
-            break;
+            break;                                                  // bad checksum
+        }
+
+#if GPS_MOVING_BASELINE
+        if (rtcm3_parser) {
+            // this is a uBlox packet, discard any partial RTCMv3 state
+            rtcm3_parser->reset();
+        }
+#endif
+#if AP_GPS_UBLOX_CFGV2_ENABLED
+        if (_class == CLASS_CFG && _msg_id == MSG_CFG_VALGET) {
+            _cfg_v2.process_valget_complete(true);
         }
+#endif
+        return _parse_gps();
     }
-    return parsed;
+    return false;
 }
 
 // Private Methods /////////////////////////////////////////////////////////////
@@ -1894,13 +1963,25 @@ AP_GPS_UBLOX::set_pps_desired_freq(uint8_t freq)
  *  update checksum for a set of bytes
  */
 void
-AP_GPS_UBLOX::_update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
+AP_GPS_UBLOX::_update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
 {
+    // four bytes at a time, with the weights each byte carries into
+    // ck_b. The sums only need to be correct mod 256, so wrapping of
+    // the 32 bit accumulators doesn't matter
+    uint32_t a = ck_a;
+    uint32_t b = ck_b;
+    while (len >= 4) {
+        b += 4*a + 4*data[0] + 3*data[1] + 2*data[2] + data[3];
+        a += data[0] + data[1] + data[2] + data[3];
+        data += 4;
+        len -= 4;
+    }
     while (len--) {
-        ck_a += *data;
-        ck_b += ck_a;
-        data++;
+        a += *data++;
+        b += a;
     }
+    ck_a = a;
+    ck_b = b;
 }
 
 
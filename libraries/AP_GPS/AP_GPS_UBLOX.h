@@ -79,6 +79,11 @@
 
 #define UBLOX_MAX_GNSS_CONFIG_BLOCKS 7
 
+// bytes read from the uart at a time
+#ifndef AP_GPS_UBLOX_READ_BLOCK_SIZE
+#define AP_GPS_UBLOX_READ_BLOCK_SIZE 128
+#endif
+
 #define UBX_TIMEGPS_VALID_WEEK_MASK 0x2
 
 #define UBLOX_MAX_PORTS 6
@@ -839,6 +844,14 @@ private:
     uint8_t         _class;
     bool            _cfg_saved;
 
+    // block of bytes read from the uart, not all of which may have
+    // been processed yet
+    struct {
+        uint8_t buf[AP_GPS_UBLOX_READ_BLOCK_SIZE];
+        uint16_t ofs;
+        uint16_t len;
+    } _rx_block;
+
     uint32_t        _last_vel_time;
     uint32_t        _last_pos_time;
     uint32_t        _last_cfg_sent_time;
@@ -893,7 +906,7 @@ private:
     bool        _configure_list_valset(const config_list *list, uint8_t count, uint8_t layers=UBX_VALSET_LAYER_ALL);
     bool        _configure_valget(ConfigKey key);
     void        _configure_rate(void);
-    static void _update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b);
+    static void _update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b);
     bool        _send_message(uint8_t msg_class, uint8_t msg_id, const void *msg, uint16_t size);
     bool        _request_message_rate(uint8_t msg_class, uint8_t msg_id);
     void        _request_next_config(void);
@@ -902,6 +915,8 @@ private:
     void        _save_cfg(void);
     void        _verify_rate(uint8_t msg_class, uint8_t msg_id, uint8_t rate);
     void        _check_new_itow(uint32_t itow);
+    bool        _parse_block(const uint8_t *data, uint16_t len);
+    bool        _parse_byte(uint8_t data);
 
     void unexpected_message(void);
     void log_mon_hw(void);
@@ -45,6 +45,16 @@
 #define GPS_BLENDED_INSTANCE GPS_MAX_RECEIVERS  // the virtual blended GPS is always the highest instance (2)
 #endif
 
+// number of GPS_RTCM_DATA blocks that can be re-assembled at once,
+// for fragments arriving out of order over several links
+#ifndef AP_GPS_RTCM_REASSEMBLY_SLOTS
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define AP_GPS_RTCM_REASSEMBLY_SLOTS 4
+#else
+#define AP_GPS_RTCM_REASSEMBLY_SLOTS 1
+#endif
+#endif
+
 #ifndef AP_GPS_DRONECAN_ENABLED
 #define AP_GPS_DRONECAN_ENABLED AP_GPS_BACKEND_DEFAULT_ENABLED && HAL_ENABLE_DRONECAN_DRIVERS
 #endif
@@ -64,6 +64,64 @@ uint16_t RTCM3_Parser::get_id(void) const
     return (pkt[3]<<8 | pkt[4]) >> 4;
 }
 
+// return length of the packet with a good CRC at the start of data
+uint16_t RTCM3_Parser::packet_len(const uint8_t *data, uint16_t len)
+{
+    if (len < 6 || data[0] != RTCMv3_PREAMBLE) {
+        return 0;
+    }
+    const uint16_t payload_len = (data[1]<<8 | data[2]) & 0x3ff;
+    if (payload_len == 0 || payload_len + 6U > len) {
+        return 0;
+    }
+    const uint8_t *parity = &data[payload_len+3];
+    const uint32_t crc1 = (parity[0] << 16) | (parity[1] << 8) | parity[2];
+    if (crc1 != crc_crc24(data, payload_len+3)) {
+        return 0;
+    }
+    return payload_len + 6;
+}
+
+// return the GPS_GNSS_MODE bits for the constellation of a message
+uint16_t RTCM3_Parser::gnss_mask(uint16_t id)
+{
+    enum {
+        GNSS_GPS     = 1U<<0,
+        GNSS_SBAS    = 1U<<1,
+        GNSS_GALILEO = 1U<<2,
+        GNSS_BEIDOU  = 1U<<3,
+        GNSS_QZSS    = 1U<<5,
+        GNSS_GLONASS = 1U<<6,
+        GNSS_NAVIC   = 1U<<7,
+    };
+    // MSM observations, in blocks of 10 message IDs
+    if (id >= 1071 && id <= 1137 && (id % 10) >= 1 && (id % 10) <= 7) {
+        static const uint8_t msm_gnss[] = {
+            GNSS_GPS, GNSS_GLONASS, GNSS_GALILEO, GNSS_SBAS, GNSS_QZSS, GNSS_BEIDOU, GNSS_NAVIC
+        };
+        return msm_gnss[(id - 1071) / 10];
+    }
+    switch (id) {
+    case 1001 ... 1004: // legacy GPS observations
+    case 1019:          // GPS ephemeris
+        return GNSS_GPS;
+    case 1009 ... 1012: // legacy GLONASS observations
+    case 1020:          // GLONASS ephemeris
+    case 1230:          // GLONASS code-phase biases
+        return GNSS_GLONASS;
+    case 1041:          // NavIC ephemeris
+        return GNSS_NAVIC;
+    case 1042:          // BeiDou ephemeris
+        return GNSS_BEIDOU;
+    case 1044:          // QZSS ephemeris
+        return GNSS_QZSS;
+    case 1045:          // Galileo F/NAV ephemeris
+    case 1046:          // Galileo I/NAV ephemeris
+        return GNSS_GALILEO;
+    }
+    return 0;
+}
+
 // look for preamble to try to resync
 void RTCM3_Parser::resync(void)
 {
@@ -39,6 +39,21 @@ public:
 
     // return ID of found packet
     uint16_t get_id(void) const;
+
+    // return the length of the packet with a good CRC at the start of
+    // data, or zero if there isn't one
+    static uint16_t packet_len(const uint8_t *data, uint16_t len);
+
+    // return the ID of a packet checked with packet_len()
+    static uint16_t packet_id(const uint8_t *data) {
+        return (data[3]<<8 | data[4]) >> 4;
+    }
+
+    // return the constellations a message carries observations or
+    // ephemerides for, as GPS_GNSS_MODE bits. Returns zero for
+    // messages that apply to all constellations, such as the
+    // reference station position
+    static uint16_t gnss_mask(uint16_t id);
     
 private:
     static constexpr uint8_t RTCMv3_PREAMBLE = 0xD3;
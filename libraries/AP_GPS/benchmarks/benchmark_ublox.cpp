@@ -0,0 +1,155 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  benchmarks for u-blox UBX parsing. A second of traffic from a
+  receiver is replayed through AP_GPS_UBLOX::read(), with the uart
+  returning at most the given number of bytes per read, as it would
+  with bytes arriving in DMA blocks of that size.
+
+  BM_UBXReadNav replays 10Hz navigation messages, and BM_UBXReadRTK
+  adds the RELPOSNED and raw measurement messages of a 20Hz moving
+  baseline rover with RAWX logging enabled.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_GPS/AP_GPS.h>
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// a uart that replays a stream of bytes
+class ReplayUart : public AP_HAL::UARTDriver {
+public:
+    bool is_initialized() override { return true; }
+    bool tx_pending() override { return false; }
+    uint32_t txspace() override { return 4096; }
+
+    void replay(const uint8_t *_data, uint32_t _len, uint16_t _max_read) {
+        data = _data;
+        len = _len;
+        ofs = 0;
+        max_read = _max_read;
+    }
+
+protected:
+    uint32_t _available() override { return len - ofs; }
+    void _begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void _end() override {}
+    void _flush() override {}
+    size_t _write(const uint8_t *buffer, size_t size) override { return size; }
+    ssize_t _read(uint8_t *buffer, uint16_t count) override {
+        const uint32_t n = MIN(MIN(uint32_t(count), uint32_t(max_read)), len - ofs);
+        memcpy(buffer, &data[ofs], n);
+        ofs += n;
+        return n;
+    }
+    bool _discard_input() override { ofs = len; return true; }
+
+private:
+    const uint8_t *data;
+    uint32_t len;
+    uint32_t ofs;
+    uint16_t max_read;
+};
+
+static AP_GPS gps;
+static AP_GPS::Params params;
+static AP_GPS::GPS_State state;
+static ReplayUart uart;
+
+static const uint16_t max_reads[] = { 1, 16, 64, 128, 512 };
+
+// second of traffic from a receiver
+static uint8_t stream[64*1024];
+static uint32_t stream_len;
+
+static void add_message(uint8_t msg_class, uint8_t msg_id, uint16_t len)
+{
+    if (stream_len + len + 8 > sizeof(stream)) {
+        return;
+    }
+    uint8_t *p = &stream[stream_len];
+    p[0] = 0xB5;
+    p[1] = 0x62;
+    p[2] = msg_class;
+    p[3] = msg_id;
+    p[4] = len & 0xFF;
+    p[5] = len >> 8;
+    // payload bytes, including preamble bytes to test resync
+    for (uint16_t i=0; i<len; i++) {
+        p[6+i] = (i % 37 == 0) ? 0xB5 : get_random16();
+    }
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i=2; i<len+6; i++) {
+        ck_a += p[i];
+        ck_b += ck_a;
+    }
+    p[6+len] = ck_a;
+    p[7+len] = ck_b;
+    stream_len += len + 8;
+}
+
+static void make_stream(bool rtk)
+{
+    stream_len = 0;
+    const uint8_t rate_hz = rtk ? 20 : 10;
+    for (uint8_t i=0; i<rate_hz; i++) {
+        add_message(0x01, 0x07, 92);            // NAV-PVT
+        add_message(0x01, 0x04, 18);            // NAV-DOP
+        if (rtk) {
+            add_message(0x01, 0x3C, 64);        // NAV-RELPOSNED
+            add_message(0x02, 0x15, 16 + 32*32); // RXM-RAWX with 32 SVs
+        }
+    }
+    add_message(0x0A, 0x09, 60);                // MON-HW
+}
+
+static void read_stream(benchmark::State& state_bm, bool rtk)
+{
+    const uint16_t max_read = max_reads[state_bm.range(0)];
+    make_stream(rtk);
+
+    AP_GPS_UBLOX *ublox = NEW_NOTHROW AP_GPS_UBLOX(gps, params, state, &uart, AP_GPS::GPS_ROLE_NORMAL);
+
+    while (state_bm.KeepRunning()) {
+        uart.replay(stream, stream_len, max_read);
+        // read() takes at most 8192 bytes per call
+        while (uart.available() > 0) {
+            ublox->read();
+        }
+        gbenchmark_escape(ublox);
+    }
+
+    char label[32];
+    snprintf(label, sizeof(label), "%u byte reads", unsigned(max_read));
+    state_bm.SetLabel(label);
+    state_bm.SetBytesProcessed(int64_t(state_bm.iterations()) * stream_len);
+
+    delete ublox;
+}
+
+static void BM_UBXReadNav(benchmark::State& state_bm)
+{
+    read_stream(state_bm, false);
+}
+
+static void BM_UBXReadRTK(benchmark::State& state_bm)
+{
+    read_stream(state_bm, true);
+}
+
+BENCHMARK(BM_UBXReadNav)->DenseRange(0, ARRAY_SIZE(max_reads)-1);
+BENCHMARK(BM_UBXReadRTK)->DenseRange(0, ARRAY_SIZE(max_reads)-1);
+
+BENCHMARK_MAIN();
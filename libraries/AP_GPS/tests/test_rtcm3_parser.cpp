@@ -0,0 +1,71 @@
+#include <AP_gtest.h>
+
+#include <AP_GPS/RTCM3_Parser.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+// build a RTCMv3 packet with the given message ID and payload length
+static uint16_t make_packet(uint8_t *buf, uint16_t id, uint16_t payload_len)
+{
+    buf[0] = 0xD3;
+    buf[1] = payload_len >> 8;
+    buf[2] = payload_len & 0xFF;
+    buf[3] = id >> 4;
+    buf[4] = (id & 0x0F) << 4;
+    for (uint16_t i=2; i<payload_len; i++) {
+        buf[3+i] = i;
+    }
+    const uint32_t crc = crc_crc24(buf, payload_len+3);
+    buf[payload_len+3] = crc >> 16;
+    buf[payload_len+4] = crc >> 8;
+    buf[payload_len+5] = crc;
+    return payload_len + 6;
+}
+
+TEST(RTCM3_Parser, packet_len)
+{
+    uint8_t buf[64];
+    const uint16_t len = make_packet(buf, 1077, 40);
+    EXPECT_EQ(len, RTCM3_Parser::packet_len(buf, sizeof(buf)));
+    EXPECT_EQ(1077, RTCM3_Parser::packet_id(buf));
+
+    // truncated
+    EXPECT_EQ(0, RTCM3_Parser::packet_len(buf, len-1));
+
+    // bad CRC
+    buf[10] ^= 1;
+    EXPECT_EQ(0, RTCM3_Parser::packet_len(buf, len));
+
+    // no preamble
+    buf[0] = 0;
+    EXPECT_EQ(0, RTCM3_Parser::packet_len(buf, sizeof(buf)));
+}
+
+TEST(RTCM3_Parser, gnss_mask)
+{
+    // MSM observations, GPS_GNSS_MODE bits
+    EXPECT_EQ(1U<<0, RTCM3_Parser::gnss_mask(1074));
+    EXPECT_EQ(1U<<6, RTCM3_Parser::gnss_mask(1087));
+    EXPECT_EQ(1U<<2, RTCM3_Parser::gnss_mask(1097));
+    EXPECT_EQ(1U<<1, RTCM3_Parser::gnss_mask(1107));
+    EXPECT_EQ(1U<<5, RTCM3_Parser::gnss_mask(1111));
+    EXPECT_EQ(1U<<3, RTCM3_Parser::gnss_mask(1127));
+    EXPECT_EQ(1U<<7, RTCM3_Parser::gnss_mask(1137));
+
+    // ephemerides and legacy observations
+    EXPECT_EQ(1U<<0, RTCM3_Parser::gnss_mask(1019));
+    EXPECT_EQ(1U<<6, RTCM3_Parser::gnss_mask(1012));
+    EXPECT_EQ(1U<<6, RTCM3_Parser::gnss_mask(1230));
+    EXPECT_EQ(1U<<2, RTCM3_Parser::gnss_mask(1046));
+    EXPECT_EQ(1U<<3, RTCM3_Parser::gnss_mask(1042));
+
+    // messages for all constellations
+    EXPECT_EQ(0, RTCM3_Parser::gnss_mask(1005));
+    EXPECT_EQ(0, RTCM3_Parser::gnss_mask(1006));
+    EXPECT_EQ(0, RTCM3_Parser::gnss_mask(1033));
+    EXPECT_EQ(0, RTCM3_Parser::gnss_mask(1078));
+    EXPECT_EQ(0, RTCM3_Parser::gnss_mask(4072));
+}
+
+AP_GTEST_MAIN()
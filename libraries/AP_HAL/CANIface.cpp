@@ -103,6 +103,36 @@ int16_t AP_HAL::CANIface::send(const CANFrame& frame, uint64_t tx_deadline, CanI
     return 1;
 }
 
+/*
+  send a batch of frames. Backends which can queue several frames
+  under one lock should override this
+ */
+int16_t AP_HAL::CANIface::send_frames(const CANFrame* frames, const uint64_t* tx_deadlines, uint8_t num_frames, CanIOFlags flags)
+{
+    for (uint8_t i=0; i<num_frames; i++) {
+        const int16_t ret = send(frames[i], tx_deadlines[i], flags);
+        if (ret <= 0) {
+            return i == 0 ? ret : i;
+        }
+    }
+    return num_frames;
+}
+
+/*
+  receive a batch of frames. Backends which can pop several frames
+  under one lock should override this
+ */
+int16_t AP_HAL::CANIface::receive_frames(CANFrame* out_frames, uint64_t* out_ts_monotonic, CanIOFlags* out_flags, uint8_t max_frames)
+{
+    for (uint8_t i=0; i<max_frames; i++) {
+        const int16_t ret = receive(out_frames[i], out_ts_monotonic[i], out_flags[i]);
+        if (ret <= 0) {
+            return i == 0 ? ret : i;
+        }
+    }
+    return max_frames;
+}
+
 /*
   register a callback for for sending CAN_FRAME messages.
   On success the returned callback_id can be used to unregister the callback
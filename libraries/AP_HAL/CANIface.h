@@ -182,6 +182,15 @@ public:
     // must be called on child class
     virtual int16_t receive(CANFrame& out_frame, uint64_t& out_ts_monotonic, CanIOFlags& out_flags);
 
+    // Put up to num_frames frames in queue to be sent, in order, stopping at the first frame
+    // that can't be queued. Returns the number of frames queued, or negative if an error
+    // occurred on the first frame
+    virtual int16_t send_frames(const CANFrame* frames, const uint64_t* tx_deadlines, uint8_t num_frames, CanIOFlags flags);
+
+    // Non blocking receive of up to max_frames frames. Returns the number of frames received,
+    // or negative if an error occurred on the first frame
+    virtual int16_t receive_frames(CANFrame* out_frames, uint64_t* out_ts_monotonic, CanIOFlags* out_flags, uint8_t max_frames);
+
     //Return Total Error Count generated so far
     virtual uint32_t getErrorCount() const
     {
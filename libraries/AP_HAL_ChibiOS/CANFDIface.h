@@ -189,6 +189,10 @@ public:
     int16_t receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_us,
                     CanIOFlags& out_flags) override;
 
+    // Receive up to max_frames frames from Rx Buffer, returns number of frames received
+    int16_t receive_frames(AP_HAL::CANFrame* out_frames, uint64_t* out_timestamp_us,
+                           CanIOFlags* out_flags, uint8_t max_frames) override;
+
     // returns true if busoff state was detected and not handled yet
     bool is_busoff() const override
     {
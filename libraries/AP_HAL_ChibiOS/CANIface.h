@@ -168,6 +168,10 @@ public:
     int16_t receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_us,
                     CanIOFlags& out_flags) override;
 
+    // Receive up to max_frames frames from Rx Buffer, returns number of frames received
+    int16_t receive_frames(AP_HAL::CANFrame* out_frames, uint64_t* out_timestamp_us,
+                           CanIOFlags* out_flags, uint8_t max_frames) override;
+
     // In BxCAN the Busoff error is cleared automatically,
     // so always return false
     bool is_busoff() const override
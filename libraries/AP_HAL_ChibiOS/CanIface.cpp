@@ -392,6 +392,29 @@ int16_t CANIface::receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_u
     return AP_HAL::CANIface::receive(out_frame, out_timestamp_us, out_flags);
 }
 
+/*
+  pop up to max_frames frames from the rx queue in one critical section
+ */
+int16_t CANIface::receive_frames(AP_HAL::CANFrame* out_frames, uint64_t* out_timestamp_us, CanIOFlags* out_flags, uint8_t max_frames)
+{
+    uint8_t n = 0;
+    {
+        CriticalSectionLocker lock;
+        CanRxItem rx_item;
+        while (n < max_frames && rx_queue_.pop(rx_item)) {
+            out_frames[n]       = rx_item.frame;
+            out_timestamp_us[n] = rx_item.timestamp_us;
+            out_flags[n]        = rx_item.flags;
+            n++;
+        }
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        AP_HAL::CANIface::receive(out_frames[i], out_timestamp_us[i], out_flags[i]);
+    }
+    return n;
+}
+
 bool CANIface::waitMsrINakBitStateChange(bool target_state)
 {
     const unsigned Timeout = 1000;
@@ -22,6 +22,7 @@
 #include "Scheduler.h"
 #include "hwdef/common/flash.h"
 #include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Common/ExpandingString.h>
 #include <stdio.h>
 
 using namespace ChibiOS;
@@ -47,6 +48,21 @@ extern const AP_HAL::HAL& hal;
 
 #define STORAGE_FLASH_RETRIES 5
 
+/*
+  dirty lines are held back until there have been no writes for
+  HAL_STORAGE_WRITE_SETTLE_MS so that bursts of writes (such as a
+  parameter save or a mission upload) coalesce into fewer, larger
+  backend writes. Once data has been dirty for
+  HAL_STORAGE_WRITE_MAX_DELAY_MS it is written regardless
+ */
+#ifndef HAL_STORAGE_WRITE_SETTLE_MS
+#define HAL_STORAGE_WRITE_SETTLE_MS 20
+#endif
+
+#ifndef HAL_STORAGE_WRITE_MAX_DELAY_MS
+#define HAL_STORAGE_WRITE_MAX_DELAY_MS 500
+#endif
+
 // by default don't allow fallback to sdcard for storage
 #ifndef HAL_RAMTRON_ALLOW_FALLBACK
 #define HAL_RAMTRON_ALLOW_FALLBACK 0
@@ -239,8 +255,14 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
         WITH_SEMAPHORE(sem);
+        const uint32_t now_ms = AP_HAL::millis();
+        if (_dirty_mask.empty()) {
+            _first_dirty_ms = now_ms;
+        }
+        _last_dirty_ms = now_ms;
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _stats.requested_bytes += n;
     }
 }
 
@@ -249,35 +271,62 @@ void Storage::_timer_tick(void)
     if (_initialisedType == StorageBackend::None) {
         return;
     }
+    const uint32_t now_ms = AP_HAL::millis();
     if (_dirty_mask.empty()) {
-        _last_empty_ms = AP_HAL::millis();
+        _last_empty_ms = now_ms;
+#ifdef STORAGE_FLASH_PAGE
+        if (_initialisedType == StorageBackend::Flash) {
+            // compact flash storage while we are idle. This changes
+            // the sector state so must not run alongside a write
+            WITH_SEMAPHORE(_flash_sem);
+            _flash.update();
+        }
+#endif
         return;
     }
-
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint16_t i;
-    for (i=0; i<CH_STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask.get(i)) {
-            break;
-        }
+    if (now_ms - _last_dirty_ms < HAL_STORAGE_WRITE_SETTLE_MS &&
+        now_ms - _first_dirty_ms < HAL_STORAGE_WRITE_MAX_DELAY_MS) {
+        // still being written to, wait for the burst to finish
+        return;
     }
-    if (i == CH_STORAGE_NUM_LINES) {
+
+    // write out the first run of contiguous dirty lines. We don't
+    // write more than one run to keep the latency of this call to a
+    // minimum
+    const int16_t first = _dirty_mask.first_set();
+    if (first < 0) {
         // this shouldn't be possible
         return;
     }
-
+    uint16_t nlines = 1;
     {
-        // take a copy of the line we are writing with a semaphore held
         WITH_SEMAPHORE(sem);
-        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE);
+        const uint16_t pending = _dirty_mask.count();
+        _stats.max_pending_lines = MAX(_stats.max_pending_lines, pending);
+        while (nlines < CH_STORAGE_MAX_RUN_LINES &&
+               first + nlines < CH_STORAGE_NUM_LINES &&
+               _dirty_mask.get(first + nlines)) {
+            nlines++;
+        }
+        // the run is marked clean before it is written. If someone
+        // re-dirties a line while we are writing it then write_block()
+        // marks it dirty again and it will be written on a later tick
+        for (uint16_t i=0; i<nlines; i++) {
+            _dirty_mask.clear(first + i);
+        }
+#if HAL_WITH_RAMTRON
+        // take a copy of the run we are writing with a semaphore held
+        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*first], CH_STORAGE_LINE_SIZE*nlines);
+#endif
     }
 
+    const uint32_t offset = CH_STORAGE_LINE_SIZE*first;
+    const uint16_t length = CH_STORAGE_LINE_SIZE*nlines;
     bool write_ok = false;
 
 #if HAL_WITH_RAMTRON
     if (_initialisedType == StorageBackend::FRAM) {
-        if (fram.write(CH_STORAGE_LINE_SIZE*i, tmpline, CH_STORAGE_LINE_SIZE)) {
+        if (fram.write(offset, tmpline, length)) {
             write_ok = true;
         }
     }
@@ -285,41 +334,32 @@ void Storage::_timer_tick(void)
 
 #ifdef USE_POSIX
     if ((_initialisedType == StorageBackend::SDCard) && log_fd != -1) {
-        uint32_t offset = CH_STORAGE_LINE_SIZE*i;
-        if (AP::FS().lseek(log_fd, offset, SEEK_SET) != offset) {
-            return;
-        }
-        if (AP::FS().write(log_fd, &_buffer[offset], CH_STORAGE_LINE_SIZE) != CH_STORAGE_LINE_SIZE) {
-            return;
-        }
-        if (AP::FS().fsync(log_fd) != 0) {
-            return;
+        if (AP::FS().lseek(log_fd, offset, SEEK_SET) == offset &&
+            AP::FS().write(log_fd, &_buffer[offset], length) == ssize_t(length) &&
+            AP::FS().fsync(log_fd) == 0) {
+            write_ok = true;
         }
-        write_ok = true;
     }
 #endif
 
 #ifdef STORAGE_FLASH_PAGE
     if (_initialisedType == StorageBackend::Flash) {
         // save to storage backend
-        if (_flash_write(i)) {
+        if (_flash_write(first, nlines)) {
             write_ok = true;
         }
     }
 #endif
 
-    if (write_ok) {
-        WITH_SEMAPHORE(sem);
-        // while holding the semaphore we check if the copy of the
-        // line is different from the original line. If it is
-        // different then someone has re-dirtied the line while we
-        // were writing it, in which case we should not mark it
-        // clean. If it matches then we know we can mark the line as
-        // clean
-        if (memcmp(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE) == 0) {
-            _dirty_mask.clear(i);
-        }
+    WITH_SEMAPHORE(sem);
+    if (!write_ok) {
+        // put the run back to be retried
+        _mark_dirty(offset, length);
+        _stats.backend_failures++;
+        return;
     }
+    _stats.backend_writes++;
+    _stats.backend_bytes += length;
 }
 
 /*
@@ -331,9 +371,9 @@ void Storage::_flash_load(void)
     _flash_page = STORAGE_FLASH_PAGE;
 
 #if AP_FLASH_STORAGE_DOUBLE_PAGE
-    ::printf("Storage: Using flash pages %u to %u\n", _flash_page, _flash_page+3);
+    ::printf("Storage: Using flash pages %u to %u\n", _flash_page, _flash_page+2*AP_FLASH_STORAGE_NUM_SECTORS-1);
 #else
-    ::printf("Storage: Using flash pages %u and %u\n", _flash_page, _flash_page+1);
+    ::printf("Storage: Using flash pages %u to %u\n", _flash_page, _flash_page+AP_FLASH_STORAGE_NUM_SECTORS-1);
 #endif
 
     if (!_flash.init()) {
@@ -345,13 +385,14 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask.
+  write a run of storage lines
 */
-bool Storage::_flash_write(uint16_t line)
+bool Storage::_flash_write(uint16_t line, uint16_t nlines)
 {
 #ifdef STORAGE_FLASH_PAGE
     EXPECT_DELAY_MS(1);
-    return _flash.write(line*CH_STORAGE_LINE_SIZE, CH_STORAGE_LINE_SIZE);
+    WITH_SEMAPHORE(_flash_sem);
+    return _flash.write(line*CH_STORAGE_LINE_SIZE, nlines*CH_STORAGE_LINE_SIZE);
 #else
     return false;
 #endif
@@ -481,6 +522,7 @@ bool Storage::erase(void)
     }
 #endif
 #ifdef STORAGE_FLASH_PAGE
+    WITH_SEMAPHORE(_flash_sem);
     return _flash.erase();
 #else
     return false;
@@ -500,5 +542,30 @@ bool Storage::get_storage_ptr(void *&ptr, size_t &size)
     return true;
 }
 
+/*
+  report write coalescing statistics. Write amplification is the
+  ratio of bytes written to the backend to bytes changed by callers,
+  in percent
+ */
+void Storage::storage_info(ExpandingString &str)
+{
+    static const char *backend_names[] { "None", "FRAM", "Flash", "SDCard" };
+    const uint16_t pending_lines = _dirty_mask.count();
+    str.printf("Storage: %s size=%u line=%u maxrun=%u\n",
+               backend_names[uint8_t(_initialisedType)],
+               unsigned(CH_STORAGE_SIZE),
+               unsigned(CH_STORAGE_LINE_SIZE),
+               unsigned(CH_STORAGE_MAX_RUN_LINES));
+    str.printf("requested=%u written=%u writes=%u fail=%u amp=%u%%\n",
+               unsigned(_stats.requested_bytes),
+               unsigned(_stats.backend_bytes),
+               unsigned(_stats.backend_writes),
+               unsigned(_stats.backend_failures),
+               unsigned(_stats.requested_bytes>0?uint64_t(_stats.backend_bytes)*100U/_stats.requested_bytes:0));
+    str.printf("pending=%u max_pending=%u\n",
+               unsigned(pending_lines*CH_STORAGE_LINE_SIZE),
+               unsigned(_stats.max_pending_lines*CH_STORAGE_LINE_SIZE));
+}
+
 
 #endif // HAL_USE_EMPTY_STORAGE
@@ -47,6 +47,22 @@
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
+/*
+  maximum number of contiguous dirty lines written to the backend in
+  one operation. For flash this matches the largest AP_FlashStorage
+  block write so each run costs a single block header, for microSD it
+  saves an fsync per line
+ */
+#ifndef CH_STORAGE_MAX_RUN_LINES
+#ifdef STORAGE_FLASH_PAGE
+#define CH_STORAGE_MAX_RUN_LINES (64/CH_STORAGE_LINE_SIZE)
+#elif defined(USE_POSIX) && !defined(HAL_WITH_RAMTRON)
+#define CH_STORAGE_MAX_RUN_LINES 8
+#else
+#define CH_STORAGE_MAX_RUN_LINES 16
+#endif
+#endif
+
 /*
   on boards with 8k sector sizes we double up to treat pairs of sectors as one
  */
@@ -54,6 +70,15 @@ static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
 #define AP_FLASH_STORAGE_DOUBLE_PAGE 0
 #endif
 
+/*
+  number of flash sectors used for storage, starting at
+  STORAGE_FLASH_PAGE. Using more sectors spreads the erase cycles over
+  more of the flash. The hwdef needs to reserve all of the pages
+ */
+#ifndef AP_FLASH_STORAGE_NUM_SECTORS
+#define AP_FLASH_STORAGE_NUM_SECTORS 2
+#endif
+
 class ChibiOS::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -64,6 +89,7 @@ public:
     void _timer_tick(void) override;
     bool healthy(void) override;
     bool get_storage_ptr(void *&ptr, size_t &size) override;
+    void storage_info(ExpandingString &str) override;
 
 private:
     enum class StorageBackend: uint8_t {
@@ -80,7 +106,13 @@ private:
     uint8_t _buffer[CH_STORAGE_SIZE] __attribute__((aligned(4)));
     Bitmask<CH_STORAGE_NUM_LINES> _dirty_mask;
     HAL_Semaphore sem;
-    uint8_t tmpline[CH_STORAGE_LINE_SIZE];
+    // serialises all calls into _flash. Separate from sem so
+    // write_block() is not held up by a sector erase
+    HAL_Semaphore _flash_sem;
+#if HAL_WITH_RAMTRON
+    // FRAM writes are verified so need a stable copy of the run
+    uint8_t tmpline[CH_STORAGE_MAX_RUN_LINES*CH_STORAGE_LINE_SIZE];
+#endif
 
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
@@ -90,6 +122,17 @@ private:
     bool _flash_failed;
     uint32_t _last_re_init_ms;
     uint32_t _last_empty_ms;
+    uint32_t _first_dirty_ms;
+    uint32_t _last_dirty_ms;
+
+    // write coalescing statistics
+    struct {
+        uint32_t requested_bytes;   // bytes changed by write_block()
+        uint32_t backend_bytes;     // bytes written to the backend
+        uint32_t backend_writes;
+        uint32_t backend_failures;
+        uint16_t max_pending_lines;
+    } _stats;
 
 #ifdef STORAGE_FLASH_PAGE
     AP_FlashStorage _flash{_buffer,
@@ -101,11 +144,12 @@ private:
             FUNCTOR_BIND_MEMBER(&Storage::_flash_write_data, bool, uint8_t, uint32_t, const uint8_t *, uint16_t),
             FUNCTOR_BIND_MEMBER(&Storage::_flash_read_data, bool, uint8_t, uint32_t, uint8_t *, uint16_t),
             FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_sector, bool, uint8_t),
-            FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_ok, bool)};
+            FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_ok, bool),
+            AP_FLASH_STORAGE_NUM_SECTORS};
 #endif
 
     void _flash_load(void);
-    bool _flash_write(uint16_t line);
+    bool _flash_write(uint16_t line, uint16_t nlines);
 
 #if HAL_WITH_RAMTRON
     AP_RAMTRON fram;
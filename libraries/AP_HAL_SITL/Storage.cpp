@@ -3,6 +3,7 @@
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 #include <AP_HAL/AP_HAL.h>
 #include "AP_HAL_SITL.h"
+#include <AP_Common/ExpandingString.h>
 
 #include <assert.h>
 #include <sys/types.h>
@@ -46,6 +47,20 @@ extern HAL_SITL& hal;
 #define HAL_FLASH_ALLOW_UPDATE 1
 #endif
 
+/*
+  dirty lines are held back until there have been no writes for
+  HAL_STORAGE_WRITE_SETTLE_MS so bursts of writes coalesce, but are
+  always written once they have been dirty for
+  HAL_STORAGE_WRITE_MAX_DELAY_MS
+ */
+#ifndef HAL_STORAGE_WRITE_SETTLE_MS
+#define HAL_STORAGE_WRITE_SETTLE_MS 20
+#endif
+
+#ifndef HAL_STORAGE_WRITE_MAX_DELAY_MS
+#define HAL_STORAGE_WRITE_MAX_DELAY_MS 500
+#endif
+
 void Storage::_storage_open(void)
 {
     if (_initialisedType != StorageBackend::None) {
@@ -155,8 +170,14 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
+        const uint32_t now_ms = AP_HAL::millis();
+        if (_dirty_mask.empty()) {
+            _first_dirty_ms = now_ms;
+        }
+        _last_dirty_ms = now_ms;
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _stats.requested_bytes += n;
     }
 }
 
@@ -165,54 +186,71 @@ void Storage::_timer_tick(void)
     if (_initialisedType == StorageBackend::None) {
         return;
     }
+    const uint32_t now_ms = AP_HAL::millis();
     if (_dirty_mask.empty()) {
-        _last_empty_ms = AP_HAL::millis();
+        _last_empty_ms = now_ms;
+#if STORAGE_USE_FLASH
+        if (_initialisedType == StorageBackend::Flash) {
+            // compact flash storage while we are idle
+            _flash.update();
+        }
+#endif
         return;
     }
-
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint16_t i;
-    for (i=0; i<STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask.get(i)) {
-            break;
-        }
+    if (now_ms - _last_dirty_ms < HAL_STORAGE_WRITE_SETTLE_MS &&
+        now_ms - _first_dirty_ms < HAL_STORAGE_WRITE_MAX_DELAY_MS) {
+        // still being written to, wait for the burst to finish
+        return;
     }
-    if (i == STORAGE_NUM_LINES) {
+
+    // write out the first run of contiguous dirty lines. We don't
+    // write more than one run to keep the latency of this call to a
+    // minimum
+    const int16_t first = _dirty_mask.first_set();
+    if (first < 0) {
         // this shouldn't be possible
         return;
     }
+    _stats.max_pending_lines = MAX(_stats.max_pending_lines, _dirty_mask.count());
+    uint16_t nlines = 1;
+    while (nlines < STORAGE_MAX_RUN_LINES &&
+           first + nlines < STORAGE_NUM_LINES &&
+           _dirty_mask.get(first + nlines)) {
+        nlines++;
+    }
+    const uint32_t offset = STORAGE_LINE_SIZE*first;
+    const uint16_t length = STORAGE_LINE_SIZE*nlines;
+    bool write_ok = false;
 
 #if STORAGE_USE_FRAM
-        if (fram.write(STORAGE_LINE_SIZE*i, &_buffer[STORAGE_LINE_SIZE*i], STORAGE_LINE_SIZE)) {
-            _dirty_mask.clear(i);
-            return;
-        }
+    if (_initialisedType == StorageBackend::FRAM) {
+        write_ok = fram.write(offset, &_buffer[offset], length);
+    }
 #endif
 
 #if STORAGE_USE_POSIX
-    if (hal.get_storage_posix_enabled()) {
-        if (log_fd != -1) {
-            const off_t offset = STORAGE_LINE_SIZE*i;
-            if (lseek(log_fd, offset, SEEK_SET) != offset) {
-                return;
-            }
-            if (write(log_fd, &_buffer[offset], STORAGE_LINE_SIZE) != STORAGE_LINE_SIZE) {
-                return;
-            }
-            _dirty_mask.clear(i);
-            return;
-        }
+    if (_initialisedType == StorageBackend::SDCard && log_fd != -1) {
+        write_ok = lseek(log_fd, offset, SEEK_SET) == off_t(offset) &&
+                   write(log_fd, &_buffer[offset], length) == ssize_t(length);
     }
 #endif
 
 #if STORAGE_USE_FLASH
-    if (hal.get_storage_flash_enabled()) {
+    if (_initialisedType == StorageBackend::Flash) {
         // save to storage backend
-        _flash_write(i);
-        return;
+        write_ok = _flash_write(first, nlines);
     }
 #endif
+
+    if (!write_ok) {
+        _stats.backend_failures++;
+        return;
+    }
+    for (uint16_t i=0; i<nlines; i++) {
+        _dirty_mask.clear(first + i);
+    }
+    _stats.backend_writes++;
+    _stats.backend_bytes += length;
 }
 
 #if STORAGE_USE_FLASH
@@ -228,14 +266,11 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask. 
+  write a run of storage lines
 */
-void Storage::_flash_write(uint16_t line)
+bool Storage::_flash_write(uint16_t line, uint16_t nlines)
 {
-    if (_flash.write(line*STORAGE_LINE_SIZE, STORAGE_LINE_SIZE)) {
-        // mark the line clean
-        _dirty_mask.clear(line);
-    }
+    return _flash.write(line*STORAGE_LINE_SIZE, nlines*STORAGE_LINE_SIZE);
 }
 
 
@@ -400,3 +435,27 @@ bool Storage::get_storage_ptr(void *&ptr, size_t &size)
     size = sizeof(_buffer);
     return true;
 }
+
+/*
+  report write coalescing statistics. Write amplification is the
+  ratio of bytes written to the backend to bytes changed by callers,
+  in percent
+ */
+void Storage::storage_info(ExpandingString &str)
+{
+    static const char *backend_names[] { "None", "FRAM", "Flash", "POSIX" };
+    str.printf("Storage: %s size=%u line=%u maxrun=%u\n",
+               backend_names[uint8_t(_initialisedType)],
+               unsigned(HAL_STORAGE_SIZE),
+               unsigned(STORAGE_LINE_SIZE),
+               unsigned(STORAGE_MAX_RUN_LINES));
+    str.printf("requested=%u written=%u writes=%u fail=%u amp=%u%%\n",
+               unsigned(_stats.requested_bytes),
+               unsigned(_stats.backend_bytes),
+               unsigned(_stats.backend_writes),
+               unsigned(_stats.backend_failures),
+               unsigned(_stats.requested_bytes>0?uint64_t(_stats.backend_bytes)*100U/_stats.requested_bytes:0));
+    str.printf("pending=%u max_pending=%u\n",
+               unsigned(_dirty_mask.count()*STORAGE_LINE_SIZE),
+               unsigned(_stats.max_pending_lines*STORAGE_LINE_SIZE));
+}
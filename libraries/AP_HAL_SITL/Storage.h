@@ -23,6 +23,11 @@
 #define STORAGE_LINE_SIZE (1<<STORAGE_LINE_SHIFT)
 #define STORAGE_NUM_LINES (HAL_STORAGE_SIZE/STORAGE_LINE_SIZE)
 
+// maximum number of contiguous dirty lines written in one operation
+#ifndef STORAGE_MAX_RUN_LINES
+#define STORAGE_MAX_RUN_LINES 8
+#endif
+
 class HALSITL::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -32,6 +37,7 @@ public:
 
     void _timer_tick(void) override;
     bool healthy(void) override;
+    void storage_info(ExpandingString &str) override;
 
 private:
     enum class StorageBackend: uint8_t {
@@ -50,6 +56,17 @@ private:
     Bitmask<STORAGE_NUM_LINES> _dirty_mask;
 
     uint32_t _last_empty_ms;
+    uint32_t _first_dirty_ms;
+    uint32_t _last_dirty_ms;
+
+    // write coalescing statistics
+    struct {
+        uint32_t requested_bytes;   // bytes changed by write_block()
+        uint32_t backend_bytes;     // bytes written to the backend
+        uint32_t backend_writes;
+        uint32_t backend_failures;
+        uint16_t max_pending_lines;
+    } _stats;
 
 #if STORAGE_USE_FLASH
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
@@ -68,7 +85,7 @@ private:
             FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_ok, bool)};
 
     void _flash_load(void);
-    void _flash_write(uint16_t line);
+    bool _flash_write(uint16_t line, uint16_t nlines);
 #endif
 
 #if STORAGE_USE_POSIX
@@ -33,6 +33,7 @@ class AP_InertialSensor_Backend;
 class AuxiliaryBus;
 class AP_AHRS;
 class FastRateBuffer;
+class ExpandingString;
 
 /*
   forward declare AP_Logger class. We can't include logger.h
@@ -832,14 +833,30 @@ public:
     uint32_t get_num_gyro_samples();
     // set the rate at which samples are collected, unused samples are dropped
     void set_rate_decimation(uint8_t rdec);
-    // push a new gyro sample into the fast rate buffer
-    bool push_next_gyro_sample(const Vector3f& gyro);
+    // push a new gyro sample into the fast rate buffer, arrival_us is
+    // the time the raw sample was handed to the filters
+    bool push_next_gyro_sample(const Vector3f& gyro, uint32_t arrival_us);
     // run the filter parmeter update code.
     void update_backend_filters();
     // are rate loop samples enabled for this instance?
     bool is_rate_loop_gyro_enabled(uint8_t instance) const;
     // is dynamic fifo enabled for this instance
     bool is_dynamic_fifo_enabled(uint8_t instance) const;
+    // stages of a fast rate loop cycle that are timed
+    enum class FastRateStage : uint8_t {
+        FILTER = 0,     // IMU sample arrival to filtered sample pushed
+        WAIT,           // filtered sample pushed to rate controller start
+        RATE,           // rate controller run
+        MOTORS,         // motor output
+        TOTAL,          // IMU sample arrival to motor output
+        NUM_STAGES
+    };
+    // mark the end of a stage of the current fast rate loop cycle
+    void fast_rate_stage_complete(FastRateStage stage);
+    // log and accumulate the fast rate loop timing, called at 1Hz by the rate thread
+    void update_fast_rate_timing();
+    // fast rate loop latency histograms for @SYS/fastrate.txt
+    void fast_rate_timing_info(ExpandingString &str);
     // endif AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
 };
 
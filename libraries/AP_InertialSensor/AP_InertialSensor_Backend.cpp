@@ -218,6 +218,9 @@ void AP_InertialSensor_Backend::save_gyro_window(const uint8_t instance, const V
  */
 void AP_InertialSensor_Backend::apply_gyro_filters(const uint8_t instance, const Vector3f &gyro)
 {
+#if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+    const uint32_t arrival_us = AP_HAL::micros();
+#endif
     uint8_t filter_phase = 0;
     save_gyro_window(instance, gyro, filter_phase++);
 
@@ -266,7 +269,7 @@ void AP_InertialSensor_Backend::apply_gyro_filters(const uint8_t instance, const
 
 #if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
     if (_imu.is_rate_loop_gyro_enabled(instance)) {
-        if (_imu.push_next_gyro_sample(gyro_filtered)) {
+        if (_imu.push_next_gyro_sample(gyro_filtered, arrival_us)) {
             // if we used the value, record it for publication to the front-end
             _imu._gyro_filtered[instance] = gyro_filtered;
         }
@@ -7,3 +7,7 @@
 #ifndef AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
 #define AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED (AP_INERTIALSENSOR_ENABLED && HAL_INS_RATE_LOOP && AP_INERTIALSENSOR_HARMONICNOTCH_ENABLED && APM_BUILD_TYPE(APM_BUILD_ArduCopter))
 #endif
+
+#ifndef AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+#define AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
+#endif
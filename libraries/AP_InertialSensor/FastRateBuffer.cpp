@@ -20,6 +20,7 @@
 
 #if AP_INERTIALSENSOR_FAST_SAMPLE_WINDOW_ENABLED
 #include "FastRateBuffer.h"
+#include <AP_Logger/AP_Logger.h>
 #include <stdio.h>
 
 extern const AP_HAL::HAL& hal;
@@ -112,7 +113,23 @@ bool FastRateBuffer::get_next_gyro_sample(Vector3f& gyro)
 
     WITH_SEMAPHORE(_mutex);
 
-    return _rate_loop_gyro_window.pop(gyro);
+    GyroSample sample;
+    if (!_rate_loop_gyro_window.pop(sample)) {
+        return false;
+    }
+    gyro = sample.gyro;
+
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+    const uint32_t now_us = AP_HAL::micros();
+    _cycle.arrival_us = sample.arrival_us;
+    _cycle.last_mark_us = now_us;
+    _interval[uint8_t(FastRateTiming::Stage::WAIT)].update(now_us - sample.push_us);
+    if (_rate_loop_gyro_window.available() > 0) {
+        _interval_behind++;
+    }
+#endif
+
+    return true;
 }
 
 void FastRateBuffer::reset()
@@ -120,7 +137,7 @@ void FastRateBuffer::reset()
     _rate_loop_gyro_window.clear();
 }
 
-bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro)
+bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro, uint32_t arrival_us)
 {
     if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
         return false;
@@ -134,14 +151,189 @@ bool AP_InertialSensor::push_next_gyro_sample(const Vector3f& gyro)
     */
     WITH_SEMAPHORE(fast_rate_buffer->_mutex);
 
-    if (!fast_rate_buffer->_rate_loop_gyro_window.push(gyro)) {
+    FastRateBuffer::GyroSample sample;
+    sample.gyro = gyro;
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+    sample.arrival_us = arrival_us;
+    sample.push_us = AP_HAL::micros();
+    fast_rate_buffer->_interval[uint8_t(FastRateTiming::Stage::FILTER)].update(sample.push_us - arrival_us);
+#endif
+
+    if (!fast_rate_buffer->_rate_loop_gyro_window.push(sample)) {
         debug("dropped rate loop sample");
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+        fast_rate_buffer->_interval_dropped++;
+#endif
     }
     fast_rate_buffer->rate_decimation_count = 0;
     fast_rate_buffer->_notifier.signal();
     return true;
 }
 
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+// mark the end of a stage of the current fast rate loop cycle
+void AP_InertialSensor::fast_rate_stage_complete(FastRateStage stage)
+{
+    if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
+        return;
+    }
+    fast_rate_buffer->mark_stage_complete(stage);
+}
+
+// log and accumulate the fast rate loop timing, called at 1Hz by the rate thread
+void AP_InertialSensor::update_fast_rate_timing()
+{
+    if (!fast_rate_buffer_enabled || fast_rate_buffer == nullptr) {
+        return;
+    }
+#if HAL_LOGGING_ENABLED
+    fast_rate_buffer->update_timing_stats(AP::logger().logging_started());
+#else
+    fast_rate_buffer->update_timing_stats(false);
+#endif
+}
+
+// fast rate loop latency histograms for @SYS/fastrate.txt
+void AP_InertialSensor::fast_rate_timing_info(ExpandingString &str)
+{
+    if (fast_rate_buffer == nullptr) {
+        str.printf("fast rate loop not running\n");
+        return;
+    }
+    fast_rate_buffer->timing_info(str);
+}
+
+void FastRateBuffer::mark_stage_complete(FastRateTiming::Stage stage)
+{
+    const uint32_t now_us = AP_HAL::micros();
+    _interval[uint8_t(stage)].update(now_us - _cycle.last_mark_us);
+    _cycle.last_mark_us = now_us;
+    if (stage == FastRateTiming::Stage::MOTORS) {
+        _interval[uint8_t(FastRateTiming::Stage::TOTAL)].update(now_us - _cycle.arrival_us);
+    }
+}
+
+/*
+  fold the interval stats into the totals, optionally logging them
+  first. Only the rate thread writes the non-FILTER interval stats
+  so only the fold itself needs the mutex
+ */
+void FastRateBuffer::update_timing_stats(bool write_log)
+{
+    WITH_SEMAPHORE(_mutex);
+
+#if HAL_LOGGING_ENABLED
+    if (write_log) {
+        const uint64_t now_us = AP_HAL::micros64();
+        for (uint8_t i=0; i<FastRateTiming::NUM_STAGES; i++) {
+            const FastRateTiming::Histogram &h = _interval[i];
+            const struct log_RTLT pkt {
+                LOG_PACKET_HEADER_INIT(LOG_RTLT_MSG),
+                time_us : now_us,
+                stage   : i,
+                count   : h.count,
+                mean_us : h.mean_us(),
+                p50_us  : uint16_t(MIN(h.percentile_us(50), UINT16_MAX)),
+                p95_us  : uint16_t(MIN(h.percentile_us(95), UINT16_MAX)),
+                p99_us  : uint16_t(MIN(h.percentile_us(99), UINT16_MAX)),
+                max_us  : uint16_t(MIN(h.max_us, UINT16_MAX)),
+                dropped : _interval_dropped,
+                behind  : _interval_behind,
+            };
+            AP::logger().WriteBlock(&pkt, sizeof(pkt));
+        }
+    }
+#endif
+
+    for (uint8_t i=0; i<FastRateTiming::NUM_STAGES; i++) {
+        _total[i].add(_interval[i]);
+        _interval[i].reset();
+    }
+    _total_dropped += _interval_dropped;
+    _total_behind += _interval_behind;
+    _interval_dropped = 0;
+    _interval_behind = 0;
+}
+
+void FastRateBuffer::timing_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(_mutex);
+
+    str.printf("dropped=%u behind=%u\n", unsigned(_total_dropped), unsigned(_total_behind));
+    str.printf("%-7s %8s %7s %6s", "stage", "count", "mean", "max");
+    for (uint8_t b=0; b<FastRateTiming::NUM_BUCKETS-1; b++) {
+        str.printf(" <%-5u", 2U<<b);
+    }
+    str.printf(" >=%-4u\n", 1U<<(FastRateTiming::NUM_BUCKETS-1));
+    for (uint8_t i=0; i<FastRateTiming::NUM_STAGES; i++) {
+        const FastRateTiming::Histogram &h = _total[i];
+        str.printf("%-7s %8u %7.1f %6u", FastRateTiming::stage_name(FastRateTiming::Stage(i)),
+                   unsigned(h.count), h.mean_us(), unsigned(h.max_us));
+        for (uint8_t b=0; b<FastRateTiming::NUM_BUCKETS; b++) {
+            str.printf(" %6u", unsigned(h.bucket[b]));
+        }
+        str.printf("\n");
+    }
+}
+
+void FastRateTiming::Histogram::update(uint32_t dt_us)
+{
+    uint8_t b = 0;
+    for (uint32_t v = dt_us >> 1; v != 0 && b < NUM_BUCKETS-1; v >>= 1) {
+        b++;
+    }
+    bucket[b]++;
+    count++;
+    sum_us += dt_us;
+    max_us = MAX(max_us, dt_us);
+}
+
+void FastRateTiming::Histogram::add(const Histogram &other)
+{
+    for (uint8_t b=0; b<NUM_BUCKETS; b++) {
+        bucket[b] += other.bucket[b];
+    }
+    count += other.count;
+    sum_us += other.sum_us;
+    max_us = MAX(max_us, other.max_us);
+}
+
+uint32_t FastRateTiming::Histogram::percentile_us(uint8_t pct) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    const uint32_t target = (uint64_t(count) * pct + 99) / 100;
+    uint32_t n = 0;
+    for (uint8_t b=0; b<NUM_BUCKETS-1; b++) {
+        n += bucket[b];
+        if (n >= target) {
+            return MIN(2U<<b, max_us);
+        }
+    }
+    return max_us;
+}
+
+const char *FastRateTiming::stage_name(Stage stage)
+{
+    switch (stage) {
+    case Stage::FILTER:
+        return "filter";
+    case Stage::WAIT:
+        return "wait";
+    case Stage::RATE:
+        return "rate";
+    case Stage::MOTORS:
+        return "motors";
+    case Stage::TOTAL:
+        return "total";
+    case Stage::NUM_STAGES:
+        break;
+    }
+    return "?";
+}
+#endif // AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+
 void AP_InertialSensor::update_backend_filters()
 {
     for (uint8_t i=0; i<_backend_count; i++) {
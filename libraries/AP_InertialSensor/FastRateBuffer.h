@@ -24,6 +24,39 @@
 #include <AP_HAL/utility/RingBuffer.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_HAL/Semaphores.h>
+#include <AP_Common/ExpandingString.h>
+
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+/*
+  latency histograms for the fast rate loop. Each stage is the time
+  spent between two points of the gyro->filter->rate->motors chain,
+  bucketed by powers of two of microseconds
+ */
+class FastRateTiming
+{
+public:
+    using Stage = AP_InertialSensor::FastRateStage;
+    static constexpr uint8_t NUM_STAGES = uint8_t(Stage::NUM_STAGES);
+    // bucket i holds samples in [2^i, 2^(i+1)) us, the last bucket holds everything above
+    static constexpr uint8_t NUM_BUCKETS = 12;
+
+    struct Histogram {
+        uint64_t sum_us;
+        uint32_t count;
+        uint32_t max_us;
+        uint32_t bucket[NUM_BUCKETS];
+
+        void update(uint32_t dt_us);
+        void add(const Histogram &other);
+        void reset() { memset(this, 0, sizeof(*this)); }
+        float mean_us() const { return count > 0 ? float(sum_us) / count : 0.0f; }
+        // upper bound of the bucket containing the given percentile
+        uint32_t percentile_us(uint8_t pct) const;
+    };
+
+    static const char *stage_name(Stage stage);
+};
+#endif
 
 class FastRateBuffer
 {
@@ -38,14 +71,48 @@ public:
     void reset();
 
 private:
+    struct GyroSample {
+        Vector3f gyro;
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+        uint32_t arrival_us;    // time the raw sample reached the filters
+        uint32_t push_us;       // time the filtered sample was pushed
+#endif
+    };
+
     /*
       binary semaphore for rate loop to use to start a rate loop when
       we hav finished filtering the primary IMU
      */
-    ObjectBuffer<Vector3f> _rate_loop_gyro_window{AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE};
+    ObjectBuffer<GyroSample> _rate_loop_gyro_window{AP_INERTIAL_SENSOR_RATE_LOOP_BUFFER_SIZE};
     uint8_t rate_decimation; // 0 means off
     uint8_t rate_decimation_count;
     HAL_BinarySemaphore _notifier;
     HAL_Semaphore _mutex;
+
+#if AP_INERTIALSENSOR_FAST_RATE_TIMING_ENABLED
+    void mark_stage_complete(FastRateTiming::Stage stage);
+    void update_timing_stats(bool write_log);
+    void timing_info(ExpandingString &str);
+
+    // timing of the sample currently being processed by the rate thread
+    struct {
+        uint32_t arrival_us;
+        uint32_t last_mark_us;
+    } _cycle;
+
+    // stats since the last call to update_timing_stats(), the
+    // FILTER stage is updated by the backend under _mutex, the
+    // others only by the rate thread
+    FastRateTiming::Histogram _interval[FastRateTiming::NUM_STAGES];
+    // stats since boot, protected by _mutex
+    FastRateTiming::Histogram _total[FastRateTiming::NUM_STAGES];
+
+    // samples dropped because the rate thread did not keep up
+    uint32_t _interval_dropped;
+    uint32_t _total_dropped;
+    // samples picked up with more samples still waiting
+    uint32_t _interval_behind;
+    uint32_t _total_behind;
+#endif
 };
 #endif
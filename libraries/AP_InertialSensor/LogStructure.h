@@ -8,7 +8,8 @@
     LOG_IMU_MSG, \
     LOG_ISBH_MSG, \
     LOG_ISBD_MSG, \
-    LOG_VIBE_MSG
+    LOG_VIBE_MSG, \
+    LOG_RTLT_MSG
 
 // @LoggerMessage: ACC
 // @Description: IMU accelerometer data
@@ -129,6 +130,32 @@ struct PACKED log_Vibe {
     uint32_t clipping;
 };
 
+// @LoggerMessage: RTLT
+// @Description: Fast rate loop latency, one message per timed stage, covering the time since the previous message
+// @Field: TimeUS: Time since system startup
+// @Field: Stg: timed stage, 0:filter (IMU sample arrival to filtered sample pushed), 1:wait (sample pushed to rate controller start), 2:rate controller, 3:motor output, 4:total (IMU sample arrival to motor output)
+// @Field: N: number of cycles timed
+// @Field: Avg: mean stage time
+// @Field: P50: 50th percentile stage time, rounded up to a power of two
+// @Field: P95: 95th percentile stage time, rounded up to a power of two
+// @Field: P99: 99th percentile stage time, rounded up to a power of two
+// @Field: Max: maximum stage time
+// @Field: Drop: gyro samples dropped because the rate loop did not keep up
+// @Field: Bhnd: rate loop cycles started with further samples still waiting
+struct PACKED log_RTLT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t stage;
+    uint32_t count;
+    float mean_us;
+    uint16_t p50_us;
+    uint16_t p95_us;
+    uint16_t p99_us;
+    uint16_t max_us;
+    uint32_t dropped;
+    uint32_t behind;
+};
+
 #define LOG_STRUCTURE_FROM_INERTIALSENSOR        \
     { LOG_ACC_MSG, sizeof(log_ACC), \
       "ACC", "QBQfff",        "TimeUS,I,SampleUS,AccX,AccY,AccZ", "s#sooo", "F-F000" , true }, \
@@ -141,4 +168,6 @@ struct PACKED log_Vibe {
     { LOG_ISBH_MSG, sizeof(log_ISBH), \
       "ISBH", "QHBBHHQf", "TimeUS,N,type,instance,mul,smp_cnt,SampleUS,smp_rate", "s-----sz", "F-----F-" },  \
     { LOG_ISBD_MSG, sizeof(log_ISBD), \
-      "ISBD", "QHHaaa", "TimeUS,N,seqno,x,y,z", "s--ooo", "F--???" },
+      "ISBD", "QHHaaa", "TimeUS,N,seqno,x,y,z", "s--ooo", "F--???" }, \
+    { LOG_RTLT_MSG, sizeof(log_RTLT), \
+      "RTLT", "QBIfHHHHII", "TimeUS,Stg,N,Avg,P50,P95,P99,Max,Drop,Bhnd", "s#-sssss--", "F--FFFFF--" , true },
@@ -623,6 +623,17 @@ bool AP_Logger::logging_failed() const
     return false;
 }
 
+void AP_Logger::io_info(ExpandingString &str)
+{
+    for (uint8_t i=0; i<_next_backend; i++) {
+        backends[i]->io_info(str);
+    }
+#if HAL_GCS_ENABLED
+    WITH_SEMAPHORE(_log_send_sem);
+    log_download_info(str);
+#endif
+}
+
 void AP_Logger::Write_MessageF(const char *fmt, ...)
 {
     char msg[65] {}; // sizeof(log_Message.msg) + null-termination
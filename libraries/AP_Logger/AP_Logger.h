@@ -372,6 +372,10 @@ public:
     bool logging_enabled() const;
     bool logging_failed() const;
 
+    // report IO statistics for each backend and log download
+    // throughput for each link
+    void io_info(class ExpandingString &str);
+
     // notify logging subsystem of an arming failure. This triggers
     // logging for HAL_LOGGER_ARM_PERSIST seconds
     void arming_failure() {
@@ -590,6 +594,30 @@ private:
     GCS_MAVLINK *_log_sending_link;
     HAL_Semaphore _log_send_sem;
 
+    // ranges of the log the GCS has asked for again while a download
+    // is in progress, sent ahead of the rest of the log
+    static constexpr uint8_t LOG_RESEND_RANGES = 8;
+    struct {
+        uint32_t offset;
+        uint32_t remaining;
+    } _log_resend[LOG_RESEND_RANGES];
+    uint8_t _log_resend_count;
+
+    // bytes the link can carry, accumulated from its baudrate between
+    // calls to handle_log_sending() on links without flow control
+    uint32_t _log_send_credit;
+    uint32_t _log_send_last_us;
+
+    // log download throughput for each link
+    struct {
+        uint16_t log_num;
+        uint32_t start_ms;
+        uint32_t last_ms;
+        uint32_t bytes;
+        uint32_t packets;
+        uint32_t resends;
+    } _log_download_stats[MAVLINK_COMM_NUM_BUFFERS];
+
     // last time arming failed, for backends
     uint32_t _last_arming_failure_ms;
 
@@ -607,6 +635,8 @@ private:
     void handle_log_send_listing(); // handle LISTING state
     void handle_log_sending(); // handle SENDING state
     bool handle_log_send_data(); // send data chunk to client
+    void queue_log_resend(uint32_t offset, uint32_t count);
+    void log_download_info(class ExpandingString &str);
 
     void get_log_info(uint16_t log_num, uint32_t &size, uint32_t &time_utc);
 
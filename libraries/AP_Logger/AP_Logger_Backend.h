@@ -12,6 +12,7 @@
 #include "LogStructure.h"
 
 class LoggerMessageWriter_DFLogStart;
+class ExpandingString;
 
 // class to handle rate limiting of log messages
 class AP_Logger_RateLimiter
@@ -187,6 +188,9 @@ public:
 
     virtual void io_timer(void) {}
 
+    // report IO thread statistics
+    virtual void io_info(ExpandingString &str) {}
+
 protected:
 
     AP_Logger &_front;
@@ -11,6 +11,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <stdio.h>
 #include <AP_RTC/AP_RTC.h>
+#include <AP_Common/ExpandingString.h>
 #include <GCS_MAVLink/GCS.h>
 
 const extern AP_HAL::HAL& hal;
@@ -19,6 +20,12 @@ const extern AP_HAL::HAL& hal;
 // this if (and only if!) the low level format changes
 #define DF_LOGGING_FORMAT    0x1901201B
 
+// time the IO thread may spend in one tick waiting on the chip when
+// the write buffer is more than half full
+#ifndef AP_LOGGER_BLOCK_IO_BUDGET_US
+#define AP_LOGGER_BLOCK_IO_BUDGET_US 1000
+#endif
+
 AP_Logger_Block::AP_Logger_Block(AP_Logger &front, LoggerMessageWriter_DFLogStart *writer) :
     AP_Logger_Backend(front, writer),
     writebuf(0)
@@ -111,10 +118,55 @@ void AP_Logger_Block::FinishWrite(void)
             chip_full = true;
             return;
         }
+        if (preerase_done && preerase_block == get_block(df_PageAdr)) {
+            // already erased while the IO thread was idle
+            preerase_done = false;
+            return;
+        }
+        preerase_done = false;
+        io_stats.inline_erases++;
         SectorErase(get_block(df_PageAdr));
     }
 }
 
+/*
+  erase the block after the write pointer while there is nothing to
+  write, so that crossing into it does not leave the write buffer
+  filling behind a block erase. The first block is left to be erased
+  on wrapping so that the start of the chip is never erased ahead of
+  time
+ */
+void AP_Logger_Block::preerase_next_block()
+{
+    if (!log_write_started || preerase_done) {
+        return;
+    }
+    const uint32_t next_block = get_block(df_PageAdr) + 1;
+    if (next_block * df_PagePerBlock >= df_NumPages) {
+        return;
+    }
+    // leave the chip full check to FinishWrite() if this log would
+    // reach its own first block
+    const uint32_t pages_left = next_block * df_PagePerBlock + 1 - df_PageAdr;
+    if (df_Write_FilePage + pages_left - 1 > df_NumPages - df_PagePerBlock) {
+        return;
+    }
+    if (Busy()) {
+        return;
+    }
+    // if we are about to erase part of an existing log, force the oldest to be recalculated
+    if (_cached_oldest_log > 0) {
+        uint16_t log_num = StartRead(first_page_of_block(next_block));
+        if (log_num != 0xFFFF && log_num >= _cached_oldest_log) {
+            _cached_oldest_log = 0;
+        }
+    }
+    SectorErase(next_block);
+    preerase_block = next_block;
+    preerase_done = true;
+    io_stats.preerases++;
+}
+
 bool AP_Logger_Block::WritesOK() const
 {
     if (!CardInserted() || erase_started) {
@@ -287,6 +339,9 @@ void AP_Logger_Block::EraseAll()
     log_write_started = false;
     writebuf.clear();
 
+    // the whole chip is about to be erased
+    preerase_done = false;
+
     // reset the format version and wrapped status so that any incomplete erase will be caught
     Sector4kErase(get_sector(df_NumPages));
 
@@ -504,7 +559,11 @@ uint16_t AP_Logger_Block::get_num_logs(void)
         // if we wrapped then the rest of the block will be filled with 0xFFFF because we always erase
         // a block before writing to it, in order to find the first page we therefore have to read after the
         // next block boundary
-        first = StartRead((get_block(lastpage) + 1) * df_PagePerBlock + 1);
+        first = StartRead(first_page_of_block(get_block(lastpage) + 1));
+        // the next block may also have been erased ahead of the write pointer
+        if (first == 0xFFFF) {
+            first = StartRead(first_page_of_block(get_block(lastpage) + 2));
+        }
         // unless we happen to land on the first page of the file that is being overwritten we skip to the next file
         if (df_FilePage > 1) {
             first++;
@@ -883,28 +942,73 @@ void AP_Logger_Block::io_timer(void)
         return;
     }
 
-    // we have been asked to stop logging, flush everything
-    if (stop_log_pending) {
-        WITH_SEMAPHORE(sem);
-
-        log_write_started = false;
-
-        // complete writing any previous log, a page at a time to avoid holding the lock for too long
-        if (writebuf.available()) {
-            write_log_page();
-        } else {
-            writebuf.clear();
-            stop_log_pending = false;
+    /*
+      never block on the chip while it programs a page or erases a
+      block, the data waits in writebuf until the next tick. Only when
+      falling behind do we wait on the chip within this tick so that
+      several pages can be written. The semaphore is released while
+      waiting so the front end can keep filling writebuf
+     */
+    const uint32_t start_us = AP_HAL::micros();
+    while (true) {
+        {
+            WITH_SEMAPHORE(sem);
+            // state may have changed while we waited
+            if (chip_full || erase_started || new_log_pending) {
+                break;
+            }
+            const uint32_t backlog = writebuf.available();
+            io_stats.max_backlog = MAX(io_stats.max_backlog, backlog);
+            if (!stop_log_pending && backlog < df_PageSize - sizeof(struct PageHeader)) {
+                // nothing to write, use the time to erase ahead
+                preerase_next_block();
+                break;
+            }
+            if (Busy()) {
+                if (backlog < writebuf.get_size() / 2 ||
+                    AP_HAL::micros() - start_us > AP_LOGGER_BLOCK_IO_BUDGET_US) {
+                    io_stats.busy_ticks++;
+                    break;
+                }
+            } else {
+                // we have been asked to stop logging, flush everything
+                if (stop_log_pending) {
+                    log_write_started = false;
+                    if (backlog == 0) {
+                        writebuf.clear();
+                        stop_log_pending = false;
+                        break;
+                    }
+                }
+                write_log_page();
+                continue;
+            }
         }
-
-    // write at most one page
-    } else if (writebuf.available() >= df_PageSize - sizeof(struct PageHeader)) {
-        WITH_SEMAPHORE(sem);
-
-        write_log_page();
+        hal.scheduler->delay_microseconds(50);
     }
 }
 
+void AP_Logger_Block::io_info(ExpandingString &str)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = MAX(now_ms - io_stats.last_info_ms, 1U);
+    const uint32_t pages = io_stats.pages_written - io_stats.last_info_pages;
+    io_stats.last_info_ms = now_ms;
+    io_stats.last_info_pages = io_stats.pages_written;
+
+    str.printf("Block: pages=%u rate=%ukB/s backlog=%u/%u max=%u\n",
+               unsigned(io_stats.pages_written),
+               unsigned((pages * df_PageSize) / dt_ms),
+               unsigned(writebuf.available()),
+               unsigned(writebuf.get_size()),
+               unsigned(io_stats.max_backlog));
+    str.printf("Block: busy=%u preerase=%u erase=%u dropped=%u\n",
+               unsigned(io_stats.busy_ticks),
+               unsigned(io_stats.preerases),
+               unsigned(io_stats.inline_erases),
+               unsigned(_dropped));
+}
+
 // write out a page of log data
 void AP_Logger_Block::write_log_page()
 {
@@ -922,6 +1026,7 @@ void AP_Logger_Block::write_log_page()
     }
     FinishWrite();
     df_Write_FilePage++;
+    io_stats.pages_written++;
 }
 
 void AP_Logger_Block::flash_test()
@@ -33,6 +33,7 @@ public:
     bool logging_failed() const override;
     bool logging_started(void) const override { return log_write_started; }
     void io_timer(void) override;
+    void io_info(ExpandingString &str) override;
 
 protected:
     /* Write a block of data at current offset */
@@ -75,6 +76,8 @@ private:
     virtual void Sector4kErase(uint32_t SectorAdr) = 0;
     virtual void StartErase() = 0;
     virtual bool InErase() = 0;
+    // true while the chip is programming or erasing
+    virtual bool Busy() = 0;
     void         flash_test(void);
 
     struct PACKED PageHeader {
@@ -121,6 +124,20 @@ private:
     volatile bool chip_full;
     // io thread health
     volatile uint32_t io_timer_heartbeat;
+    // block erased ahead of the write pointer while idle
+    bool preerase_done;
+    uint32_t preerase_block;
+
+    // IO thread statistics, reported by io_info()
+    struct {
+        uint32_t pages_written;
+        uint32_t busy_ticks;        // ticks with a page to write that found the chip busy
+        uint32_t preerases;         // blocks erased ahead of the write pointer
+        uint32_t inline_erases;     // blocks erased on reaching them
+        uint32_t max_backlog;       // bytes waiting in writebuf
+        uint32_t last_info_ms;
+        uint32_t last_info_pages;
+    } io_stats;
     uint8_t warning_decimation_counter;
 
     volatile enum class StatusMessage {
@@ -162,6 +179,11 @@ private:
     // callback on IO thread
     bool io_thread_alive() const;
     void write_log_page();
+    void preerase_next_block();
+    // first page of a block, wrapping at the end of the chip
+    uint32_t first_page_of_block(uint32_t block) const {
+        return (block % (df_NumPages / df_PagePerBlock)) * df_PagePerBlock + 1;
+    }
 };
 
 #endif  // HAL_LOGGING_BLOCK_ENABLED
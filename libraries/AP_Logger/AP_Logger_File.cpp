@@ -31,6 +31,7 @@
 
 #include <AP_Math/AP_Math.h>
 #include <GCS_MAVLink/GCS.h>
+#include <AP_Common/ExpandingString.h>
 #include <stdio.h>
 
 
@@ -602,9 +603,10 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
         return -1;
     }
 
+    WITH_SEMAPHORE(read_fd_semaphore);
+
     if (_read_fd != -1 && log_num != _read_fd_log_num) {
-        AP::FS().close(_read_fd);
-        _read_fd = -1;
+        close_read_fd();
     }
     if (_read_fd == -1) {
         char *fname = _log_file_name(log_num);
@@ -627,13 +629,22 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
         free(fname);
         _read_offset = 0;
         _read_fd_log_num = log_num;
+#if HAL_LOGGER_READ_AHEAD_SIZE > 0
+        // if allocation fails we read directly from the file
+        read_ahead_alloc();
+#endif
     }
     uint32_t ofs = page * (uint32_t)LOGGER_PAGE_SIZE + offset;
 
+#if HAL_LOGGER_READ_AHEAD_SIZE > 0
+    if (_read_ahead.buf[0].data != nullptr) {
+        return read_ahead_get(ofs, len, data);
+    }
+#endif
+
     if (ofs != _read_offset) {
         if (AP::FS().lseek(_read_fd, ofs, SEEK_SET) == (off_t)-1) {
-            AP::FS().close(_read_fd);
-            _read_fd = -1;
+            close_read_fd();
             return -1;
         }
         _read_offset = ofs;
@@ -646,11 +657,233 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
 }
 
 void AP_Logger_File::end_log_transfer()
+{
+    WITH_SEMAPHORE(read_fd_semaphore);
+    close_read_fd();
+}
+
+/*
+  close the file being downloaded. Caller holds read_fd_semaphore
+ */
+void AP_Logger_File::close_read_fd()
 {
     if (_read_fd != -1) {
         AP::FS().close(_read_fd);
         _read_fd = -1;
     }
+#if HAL_LOGGER_READ_AHEAD_SIZE > 0
+    read_ahead_free();
+#endif
+}
+
+#if HAL_LOGGER_READ_AHEAD_SIZE > 0
+/*
+  allocate the read-ahead buffers for a download
+ */
+bool AP_Logger_File::read_ahead_alloc()
+{
+    for (auto &b : _read_ahead.buf) {
+        if (b.data == nullptr) {
+            b.data = NEW_NOTHROW uint8_t[HAL_LOGGER_READ_AHEAD_SIZE];
+        }
+        b.offset = 0;
+        b.len = 0;
+    }
+    if (_read_ahead.spare == nullptr) {
+        _read_ahead.spare = NEW_NOTHROW uint8_t[HAL_LOGGER_READ_AHEAD_SIZE];
+    }
+    _read_ahead.cur = 0;
+    _read_ahead.fill_pending = false;
+    _read_ahead.request++;
+    if (_read_ahead.buf[0].data == nullptr || _read_ahead.buf[1].data == nullptr ||
+        _read_ahead.spare == nullptr) {
+        read_ahead_free();
+        return false;
+    }
+    return true;
+}
+
+void AP_Logger_File::read_ahead_free()
+{
+    _read_ahead.fill_pending = false;
+    _read_ahead.request++;
+    for (auto &b : _read_ahead.buf) {
+        delete[] b.data;
+        b.data = nullptr;
+        b.len = 0;
+    }
+    // if the io thread is filling it has the spare buffer and frees
+    // it when it finds the fill was cancelled
+    delete[] _read_ahead.spare;
+    _read_ahead.spare = nullptr;
+}
+
+/*
+  fill a read-ahead buffer from the file. Caller holds read_fd_semaphore
+ */
+bool AP_Logger_File::read_ahead_fill(ReadAheadBuffer &b, uint32_t offset)
+{
+    b.offset = offset;
+    b.len = 0;
+    if (offset != _read_offset) {
+        if (AP::FS().lseek(_read_fd, offset, SEEK_SET) == (off_t)-1) {
+            return false;
+        }
+        _read_offset = offset;
+    }
+    const int32_t ret = AP::FS().read(_read_fd, b.data, HAL_LOGGER_READ_AHEAD_SIZE);
+    if (ret < 0) {
+        return false;
+    }
+    b.len = ret;
+    _read_offset += ret;
+    return true;
+}
+
+/*
+  copy download data from the read-ahead buffers, reading from the
+  file when the data is not buffered, and ask the io thread to fill
+  the buffer after the one being read. Caller holds read_fd_semaphore
+ */
+int16_t AP_Logger_File::read_ahead_get(uint32_t offset, uint16_t len, uint8_t *data)
+{
+    uint16_t ret = 0;
+    while (ret < len) {
+        ReadAheadBuffer *b = nullptr;
+        for (auto &rb : _read_ahead.buf) {
+            if (rb.len > 0 && offset >= rb.offset && offset - rb.offset < rb.len) {
+                b = &rb;
+                break;
+            }
+        }
+        if (b == nullptr) {
+            // the GCS has moved or the io thread has not kept up
+            _read_ahead.misses++;
+            _read_ahead.fill_pending = false;
+            _read_ahead.request++;
+            b = &_read_ahead.buf[_read_ahead.cur];
+            if (!read_ahead_fill(*b, offset)) {
+                close_read_fd();
+                return ret > 0 ? ret : -1;
+            }
+            if (b->len == 0) {
+                // end of file
+                break;
+            }
+        }
+
+        const uint16_t n = MIN(uint32_t(len - ret), b->offset + b->len - offset);
+        memcpy(&data[ret], &b->data[offset - b->offset], n);
+        ret += n;
+        offset += n;
+
+        // queue a fill of the data following this buffer unless it
+        // ends at the end of the file
+        _read_ahead.cur = b - &_read_ahead.buf[0];
+        ReadAheadBuffer &next = _read_ahead.buf[1 - _read_ahead.cur];
+        const uint32_t next_offset = b->offset + b->len;
+        if (b->len == HAL_LOGGER_READ_AHEAD_SIZE && !_read_ahead.fill_pending &&
+            (next.len == 0 || next.offset != next_offset)) {
+            next.offset = next_offset;
+            next.len = 0;
+            _read_ahead.fill_pending = true;
+            _read_ahead.request++;
+        }
+    }
+    return ret;
+}
+
+/*
+  fill the read-ahead buffer the frontend will read next, called
+  from the io thread. The file is read without read_fd_semaphore held
+  so the frontend is not held up for the length of the read
+ */
+void AP_Logger_File::read_ahead_prefetch()
+{
+    uint32_t request = 0;
+    uint32_t offset = 0;
+    uint16_t log_num = 0;
+    uint8_t *data = nullptr;
+    {
+        WITH_SEMAPHORE(read_fd_semaphore);
+        if (_read_fd != -1) {
+            log_num = _read_fd_log_num;
+        }
+        if (_read_ahead.fill_pending && _read_fd != -1 && _read_ahead.spare != nullptr) {
+            request = _read_ahead.request;
+            offset = _read_ahead.buf[1 - _read_ahead.cur].offset;
+            data = _read_ahead.spare;
+            _read_ahead.spare = nullptr;
+        }
+    }
+    // close our file once the download has ended or moved to
+    // another log
+    if (_read_ahead.fd != -1 && _read_ahead.fd_log_num != log_num) {
+        AP::FS().close(_read_ahead.fd);
+        _read_ahead.fd = -1;
+    }
+    if (data == nullptr) {
+        return;
+    }
+
+    last_io_operation = "read_ahead";
+    int32_t len = -1;
+    if (_read_ahead.fd == -1) {
+        char *fname = _log_file_name(log_num);
+        if (fname != nullptr) {
+            _read_ahead.fd = AP::FS().open(fname, O_RDONLY);
+            _read_ahead.fd_log_num = log_num;
+            _read_ahead.fd_offset = 0;
+            free(fname);
+        }
+    }
+    if (_read_ahead.fd != -1) {
+        if (offset == _read_ahead.fd_offset ||
+            AP::FS().lseek(_read_ahead.fd, offset, SEEK_SET) != (off_t)-1) {
+            len = AP::FS().read(_read_ahead.fd, data, HAL_LOGGER_READ_AHEAD_SIZE);
+        }
+        if (len >= 0) {
+            _read_ahead.fd_offset = offset + len;
+        } else {
+            // position unknown, start again on the next fill
+            AP::FS().close(_read_ahead.fd);
+            _read_ahead.fd = -1;
+        }
+    }
+    last_io_operation = "";
+
+    WITH_SEMAPHORE(read_fd_semaphore);
+    if (len >= 0 && _read_ahead.request == request) {
+        // publish the data, the buffer it replaces becomes the spare
+        ReadAheadBuffer &b = _read_ahead.buf[1 - _read_ahead.cur];
+        _read_ahead.spare = b.data;
+        b.data = data;
+        b.len = len;
+        _read_ahead.fill_pending = false;
+        _read_ahead.prefetches++;
+        return;
+    }
+    if (len < 0 && _read_ahead.request == request) {
+        // leave the frontend to read it itself
+        _read_ahead.fill_pending = false;
+    }
+    if (_read_ahead.spare == nullptr && _read_ahead.buf[0].data != nullptr) {
+        _read_ahead.spare = data;
+    } else {
+        // the buffers were freed or reallocated while we read
+        delete[] data;
+    }
+}
+#endif // HAL_LOGGER_READ_AHEAD_SIZE > 0
+
+void AP_Logger_File::io_info(ExpandingString &str)
+{
+#if HAL_LOGGER_READ_AHEAD_SIZE > 0
+    str.printf("File: read-ahead=%u prefetches=%u misses=%u\n",
+               unsigned(HAL_LOGGER_READ_AHEAD_SIZE),
+               unsigned(_read_ahead.prefetches),
+               unsigned(_read_ahead.misses));
+#endif
 }
 
 /*
@@ -785,9 +1018,9 @@ void AP_Logger_File::start_new_log(void)
 
     start_new_log_reset_variables();
 
-    if (_read_fd != -1) {
-        AP::FS().close(_read_fd);
-        _read_fd = -1;
+    {
+        WITH_SEMAPHORE(read_fd_semaphore);
+        close_read_fd();
     }
 
     if (disk_space_avail() < _free_space_min_avail && disk_space() > 0) {
@@ -917,6 +1150,12 @@ void AP_Logger_File::io_timer(void)
         start_new_log_pending = false;
     }
 
+#if HAL_LOGGER_READ_AHEAD_SIZE > 0
+    if (_read_ahead.fill_pending || _read_ahead.fd != -1) {
+        read_ahead_prefetch();
+    }
+#endif
+
     if (erase.log_num != 0) {
         // continue erase
         erase_next();
@@ -23,6 +23,16 @@
 #endif
 #endif
 
+// size of each of the two buffers used to read ahead of a log
+// download, allocated only while downloading.  0 disables read-ahead
+#ifndef HAL_LOGGER_READ_AHEAD_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define HAL_LOGGER_READ_AHEAD_SIZE 8192
+#else
+#define HAL_LOGGER_READ_AHEAD_SIZE 2048
+#endif
+#endif
+
 class AP_Logger_File : public AP_Logger_Backend
 {
 public:
@@ -67,6 +77,7 @@ public:
 
     bool logging_started(void) const override { return _write_fd != -1; }
     void io_timer(void) override;
+    void io_info(ExpandingString &str) override;
 
 protected:
 
@@ -86,6 +97,40 @@ private:
     int _read_fd = -1;
     uint16_t _read_fd_log_num;
     uint32_t _read_offset;
+    // read_fd_semaphore mediates access to read_fd and the read-ahead
+    // buffers between the frontend and the io thread
+    HAL_Semaphore read_fd_semaphore;
+
+#if HAL_LOGGER_READ_AHEAD_SIZE > 0
+    // log downloads read from one buffer while the io thread fills
+    // the other with the data that follows it. The io thread reads
+    // into its own buffer from its own file descriptor without holding
+    // read_fd_semaphore, then swaps the buffer in with it held
+    struct ReadAheadBuffer {
+        uint8_t *data;
+        uint32_t offset;    // file offset of data[0]
+        uint16_t len;       // bytes of valid data
+    };
+    struct {
+        ReadAheadBuffer buf[2];
+        uint8_t *spare;     // buffer the io thread reads into
+        uint8_t cur;        // buffer last read by the frontend
+        bool fill_pending;  // io thread to fill the other buffer
+        uint32_t request;   // changed whenever a queued fill is replaced or cancelled
+        uint32_t prefetches;
+        uint32_t misses;
+        // owned by the io thread
+        int fd = -1;
+        uint16_t fd_log_num;
+        uint32_t fd_offset;
+    } _read_ahead;
+    bool read_ahead_alloc();
+    void read_ahead_free();
+    bool read_ahead_fill(ReadAheadBuffer &b, uint32_t offset);
+    int16_t read_ahead_get(uint32_t offset, uint16_t len, uint8_t *data);
+    void read_ahead_prefetch();
+#endif
+    void close_read_fd();
     uint32_t _write_offset;
     volatile uint32_t _open_error_ms;
     const char *_log_directory;
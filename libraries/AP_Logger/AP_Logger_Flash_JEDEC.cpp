@@ -287,6 +287,9 @@ void AP_Logger_Flash_JEDEC::BufferToPage(uint32_t pageNum)
 */
 void AP_Logger_Flash_JEDEC::SectorErase(uint32_t blockNum)
 {
+    // the erased block may hold the cached page
+    read_cache_valid = false;
+
     WriteEnable();
 
     WITH_SEMAPHORE(dev_sem);
@@ -300,6 +303,8 @@ void AP_Logger_Flash_JEDEC::SectorErase(uint32_t blockNum)
 */
 void AP_Logger_Flash_JEDEC::Sector4kErase(uint32_t sectorNum)
 {
+    read_cache_valid = false;
+
     WriteEnable();
 
     WITH_SEMAPHORE(dev_sem);
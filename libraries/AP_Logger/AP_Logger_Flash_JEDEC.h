@@ -27,9 +27,9 @@ private:
     void              Sector4kErase(uint32_t SectorAdr) override;
     void              StartErase() override;
     bool              InErase() override;
+    bool              Busy() override;
     void              send_command_addr(uint8_t cmd, uint32_t address);
     void              WaitReady();
-    bool              Busy();
     uint8_t           ReadStatusReg();
     void              Enter4ByteAddressMode(void);
 
@@ -25,6 +25,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Logger/AP_Logger.h>
 #include <GCS_MAVLink/GCS.h> // for LOG_ENTRY
+#include <AP_Common/ExpandingString.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -108,20 +109,25 @@ void AP_Logger::handle_log_request_data(GCS_MAVLINK &link, const mavlink_message
 {
     WITH_SEMAPHORE(_log_send_sem);
 
+    mavlink_log_request_data_t packet;
+    mavlink_msg_log_request_data_decode(&msg, &packet);
+
     if (_log_sending_link != nullptr) {
-        // some GCS (e.g. MAVProxy) attempt to stream request_data
-        // messages when they're filling gaps in the downloaded logs.
-        // This channel check avoids complaining to them, at the cost
-        // of silently dropping any repeated attempts to start logging
         if (_log_sending_link->get_chan() != link.get_chan()) {
             link.send_text(MAV_SEVERITY_INFO, "Log download in progress");
+            return;
+        }
+        // some GCS (e.g. MAVProxy) stream request_data messages while
+        // a download is in progress to fill gaps in what they have
+        // received.  Queue those ranges so the gaps are sent again
+        // ahead of the rest of the log
+        if (transfer_activity == TransferActivity::SENDING &&
+            packet.id == _log_num_data) {
+            queue_log_resend(packet.ofs, packet.count);
         }
         return;
     }
 
-    mavlink_log_request_data_t packet;
-    mavlink_msg_log_request_data_decode(&msg, &packet);
-
     // consider opening or switching logs:
     if (transfer_activity != TransferActivity::SENDING || _log_num_data != packet.id) {
 
@@ -150,6 +156,17 @@ void AP_Logger::handle_log_request_data(GCS_MAVLINK &link, const mavlink_message
     if (_log_data_remaining > packet.count) {
         _log_data_remaining = packet.count;
     }
+    _log_resend_count = 0;
+    _log_send_credit = 0;
+    _log_send_last_us = AP_HAL::micros();
+
+    const mavlink_channel_t chan = link.get_chan();
+    if (chan < ARRAY_SIZE(_log_download_stats)) {
+        auto &stats = _log_download_stats[chan];
+        memset(&stats, 0, sizeof(stats));
+        stats.log_num = _log_num_data;
+        stats.start_ms = stats.last_ms = AP_HAL::millis();
+    }
 
     transfer_activity = TransferActivity::SENDING;
     _log_sending_link = &link;
@@ -157,6 +174,44 @@ void AP_Logger::handle_log_request_data(GCS_MAVLINK &link, const mavlink_message
     handle_log_send();
 }
 
+/*
+  queue a range of the log being downloaded to be sent again
+ */
+void AP_Logger::queue_log_resend(uint32_t offset, uint32_t count)
+{
+    if (offset >= _log_data_size || count == 0) {
+        return;
+    }
+    const uint32_t remaining = MIN(count, _log_data_size - offset);
+
+    // ranges still ahead of the download will be sent anyway
+    if (offset >= _log_data_offset &&
+        offset - _log_data_offset + remaining <= _log_data_remaining) {
+        return;
+    }
+
+    // GCSs repeat requests for gaps that have not yet been filled
+    for (uint8_t i=0; i<_log_resend_count; i++) {
+        const auto &r = _log_resend[i];
+        if (offset >= r.offset && offset - r.offset + remaining <= r.remaining) {
+            return;
+        }
+    }
+
+    if (_log_resend_count >= ARRAY_SIZE(_log_resend)) {
+        // the GCS will ask again once the queued ranges are sent
+        return;
+    }
+    _log_resend[_log_resend_count].offset = offset;
+    _log_resend[_log_resend_count].remaining = remaining;
+    _log_resend_count++;
+
+    const mavlink_channel_t chan = _log_sending_link->get_chan();
+    if (chan < ARRAY_SIZE(_log_download_stats)) {
+        _log_download_stats[chan].resends++;
+    }
+}
+
 /**
    handle request to erase log data
  */
@@ -183,6 +238,7 @@ void AP_Logger::end_log_transfer()
 {
     transfer_activity = TransferActivity::IDLE;
     _log_sending_link = nullptr;
+    _log_resend_count = 0;
     backends[0]->end_log_transfer();
 }
 
@@ -225,6 +281,10 @@ void AP_Logger::handle_log_sending()
     // an expected delay:
     EXPECT_DELAY_MS(5000);
 
+    const uint32_t now_us = AP_HAL::micros();
+    const uint32_t dt_us = now_us - _log_send_last_us;
+    _log_send_last_us = now_us;
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     // assume USB speeds in SITL for the purposes of log download
     const uint8_t num_sends = 40;
@@ -239,6 +299,18 @@ void AP_Logger::handle_log_sending()
     #else
         num_sends = 10;
     #endif
+    } else {
+        // without flow control send a burst of what the link can
+        // carry at its baudrate since we were last called, so fast
+        // links are not limited to one packet per call.  The uart
+        // buffer space still limits each burst
+        const uint32_t baudrate = _log_sending_link->get_uart()->get_baud_rate();
+        const uint32_t packet_size = PAYLOAD_SIZE(_log_sending_link->get_chan(), LOG_DATA);
+        const uint32_t max_credit = 10 * packet_size;
+        _log_send_credit += uint32_t(uint64_t(baudrate) * MIN(dt_us, 100000U) / 10000000U);
+        _log_send_credit = MIN(_log_send_credit, max_credit);
+        num_sends = MAX(_log_send_credit / packet_size, 1U);
+        _log_send_credit -= MIN(_log_send_credit, num_sends * packet_size);
     }
 #endif
 
@@ -306,15 +378,20 @@ bool AP_Logger::handle_log_send_data()
         return false;
     }
 
+    // ranges the GCS has asked for again are sent first
+    const bool resending = _log_resend_count > 0;
+    uint32_t &offset = resending ? _log_resend[0].offset : _log_data_offset;
+    uint32_t &remaining = resending ? _log_resend[0].remaining : _log_data_remaining;
+
     int16_t nbytes = 0;
-    uint32_t len = _log_data_remaining;
+    uint32_t len = remaining;
 	mavlink_log_data_t packet;
 
     if (len > MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) {
         len = MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
     }
 
-    nbytes = get_log_data(_log_num_data, _log_data_page, _log_data_offset, len, packet.data);
+    nbytes = get_log_data(_log_num_data, _log_data_page, offset, len, packet.data);
 
     if (nbytes < 0) {
         // report as EOF on error
@@ -324,7 +401,7 @@ bool AP_Logger::handle_log_send_data()
         memset(&packet.data[nbytes], 0, MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN-nbytes);
     }
 
-    packet.ofs = _log_data_offset;
+    packet.ofs = offset;
     packet.id = _log_num_data;
     packet.count = nbytes;
     _mav_finalize_message_chan_send(_log_sending_link->get_chan(),
@@ -334,12 +411,50 @@ bool AP_Logger::handle_log_send_data()
                                     MAVLINK_MSG_ID_LOG_DATA_LEN,
                                     MAVLINK_MSG_ID_LOG_DATA_CRC);
 
-    _log_data_offset += nbytes;
-    _log_data_remaining -= nbytes;
-    if (nbytes < MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN || _log_data_remaining == 0) {
+    const mavlink_channel_t chan = _log_sending_link->get_chan();
+    if (chan < ARRAY_SIZE(_log_download_stats)) {
+        auto &stats = _log_download_stats[chan];
+        stats.bytes += nbytes;
+        stats.packets++;
+        stats.last_ms = AP_HAL::millis();
+    }
+
+    offset += nbytes;
+    remaining -= nbytes;
+    if (nbytes < MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) {
+        // end of the log
+        remaining = 0;
+    }
+    if (resending && remaining == 0) {
+        _log_resend_count--;
+        memmove(&_log_resend[0], &_log_resend[1], _log_resend_count*sizeof(_log_resend[0]));
+    }
+    if (_log_data_remaining == 0 && _log_resend_count == 0) {
         end_log_transfer();
     }
     return true;
 }
 
+/*
+  report log download throughput for each link
+ */
+void AP_Logger::log_download_info(ExpandingString &str)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(_log_download_stats); i++) {
+        const auto &stats = _log_download_stats[i];
+        if (stats.packets == 0) {
+            continue;
+        }
+        const uint32_t dt_ms = MAX(stats.last_ms - stats.start_ms, 1U);
+        str.printf("Download: chan=%u log=%u bytes=%u packets=%u resends=%u rate=%ukB/s%s\n",
+                   unsigned(i),
+                   unsigned(stats.log_num),
+                   unsigned(stats.bytes),
+                   unsigned(stats.packets),
+                   unsigned(stats.resends),
+                   unsigned(stats.bytes / dt_ms),
+                   (_log_sending_link != nullptr && _log_sending_link->get_chan() == i) ? " active" : "");
+    }
+}
+
 #endif  // HAL_LOGGING_ENABLED && HAL_GCS_ENABLED
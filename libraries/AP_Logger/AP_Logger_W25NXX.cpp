@@ -304,6 +304,9 @@ void AP_Logger_W25NXX::BufferToPage(uint32_t pageNum)
 */
 void AP_Logger_W25NXX::SectorErase(uint32_t blockNum)
 {
+    // the erased block may hold the cached page
+    read_cache_valid = false;
+
     WriteEnable();
     WITH_SEMAPHORE(dev_sem);
 
@@ -0,0 +1,464 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  benchmarks for the geometry used by fences, object avoidance and
+  the attitude code. Each is run for float and double, and the
+  polygon tests also for the int32_t lat/lng used by fences.
+
+  The batched functions are run alongside a loop over the single
+  versions they replace, with the argument being the number of
+  polygon points or vectors:
+
+  BM_PolygonOutside and BM_PolygonOutsideMany test points against
+  one and eight star shaped polygons. BM_PolygonIntersects,
+  BM_SegmentIntersectionLoop and BM_SegmentIntersectionClosest find
+  the first crossing of a line with a polygon's edges.
+  BM_MatrixMulLoop and BM_MatrixMulArray rotate arrays of vectors.
+
+  The Location benchmarks use ftype, so they time double maths in
+  builds with HAL_WITH_EKF_DOUBLE.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Common/Location.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// test points, cycled through by the point in polygon benchmarks
+static const uint8_t num_test_points = 64;
+
+// polygons have up to this many points
+static const uint16_t max_points = 1024;
+
+// a star with n points alternating between radius 100 and 60,
+// multiplied by scale
+template <typename T>
+static void make_star(Vector2<T> *V, unsigned n, float scale, float ofs=0)
+{
+    for (unsigned i=0; i<n; i++) {
+        const float r = ((i & 1) ? 60 : 100) * scale;
+        const float angle = i * M_2PI / n;
+        V[i] = Vector2<T>(ofs * scale + r * cosf(angle), r * sinf(angle));
+    }
+}
+
+template <typename T>
+static void make_test_points(Vector2<T> *P, float scale)
+{
+    for (uint8_t i=0; i<num_test_points; i++) {
+        P[i] = Vector2<T>(((get_random16() % 240) - 120) * scale,
+                          ((get_random16() % 240) - 120) * scale);
+    }
+}
+
+// lat/lng polygons in 1e-7 degrees are around 1000 times larger than
+// metres
+template <typename T>
+static float polygon_scale()
+{
+    return std::is_floating_point<T>::value ? 1 : 1000;
+}
+
+template <typename T>
+static void BM_PolygonOutside(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    Vector2<T> *V = NEW_NOTHROW Vector2<T>[n];
+    Vector2<T> P[num_test_points];
+    make_star(V, n, polygon_scale<T>());
+    make_test_points(P, polygon_scale<T>());
+
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        bool outside = Polygon_outside(P[i], V, n);
+        gbenchmark_escape(&outside);
+        i = (i + 1) % num_test_points;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    delete[] V;
+}
+
+template <typename T>
+static void BM_PolygonOutsideMany(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    const uint8_t num_polygons = 8;
+    Vector2<T> *points = NEW_NOTHROW Vector2<T>[n * num_polygons];
+    const Vector2<T> *V[num_polygons];
+    unsigned counts[num_polygons];
+    for (uint8_t p=0; p<num_polygons; p++) {
+        make_star(&points[p*n], n, polygon_scale<T>(), (p - num_polygons/2) * 20);
+        V[p] = &points[p*n];
+        counts[p] = n;
+    }
+    Vector2<T> P[num_test_points];
+    make_test_points(P, polygon_scale<T>());
+
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        bool outside[num_polygons];
+        unsigned count = Polygon_outside_many(P[i], V, counts, num_polygons, outside);
+        gbenchmark_escape(&count);
+        gbenchmark_escape(outside);
+        i = (i + 1) % num_test_points;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n * num_polygons);
+    delete[] points;
+}
+
+// lines from the test points to the origin, which cross a polygon
+// edge unless the point is inside the star
+static void BM_PolygonIntersects(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    Vector2f *V = NEW_NOTHROW Vector2f[n];
+    Vector2f P[num_test_points];
+    make_star(V, n, 1);
+    make_test_points(P, 1);
+
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        Vector2f intersection;
+        bool crossed = Polygon_intersects(V, n, P[i], Vector2f(), intersection);
+        gbenchmark_escape(&crossed);
+        gbenchmark_escape(&intersection);
+        i = (i + 1) % num_test_points;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    delete[] V;
+}
+
+template <typename T>
+static void BM_SegmentIntersectionLoop(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    Vector2<T> *V = NEW_NOTHROW Vector2<T>[n+1];
+    Vector2<T> P[num_test_points];
+    make_star(V, n, 1);
+    V[n] = V[0];
+    make_test_points(P, 1);
+
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        T best_dist_sq = -1;
+        Vector2<T> best;
+        for (unsigned j=0; j<n; j++) {
+            Vector2<T> intersection;
+            if (Vector2<T>::segment_intersection(P[i], Vector2<T>(), V[j], V[j+1], intersection)) {
+                const T dist_sq = (intersection - P[i]).length_squared();
+                if (best_dist_sq < 0 || dist_sq < best_dist_sq) {
+                    best_dist_sq = dist_sq;
+                    best = intersection;
+                }
+            }
+        }
+        gbenchmark_escape(&best);
+        i = (i + 1) % num_test_points;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    delete[] V;
+}
+
+template <typename T>
+static void BM_SegmentIntersectionClosest(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    Vector2<T> *V = NEW_NOTHROW Vector2<T>[n+1];
+    Vector2<T> P[num_test_points];
+    make_star(V, n, 1);
+    V[n] = V[0];
+    make_test_points(P, 1);
+
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        Vector2<T> intersection;
+        int32_t idx = Vector2<T>::segment_intersection_closest(P[i], Vector2<T>(), V, V+1, n, intersection);
+        gbenchmark_escape(&idx);
+        gbenchmark_escape(&intersection);
+        i = (i + 1) % num_test_points;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    delete[] V;
+}
+
+static void BM_PolygonClosestDistancePoint(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    Vector2f *V = NEW_NOTHROW Vector2f[n];
+    Vector2f P[num_test_points];
+    make_star(V, n, 1);
+    make_test_points(P, 1);
+
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        Vector2f closest;
+        bool ok = Polygon_closest_distance_point(V, n, P[i], closest);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&closest);
+        i = (i + 1) % num_test_points;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    delete[] V;
+}
+
+template <typename T>
+static Matrix3<T> test_rotation()
+{
+    Matrix3<T> m;
+    m.from_euler(radians(10), radians(-20), radians(135));
+    return m;
+}
+
+template <typename T>
+static void make_vectors(Vector3<T> *v, unsigned n)
+{
+    for (unsigned i=0; i<n; i++) {
+        v[i] = Vector3<T>(rand_float(), rand_float(), rand_float());
+    }
+}
+
+template <typename T>
+static void BM_MatrixMulLoop(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    const Matrix3<T> m = test_rotation<T>();
+    Vector3<T> *v = NEW_NOTHROW Vector3<T>[n];
+    Vector3<T> *out = NEW_NOTHROW Vector3<T>[n];
+    make_vectors(v, n);
+
+    while (state.KeepRunning()) {
+        for (unsigned i=0; i<n; i++) {
+            out[i] = m * v[i];
+        }
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    delete[] v;
+    delete[] out;
+}
+
+template <typename T>
+static void BM_MatrixMulArray(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    const Matrix3<T> m = test_rotation<T>();
+    Vector3<T> *v = NEW_NOTHROW Vector3<T>[n];
+    Vector3<T> *out = NEW_NOTHROW Vector3<T>[n];
+    make_vectors(v, n);
+
+    while (state.KeepRunning()) {
+        m.mul_array(v, out, n);
+        gbenchmark_escape(out);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    delete[] v;
+    delete[] out;
+}
+
+template <typename T>
+static void BM_MatrixMulTransposeArray(benchmark::State& state)
+{
+    const unsigned n = state.range(0);
+    const Matrix3<T> m = test_rotation<T>();
+    Vector3<T> *v = NEW_NOTHROW Vector3<T>[n];
+    make_vectors(v, n);
+
+    while (state.KeepRunning()) {
+        m.mul_transpose_array(v, v, n);
+        gbenchmark_escape(v);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    delete[] v;
+}
+
+template <typename T>
+static void BM_MatrixFromEuler(benchmark::State& state)
+{
+    T angle = 0;
+    while (state.KeepRunning()) {
+        Matrix3<T> m;
+        m.from_euler(angle, -angle, 2*angle);
+        gbenchmark_escape(&m);
+        angle += 0.01;
+    }
+}
+
+template <typename T>
+static void BM_MatrixToEuler(benchmark::State& state)
+{
+    const Matrix3<T> m = test_rotation<T>();
+    while (state.KeepRunning()) {
+        T roll, pitch, yaw;
+        m.to_euler(&roll, &pitch, &yaw);
+        gbenchmark_escape(&roll);
+        gbenchmark_escape(&pitch);
+        gbenchmark_escape(&yaw);
+    }
+}
+
+// rotations cycle through the board orientations, excluding the
+// custom rotations which need the parameters
+template <typename T>
+static void BM_Vector3Rotate(benchmark::State& state)
+{
+    Vector3<T> v(1, 2, 3);
+    uint8_t r = 0;
+    while (state.KeepRunning()) {
+        v.rotate(Rotation(r));
+        gbenchmark_escape(&v);
+        r = (r + 1) % ROTATION_MAX;
+    }
+}
+
+template <typename T>
+static void BM_Vector3Normalize(benchmark::State& state)
+{
+    Vector3<T> v(1, 2, 3);
+    while (state.KeepRunning()) {
+        Vector3<T> n = v.normalized();
+        gbenchmark_escape(&n);
+        v.x += 1;
+    }
+}
+
+template <typename T>
+static void BM_Vector3Cross(benchmark::State& state)
+{
+    const Vector3<T> v1(1, 2, 3);
+    Vector3<T> v2(-3, 0.5, 2);
+    while (state.KeepRunning()) {
+        Vector3<T> c = v1 % v2;
+        gbenchmark_escape(&c);
+        v2.x += 1;
+    }
+}
+
+template <typename T>
+static void BM_QuaternionEarthToBody(benchmark::State& state)
+{
+    QuaternionT<T> q;
+    q.from_euler(radians(10), radians(-20), radians(135));
+    Vector3<T> v(1, 2, 3);
+    while (state.KeepRunning()) {
+        q.earth_to_body(v);
+        gbenchmark_escape(&v);
+    }
+}
+
+static const Location test_location(-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE);
+
+static Location test_offset_location(uint16_t i)
+{
+    Location loc = test_location;
+    loc.offset((i % 100) * 25.0, ((i / 100) % 100) * -25.0);
+    return loc;
+}
+
+static void BM_LocationDistance(benchmark::State& state)
+{
+    Location locs[num_test_points];
+    for (uint8_t i=0; i<num_test_points; i++) {
+        locs[i] = test_offset_location(get_random16());
+    }
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        ftype dist = test_location.get_distance(locs[i]);
+        gbenchmark_escape(&dist);
+        i = (i + 1) % num_test_points;
+    }
+}
+
+static void BM_LocationDistanceNE(benchmark::State& state)
+{
+    Location locs[num_test_points];
+    for (uint8_t i=0; i<num_test_points; i++) {
+        locs[i] = test_offset_location(get_random16());
+    }
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        Vector2f ne = test_location.get_distance_NE(locs[i]);
+        gbenchmark_escape(&ne);
+        i = (i + 1) % num_test_points;
+    }
+}
+
+static void BM_LocationBearing(benchmark::State& state)
+{
+    Location locs[num_test_points];
+    for (uint8_t i=0; i<num_test_points; i++) {
+        locs[i] = test_offset_location(get_random16());
+    }
+    uint8_t i = 0;
+    while (state.KeepRunning()) {
+        ftype bearing = test_location.get_bearing(locs[i]);
+        gbenchmark_escape(&bearing);
+        i = (i + 1) % num_test_points;
+    }
+}
+
+static void BM_LocationOffset(benchmark::State& state)
+{
+    Location loc = test_location;
+    ftype ofs = 1;
+    while (state.KeepRunning()) {
+        loc.offset(ofs, -ofs);
+        gbenchmark_escape(&loc);
+        ofs = -ofs;
+    }
+}
+
+// the polygon sizes seen in fences and object avoidance
+#define POLYGON_RANGE RangeMultiplier(4)->Range(4, max_points)
+// the number of vectors rotated together, such as sensor samples
+#define VECTOR_RANGE RangeMultiplier(8)->Range(8, 4096)
+
+BENCHMARK_TEMPLATE(BM_PolygonOutside, int32_t)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_PolygonOutside, float)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_PolygonOutside, double)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_PolygonOutsideMany, int32_t)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_PolygonOutsideMany, float)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_PolygonOutsideMany, double)->POLYGON_RANGE;
+BENCHMARK(BM_PolygonIntersects)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_SegmentIntersectionLoop, float)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_SegmentIntersectionLoop, double)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_SegmentIntersectionClosest, float)->POLYGON_RANGE;
+BENCHMARK_TEMPLATE(BM_SegmentIntersectionClosest, double)->POLYGON_RANGE;
+BENCHMARK(BM_PolygonClosestDistancePoint)->POLYGON_RANGE;
+
+BENCHMARK_TEMPLATE(BM_MatrixMulLoop, float)->VECTOR_RANGE;
+BENCHMARK_TEMPLATE(BM_MatrixMulLoop, double)->VECTOR_RANGE;
+BENCHMARK_TEMPLATE(BM_MatrixMulArray, float)->VECTOR_RANGE;
+BENCHMARK_TEMPLATE(BM_MatrixMulArray, double)->VECTOR_RANGE;
+BENCHMARK_TEMPLATE(BM_MatrixMulTransposeArray, float)->VECTOR_RANGE;
+BENCHMARK_TEMPLATE(BM_MatrixMulTransposeArray, double)->VECTOR_RANGE;
+BENCHMARK_TEMPLATE(BM_MatrixFromEuler, float);
+BENCHMARK_TEMPLATE(BM_MatrixFromEuler, double);
+BENCHMARK_TEMPLATE(BM_MatrixToEuler, float);
+BENCHMARK_TEMPLATE(BM_MatrixToEuler, double);
+
+BENCHMARK_TEMPLATE(BM_Vector3Rotate, float);
+BENCHMARK_TEMPLATE(BM_Vector3Rotate, double);
+BENCHMARK_TEMPLATE(BM_Vector3Normalize, float);
+BENCHMARK_TEMPLATE(BM_Vector3Normalize, double);
+BENCHMARK_TEMPLATE(BM_Vector3Cross, float);
+BENCHMARK_TEMPLATE(BM_Vector3Cross, double);
+BENCHMARK_TEMPLATE(BM_QuaternionEarthToBody, float);
+BENCHMARK_TEMPLATE(BM_QuaternionEarthToBody, double);
+
+BENCHMARK(BM_LocationDistance);
+BENCHMARK(BM_LocationDistanceNE);
+BENCHMARK(BM_LocationBearing);
+BENCHMARK(BM_LocationOffset);
+
+BENCHMARK_MAIN();
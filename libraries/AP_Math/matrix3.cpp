@@ -162,6 +162,41 @@ Vector3<T> Matrix3<T>::mul_transpose(const Vector3<T> &v) const
                       a.z * v.x + b.z * v.y + c.z * v.z);
 }
 
+#pragma GCC push_options
+#pragma GCC optimize("tree-vectorize","vect-cost-model=dynamic")
+// multiplication by n vectors. The matrix is held in locals so the
+// compiler knows writes to out can't change it, letting it vectorise
+// the loop
+template <typename T>
+void Matrix3<T>::mul_array(const Vector3<T> *v, Vector3<T> *out, uint32_t n) const
+{
+    const T ax = a.x, ay = a.y, az = a.z;
+    const T bx = b.x, by = b.y, bz = b.z;
+    const T cx = c.x, cy = c.y, cz = c.z;
+    for (uint32_t i=0; i<n; i++) {
+        const T x = v[i].x, y = v[i].y, z = v[i].z;
+        out[i].x = ax * x + ay * y + az * z;
+        out[i].y = bx * x + by * y + bz * z;
+        out[i].z = cx * x + cy * y + cz * z;
+    }
+}
+
+// multiplication of transpose by n vectors
+template <typename T>
+void Matrix3<T>::mul_transpose_array(const Vector3<T> *v, Vector3<T> *out, uint32_t n) const
+{
+    const T ax = a.x, ay = a.y, az = a.z;
+    const T bx = b.x, by = b.y, bz = b.z;
+    const T cx = c.x, cy = c.y, cz = c.z;
+    for (uint32_t i=0; i<n; i++) {
+        const T x = v[i].x, y = v[i].y, z = v[i].z;
+        out[i].x = ax * x + bx * y + cx * z;
+        out[i].y = ay * x + by * y + cy * z;
+        out[i].z = az * x + bz * y + cz * z;
+    }
+}
+#pragma GCC pop_options
+
 // multiplication by another Matrix3<T>
 template <typename T>
 Matrix3<T> Matrix3<T>::operator *(const Matrix3<T> &m) const
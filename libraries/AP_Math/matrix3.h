@@ -156,6 +156,12 @@ public:
     // multiplication of transpose by a vector
     Vector3<T>                  mul_transpose(const Vector3<T> &v) const;
 
+    // multiplication of n vectors, out may be the same array as v
+    void mul_array(const Vector3<T> *v, Vector3<T> *out, uint32_t n) const;
+
+    // multiplication of transpose by n vectors, out may be the same array as v
+    void mul_transpose_array(const Vector3<T> *v, Vector3<T> *out, uint32_t n) const;
+
     // multiplication by a vector giving a Vector2 result (XY components)
     Vector2<T> mulXY(const Vector3<T> &v) const;
 
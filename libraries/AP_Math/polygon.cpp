@@ -27,6 +27,92 @@
  */
 
 
+#pragma GCC push_options
+#pragma GCC optimize("tree-vectorize","vect-cost-model=dynamic")
+/*
+  return true if the edge from v1 to v2 crosses the ray from P in the
+  +x direction. This gives the same answer as the sign checks in
+  Polygon_outside() below, which are only there to avoid 64 bit
+  multiplies with int32_t coordinates
+ */
+template <typename T>
+static inline bool edge_crosses(const Vector2<T> &P, const Vector2<T> &v1, const Vector2<T> &v2)
+{
+    const T dx1 = P.x - v1.x;
+    const T dx2 = v2.x - v1.x;
+    const T dy1 = P.y - v1.y;
+    const T dy2 = v2.y - v1.y;
+    const T a = dx1 * dy2;
+    const T b = dx2 * dy1;
+    const bool straddles = (v1.y > P.y) != (v2.y > P.y);
+    const bool down = dy2 < 0;
+    return straddles & ((down & (a > b)) | (!down & (a < b)));
+}
+
+/*
+  point in polygon test for float polygons with n points, not
+  including a closing point. There are no branches in the loop over
+  the edges so the compiler can vectorise it on targets with SIMD
+  floating point, and long fences don't suffer branch mispredictions.
+  Doubles are left to the loop below, as two at a time is slower than
+  skipping the edges that don't straddle the point
+ */
+template <typename T>
+static bool polygon_outside_float(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
+{
+    if (n == 0) {
+        return true;
+    }
+    uint32_t crossings = edge_crosses(P, V[n-1], V[0]);
+    for (unsigned i=0; i<n-1; i++) {
+        crossings += edge_crosses(P, V[i], V[i+1]);
+    }
+    return (crossings & 1U) == 0;
+}
+#pragma GCC pop_options
+
+/*
+  the edge test for Polygon_outside() on int32_t and double polygons
+ */
+template <typename T>
+static inline bool edge_crosses_signs(const Vector2<T> &P, const Vector2<T> &v1, const Vector2<T> &v2)
+{
+    if ((v1.y > P.y) == (v2.y > P.y)) {
+        return false;
+    }
+    const T dx1 = P.x - v1.x;
+    const T dx2 = v2.x - v1.x;
+    const T dy1 = P.y - v1.y;
+    const T dy2 = v2.y - v1.y;
+    const int8_t dx1s = (dx1 < 0) ? -1 : 1;
+    const int8_t dx2s = (dx2 < 0) ? -1 : 1;
+    const int8_t dy1s = (dy1 < 0) ? -1 : 1;
+    const int8_t dy2s = (dy2 < 0) ? -1 : 1;
+    const int8_t m1 = dx1s * dy2s;
+    const int8_t m2 = dx2s * dy1s;
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 > m2) {
+            return true;
+        } else if (m1 < m2) {
+            return false;
+        }
+        if (std::is_floating_point<T>::value) {
+            return dx1 * dy2 > dx2 * dy1;
+        }
+        return dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1;
+    }
+    if (m1 < m2) {
+        return true;
+    } else if (m1 > m2) {
+        return false;
+    }
+    if (std::is_floating_point<T>::value) {
+        return dx1 * dy2 < dx2 * dy1;
+    }
+    return dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1;
+}
+
 /*
  *  Polygon_outside(): test for a point in a polygon
  *     Input:   P = a point,
@@ -47,6 +133,10 @@ bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
         n--;
     }
 
+    if (std::is_same<T, float>::value) {
+        return polygon_outside_float(P, V, n);
+    }
+
     unsigned i, j;
     // step through each edge pair-wise looking for crossings:
     bool outside = true;
@@ -55,57 +145,27 @@ bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
         if (j >= n) {
             j = 0;
         }
-        if ((V[i].y > P.y) == (V[j].y > P.y)) {
-            continue;
-        }
-        const T dx1 = P.x - V[i].x;
-        const T dx2 = V[j].x - V[i].x;
-        const T dy1 = P.y - V[i].y;
-        const T dy2 = V[j].y - V[i].y;
-        const int8_t dx1s = (dx1 < 0) ? -1 : 1;
-        const int8_t dx2s = (dx2 < 0) ? -1 : 1;
-        const int8_t dy1s = (dy1 < 0) ? -1 : 1;
-        const int8_t dy2s = (dy2 < 0) ? -1 : 1;
-        const int8_t m1 = dx1s * dy2s;
-        const int8_t m2 = dx2s * dy1s;
-        // we avoid the 64 bit multiplies if we can based on sign checks.
-        if (dy2 < 0) {
-            if (m1 > m2) {
-                outside = !outside;
-            } else if (m1 < m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 > dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
-        } else {
-            if (m1 < m2) {
-                outside = !outside;
-            } else if (m1 > m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 < dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
+        if (edge_crosses_signs(P, V[i], V[j])) {
+            outside = !outside;
         }
     }
     return outside;
 }
 
+/*
+  return true if the edge from v1 to v2 crosses the ray from P used
+  by Polygon_outside(), so P is outside if an even number of edges
+  cross it. Only edges that straddle P.y can cross
+ */
+template <typename T>
+bool Polygon_edge_crosses(const Vector2<T> &P, const Vector2<T> &v1, const Vector2<T> &v2)
+{
+    if (std::is_same<T, float>::value) {
+        return edge_crosses(P, v1, v2);
+    }
+    return edge_crosses_signs(P, v1, v2);
+}
+
 /*
  *  check if a polygon is complete.
  *
@@ -124,6 +184,31 @@ template bool Polygon_outside<int32_t>(const Vector2l &P, const Vector2l *V, uns
 template bool Polygon_complete<int32_t>(const Vector2l *V, unsigned n);
 template bool Polygon_outside<float>(const Vector2f &P, const Vector2f *V, unsigned n);
 template bool Polygon_complete<float>(const Vector2f *V, unsigned n);
+template bool Polygon_outside<double>(const Vector2d &P, const Vector2d *V, unsigned n);
+template bool Polygon_complete<double>(const Vector2d *V, unsigned n);
+template bool Polygon_edge_crosses<int32_t>(const Vector2l &P, const Vector2l &v1, const Vector2l &v2);
+template bool Polygon_edge_crosses<float>(const Vector2f &P, const Vector2f &v1, const Vector2f &v2);
+template bool Polygon_edge_crosses<double>(const Vector2d &P, const Vector2d &v1, const Vector2d &v2);
+
+/*
+  test point P against num_polygons polygons, where polygon i has
+  n[i] points starting at V[i]. outside[i] is set to true if P is
+  outside polygon i. Returns the number of polygons P is outside of
+ */
+template <typename T>
+unsigned Polygon_outside_many(const Vector2<T> &P, const Vector2<T> * const V[], const unsigned n[], unsigned num_polygons, bool outside[])
+{
+    unsigned count = 0;
+    for (unsigned i=0; i<num_polygons; i++) {
+        outside[i] = Polygon_outside(P, V[i], n[i]);
+        count += outside[i];
+    }
+    return count;
+}
+
+template unsigned Polygon_outside_many<int32_t>(const Vector2l &P, const Vector2l * const V[], const unsigned n[], unsigned num_polygons, bool outside[]);
+template unsigned Polygon_outside_many<float>(const Vector2f &P, const Vector2f * const V[], const unsigned n[], unsigned num_polygons, bool outside[]);
+template unsigned Polygon_outside_many<double>(const Vector2d &P, const Vector2d * const V[], const unsigned n[], unsigned num_polygons, bool outside[]);
 
 /*
   determine if the polygon of N verticies defined by points V is
@@ -140,8 +225,8 @@ bool Polygon_intersects(const Vector2f *V, unsigned N, const Vector2f &p1, const
     }
 
     float intersect_dist_sq = FLT_MAX;
-    for (uint8_t i=0; i<N; i++) {
-        uint8_t j = i+1;
+    for (unsigned i=0; i<N; i++) {
+        unsigned j = i+1;
         if (j >= N) {
             j = 0;
         }
@@ -184,7 +269,7 @@ float Polygon_closest_distance_line(const Vector2f *V, unsigned N, const Vector2
         return -sqrtf(sq(intersection.x - p2.x) + sq(intersection.y - p2.y));
     }
     float closest_sq = FLT_MAX;
-    for (uint8_t i=0; i<N-1; i++) {
+    for (unsigned i=0; i+1<N; i++) {
         const Vector2f &v1 = V[i];
         const Vector2f &v2 = V[i+1];
 
@@ -23,6 +23,16 @@ template <typename T>
 bool        Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n) WARN_IF_UNUSED;
 template <typename T>
 bool        Polygon_complete(const Vector2<T> *V, unsigned n) WARN_IF_UNUSED;
+template <typename T>
+bool        Polygon_edge_crosses(const Vector2<T> &P, const Vector2<T> &v1, const Vector2<T> &v2) WARN_IF_UNUSED;
+
+/*
+  test point P against num_polygons polygons, where polygon i has
+  n[i] points starting at V[i]. outside[i] is set to true if P is
+  outside polygon i. Returns the number of polygons P is outside of
+ */
+template <typename T>
+unsigned    Polygon_outside_many(const Vector2<T> &P, const Vector2<T> * const V[], const unsigned n[], unsigned num_polygons, bool outside[]);
 
 /*
   determine if the polygon of N verticies defined by points V is
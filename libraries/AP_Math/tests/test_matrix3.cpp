@@ -103,6 +103,42 @@ TEST_P(Matrix3fTest, Inverses)
     }
 }
 
+TEST(Matrix3Test, MulArray)
+{
+    Matrix3f m;
+    m.from_euler(radians(10), radians(-20), radians(135));
+    Vector3f v[7];
+    for (uint8_t i=0; i<ARRAY_SIZE(v); i++) {
+        v[i] = Vector3f(i, -2.5f*i, 100-i);
+    }
+    Vector3f out[ARRAY_SIZE(v)];
+    Vector3f out_t[ARRAY_SIZE(v)];
+    m.mul_array(v, out, ARRAY_SIZE(v));
+    m.mul_transpose_array(v, out_t, ARRAY_SIZE(v));
+    for (uint8_t i=0; i<ARRAY_SIZE(v); i++) {
+        EXPECT_EQ(m * v[i], out[i]);
+        EXPECT_EQ(m.mul_transpose(v[i]), out_t[i]);
+    }
+
+    // in place
+    Vector3f w[ARRAY_SIZE(v)];
+    memcpy(w, v, sizeof(w));
+    m.mul_array(w, w, ARRAY_SIZE(w));
+    for (uint8_t i=0; i<ARRAY_SIZE(v); i++) {
+        EXPECT_EQ(out[i], w[i]);
+    }
+
+    Matrix3d md = m.todouble();
+    Vector3d vd[ARRAY_SIZE(v)];
+    for (uint8_t i=0; i<ARRAY_SIZE(v); i++) {
+        vd[i] = v[i].todouble();
+    }
+    md.mul_array(vd, vd, ARRAY_SIZE(vd));
+    for (uint8_t i=0; i<ARRAY_SIZE(v); i++) {
+        EXPECT_EQ(md * v[i].todouble(), vd[i]);
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(InvertibleMatrices,
                         Matrix3fTest,
                         ::testing::ValuesIn(invertible));
@@ -355,6 +355,60 @@ TEST(Polygon, simple)
     TEST_POLYGON_POINTS(SIMPLE_boundary, SIMPLE_test_points);
 }
 
+TEST(Polygon, outside_many)
+{
+    // every triangle from the points_boundaries tests at once, both
+    // closed and unclosed, against each of the test points
+    const unsigned num = ARRAY_SIZE(points_boundaries);
+    Vector2f closed[num][4];
+    const Vector2f *V[2*num];
+    unsigned n[2*num];
+    for (unsigned i=0; i<num; i++) {
+        memcpy(closed[i], points_boundaries[i].boundary, sizeof(points_boundaries[i].boundary));
+        closed[i][3] = closed[i][0];
+        V[i] = closed[i];
+        n[i] = 4;
+        V[num+i] = points_boundaries[i].boundary;
+        n[num+i] = 3;
+    }
+    for (const struct PB &pb : points_boundaries) {
+        bool outside[2*num];
+        unsigned count = 0;
+        for (unsigned i=0; i<2*num; i++) {
+            count += Polygon_outside(pb.point, V[i], n[i]);
+        }
+        EXPECT_EQ(count, Polygon_outside_many(pb.point, V, n, 2*num, outside));
+        for (unsigned i=0; i<2*num; i++) {
+            EXPECT_EQ(Polygon_outside(pb.point, V[i], n[i]), outside[i]);
+        }
+    }
+}
+
+TEST(Polygon, outside_many_long)
+{
+    const Vector2l *V[] { OBC_boundary, OBC_boundary };
+    const unsigned n[] { ARRAY_SIZE(OBC_boundary), ARRAY_SIZE(OBC_boundary)-1 };
+    for (const auto &p : OBC_test_points) {
+        bool outside[2];
+        EXPECT_EQ(p.outside ? 2U : 0U, Polygon_outside_many(p.point, V, n, 2, outside));
+        EXPECT_EQ(p.outside, outside[0]);
+        EXPECT_EQ(p.outside, outside[1]);
+    }
+}
+
+TEST(Polygon, outside_double)
+{
+    for (const struct PB &pb : points_boundaries) {
+        Vector2d v[4];
+        for (uint8_t i=0; i<3; i++) {
+            v[i] = pb.boundary[i].todouble();
+        }
+        v[3] = v[0];
+        EXPECT_EQ(pb.outside, Polygon_outside(pb.point.todouble(), v, 4));
+        EXPECT_EQ(pb.outside, Polygon_outside(pb.point.todouble(), v, 3));
+    }
+}
+
 AP_GTEST_MAIN()
 
 
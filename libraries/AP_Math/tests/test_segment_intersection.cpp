@@ -63,5 +63,48 @@ TEST(SegmentIntersectionTests, NonIntersecting)
     SHOULD_NOT_INTERSECT(0,0,0,1, -2,2,2,2)
 }
 
+TEST(SegmentIntersectionTests, Closest)
+{
+    // a square with a spike, crossed left to right by the segment
+    const Vector2f V[] {
+        {1,-1}, {1,1}, {3,1}, {3,-1}, {2,-1}, {1.5,0.5}, {1.2,-1}, {1,-1}
+    };
+    const uint32_t num_segs = ARRAY_SIZE(V)-1;
+    Vector2f intersection;
+    EXPECT_EQ(0, Vector2f::segment_intersection_closest({0,0}, {4,0}, V, V+1, num_segs, intersection));
+    EXPECT_VECTOR2F_EQ(intersection, Vector2f(1,0));
+    EXPECT_EQ(1, Vector2f::segment_intersection_closest({2,2}, {2,0}, V, V+1, num_segs, intersection));
+    EXPECT_VECTOR2F_EQ(intersection, Vector2f(2,1));
+
+    // starting inside the spike the closest crossing is its left edge
+    EXPECT_EQ(5, Vector2f::segment_intersection_closest({1.5,0}, {0,0}, V, V+1, num_segs, intersection));
+    Vector2f expected;
+    EXPECT_TRUE(Vector2f::segment_intersection(V[5], V[6], {1.5,0}, {0,0}, expected));
+    EXPECT_VECTOR2F_EQ(intersection, expected);
+
+    // no crossings, and collinear with an edge
+    EXPECT_EQ(-1, Vector2f::segment_intersection_closest({0,2}, {4,2}, V, V+1, num_segs, intersection));
+    EXPECT_EQ(-1, Vector2f::segment_intersection_closest({1,-0.5}, {1,0.5}, V, V+1, num_segs, intersection));
+    EXPECT_EQ(-1, Vector2f::segment_intersection_closest({0,0}, {4,0}, V, V+1, 0, intersection));
+
+    // the same as segment_intersection() for each segment alone
+    for (uint32_t i=0; i<num_segs; i++) {
+        const bool result = Vector2f::segment_intersection({0,0}, {4,0}, V[i], V[i+1], expected);
+        EXPECT_EQ(result ? 0 : -1, Vector2f::segment_intersection_closest({0,0}, {4,0}, &V[i], &V[i+1], 1, intersection));
+        if (result) {
+            EXPECT_VECTOR2F_EQ(intersection, expected);
+        }
+    }
+
+    // and for doubles
+    Vector2d Vd[ARRAY_SIZE(V)];
+    for (uint8_t i=0; i<ARRAY_SIZE(V); i++) {
+        Vd[i] = V[i].todouble();
+    }
+    Vector2d intersection_d;
+    EXPECT_EQ(1, Vector2d::segment_intersection_closest({2,2}, {2,0}, Vd, Vd+1, num_segs, intersection_d));
+    EXPECT_DOUBLE_EQ(intersection_d.x, 2);
+    EXPECT_DOUBLE_EQ(intersection_d.y, 1);
+}
 
 AP_GTEST_MAIN()
@@ -197,6 +197,37 @@ bool Vector2<T>::segment_intersection(const Vector2<T>& seg1_start, const Vector
     }
 }
 
+// find the intersection of a line segment with many line segments
+// returns the index of the segment with the intersection closest to seg_start, or -1 if none intersect
+// this is the same test as segment_intersection() with the branches
+// replaced by selects, and without calculating the intersection point
+// for every segment crossed
+template <typename T>
+int32_t Vector2<T>::segment_intersection_closest(const Vector2<T>& seg_start, const Vector2<T>& seg_end, const Vector2<T>* seg_starts, const Vector2<T>* seg_ends, uint32_t num_segs, Vector2<T>& intersection)
+{
+    const Vector2<T> r1 = seg_end - seg_start;
+    // t is the fraction along our segment, so the closest intersection has the smallest t
+    T best_t = 2;
+    int32_t best = -1;
+    for (uint32_t i=0; i<num_segs; i++) {
+        const Vector2<T> r2 = seg_ends[i] - seg_starts[i];
+        const Vector2<T> ss2_ss1 = seg_starts[i] - seg_start;
+        const T r1xr2 = r1 % r2;
+        // collinear or parallel segments don't intersect, avoid dividing by zero for them
+        const bool parallel = ::is_zero(r1xr2);
+        const T denom = parallel ? 1 : r1xr2;
+        const T t = (ss2_ss1 % r2) / denom;
+        const T u = (ss2_ss1 % r1) / denom;
+        const bool closer = !parallel & (u >= 0) & (u <= 1) & (t >= 0) & (t <= 1) & (t < best_t);
+        best_t = closer ? t : best_t;
+        best = closer ? int32_t(i) : best;
+    }
+    if (best >= 0) {
+        intersection = seg_start + (r1*best_t);
+    }
+    return best;
+}
+
 // find the intersection between a line segment and a circle
 // returns true if they intersect and intersection argument is updated with intersection closest to seg_start
 // solution adapted from http://stackoverflow.com/questions/1073336/circle-line-segment-collision-detection-algorithm
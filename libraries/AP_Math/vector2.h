@@ -239,6 +239,13 @@ struct Vector2
     // the point of intersection is returned in the intersection argument
     static bool segment_intersection(const Vector2<T>& seg1_start, const Vector2<T>& seg1_end, const Vector2<T>& seg2_start, const Vector2<T>& seg2_end, Vector2<T>& intersection) WARN_IF_UNUSED;
 
+    // find the intersection of the segment from seg_start to seg_end
+    // with num_segs segments, segment i going from seg_starts[i] to seg_ends[i]
+    // returns the index of the segment with the intersection closest to seg_start, or -1 if none intersect
+    // the point of intersection is returned in the intersection argument
+    // for a polyline of n points pass V and V+1 as the starts and ends with n-1 segments
+    static int32_t segment_intersection_closest(const Vector2<T>& seg_start, const Vector2<T>& seg_end, const Vector2<T>* seg_starts, const Vector2<T>* seg_ends, uint32_t num_segs, Vector2<T>& intersection) WARN_IF_UNUSED;
+
     // find the intersection between a line segment and a circle
     // returns true if they intersect and intersection argument is updated with intersection closest to seg_start
     static bool circle_segment_intersection(const Vector2<T>& seg_start, const Vector2<T>& seg_end, const Vector2<T>& circle_center, T radius, Vector2<T>& intersection) WARN_IF_UNUSED;
@@ -88,6 +88,9 @@ void AP_Mission::init()
     }
 
 
+    // storage may have changed underneath anything already cached
+    invalidate_caches(AP_MISSION_FIRST_REAL_COMMAND, true);
+
     // check_eeprom_version - checks version of missions stored in eeprom matches this library
     // command list will be cleared if they do not match
     check_eeprom_version();
@@ -301,6 +304,7 @@ void AP_Mission::truncate(uint16_t index)
 {
     if ((unsigned)_cmd_total > index) {
         _cmd_total.set_and_save(index);
+        invalidate_caches(index, true);
         _last_change_time_ms = AP_HAL::millis();
     }
 }
@@ -357,6 +361,12 @@ void AP_Mission::update()
             _flags.do_cmd_loaded = false;
         }
     }
+
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    // load upcoming commands into the cache while the nav command runs
+    // so the next transition does not have to wait on storage
+    prefetch_cmds();
+#endif
 }
 
 // handle events for when the mission has been updated (but maybe not changed)
@@ -824,8 +834,6 @@ union PackedContent {
 ///     true is return if successful
 bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) const
 {
-    ASSERT_STORAGE_SIZE(PackedContent, 12);
-
     WITH_SEMAPHORE(_rsem);
 
     // special handling for command #0 which is home
@@ -839,6 +847,29 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    check_cmd_total();
+    if (read_cmd_from_cache(index, cmd)) {
+        return true;
+    }
+#endif
+
+    decode_cmd_from_storage(index, cmd);
+
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    add_cmd_to_cache(cmd);
+#endif
+
+    // return success
+    return true;
+}
+
+/// decode_cmd_from_storage - decode a command from storage, bypassing the cache
+///     index must be within the mission and not home
+void AP_Mission::decode_cmd_from_storage(uint16_t index, Mission_Command& cmd) const
+{
+    ASSERT_STORAGE_SIZE(PackedContent, 12);
+
     // ensure all bytes of cmd are zeroed
     cmd = {};
 
@@ -896,9 +927,145 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
 
     // set command's index to it's position in eeprom
     cmd.index = index;
+}
 
-    // return success
-    return true;
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+/// read_cmd_from_cache - get a command from the cache
+///     returns false if the command is not cached
+bool AP_Mission::read_cmd_from_cache(uint16_t index, Mission_Command& cmd) const
+{
+    for (auto &entry : _cmd_cache) {
+        if (entry.cmd.index == index) {
+            entry.last_used = ++_cmd_cache_counter;
+            cmd = entry.cmd;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// add_cmd_to_cache - add a command decoded from storage to the cache, replacing the least recently used entry
+void AP_Mission::add_cmd_to_cache(const Mission_Command& cmd) const
+{
+    cmd_cache_entry *lru = &_cmd_cache[0];
+    for (auto &entry : _cmd_cache) {
+        if (entry.cmd.index == 0) {
+            // unused entry
+            lru = &entry;
+            break;
+        }
+        if (entry.last_used < lru->last_used) {
+            lru = &entry;
+        }
+    }
+    lru->cmd = cmd;
+    lru->last_used = ++_cmd_cache_counter;
+}
+
+/*
+  load upcoming commands into the cache, one per call, until
+  AP_MISSION_PREFETCH_NAV_CMDS nav commands past the current one have
+  been loaded. DO_JUMP commands with repeats remaining are followed to
+  their target. The lookahead only uses half the cache so it does not
+  evict the commands it has just loaded
+ */
+void AP_Mission::prefetch_cmds()
+{
+    if (_prefetch.nav_index != _nav_cmd.index) {
+        // nav command has changed, restart the lookahead after it
+        _prefetch.nav_index = _nav_cmd.index;
+        _prefetch.next_index = _nav_cmd.index + 1;
+        _prefetch.nav_count = 0;
+        _prefetch.count = 0;
+    }
+    if (_prefetch.nav_count >= AP_MISSION_PREFETCH_NAV_CMDS ||
+        _prefetch.count >= AP_MISSION_CMD_CACHE_SIZE/2 ||
+        _nav_cmd.index == AP_MISSION_CMD_INDEX_NONE) {
+        return;
+    }
+
+    Mission_Command cmd;
+    if (!read_cmd_from_storage(_prefetch.next_index, cmd)) {
+        // end of mission
+        _prefetch.count = AP_MISSION_CMD_CACHE_SIZE/2;
+        return;
+    }
+    _prefetch.count++;
+    _prefetch.next_index++;
+
+    if (is_nav_cmd(cmd)) {
+        _prefetch.nav_count++;
+        return;
+    }
+
+    uint16_t target = AP_MISSION_CMD_INDEX_NONE;
+    if (cmd.id == MAV_CMD_DO_JUMP) {
+        target = cmd.content.jump.target;
+    } else if (cmd.id == MAV_CMD_DO_JUMP_TAG) {
+        target = get_index_of_jump_tag(cmd.content.jump.target);
+    } else {
+        return;
+    }
+    if (target == 0 || target >= (unsigned)_cmd_total) {
+        return;
+    }
+
+    // follow the jump if it will be taken, without allocating a jump
+    // tracking slot for it
+    int16_t times_run = 0;
+    for (const auto &jump : _jump_tracking) {
+        if (jump.index == cmd.index) {
+            times_run = jump.num_times_run;
+            break;
+        }
+    }
+    if (cmd.content.jump.num_times == AP_MISSION_JUMP_REPEAT_FOREVER ||
+        times_run < cmd.content.jump.num_times) {
+        _prefetch.next_index = target;
+    }
+}
+#endif  // AP_MISSION_CMD_CACHE_SIZE
+
+/// invalidate_caches - discard the cached command at index, or all commands
+///     from index onwards if to_end is true, and the jump tag table
+void AP_Mission::invalidate_caches(uint16_t index, bool to_end)
+{
+    WITH_SEMAPHORE(_rsem);
+
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    for (auto &entry : _cmd_cache) {
+        if (entry.cmd.index == index || (to_end && entry.cmd.index > index)) {
+            entry.cmd.index = 0;
+        }
+    }
+    // restart the lookahead in case it passed over the changed commands
+    _prefetch.nav_index = AP_MISSION_CMD_INDEX_NONE;
+#endif
+
+    _jump_tag_table_valid = false;
+}
+
+/// check_cmd_total - discard cached commands past the end of the mission
+///     and the jump tag table if the number of commands has changed.
+///     MIS_TOTAL can be set as a parameter without going through
+///     truncate(). Called with _rsem held
+void AP_Mission::check_cmd_total() const
+{
+    const uint16_t total = _cmd_total;
+    if (total == _caches_cmd_total) {
+        return;
+    }
+    _caches_cmd_total = total;
+
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    for (auto &entry : _cmd_cache) {
+        if (entry.cmd.index >= total) {
+            entry.cmd.index = 0;
+        }
+    }
+#endif
+
+    _jump_tag_table_valid = false;
 }
 
 bool AP_Mission::stored_in_location(uint16_t id)
@@ -996,6 +1163,7 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
     if (index != 0) {
         // Update of home location is not a true change
         _last_change_time_ms = AP_HAL::millis();
+        invalidate_caches(index, false);
     }
 
     // return success
@@ -2346,6 +2514,22 @@ bool AP_Mission::jump_to_tag(const uint16_t tag)
 // Returns 0 if no appropriate JUMP_TAG match can be found.
 uint16_t AP_Mission::get_index_of_jump_tag(const uint16_t tag) const
 {
+    WITH_SEMAPHORE(_rsem);
+
+    check_cmd_total();
+    if (!_jump_tag_table_valid) {
+        build_jump_tag_table();
+    }
+    for (uint8_t i = 0; i < _jump_tag_table_count; i++) {
+        if (_jump_tag_table[i].tag == tag) {
+            return _jump_tag_table[i].index;
+        }
+    }
+    if (!_jump_tag_table_overflow) {
+        return 0;
+    }
+
+    // the table is full so this tag may not be in it, search the mission
     const auto count = num_commands();
     for (uint16_t i = 1; i < count; i++) {
         if (get_command_id(i) != uint16_t(MAV_CMD_JUMP_TAG)) {
@@ -2362,6 +2546,43 @@ uint16_t AP_Mission::get_index_of_jump_tag(const uint16_t tag) const
     return 0;
 }
 
+// build the table of the first JUMP_TAG command index for each tag.
+// Commands are decoded straight from storage so the scan does not
+// evict the commands prefetched into the cache
+void AP_Mission::build_jump_tag_table() const
+{
+    _jump_tag_table_count = 0;
+    _jump_tag_table_overflow = false;
+
+    const uint16_t count = MIN(num_commands(), _commands_max);
+    for (uint16_t i = 1; i < count; i++) {
+        if (get_command_id(i) != uint16_t(MAV_CMD_JUMP_TAG)) {
+            continue;
+        }
+        Mission_Command tmp;
+        decode_cmd_from_storage(i, tmp);
+        if (tmp.id != MAV_CMD_JUMP_TAG) {
+            continue;
+        }
+        bool seen = false;
+        for (uint8_t j = 0; j < _jump_tag_table_count; j++) {
+            if (_jump_tag_table[j].tag == tmp.content.jump.target) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) {
+            continue;
+        }
+        if (_jump_tag_table_count >= ARRAY_SIZE(_jump_tag_table)) {
+            _jump_tag_table_overflow = true;
+            break;
+        }
+        _jump_tag_table[_jump_tag_table_count++] = { tmp.content.jump.target, i };
+    }
+    _jump_tag_table_valid = true;
+}
+
 #if AP_SCRIPTING_ENABLED
 bool AP_Mission::get_last_jump_tag(uint16_t &tag, uint16_t &age) const
 {
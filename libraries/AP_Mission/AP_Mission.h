@@ -968,6 +968,55 @@ private:
     // const functions
     static HAL_Semaphore _rsem;
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    // LRU cache of decoded commands, protected by _rsem. Home (index 0)
+    // is never cached so an index of 0 marks an unused entry
+    struct cmd_cache_entry {
+        Mission_Command cmd;
+        uint32_t last_used;     // value of _cmd_cache_counter when the entry was last used
+    };
+    mutable cmd_cache_entry _cmd_cache[AP_MISSION_CMD_CACHE_SIZE];
+    mutable uint32_t _cmd_cache_counter;
+
+    // get a command from the cache, returns false if it is not cached
+    bool read_cmd_from_cache(uint16_t index, Mission_Command& cmd) const;
+
+    // add a command decoded from storage to the cache, replacing the least recently used entry
+    void add_cmd_to_cache(const Mission_Command& cmd) const;
+
+    // lookahead loading upcoming commands into the cache while the current nav command runs
+    struct {
+        uint16_t nav_index;     // nav command index the lookahead started from
+        uint16_t next_index;    // index of the next command to load
+        uint8_t nav_count;      // number of nav commands loaded
+        uint8_t count;          // number of commands loaded
+    } _prefetch;
+    void prefetch_cmds();
+#endif
+
+    // index of JUMP_TAG commands by tag, built on demand and discarded
+    // whenever the mission changes. Protected by _rsem
+    struct jump_tag_entry {
+        uint16_t tag;
+        uint16_t index;         // index of the first JUMP_TAG command with this tag
+    };
+    mutable jump_tag_entry _jump_tag_table[AP_MISSION_MAX_NUM_DO_JUMP_COMMANDS];
+    mutable uint8_t _jump_tag_table_count;
+    mutable bool _jump_tag_table_valid;
+    mutable bool _jump_tag_table_overflow;  // true if the mission has more tags than fit in the table
+    void build_jump_tag_table() const;
+
+    // decode a command from storage without using the cache
+    void decode_cmd_from_storage(uint16_t index, Mission_Command& cmd) const;
+
+    // _cmd_total when the caches were last checked against it
+    mutable uint16_t _caches_cmd_total;
+    void check_cmd_total() const;
+
+    // discard the cached command at index (or all commands from index
+    // onwards if to_end is true) and the jump tag table after the mission changes
+    void invalidate_caches(uint16_t index, bool to_end);
+
     // mission items common to all vehicles:
     bool start_command_do_aux_function(const AP_Mission::Mission_Command& cmd);
     bool start_command_do_gripper(const AP_Mission::Mission_Command& cmd);
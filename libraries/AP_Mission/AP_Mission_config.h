@@ -12,3 +12,21 @@
 #ifndef AP_MISSION_MAV_CMD_DO_SET_ROI_WPNEXT_OFFSET_ENABLED
 #define AP_MISSION_MAV_CMD_DO_SET_ROI_WPNEXT_OFFSET_ENABLED AP_MOUNT_ROI_WPNEXT_OFFSET_ENABLED
 #endif
+
+// number of decoded mission commands held in an LRU cache in front of
+// storage, 0 disables the cache and the lookahead prefetch
+#ifndef AP_MISSION_CMD_CACHE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MISSION_CMD_CACHE_SIZE 32
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define AP_MISSION_CMD_CACHE_SIZE 16
+#else
+#define AP_MISSION_CMD_CACHE_SIZE 0
+#endif
+#endif
+
+// number of upcoming navigation commands prefetched into the cache
+// while the current navigation command runs
+#ifndef AP_MISSION_PREFETCH_NAV_CMDS
+#define AP_MISSION_PREFETCH_NAV_CMDS 4
+#endif
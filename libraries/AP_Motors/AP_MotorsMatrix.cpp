@@ -106,6 +106,7 @@ bool AP_MotorsMatrix::set_throttle_factor(int8_t motor_num, float throttle_facto
     }
 
     _throttle_factor[motor_num] = throttle_factor;
+    update_mix_matrix();
     return true;
 }
 
@@ -271,29 +272,42 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     // Octo-Quad (x8) + : MOT_YAW_HEADROOM = 300, ATC_RAT_RLL_IMAX = 0.5,   ATC_RAT_PIT_IMAX = 0.5,   ATC_RAT_YAW_IMAX = 0.25
     // Quads cannot make use of motor loss handling because it doesn't have enough degrees of freedom.
 
+    // row of the lost motor in the mixing matrix, excluded from the
+    // yaw and saturation limits while thrust boost is active
+    int8_t lost_row = -1;
+    if (_thrust_boost) {
+        for (uint8_t j = 0; j < _mix.num_rows; j++) {
+            if (_mix.motor[j] == _motor_lost_index) {
+                lost_row = j;
+                break;
+            }
+        }
+    }
+
+    // roll, pitch and yaw thrust for each row of the mixing matrix
+    float thrust_rpy[AP_MOTORS_MAX_NUM_MOTORS];
+
     // calculate amount of yaw we can fit into the throttle range
     // this is always equal to or less than the requested yaw from the pilot or rate controller
     float yaw_allowed = 1.0f; // amount of yaw we can fit in
-    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            // calculate the thrust outputs for roll and pitch
-            _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
-
-            // Check the maximum yaw control that can be used on this channel
-            // Exclude any lost motors if thrust boost is enabled
-            if (!is_zero(_yaw_factor[i]) && (!_thrust_boost || i != _motor_lost_index)) {
-                const float thrust_rp_best_throttle = throttle_thrust_best_rpy + _thrust_rpyt_out[i];
-                float motor_room;
-                if (is_positive(yaw_thrust * _yaw_factor[i])) {
-                    // room to upper limit
-                    motor_room = 1.0 - thrust_rp_best_throttle;
-                } else {
-                    // room to lower limit
-                    motor_room = thrust_rp_best_throttle;
-                }
-                const float motor_yaw_allowed = MAX(motor_room, 0.0)/fabsf(_yaw_factor[i]);
-                yaw_allowed = MIN(yaw_allowed, motor_yaw_allowed);
+    for (uint8_t j = 0; j < _mix.num_rows; j++) {
+        // calculate the thrust outputs for roll and pitch
+        thrust_rpy[j] = roll_thrust * _mix.roll[j] + pitch_thrust * _mix.pitch[j];
+
+        // Check the maximum yaw control that can be used on this channel
+        // Exclude any lost motors if thrust boost is enabled
+        if (!is_zero(_mix.yaw[j]) && j != lost_row) {
+            const float thrust_rp_best_throttle = throttle_thrust_best_rpy + thrust_rpy[j];
+            float motor_room;
+            if (is_positive(yaw_thrust * _mix.yaw[j])) {
+                // room to upper limit
+                motor_room = 1.0 - thrust_rp_best_throttle;
+            } else {
+                // room to lower limit
+                motor_room = thrust_rp_best_throttle;
             }
+            const float motor_yaw_allowed = MAX(motor_room, 0.0)/fabsf(_mix.yaw[j]);
+            yaw_allowed = MIN(yaw_allowed, motor_yaw_allowed);
         }
     }
 
@@ -308,18 +322,18 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     yaw_allowed = MAX(yaw_allowed, yaw_allowed_min);
 
     // Include the lost motor scaled by _thrust_boost_ratio to smoothly transition this motor in and out of the calculation
-    if (_thrust_boost && motor_enabled[_motor_lost_index]) {
+    if (lost_row >= 0) {
         // Check the maximum yaw control that can be used on this channel
         // Exclude any lost motors if thrust boost is enabled
-        if (!is_zero(_yaw_factor[_motor_lost_index])){
-            const float thrust_rp_best_throttle = throttle_thrust_best_rpy + _thrust_rpyt_out[_motor_lost_index];
+        if (!is_zero(_mix.yaw[lost_row])){
+            const float thrust_rp_best_throttle = throttle_thrust_best_rpy + thrust_rpy[lost_row];
             float motor_room;
-            if (is_positive(yaw_thrust * _yaw_factor[_motor_lost_index])) {
+            if (is_positive(yaw_thrust * _mix.yaw[lost_row])) {
                 motor_room = 1.0 - thrust_rp_best_throttle;
             } else {
                 motor_room = thrust_rp_best_throttle;
             }
-            const float motor_yaw_allowed = MAX(motor_room, 0.0)/fabsf(_yaw_factor[_motor_lost_index]);
+            const float motor_yaw_allowed = MAX(motor_room, 0.0)/fabsf(_mix.yaw[lost_row]);
             yaw_allowed = boost_ratio(yaw_allowed, MIN(yaw_allowed, motor_yaw_allowed));
         }
     }
@@ -333,29 +347,28 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     // add yaw control to thrust outputs
     float rpy_low = 1.0f;   // lowest thrust value
     float rpy_high = -1.0f; // highest thrust value
-    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
+    for (uint8_t j = 0; j < _mix.num_rows; j++) {
+        thrust_rpy[j] = thrust_rpy[j] + yaw_thrust * _mix.yaw[j];
 
-            // record lowest roll + pitch + yaw command
-            if (_thrust_rpyt_out[i] < rpy_low) {
-                rpy_low = _thrust_rpyt_out[i];
-            }
-            // record highest roll + pitch + yaw command
-            // Exclude any lost motors if thrust boost is enabled
-            if (_thrust_rpyt_out[i] > rpy_high && (!_thrust_boost || i != _motor_lost_index)) {
-                rpy_high = _thrust_rpyt_out[i];
-            }
+        // record lowest roll + pitch + yaw command
+        if (thrust_rpy[j] < rpy_low) {
+            rpy_low = thrust_rpy[j];
+        }
+        // record highest roll + pitch + yaw command
+        // Exclude any lost motors if thrust boost is enabled
+        if (thrust_rpy[j] > rpy_high && j != lost_row) {
+            rpy_high = thrust_rpy[j];
         }
     }
     // Include the lost motor scaled by _thrust_boost_ratio to smoothly transition this motor in and out of the calculation
-    if (_thrust_boost) {
+    if (lost_row >= 0) {
         // record highest roll + pitch + yaw command
-        if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && motor_enabled[_motor_lost_index]) {
-            rpy_high = boost_ratio(rpy_high, _thrust_rpyt_out[_motor_lost_index]);
+        if (thrust_rpy[lost_row] > rpy_high) {
+            rpy_high = boost_ratio(rpy_high, thrust_rpy[lost_row]);
         }
     }
 
+    // resolve saturation once for all motors:
     // calculate any scaling needed to make the combined thrust outputs fit within the output range
     float rpy_scale = 1.0f;
     if (rpy_high - rpy_low > 1.0f) {
@@ -389,10 +402,8 @@ void AP_MotorsMatrix::output_armed_stabilizing()
 
     // add scaled roll, pitch, constrained yaw and throttle for each motor
     const float throttle_thrust_best_plus_adj = throttle_thrust_best_rpy + thr_adj;
-    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = (throttle_thrust_best_plus_adj * _throttle_factor[i]) + (rpy_scale * _thrust_rpyt_out[i]);
-        }
+    for (uint8_t j = 0; j < _mix.num_rows; j++) {
+        _thrust_rpyt_out[_mix.motor[j]] = (throttle_thrust_best_plus_adj * _mix.throttle[j]) + (rpy_scale * thrust_rpy[j]);
     }
 
     // determine throttle thrust for harmonic notch
@@ -524,6 +535,8 @@ void AP_MotorsMatrix::add_motor_raw(int8_t motor_num, float roll_fac, float pitc
 
         // call parent class method
         add_motor_num(motor_num);
+
+        update_mix_matrix();
     }
 }
 
@@ -555,6 +568,8 @@ void AP_MotorsMatrix::remove_motor(int8_t motor_num)
         _pitch_factor[motor_num] = 0.0f;
         _yaw_factor[motor_num] = 0.0f;
         _throttle_factor[motor_num] = 0.0f;
+
+        update_mix_matrix();
     }
 }
 
@@ -1384,6 +1399,25 @@ void AP_MotorsMatrix::normalise_rpy_factors()
             }
         }
     }
+
+    update_mix_matrix();
+}
+
+// rebuild the mixing matrix from the factors of the enabled motors
+void AP_MotorsMatrix::update_mix_matrix()
+{
+    uint8_t j = 0;
+    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _mix.roll[j] = _roll_factor[i];
+            _mix.pitch[j] = _pitch_factor[i];
+            _mix.yaw[j] = _yaw_factor[i];
+            _mix.throttle[j] = _throttle_factor[i];
+            _mix.motor[j] = i;
+            j++;
+        }
+    }
+    _mix.num_rows = j;
 }
 
 
@@ -1408,6 +1442,7 @@ void AP_MotorsMatrix::disable_yaw_torque(void)
     for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
         _yaw_factor[i] = 0;
     }
+    update_mix_matrix();
 }
 
 #if APM_BUILD_TYPE(APM_BUILD_UNKNOWN)
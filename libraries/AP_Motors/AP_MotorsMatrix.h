@@ -127,6 +127,10 @@ protected:
     // normalizes the roll, pitch and yaw factors so maximum magnitude is 0.5
     void                normalise_rpy_factors();
 
+    // rebuild the mixing matrix from the factors of the enabled motors,
+    // must be called whenever the factors or enabled motors change
+    void                update_mix_matrix();
+
     // call vehicle supplied thrust compensation if set
     void                thrust_compensation(void) override;
 
@@ -160,6 +164,17 @@ private:
     // helper to return value scaled between boost and normal based on the value of _thrust_boost_ratio
     float boost_ratio(float boost_value, float normal_value) const;
 
+    // mixing matrix holding a row for each enabled motor, in output
+    // order, so the mixer runs over dense arrays with no enable checks
+    struct {
+        float roll[AP_MOTORS_MAX_NUM_MOTORS];
+        float pitch[AP_MOTORS_MAX_NUM_MOTORS];
+        float yaw[AP_MOTORS_MAX_NUM_MOTORS];
+        float throttle[AP_MOTORS_MAX_NUM_MOTORS];
+        uint8_t motor[AP_MOTORS_MAX_NUM_MOTORS];    // output number of each row
+        uint8_t num_rows;
+    } _mix;
+
     // setup motors matrix
     bool setup_quad_matrix(motor_frame_type frame_type);
     bool setup_hexa_matrix(motor_frame_type frame_type);
@@ -0,0 +1,128 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  benchmarks for the multicopter matrix mixer, for each frame class.
+  BM_MixerUnsaturated feeds small demands that fit within the output
+  range, BM_MixerSaturated feeds full scale demands so the roll, pitch
+  and yaw outputs are scaled back, and BM_MixerThrustBoost runs with a
+  lost motor excluded from the limits
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Motors/AP_Motors.h>
+#include <AP_BattMonitor/AP_BattMonitor.h>
+#include <SRV_Channel/SRV_Channel.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// singletons used by the motors library
+SRV_Channels srvs;
+AP_BattMonitor _battmonitor{0, nullptr, nullptr};
+
+class MixerBenchmark : public AP_MotorsMatrix {
+public:
+    using AP_MotorsMatrix::AP_MotorsMatrix;
+
+    // no outputs to configure
+    void set_update_rate(uint16_t speed_hz) override { _speed_hz = speed_hz; }
+
+    void setup(motor_frame_class frame_class, motor_frame_type frame_type) {
+        set_initialised_ok(false);
+        init(frame_class, frame_type);
+        set_dt_s(1.0 / 400);
+        set_throttle_avg_max(0.5f);
+        set_yaw_headroom(200);
+    }
+
+    void set_inputs(float roll, float pitch, float yaw, float throttle) {
+        set_roll(roll);
+        set_pitch(pitch);
+        set_yaw(yaw);
+        set_throttle(throttle);
+        _throttle_filter.reset(throttle);
+    }
+
+    void set_lost_motor(uint8_t index) {
+        _thrust_boost = true;
+        _thrust_boost_ratio = 1.0f;
+        _motor_lost_index = index;
+    }
+
+    void mix() {
+        limit.set_all(false);
+        output_armed_stabilizing();
+    }
+};
+
+static MixerBenchmark motors{400};
+
+static const struct {
+    const char *name;
+    AP_Motors::motor_frame_class frame_class;
+    AP_Motors::motor_frame_type frame_type;
+} frames[] = {
+    { "Quad X", AP_Motors::MOTOR_FRAME_QUAD, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { "Hexa X", AP_Motors::MOTOR_FRAME_HEXA, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { "Y6B", AP_Motors::MOTOR_FRAME_Y6, AP_Motors::MOTOR_FRAME_TYPE_Y6B },
+    { "Octa X", AP_Motors::MOTOR_FRAME_OCTA, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { "OctaQuad X", AP_Motors::MOTOR_FRAME_OCTAQUAD, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { "Deca X", AP_Motors::MOTOR_FRAME_DECA, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { "DodecaHexa X", AP_Motors::MOTOR_FRAME_DODECAHEXA, AP_Motors::MOTOR_FRAME_TYPE_X },
+};
+
+static void BM_MixerUnsaturated(benchmark::State& state)
+{
+    const auto &f = frames[state.range(0)];
+    motors.setup(f.frame_class, f.frame_type);
+    motors.set_inputs(0.05f, -0.03f, 0.02f, 0.4f);
+    state.SetLabel(f.name);
+
+    while (state.KeepRunning()) {
+        motors.mix();
+        gbenchmark_escape(&motors);
+    }
+}
+
+static void BM_MixerSaturated(benchmark::State& state)
+{
+    const auto &f = frames[state.range(0)];
+    motors.setup(f.frame_class, f.frame_type);
+    motors.set_inputs(0.8f, -0.7f, 0.9f, 0.9f);
+    state.SetLabel(f.name);
+
+    while (state.KeepRunning()) {
+        motors.mix();
+        gbenchmark_escape(&motors);
+    }
+}
+
+static void BM_MixerThrustBoost(benchmark::State& state)
+{
+    const auto &f = frames[state.range(0)];
+    motors.setup(f.frame_class, f.frame_type);
+    motors.set_inputs(0.3f, -0.2f, 0.3f, 0.6f);
+    state.SetLabel(f.name);
+
+    while (state.KeepRunning()) {
+        // check_for_failed_motor() may clear the boost
+        motors.set_lost_motor(AP_MOTORS_MOT_1);
+        motors.mix();
+        gbenchmark_escape(&motors);
+    }
+}
+
+BENCHMARK(BM_MixerUnsaturated)->DenseRange(0, ARRAY_SIZE(frames)-1);
+BENCHMARK(BM_MixerSaturated)->DenseRange(0, ARRAY_SIZE(frames)-1);
+BENCHMARK(BM_MixerThrustBoost)->DenseRange(0, ARRAY_SIZE(frames)-1);
+
+BENCHMARK_MAIN();
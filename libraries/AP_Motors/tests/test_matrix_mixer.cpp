@@ -0,0 +1,321 @@
+#include <AP_gtest.h>
+
+#include <AP_Motors/AP_Motors.h>
+#include <AP_BattMonitor/AP_BattMonitor.h>
+#include <SRV_Channel/SRV_Channel.h>
+
+/*
+  check the multicopter mixer running over the precomputed mixing
+  matrix gives bit identical outputs to the mixer that looped over all
+  outputs checking the enabled motors
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// singletons used by the motors library
+SRV_Channels srvs;
+AP_BattMonitor _battmonitor{0, nullptr, nullptr};
+
+class MixerTest : public AP_MotorsMatrix {
+public:
+    using AP_MotorsMatrix::AP_MotorsMatrix;
+    using AP_MotorsMatrix::remove_motor;
+
+    // no outputs to configure
+    void set_update_rate(uint16_t speed_hz) override { _speed_hz = speed_hz; }
+
+    // state changed by a run of the mixer
+    struct State {
+        float thrust_rpyt_out[AP_MOTORS_MAX_NUM_MOTORS];
+        float thrust_rpyt_out_filt[AP_MOTORS_MAX_NUM_MOTORS];
+        uint8_t motor_lost_index;
+        bool thrust_boost;
+        bool thrust_balanced;
+        float throttle_out;
+        AP_Motors_limit limit;
+    };
+
+    void save(State &s) const {
+        memcpy(s.thrust_rpyt_out, _thrust_rpyt_out, sizeof(s.thrust_rpyt_out));
+        memcpy(s.thrust_rpyt_out_filt, _thrust_rpyt_out_filt, sizeof(s.thrust_rpyt_out_filt));
+        s.motor_lost_index = _motor_lost_index;
+        s.thrust_boost = _thrust_boost;
+        s.thrust_balanced = _thrust_balanced;
+        s.throttle_out = _throttle_out;
+        s.limit = limit;
+    }
+
+    void restore(const State &s) {
+        memcpy(_thrust_rpyt_out, s.thrust_rpyt_out, sizeof(_thrust_rpyt_out));
+        memcpy(_thrust_rpyt_out_filt, s.thrust_rpyt_out_filt, sizeof(_thrust_rpyt_out_filt));
+        _motor_lost_index = s.motor_lost_index;
+        _thrust_boost = s.thrust_boost;
+        _thrust_balanced = s.thrust_balanced;
+        _throttle_out = s.throttle_out;
+        limit = s.limit;
+    }
+
+    void set_inputs(float roll, float pitch, float yaw, float throttle, float boost_ratio) {
+        set_roll(roll);
+        set_pitch(pitch);
+        set_yaw(yaw);
+        set_throttle(throttle);
+        _throttle_filter.reset(throttle);
+        _thrust_boost_ratio = boost_ratio;
+        limit.set_all(false);
+    }
+
+    void set_lost_motor(bool boost, uint8_t index) {
+        _thrust_boost = boost;
+        _motor_lost_index = index;
+    }
+
+    void mix() {
+        output_armed_stabilizing();
+    }
+
+    float reference_boost_ratio(float boost_value, float normal_value) const {
+        return _thrust_boost_ratio * boost_value + (1.0 - _thrust_boost_ratio) * normal_value;
+    }
+
+    // the mixer before the mixing matrix was introduced
+    void reference_mix() {
+        const float compensation_gain = thr_lin.get_compensation_gain();
+        const float roll_thrust = (_roll_in + _roll_in_ff) * compensation_gain;
+        const float pitch_thrust = (_pitch_in + _pitch_in_ff) * compensation_gain;
+        float yaw_thrust = (_yaw_in + _yaw_in_ff) * compensation_gain;
+        float throttle_thrust = get_throttle() * compensation_gain;
+        float throttle_avg_max = _throttle_avg_max * compensation_gain;
+        const float throttle_thrust_max = reference_boost_ratio(1.0, _throttle_thrust_max * compensation_gain);
+
+        if (throttle_thrust <= 0.0f) {
+            throttle_thrust = 0.0f;
+            limit.throttle_lower = true;
+        }
+        if (throttle_thrust >= throttle_thrust_max) {
+            throttle_thrust = throttle_thrust_max;
+            limit.throttle_upper = true;
+        }
+
+        throttle_avg_max = constrain_float(throttle_avg_max, throttle_thrust, throttle_thrust_max);
+
+        float throttle_thrust_best_rpy = MIN(0.5f, throttle_avg_max);
+
+        float yaw_allowed = 1.0f;
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
+                if (!is_zero(_yaw_factor[i]) && (!_thrust_boost || i != _motor_lost_index)) {
+                    const float thrust_rp_best_throttle = throttle_thrust_best_rpy + _thrust_rpyt_out[i];
+                    float motor_room;
+                    if (is_positive(yaw_thrust * _yaw_factor[i])) {
+                        motor_room = 1.0 - thrust_rp_best_throttle;
+                    } else {
+                        motor_room = thrust_rp_best_throttle;
+                    }
+                    const float motor_yaw_allowed = MAX(motor_room, 0.0)/fabsf(_yaw_factor[i]);
+                    yaw_allowed = MIN(yaw_allowed, motor_yaw_allowed);
+                }
+            }
+        }
+
+        float yaw_allowed_min = (float)_yaw_headroom * 0.001f;
+        yaw_allowed_min = reference_boost_ratio(0.5, yaw_allowed_min);
+        yaw_allowed = MAX(yaw_allowed, yaw_allowed_min);
+
+        if (_thrust_boost && motor_enabled[_motor_lost_index]) {
+            if (!is_zero(_yaw_factor[_motor_lost_index])){
+                const float thrust_rp_best_throttle = throttle_thrust_best_rpy + _thrust_rpyt_out[_motor_lost_index];
+                float motor_room;
+                if (is_positive(yaw_thrust * _yaw_factor[_motor_lost_index])) {
+                    motor_room = 1.0 - thrust_rp_best_throttle;
+                } else {
+                    motor_room = thrust_rp_best_throttle;
+                }
+                const float motor_yaw_allowed = MAX(motor_room, 0.0)/fabsf(_yaw_factor[_motor_lost_index]);
+                yaw_allowed = reference_boost_ratio(yaw_allowed, MIN(yaw_allowed, motor_yaw_allowed));
+            }
+        }
+
+        if (fabsf(yaw_thrust) > yaw_allowed) {
+            yaw_thrust = constrain_float(yaw_thrust, -yaw_allowed, yaw_allowed);
+            limit.yaw = true;
+        }
+
+        float rpy_low = 1.0f;
+        float rpy_high = -1.0f;
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
+                if (_thrust_rpyt_out[i] < rpy_low) {
+                    rpy_low = _thrust_rpyt_out[i];
+                }
+                if (_thrust_rpyt_out[i] > rpy_high && (!_thrust_boost || i != _motor_lost_index)) {
+                    rpy_high = _thrust_rpyt_out[i];
+                }
+            }
+        }
+        if (_thrust_boost) {
+            if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && motor_enabled[_motor_lost_index]) {
+                rpy_high = reference_boost_ratio(rpy_high, _thrust_rpyt_out[_motor_lost_index]);
+            }
+        }
+
+        float rpy_scale = 1.0f;
+        if (rpy_high - rpy_low > 1.0f) {
+            rpy_scale = 1.0f / (rpy_high - rpy_low);
+        }
+        if (throttle_avg_max + rpy_low < 0) {
+            rpy_scale = MIN(rpy_scale, -throttle_avg_max / rpy_low);
+        }
+
+        rpy_high *= rpy_scale;
+        rpy_low *= rpy_scale;
+        throttle_thrust_best_rpy = -rpy_low;
+        float thr_adj = throttle_thrust - throttle_thrust_best_rpy;
+        if (rpy_scale < 1.0f) {
+            limit.set_rpy(true);
+            if (thr_adj > 0.0f) {
+                limit.throttle_upper = true;
+            }
+            thr_adj = 0.0f;
+        } else if (thr_adj < 0.0f) {
+            thr_adj = 0.0f;
+        } else if (thr_adj > 1.0f - (throttle_thrust_best_rpy + rpy_high)) {
+            thr_adj = 1.0f - (throttle_thrust_best_rpy + rpy_high);
+            limit.throttle_upper = true;
+        }
+
+        const float throttle_thrust_best_plus_adj = throttle_thrust_best_rpy + thr_adj;
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                _thrust_rpyt_out[i] = (throttle_thrust_best_plus_adj * _throttle_factor[i]) + (rpy_scale * _thrust_rpyt_out[i]);
+            }
+        }
+
+        _throttle_out = throttle_thrust_best_plus_adj / compensation_gain;
+
+        check_for_failed_motor(throttle_thrust_best_plus_adj);
+    }
+};
+
+static MixerTest motors{400};
+
+static const struct {
+    AP_Motors::motor_frame_class frame_class;
+    AP_Motors::motor_frame_type frame_type;
+} frames[] = {
+    { AP_Motors::MOTOR_FRAME_QUAD, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_QUAD, AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { AP_Motors::MOTOR_FRAME_QUAD, AP_Motors::MOTOR_FRAME_TYPE_H },
+    { AP_Motors::MOTOR_FRAME_HEXA, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_HEXA, AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { AP_Motors::MOTOR_FRAME_OCTA, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_OCTA, AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { AP_Motors::MOTOR_FRAME_OCTAQUAD, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_OCTAQUAD, AP_Motors::MOTOR_FRAME_TYPE_PLUS },
+    { AP_Motors::MOTOR_FRAME_Y6, AP_Motors::MOTOR_FRAME_TYPE_Y6B },
+    { AP_Motors::MOTOR_FRAME_DODECAHEXA, AP_Motors::MOTOR_FRAME_TYPE_X },
+    { AP_Motors::MOTOR_FRAME_DECA, AP_Motors::MOTOR_FRAME_TYPE_X },
+};
+
+// uniform random value between -range and range
+static float rand_range(float range)
+{
+    return range * (get_random16() / 32767.5f - 1.0f);
+}
+
+static void check_equal(const MixerTest::State &a, const MixerTest::State &b)
+{
+    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        EXPECT_EQ(a.thrust_rpyt_out[i], b.thrust_rpyt_out[i]);
+        EXPECT_EQ(a.thrust_rpyt_out_filt[i], b.thrust_rpyt_out_filt[i]);
+    }
+    EXPECT_EQ(a.motor_lost_index, b.motor_lost_index);
+    EXPECT_EQ(a.thrust_boost, b.thrust_boost);
+    EXPECT_EQ(a.thrust_balanced, b.thrust_balanced);
+    EXPECT_EQ(a.throttle_out, b.throttle_out);
+    EXPECT_EQ(a.limit.roll, b.limit.roll);
+    EXPECT_EQ(a.limit.pitch, b.limit.pitch);
+    EXPECT_EQ(a.limit.yaw, b.limit.yaw);
+    EXPECT_EQ(a.limit.throttle_lower, b.limit.throttle_lower);
+    EXPECT_EQ(a.limit.throttle_upper, b.limit.throttle_upper);
+}
+
+// run both mixers from the same state and check the results match
+static void check_mix(float roll, float pitch, float yaw, float throttle, float boost_ratio)
+{
+    MixerTest::State start, expected, result;
+    motors.set_inputs(roll, pitch, yaw, throttle, boost_ratio);
+    motors.save(start);
+
+    motors.reference_mix();
+    motors.save(expected);
+
+    motors.restore(start);
+    motors.mix();
+    motors.save(result);
+
+    check_equal(expected, result);
+}
+
+TEST(MatrixMixer, frames)
+{
+    for (const auto &f : frames) {
+        motors.set_initialised_ok(false);
+        motors.init(f.frame_class, f.frame_type);
+        motors.set_dt_s(1.0 / 400);
+        motors.set_throttle_avg_max(0.5f);
+
+        for (uint16_t yaw_headroom : { 0, 200, 500 }) {
+            motors.set_yaw_headroom(yaw_headroom);
+            for (uint16_t i = 0; i < 2000; i++) {
+                // inputs range beyond full scale to exercise saturation
+                check_mix(rand_range(1.2f), rand_range(1.2f), rand_range(1.2f),
+                          0.5f + rand_range(0.6f), 0);
+            }
+        }
+    }
+}
+
+TEST(MatrixMixer, thrust_boost)
+{
+    for (const auto &f : frames) {
+        motors.set_initialised_ok(false);
+        motors.init(f.frame_class, f.frame_type);
+        motors.set_dt_s(1.0 / 400);
+        motors.set_throttle_avg_max(0.5f);
+        motors.set_yaw_headroom(200);
+
+        // lose each output in turn, including ones with no motor
+        for (uint8_t lost = 0; lost < AP_MOTORS_MAX_NUM_MOTORS; lost++) {
+            for (uint16_t i = 0; i < 200; i++) {
+                motors.set_lost_motor(true, lost);
+                check_mix(rand_range(1.0f), rand_range(1.0f), rand_range(1.0f),
+                          0.5f + rand_range(0.5f), (i % 5) * 0.25f);
+            }
+        }
+    }
+}
+
+TEST(MatrixMixer, removed_motor)
+{
+    motors.set_initialised_ok(false);
+    motors.init(AP_Motors::MOTOR_FRAME_OCTA, AP_Motors::MOTOR_FRAME_TYPE_X);
+    motors.set_dt_s(1.0 / 400);
+    motors.set_throttle_avg_max(0.5f);
+    motors.set_yaw_headroom(200);
+
+    // the mixing matrix must follow motors being removed and the yaw
+    // torque being disabled
+    motors.remove_motor(AP_MOTORS_MOT_3);
+    for (uint16_t i = 0; i < 2000; i++) {
+        check_mix(rand_range(1.0f), rand_range(1.0f), rand_range(1.0f), 0.5f + rand_range(0.5f), 0);
+    }
+    motors.disable_yaw_torque();
+    for (uint16_t i = 0; i < 2000; i++) {
+        check_mix(rand_range(1.0f), rand_range(1.0f), rand_range(1.0f), 0.5f + rand_range(0.5f), 0);
+    }
+}
+
+AP_GTEST_MAIN()
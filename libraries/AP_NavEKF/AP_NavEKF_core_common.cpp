@@ -33,3 +33,39 @@ void NavEKF_core_common::fill_scratch_variables(void)
     fill_nanf(&Kfusion[0], sizeof(Kfusion)/sizeof(ftype));
 #endif
 }
+
+/*
+  form the row H*P for a scalar observation using only the nonzero
+  elements of H
+ */
+void NavEKF_core_common::sparse_HP(const Matrix24 &P, const ftype *H, const uint8_t *Hidx, uint8_t Hnum, uint8_t lim, ftype *HP)
+{
+    for (uint8_t c=0; c<=lim; c++) {
+        ftype res = 0;
+        for (uint8_t k=0; k<Hnum; k++) {
+            res += H[Hidx[k]] * P[Hidx[k]][c];
+        }
+        HP[c] = res;
+    }
+}
+
+/*
+  update the covariance as P = P - K*HP. K*HP is the outer product of
+  two vectors, so rather than forming it only the lower triangle is
+  computed and mirrored
+ */
+void NavEKF_core_common::symmetric_rank1_update(Matrix24 &P, const ftype *K, const ftype *HP, uint8_t lim)
+{
+    for (uint8_t r=0; r<=lim; r++) {
+        const ftype Kr = K[r];
+        const ftype HPr = HP[r];
+        for (uint8_t c=0; c<=r; c++) {
+            // P must end up symmetric, so average the upper and lower
+            // differences, then store that result in both positions. we
+            // have no good proof P was symmetric before!
+            const ftype res = 0.5f*((P[r][c] + P[c][r]) - (Kr * HP[c] + K[c] * HPr));
+            P[r][c] = res;
+            P[c][r] = res;
+        }
+    }
+}
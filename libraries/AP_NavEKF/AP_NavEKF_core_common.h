@@ -48,6 +48,17 @@ protected:
     // fill all the common scratch variables with NaN on SITL
     void fill_scratch_variables(void);
 
+    /*
+      sequential fusion of a scalar observation with a sparse
+      observation Jacobian H. H is indexed by state and only the Hnum
+      states listed in Hidx are read. lim is the last state index used
+    */
+    // form the single row H*P
+    static void sparse_HP(const Matrix24 &P, const ftype *H, const uint8_t *Hidx, uint8_t Hnum, uint8_t lim, ftype *HP);
+
+    // update P = P - K*HP as a symmetric rank-1 update, keeping P symmetric
+    static void symmetric_rank1_update(Matrix24 &P, const ftype *K, const ftype *HP, uint8_t lim);
+
     // zero part of an array for index range [n1,n2]
     static void zero_range(ftype *v, uint8_t n1, uint8_t n2) {
         memset(&v[n1], 0, sizeof(ftype)*(1+(n2-n1)));
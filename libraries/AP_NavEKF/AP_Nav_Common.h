@@ -106,4 +106,11 @@ struct ekf_timing {
     float delVelDT_min;
 };
 
+/*
+  number of models in the EKF-GSF yaw estimator bank. More models give
+  a finer initial yaw spacing and faster convergence after a reset at
+  the cost of memory and CPU. Logging requires at least 5
+ */
+#ifndef N_MODELS_EKFGSF
 #define N_MODELS_EKFGSF 5U
+#endif
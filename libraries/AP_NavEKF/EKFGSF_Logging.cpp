@@ -14,22 +14,28 @@ void EKFGSF_yaw::Log_Write(uint64_t time_us, LogMessages id0, LogMessages id1, u
 
     static_assert(N_MODELS_EKFGSF >= 5, "Logging will break on <5 EKFGSF models");
 
+    // log 5 models evenly spaced around the bank
+    uint8_t m[5];
+    for (uint8_t i = 0; i < ARRAY_SIZE(m); i++) {
+        m[i] = i * N_MODELS_EKFGSF / ARRAY_SIZE(m);
+    }
+
     const struct log_KY0 ky0{
         LOG_PACKET_HEADER_INIT(id0),
         time_us                 : time_us,
         core                    : core_index,
         yaw_composite           : wrap_360(degrees(GSF.yaw)),
         yaw_composite_variance  : sqrtF(MAX(degrees(GSF.yaw_variance), 0.0f)),
-        yaw0                    : wrap_360(degrees(EKF[0].X[2])),
-        yaw1                    : wrap_360(degrees(EKF[1].X[2])),
-        yaw2                    : wrap_360(degrees(EKF[2].X[2])),
-        yaw3                    : wrap_360(degrees(EKF[3].X[2])),
-        yaw4                    : wrap_360(degrees(EKF[4].X[2])),
-        wgt0                    : GSF.weights[0],
-        wgt1                    : GSF.weights[1],
-        wgt2                    : GSF.weights[2],
-        wgt3                    : GSF.weights[3],
-        wgt4                    : GSF.weights[4],
+        yaw0                    : wrap_360(degrees(EKF.X[2][m[0]])),
+        yaw1                    : wrap_360(degrees(EKF.X[2][m[1]])),
+        yaw2                    : wrap_360(degrees(EKF.X[2][m[2]])),
+        yaw3                    : wrap_360(degrees(EKF.X[2][m[3]])),
+        yaw4                    : wrap_360(degrees(EKF.X[2][m[4]])),
+        wgt0                    : GSF.weights[m[0]],
+        wgt1                    : GSF.weights[m[1]],
+        wgt2                    : GSF.weights[m[2]],
+        wgt3                    : GSF.weights[m[3]],
+        wgt4                    : GSF.weights[m[4]],
     };
     AP::logger().WriteBlock(&ky0, sizeof(ky0));
 
@@ -37,16 +43,16 @@ void EKFGSF_yaw::Log_Write(uint64_t time_us, LogMessages id0, LogMessages id1, u
         LOG_PACKET_HEADER_INIT(id1),
         time_us                 : time_us,
         core                    : core_index,
-        ivn0                    : EKF[0].innov[0],
-        ivn1                    : EKF[1].innov[0],
-        ivn2                    : EKF[2].innov[0],
-        ivn3                    : EKF[3].innov[0],
-        ivn4                    : EKF[4].innov[0],
-        ive0                    : EKF[0].innov[1],
-        ive1                    : EKF[1].innov[1],
-        ive2                    : EKF[2].innov[1],
-        ive3                    : EKF[3].innov[1],
-        ive4                    : EKF[4].innov[1],
+        ivn0                    : EKF.innov[0][m[0]],
+        ivn1                    : EKF.innov[0][m[1]],
+        ivn2                    : EKF.innov[0][m[2]],
+        ivn3                    : EKF.innov[0][m[3]],
+        ivn4                    : EKF.innov[0][m[4]],
+        ive0                    : EKF.innov[1][m[0]],
+        ive1                    : EKF.innov[1][m[1]],
+        ive2                    : EKF.innov[1][m[2]],
+        ive3                    : EKF.innov[1][m[3]],
+        ive4                    : EKF.innov[1][m[4]],
     };
     AP::logger().WriteBlock(&ky1, sizeof(ky1));
 }
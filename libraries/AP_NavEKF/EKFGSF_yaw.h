@@ -68,31 +68,29 @@ private:
     // Declarations used by the bank of AHRS complementary filters that use IMU data augmented by true
     // airspeed data when in fixed wing mode to estimate the quaternions that are used to rotate IMU data into a
     // Front, Right, Yaw frame of reference.
+    // The AHRS and EKF banks are stored as a structure of arrays indexed by model so that each
+    // step is a single loop across all models.
     Vector3F delta_angle;
     Vector3F delta_velocity;
     ftype angle_dt;
     ftype velocity_dt;
-    struct ahrs_struct {
-        Matrix3F R;             // matrix that rotates a vector from body to earth frame
-        Vector3F gyro_bias;     // gyro bias learned and used by the quaternion calculation
-        bool aligned;           // true when AHRS has been aligned
-        ftype accel_FR[2];      // front-right acceleration vector in a horizontal plane (m/s/s)
-        ftype vel_NE[2];        // NE velocity vector from last GPS measurement (m/s)
-        bool fuse_gps;          // true when GPS should be fused on that frame
-        ftype accel_dt;         // time step used when generating _simple_accel_FR data (sec)
+    struct ahrs_bank {
+        ftype R[3][3][N_MODELS_EKFGSF];         // matrices that rotate a vector from body to earth frame
+        ftype gyro_bias[3][N_MODELS_EKFGSF];    // gyro bias learned and used by the rotation matrix calculation (rad/sec)
     };
-    ahrs_struct AHRS[N_MODELS_EKFGSF];
+    ahrs_bank AHRS;
     bool ahrs_tilt_aligned;         // true the initial tilt alignment has been calculated
     ftype accel_gain;               // gain from accel vector tilt error to rate gyro correction used by AHRS calculation
     Vector3F ahrs_accel;            // filtered body frame specific force vector used by AHRS calculation (m/s/s)
     ftype ahrs_accel_norm;          // length of body frame specific force vector used by AHRS calculation (m/s/s)
     ftype true_airspeed;            // true airspeed used to correct for centripetal acceleratoin in coordinated turns (m/s)
 
-    // Runs quaternion prediction for the selected AHRS using IMU (and optionally true airspeed) data
-    void predictAHRS(const uint8_t mdl_idx);
+    // Runs the rotation matrix prediction for all AHRS using IMU (and optionally true airspeed) data
+    void predictAHRS();
 
-    // Applies a body frame delta angle to a body to earth frame rotation matrix using a small angle approximation
-    Matrix3F updateRotMat(const Matrix3F &R, const Vector3F &g) const;
+    // get and set the body to earth frame rotation matrix for a single model
+    Matrix3F getRotMat(const uint8_t mdl_idx) const;
+    void setRotMat(const uint8_t mdl_idx, const Matrix3F &R);
 
     // Initialises the tilt (roll and pitch) for all AHRS using IMU acceleration data
     void alignTilt();
@@ -102,28 +100,32 @@ private:
 
     // The Following declarations are used by bank of EKF's that estimate yaw angle starting from a different yaw hypothesis for each filter.
 
-    struct EKF_struct {
-        ftype X[3];     // Vel North (m/s),  Vel East (m/s), yaw (rad)
-        ftype P[3][3];  // covariance matrix
-        ftype S[2][2];  // N,E velocity innovation variance (m/s)^2
-        ftype innov[2]; // Velocity N,E innovation (m/s)
+    struct ekf_bank {
+        ftype X[3][N_MODELS_EKFGSF];    // Vel North (m/s),  Vel East (m/s), yaw (rad)
+        ftype P00[N_MODELS_EKFGSF];     // upper triangle of the symmetric covariance matrix
+        ftype P01[N_MODELS_EKFGSF];
+        ftype P02[N_MODELS_EKFGSF];
+        ftype P11[N_MODELS_EKFGSF];
+        ftype P12[N_MODELS_EKFGSF];
+        ftype P22[N_MODELS_EKFGSF];
+        ftype S00[N_MODELS_EKFGSF];     // upper triangle of the N,E velocity innovation variance (m/s)^2
+        ftype S01[N_MODELS_EKFGSF];
+        ftype S11[N_MODELS_EKFGSF];
+        ftype innov[2][N_MODELS_EKFGSF];// Velocity N,E innovation (m/s)
     };
-    EKF_struct EKF[N_MODELS_EKFGSF];
+    ekf_bank EKF;
     bool vel_fuse_running;  // true when the bank of EKF's has started fusing GPS velocity data
     bool run_ekf_gsf;       // true when operating condition is suitable for to run the GSF and EKF models and fuse velocity data
 
     // Resets states and covariances for the EKF's and GSF including GSF weights, but not the AHRS complementary filters
     void resetEKFGSF();
 
-    // Runs the state and covariance prediction for the selected EKF
-    void predict(const uint8_t mdl_idx);
+    // Runs the state and covariance prediction for all EKF's
+    void predict();
 
-    // Runs the state and covariance update for the selected EKF using the GPS NE velocity measurement
-    // Returns false if the sttae and covariance correction failed
-    bool correct(const uint8_t mdl_idx, const Vector2F &vel, const ftype velObsVar);
-
-    // Forces symmetry on the covariance matrix for the selected EKF
-    void forceSymmetry(const uint8_t mdl_idx);
+    // Runs the state and covariance update for all EKF's using the GPS NE velocity measurement
+    // Returns false if the state and covariance correction failed for any model
+    bool correct(const Vector2F &vel, const ftype velObsVar);
 
     // The following declarations are used  by the Gaussian Sum Filter that combines the state estimates from the bank of
     // EKF's to form a single state estimate.
@@ -135,9 +137,9 @@ private:
     };
     GSF_struct GSF;
 
-    // Returns the probability for a selected model assuming a Gaussian error distribution
+    // Calculates the probability for each model assuming a Gaussian error distribution
     // Used by the Gaussian Sum Filter to calculate the weightings when combining the outputs from the bank of EKF's
-    ftype gaussianDensity(const uint8_t mdl_idx) const;
+    void gaussianDensity(ftype density[N_MODELS_EKFGSF]) const;
 
     // number of models whose weights underflowed due to excessive
     // innovation variances:
@@ -7,11 +7,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <AP_InternalError/AP_InternalError.h>
+#include <AP_Math/AP_Math.h>
 
 // constructor
 ekf_ring_buffer::ekf_ring_buffer(uint8_t _elsize) :
     elsize(_elsize),
-    buffer(nullptr)
+    buffer(nullptr),
+    size(0)
 {}
 
 bool ekf_ring_buffer::init(uint8_t _size)
@@ -24,10 +26,43 @@ bool ekf_ring_buffer::init(uint8_t _size)
         return false;
     }
     size = _size;
+    max_count = 0;
+    overflows = 0;
+    last_recall_ms = 0;
     reset();
     return true;
 }
 
+/*
+  change the number of elements the buffer can hold, keeping the
+  newest data
+ */
+bool ekf_ring_buffer::resize(uint8_t new_size)
+{
+    if (buffer == nullptr || new_size == 0) {
+        return false;
+    }
+    void *new_buffer = calloc(new_size, elsize);
+    if (new_buffer == nullptr) {
+        return false;
+    }
+    // copy the newest elements in order, oldest first
+    const uint8_t keep = MIN(count, new_size);
+    uint8_t idx = (oldest + (count - keep)) % size;
+    for (uint8_t i=0; i<keep; i++) {
+        memcpy(((uint8_t*)new_buffer)+i*uint32_t(elsize), get_offset(idx), elsize);
+        idx = next(idx);
+    }
+    free(buffer);
+    buffer = new_buffer;
+    size = new_size;
+    oldest = 0;
+    count = keep;
+    max_count = keep;
+    overflows = 0;
+    return true;
+}
+
 /*
   get buffer offset for an index
  */
@@ -52,6 +87,8 @@ uint32_t ekf_ring_buffer::time_ms(uint8_t idx) const
 */
 bool ekf_ring_buffer::recall(void *element, const uint32_t sample_time_ms)
 {
+    last_recall_ms = sample_time_ms;
+
     bool ret = false;
     uint8_t best_index = 0;  // only valid when ret becomes true
     while (count > 0) {
@@ -69,7 +106,7 @@ bool ekf_ring_buffer::recall(void *element, const uint32_t sample_time_ms)
         }
         // discard the sample
         count--;
-        oldest = (oldest+1) % size;
+        oldest = next(oldest);
     }
 
     if (ret) {
@@ -90,15 +127,26 @@ void ekf_ring_buffer::push(const void *element)
     }
 
     // Advance head to next available index
-    const uint8_t head = (oldest+count) % size;
+    uint16_t head = oldest + count;
+    if (head >= size) {
+        head -= size;
+    }
 
     // New data is written at the head
     memcpy(get_offset(head), element, elsize);
 
     if (count < size) {
         count++;
+        max_count = MAX(max_count, count);
     } else {
-        oldest = (oldest+1) % size;
+        // the oldest element is discarded. Only count this as an
+        // overflow if the buffer is being recalled from, buffers for
+        // sensors that are not being fused are expected to be full
+        oldest = next(oldest);
+        const uint32_t t = ((const EKF_obs_element_t *)element)->time_ms;
+        if (last_recall_ms != 0 && t - last_recall_ms < 1000 && overflows < UINT16_MAX) {
+            overflows++;
+        }
     }
 }
 
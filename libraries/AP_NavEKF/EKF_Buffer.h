@@ -39,6 +39,26 @@ public:
     // zeroes all data in the ring buffer
     void reset();
 
+    /*
+     * change the number of elements the buffer can hold, keeping the
+     * newest data. Returns false when allocation has failed, leaving
+     * the buffer unchanged
+     */
+    bool resize(uint8_t new_size);
+
+    // number of elements the buffer can hold
+    uint8_t get_size() const { return size; }
+
+    // most elements held at once since the buffer was sized
+    uint8_t get_max_count() const { return max_count; }
+
+    // number of elements discarded before they could be recalled
+    // while the buffer was being recalled from
+    uint16_t get_overflows() const { return overflows; }
+
+    // bytes of allocated storage
+    uint32_t get_memory_used() const { return buffer == nullptr ? 0 : size * uint32_t(elsize); }
+
 private:
     const uint8_t elsize;
     void *buffer;
@@ -52,8 +72,21 @@ private:
     // total number of elements in the buffer
     uint8_t count;
 
+    // usage statistics, used to size the buffer to the sensor rate
+    uint8_t max_count;
+    uint16_t overflows;
+
+    // sample time of the last recall, zero if never recalled
+    uint32_t last_recall_ms;
+
     uint32_t time_ms(uint8_t idx) const;
     void *get_offset(uint8_t idx) const;
+
+    // advance an index by one element
+    uint8_t next(uint8_t idx) const {
+        idx++;
+        return idx == size ? 0 : idx;
+    }
 };
 
 /*
@@ -86,6 +119,15 @@ public:
     void reset() {
         return ekf_ring_buffer::reset();
     }
+
+    bool resize(uint8_t new_size) {
+        return ekf_ring_buffer::resize(new_size);
+    }
+
+    using ekf_ring_buffer::get_size;
+    using ekf_ring_buffer::get_max_count;
+    using ekf_ring_buffer::get_overflows;
+    using ekf_ring_buffer::get_memory_used;
 };
 
 
@@ -133,6 +175,11 @@ public:
         return _youngest;
     }
 
+    // bytes of allocated storage
+    uint32_t get_memory_used() const {
+        return buffer == nullptr ? 0 : _size * uint32_t(elsize);
+    }
+
 protected:
     const uint8_t elsize;
     void *buffer;
@@ -202,4 +249,9 @@ public:
     inline uint8_t get_youngest_index() {
         return ekf_imu_buffer::get_youngest_index();
     }
+
+    // bytes of allocated storage
+    uint32_t get_memory_used() const {
+        return ekf_imu_buffer::get_memory_used();
+    }
 };
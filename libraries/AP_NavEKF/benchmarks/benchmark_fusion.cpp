@@ -0,0 +1,169 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  benchmarks for the EKF3 scalar fusion covariance update, comparing
+  the old path of forming the full K*H*P product before subtracting it
+  from P against the symmetric rank-1 update, for the observation
+  Jacobian sparsity of each fusion type
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF/AP_NavEKF_core_common.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class FusionBenchmark : public NavEKF_core_common {
+public:
+    using NavEKF_core_common::Matrix24;
+    using NavEKF_core_common::sparse_HP;
+    using NavEKF_core_common::symmetric_rank1_update;
+
+    // the path used before the rank-1 update, forming KHP in full
+    static void dense_update(Matrix24 &P, const ftype *K, const ftype *H, const uint8_t *Hidx, uint8_t Hnum, uint8_t lim) {
+        for (uint8_t i=0; i<=lim; i++) {
+            for (uint8_t j=0; j<=lim; j++) {
+                ftype res = 0;
+                for (uint8_t k=0; k<Hnum; k++) {
+                    res += (K[i] * H[Hidx[k]]) * P[Hidx[k]][j];
+                }
+                KHP[i][j] = res;
+            }
+        }
+        for (uint8_t r=0; r<=lim; r++) {
+            for (uint8_t c=0; c<=r; c++) {
+                const ftype res = 0.5f*((P[r][c] - KHP[r][c]) + (P[c][r] - KHP[c][r]));
+                P[r][c] = res;
+                P[c][r] = res;
+            }
+        }
+    }
+};
+
+// nonzero elements of H for each fusion type
+static const struct {
+    const char *name;
+    uint8_t num;
+    uint8_t idx[9];
+} fusion_types[] = {
+    { "VelPosNED", 1, { 4 } },
+    { "Magnetometer", 8, { 0, 1, 2, 3, 16, 17, 18, 19 } },
+    { "EulerYaw", 4, { 0, 1, 2, 3 } },
+    { "Declination", 2, { 16, 17 } },
+    { "Airspeed", 5, { 4, 5, 6, 22, 23 } },
+    { "Sideslip/Drag", 9, { 0, 1, 2, 3, 4, 5, 6, 22, 23 } },
+    { "OptFlow/BodyVel", 7, { 0, 1, 2, 3, 4, 5, 6 } },
+    { "RngBcn", 3, { 7, 8, 9 } },
+};
+
+/*
+  a covariance typical of a converged filter in flight: state
+  uncertainties of the magnitudes seen in flight logs, with moderate
+  correlation between all states
+ */
+static void setup_covariance(FusionBenchmark::Matrix24 &P)
+{
+    static const ftype sigma[24] {
+        0.01, 0.01, 0.01, 0.02,     // quaternion
+        0.2, 0.2, 0.3,              // velocity
+        1.0, 1.0, 2.0,              // position
+        1e-4, 1e-4, 1e-4,           // delta angle bias
+        1e-3, 1e-3, 2e-3,           // delta velocity bias
+        0.01, 0.01, 0.01,           // earth field
+        0.005, 0.005, 0.005,        // body field
+        1.0, 1.0                    // wind
+    };
+    // deterministic pseudo-random loading vectors, giving a positive
+    // definite correlation matrix
+    ftype L[24][4];
+    uint32_t seed = 0x1234567;
+    for (uint8_t i=0; i<24; i++) {
+        for (uint8_t k=0; k<4; k++) {
+            seed = seed * 1664525U + 1013904223U;
+            L[i][k] = ftype(seed >> 8) / ftype(1U<<24) - 0.5f;
+        }
+    }
+    for (uint8_t i=0; i<24; i++) {
+        for (uint8_t j=0; j<24; j++) {
+            ftype c = (i == j) ? 1.0f : 0.0f;
+            for (uint8_t k=0; k<4; k++) {
+                c += 0.2f * L[i][k] * L[j][k];
+            }
+            P[i][j] = sigma[i] * sigma[j] * c;
+        }
+    }
+}
+
+static void setup_fusion(uint8_t type, FusionBenchmark::Matrix24 &P, ftype H[24], ftype K[24])
+{
+    setup_covariance(P);
+    for (uint8_t s=0; s<24; s++) {
+        H[s] = 0;
+    }
+    const auto &f = fusion_types[type];
+    for (uint8_t k=0; k<f.num; k++) {
+        H[f.idx[k]] = (k & 1) ? -0.7f : 1.3f;
+    }
+    // Kalman gain for an observation noise equal to the predicted variance
+    ftype HP[24];
+    FusionBenchmark::sparse_HP(P, H, f.idx, f.num, 23, HP);
+    ftype HPHT = 0;
+    for (uint8_t k=0; k<f.num; k++) {
+        HPHT += H[f.idx[k]] * HP[f.idx[k]];
+    }
+    for (uint8_t s=0; s<24; s++) {
+        K[s] = HP[s] / (2 * HPHT);
+    }
+}
+
+static void BM_FusionDense(benchmark::State& state)
+{
+    const uint8_t type = state.range(0);
+    // matrices are static to keep within the EKF stack frame limit
+    static FusionBenchmark::Matrix24 P0, P;
+    ftype H[24], K[24];
+    setup_fusion(type, P0, H, K);
+    const auto &f = fusion_types[type];
+    state.SetLabel(f.name);
+
+    while (state.KeepRunning()) {
+        // start every iteration from the same covariance
+        memcpy(&P, &P0, sizeof(P));
+        FusionBenchmark::dense_update(P, K, H, f.idx, f.num, 23);
+        gbenchmark_escape(&P);
+    }
+}
+
+static void BM_FusionRank1(benchmark::State& state)
+{
+    const uint8_t type = state.range(0);
+    // matrices are static to keep within the EKF stack frame limit
+    static FusionBenchmark::Matrix24 P0, P;
+    ftype H[24], K[24];
+    setup_fusion(type, P0, H, K);
+    const auto &f = fusion_types[type];
+    state.SetLabel(f.name);
+
+    while (state.KeepRunning()) {
+        // start every iteration from the same covariance
+        memcpy(&P, &P0, sizeof(P));
+        ftype HP[24];
+        FusionBenchmark::sparse_HP(P, H, f.idx, f.num, 23, HP);
+        FusionBenchmark::symmetric_rank1_update(P, K, HP, 23);
+        gbenchmark_escape(&P);
+    }
+}
+
+BENCHMARK(BM_FusionDense)->DenseRange(0, ARRAY_SIZE(fusion_types)-1);
+BENCHMARK(BM_FusionRank1)->DenseRange(0, ARRAY_SIZE(fusion_types)-1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,197 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  benchmarks for the EKF-GSF yaw estimator. The estimator is fed
+  simulated IMU and GPS velocity data from a fixed wing vehicle that
+  flies straight and level before rolling into a coordinated turn.
+
+  BM_GSFUpdate and BM_GSFFuseVel time the IMU update and the GPS
+  velocity fusion steps for the whole bank. BM_GSFConvergence times a
+  complete yaw reset from a range of true headings and reports how long
+  the bank took to converge in its label.
+
+  Build with a different N_MODELS_EKFGSF to compare bank sizes.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF/EKFGSF_yaw.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t imu_rate_hz = 400;
+static const uint8_t gps_rate_hz = 5;
+static const ftype airspeed = 20.0f;            // m/s
+static const ftype straight_time = 2.0f;        // time flying straight before rolling into the turn (s)
+static const ftype max_bank = radians(30.0f);
+static const ftype roll_rate = radians(30.0f);  // rad/s
+static const ftype max_sim_time = 60.0f;        // s
+
+/*
+  truth for a vehicle in coordinated flight with no wind, so the
+  velocity is along the heading and the turn rate follows from the
+  bank angle
+ */
+class TurnSim {
+public:
+    TurnSim(ftype initial_yaw) :
+        t(0),
+        roll(0),
+        yaw(initial_yaw)
+    {}
+
+    // advance the truth by one IMU sample, returning the IMU deltas
+    void step(Vector3F &delAng, Vector3F &delVel) {
+        const ftype dt = 1.0f / imu_rate_hz;
+        const Matrix3F R_prev = rotation();
+        const Vector3F vel_prev = velocity();
+
+        t += dt;
+        roll = constrain_ftype((t - straight_time) * roll_rate, 0.0f, max_bank);
+        yaw = wrap_PI(yaw + GRAVITY_MSS * tanF(roll) / airspeed * dt);
+
+        // small angle rotation between the two attitudes in body frame
+        const Matrix3F dR = R_prev.transposed() * rotation();
+        delAng = Vector3F{dR.c.y - dR.b.z, dR.a.z - dR.c.x, dR.b.x - dR.a.y} * 0.5f;
+
+        // specific force is the change in velocity less gravity
+        const Vector3F dv_ef = velocity() - vel_prev - Vector3F{0.0f, 0.0f, GRAVITY_MSS * dt};
+        delVel = R_prev.transposed() * dv_ef;
+    }
+
+    // body to earth frame rotation
+    Matrix3F rotation() const {
+        Matrix3F R;
+        R.from_euler(roll, 0.0f, yaw);
+        return R;
+    }
+
+    // NED velocity
+    Vector3F velocity() const {
+        return Vector3F{cosF(yaw), sinF(yaw), 0.0f} * airspeed;
+    }
+
+    // true when a GPS velocity measurement is due
+    bool gps_due() const {
+        return (step_count() % (imu_rate_hz / gps_rate_hz)) == 0;
+    }
+
+    uint32_t step_count() const {
+        return uint32_t(t * imu_rate_hz + 0.5f);
+    }
+
+    ftype t;        // time since start (s)
+    ftype roll;
+    ftype yaw;
+};
+
+// step the estimator and truth by one IMU sample
+static void sim_step(EKFGSF_yaw &gsf, TurnSim &sim)
+{
+    Vector3F delAng, delVel;
+    sim.step(delAng, delVel);
+    const ftype dt = 1.0f / imu_rate_hz;
+    gsf.update(delAng, delVel, dt, dt, true, airspeed);
+    if (sim.gps_due()) {
+        const Vector3F vel = sim.velocity();
+        gsf.fuseVelData(Vector2F{vel.x, vel.y}, 0.5f);
+    }
+}
+
+/*
+  run a yaw reset from the given true heading, returning the time from
+  rolling into the turn until the yaw estimate has had a variance below the accuracy threshold
+  used by EKF3 for five consecutive fusions, or a negative value if it
+  did not converge
+ */
+static ftype convergence_time(EKFGSF_yaw &gsf, ftype initial_yaw, ftype &yaw_error)
+{
+    TurnSim sim{initial_yaw};
+    uint8_t valid_count = 0;
+    while (sim.t < max_sim_time) {
+        sim_step(gsf, sim);
+        ftype yaw, yaw_variance;
+        if (sim.gps_due() && gsf.getYawData(yaw, yaw_variance)) {
+            if (yaw_variance < sq(radians(15.0f))) {
+                valid_count++;
+            } else {
+                valid_count = 0;
+            }
+            if (valid_count >= 5) {
+                yaw_error = wrap_PI(yaw - sim.yaw);
+                return sim.t - straight_time;
+            }
+        }
+    }
+    return -1;
+}
+
+// estimator in a steady turn with the bank converged
+static EKFGSF_yaw *converged_gsf(TurnSim &sim)
+{
+    EKFGSF_yaw *gsf = NEW_NOTHROW EKFGSF_yaw();
+    while (sim.t < straight_time + 20.0f) {
+        sim_step(*gsf, sim);
+    }
+    return gsf;
+}
+
+static void BM_GSFUpdate(benchmark::State& state)
+{
+    TurnSim sim{radians(20.0f)};
+    EKFGSF_yaw *gsf = converged_gsf(sim);
+    Vector3F delAng, delVel;
+    sim.step(delAng, delVel);
+    const ftype dt = 1.0f / imu_rate_hz;
+
+    while (state.KeepRunning()) {
+        gsf->update(delAng, delVel, dt, dt, true, airspeed);
+        gbenchmark_escape(gsf);
+    }
+    delete gsf;
+}
+
+static void BM_GSFFuseVel(benchmark::State& state)
+{
+    TurnSim sim{radians(20.0f)};
+    EKFGSF_yaw *gsf = converged_gsf(sim);
+    const Vector3F vel = sim.velocity();
+
+    while (state.KeepRunning()) {
+        gsf->fuseVelData(Vector2F{vel.x, vel.y}, 0.5f);
+        gbenchmark_escape(gsf);
+    }
+    delete gsf;
+}
+
+static void BM_GSFConvergence(benchmark::State& state)
+{
+    // true headings spread around the circle, offset from the initial yaw hypotheses
+    const ftype initial_yaw = wrap_PI(radians(20.0f + 45.0f * state.range(0)));
+    char label[64];
+
+    while (state.KeepRunning()) {
+        EKFGSF_yaw *gsf = NEW_NOTHROW EKFGSF_yaw();
+        ftype yaw_error = 0;
+        const ftype t = convergence_time(*gsf, initial_yaw, yaw_error);
+        snprintf(label, sizeof(label), "yaw %.0f: converged %.2fs err %.2fdeg",
+                 (double)degrees(initial_yaw), (double)t, (double)degrees(yaw_error));
+        delete gsf;
+    }
+    state.SetLabel(label);
+}
+
+BENCHMARK(BM_GSFUpdate);
+BENCHMARK(BM_GSFFuseVel);
+BENCHMARK(BM_GSFConvergence)->DenseRange(0, 7);
+
+BENCHMARK_MAIN();
@@ -122,6 +122,63 @@ TEST(EKF_Buffer, EKF_Buffer)
     EXPECT_FALSE(buf.recall(d2, 103));
 }
 
+TEST(EKF_Buffer, resize)
+{
+    struct test_data : EKF_obs_element_t {
+        uint32_t data;
+    };
+    EKF_obs_buffer_t<test_data> buf;
+    buf.init(4);
+    EXPECT_EQ(buf.get_size(), 4U);
+    EXPECT_EQ(buf.get_memory_used(), 4*sizeof(test_data));
+
+    // wrap the buffer so the data is not at the start of the storage.
+    // Discarded data is not an overflow until the buffer is recalled from
+    struct test_data d, d2;
+    for (uint8_t i=0; i<6; i++) {
+        d.time_ms = 100+i;
+        d.data = 1000+i;
+        buf.push(d);
+    }
+    EXPECT_EQ(buf.get_max_count(), 4U);
+    EXPECT_EQ(buf.get_overflows(), 0U);
+    EXPECT_FALSE(buf.recall(d2, 90));
+    for (uint8_t i=6; i<8; i++) {
+        d.time_ms = 100+i;
+        d.data = 1000+i;
+        buf.push(d);
+    }
+    EXPECT_EQ(buf.get_overflows(), 2U);
+
+    // growing keeps all the data in order
+    EXPECT_TRUE(buf.resize(8));
+    EXPECT_EQ(buf.get_size(), 8U);
+    EXPECT_EQ(buf.get_overflows(), 0U);
+    d.time_ms = 108;
+    d.data = 1008;
+    buf.push(d);
+    for (uint8_t i=4; i<9; i++) {
+        EXPECT_TRUE(buf.recall(d2, 100+i));
+        EXPECT_EQ(d2.data, 1000U+i);
+    }
+    EXPECT_FALSE(buf.recall(d2, 109));
+
+    // shrinking keeps the newest data
+    for (uint8_t i=0; i<6; i++) {
+        d.time_ms = 200+i;
+        d.data = 2000+i;
+        buf.push(d);
+    }
+    EXPECT_TRUE(buf.resize(3));
+    EXPECT_EQ(buf.get_max_count(), 3U);
+    EXPECT_FALSE(buf.recall(d2, 202));
+    for (uint8_t i=3; i<6; i++) {
+        EXPECT_TRUE(buf.recall(d2, 200+i));
+        EXPECT_EQ(d2.data, 2000U+i);
+    }
+    EXPECT_FALSE(buf.resize(0));
+}
+
 TEST(ekf_imu_buffer, one_element_case)
 {
     // test degenerate 1-element case:
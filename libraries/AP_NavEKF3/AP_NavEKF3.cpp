@@ -1,6 +1,7 @@
 #include "AP_NavEKF3_core.h"
 
 #include "AP_NavEKF3.h"
+#include "AP_NavEKF3_LanePool.h"
 
 #include <AP_HAL/AP_HAL.h>
 
@@ -8,6 +9,7 @@
 #include <AP_Logger/AP_Logger.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_Common/ExpandingString.h>
 
 #include "AP_DAL/AP_DAL.h"
 
@@ -765,8 +767,8 @@ const AP_Param::GroupInfo NavEKF3::var_info2[] = {
 
     // @Param: OPTIONS
     // @DisplayName: Optional EKF behaviour
-    // @Description: EKF optional behaviour. Bit 0 (JammingExpected): Setting JammingExpected will change the EKF behaviour such that if dead reckoning navigation is possible it will require the preflight alignment GPS quality checks controlled by EK3_GPS_CHECK and EK3_CHECK_SCALE to pass before resuming GPS use if GPS lock is lost for more than 2 seconds to prevent bad position estimate. Bit 1 (Manual lane switching): DANGEROUS – If enabled, this disables automatic lane switching. If the active lane becomes unhealthy, no automatic switching will occur. Users must manually set EK3_PRIMARY to change lanes. No health checks will be performed on the selected lane. Use with extreme caution.  Bit 2 (Optflow may use terrain alt): Terrain SRTM data will be used if the vehicle climbs above the rangefinder's range allowing optical flow to be used at higher altitudes. Bit 3 (AGL KF for optflow scaling): Use a 2-state IMU-aided AGL Kalman filter (height + vertical velocity, fused with rangefinder) to compute the height-above-ground used for optical flow velocity scaling, instead of terrainState-pd. This decouples optical flow scaling from errors in the main filter's vertical position state.
-    // @Bitmask: 0:JammingExpected, 1:ManualLaneSwitching, 2:Optflow may use terrain alt, 3:AGL KF for optflow scaling
+    // @Description: EKF optional behaviour. Bit 0 (JammingExpected): Setting JammingExpected will change the EKF behaviour such that if dead reckoning navigation is possible it will require the preflight alignment GPS quality checks controlled by EK3_GPS_CHECK and EK3_CHECK_SCALE to pass before resuming GPS use if GPS lock is lost for more than 2 seconds to prevent bad position estimate. Bit 1 (Manual lane switching): DANGEROUS – If enabled, this disables automatic lane switching. If the active lane becomes unhealthy, no automatic switching will occur. Users must manually set EK3_PRIMARY to change lanes. No health checks will be performed on the selected lane. Use with extreme caution.  Bit 2 (Optflow may use terrain alt): Terrain SRTM data will be used if the vehicle climbs above the rangefinder's range allowing optical flow to be used at higher altitudes. Bit 3 (AGL KF for optflow scaling): Use a 2-state IMU-aided AGL Kalman filter (height + vertical velocity, fused with rangefinder) to compute the height-above-ground used for optical flow velocity scaling, instead of terrainState-pd. This decouples optical flow scaling from errors in the main filter's vertical position state. Bit 4 (Parallel lanes): Update each lane in isolation from the other lanes, and on Linux boards and SITL run the lanes concurrently on a pool of worker threads. Takes effect on reboot.
+    // @Bitmask: 0:JammingExpected, 1:ManualLaneSwitching, 2:Optflow may use terrain alt, 3:AGL KF for optflow scaling, 4:Parallel lanes
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  11, NavEKF3, _options, 0),
 
@@ -781,6 +783,63 @@ NavEKF3::NavEKF3() :
 }
 
 
+// update one lane, recording how long it took
+void NavEKF3::UpdateLane(uint8_t i)
+{
+    const uint32_t start_us = AP_HAL::micros();
+    core[i].UpdateFilter(lane_allow_prediction[i]);
+    const uint32_t dt_us = MIN(AP_HAL::micros() - start_us, uint32_t(UINT16_MAX));
+
+    LaneTiming &t = lane_timing[i];
+    t.sum_us += dt_us;
+    t.max_us = MAX(t.max_us, dt_us);
+    t.count++;
+}
+
+// update the lanes belonging to one executor of the lane pool
+void NavEKF3::UpdateLanes(uint8_t executor, uint8_t num_executors)
+{
+    for (uint8_t i=executor; i<num_cores; i+=num_executors) {
+        UpdateLane(i);
+    }
+}
+
+/*
+  update all lanes in isolation from each other. Each lane only reads
+  the DAL frame, which is captured before the lanes run, and its own
+  state. Anything a lane changes outside itself, such as the common
+  origin or the AHRS takeoff expectation, is only applied once all
+  lanes have completed, in lane order. This
+  makes the result independent of how lanes are scheduled, so logs
+  from the lane pool replay identically when the lanes are run
+  sequentially
+ */
+void NavEKF3::UpdateLanesIsolated(void)
+{
+    // work out which lanes may predict before any lane runs so the
+    // decision doesn't depend on how long the other lanes took
+    for (uint8_t i=0; i<num_cores; i++) {
+        lane_allow_prediction[i] = !(core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+                                     dal.ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i));
+    }
+
+    lanes_running = true;
+#if EK3_FEATURE_PARALLEL_LANES
+    if (lane_pool != nullptr) {
+        lane_pool->run();
+    } else
+#endif
+    {
+        UpdateLanes(0, 1);
+    }
+    lanes_running = false;
+
+    // apply anything a lane changed outside itself during this update
+    for (uint8_t i=0; i<num_cores; i++) {
+        core[i].publishPending();
+    }
+}
+
 // Initialise the filter
 bool NavEKF3::InitialiseFilter(void)
 {
@@ -857,6 +916,20 @@ bool NavEKF3::InitialiseFilter(void)
         for (uint8_t i = 0; i < num_cores; i++) {
             new (&core[i]) NavEKF3_core(this, dal);
         }
+
+        isolate_lanes = option_is_enabled(Option::ParallelLanes);
+#if EK3_FEATURE_PARALLEL_LANES
+        if (isolate_lanes && num_cores > 1) {
+            lane_pool = NEW_NOTHROW NavEKF3_LanePool(*this);
+            if (lane_pool != nullptr && !lane_pool->init(num_cores-1)) {
+                delete lane_pool;
+                lane_pool = nullptr;
+            }
+            if (lane_pool == nullptr) {
+                GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "EKF3 lane workers failed, running lanes sequentially");
+            }
+        }
+#endif
     }
 
     // Set up any cores that have been created
@@ -943,19 +1016,31 @@ void NavEKF3::UpdateFilter(void)
 
     imuSampleTime_us = dal.micros64();
 
-    for (uint8_t i=0; i<num_cores; i++) {
-        // if we have not overrun by more than 3 IMU frames, and we
-        // have already used more than 1/3 of the CPU budget for this
-        // loop then suppress the prediction step. This allows
-        // multiple EKF instances to cooperate on scheduling
-        bool allow_state_prediction = true;
-        if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
-            dal.ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
-            allow_state_prediction = false;
+    const uint32_t frame_start_us = AP_HAL::micros();
+
+    if (isolate_lanes) {
+        UpdateLanesIsolated();
+    } else {
+        for (uint8_t i=0; i<num_cores; i++) {
+            // if we have not overrun by more than 3 IMU frames, and we
+            // have already used more than 1/3 of the CPU budget for this
+            // loop then suppress the prediction step. This allows
+            // multiple EKF instances to cooperate on scheduling
+            bool allow_state_prediction = true;
+            if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+                dal.ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
+                allow_state_prediction = false;
+            }
+            lane_allow_prediction[i] = allow_state_prediction;
+            UpdateLane(i);
         }
-        core[i].UpdateFilter(allow_state_prediction);
     }
 
+    const uint32_t frame_us = MIN(AP_HAL::micros() - frame_start_us, uint32_t(UINT16_MAX));
+    frame_timing.sum_us += frame_us;
+    frame_timing.max_us = MAX(frame_timing.max_us, frame_us);
+    frame_timing.count++;
+
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
     // Don't start running the check until the primary core has started returned healthy for at least 10 seconds to avoid switching
     // due to initial alignment fluctuations and race conditions
@@ -1046,6 +1131,18 @@ void NavEKF3::UpdateFilter(void)
     sources.align_inactive_sources();
 }
 
+// report data buffer sizes, usage and memory for each core
+void NavEKF3::buffer_info(ExpandingString &str) const
+{
+    if (!core) {
+        return;
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        str.printf("EKF3 ");
+        core[i].buffer_info(str);
+    }
+}
+
 /*
   check if switching lanes will reduce the normalised
   innovations. This is called when the vehicle code is about to
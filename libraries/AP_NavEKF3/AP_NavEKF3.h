@@ -25,11 +25,15 @@
 #include <AP_NavEKF/AP_Nav_Common.h>
 #include <AP_NavEKF/AP_NavEKF_Source.h>
 
+#include "AP_NavEKF3_feature.h"
+
 class NavEKF3_core;
+class NavEKF3_LanePool;
 class EKFGSF_yaw;
 
 class NavEKF3 {
     friend class NavEKF3_core;
+    friend class NavEKF3_LanePool;
 
 public:
     NavEKF3();
@@ -352,6 +356,9 @@ public:
     // write EKF information to on-board logs
     void Log_Write();
 
+    // report data buffer sizes, usage and memory for each core
+    void buffer_info(class ExpandingString &str) const;
+
     // are we using (aka fusing) a non-compass yaw?
     bool using_noncompass_for_yaw() const;
 
@@ -480,6 +487,7 @@ private:
         ManualLaneSwitch        = (1<<1),
         OptflowMayUseTerrainAlt = (1<<2),
         AglKfForOptflow         = (1<<3),  // Use IMU-aided 2-state AGL KF for optflow scaling
+        ParallelLanes           = (1<<4),  // run lanes concurrently on worker threads
     };
     bool option_is_enabled(Option option) const {
         return (_options & (uint32_t)option) != 0;
@@ -568,6 +576,42 @@ private:
     // origin set by one of the cores
     Location common_EKF_origin;
     bool common_origin_valid;
+
+    // lanes are updated in isolation from each other, latched from
+    // the ParallelLanes option when the cores are created
+    bool isolate_lanes;
+    // true while lanes may be running concurrently
+    bool lanes_running;
+    bool lane_allow_prediction[MAX_EKF_CORES];
+#if EK3_FEATURE_PARALLEL_LANES
+    NavEKF3_LanePool *lane_pool;
+#endif
+
+    // per lane UpdateFilter timing, reset when logged
+    struct LaneTiming {
+        uint32_t sum_us;
+        uint16_t max_us;
+        uint16_t count;
+    } lane_timing[MAX_EKF_CORES];
+    struct {
+        uint32_t sum_us;
+        uint16_t max_us;
+        uint16_t count;
+    } frame_timing;
+    uint32_t lastLaneTimingLog_ms;
+
+    // update one lane
+    void UpdateLane(uint8_t i);
+
+    // update the lanes belonging to one executor of the lane pool
+    void UpdateLanes(uint8_t executor, uint8_t num_executors);
+
+    // update all lanes in isolation from each other, concurrently if
+    // the lane pool is running
+    void UpdateLanesIsolated(void);
+
+    // log lane timing
+    void Log_Write_LaneTiming(uint64_t time_us);
     
     // update the yaw reset data to capture changes due to a lane switch
     // new_primary - index of the ekf instance that we are about to switch to as the primary
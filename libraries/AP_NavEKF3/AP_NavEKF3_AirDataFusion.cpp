@@ -118,24 +118,9 @@ void NavEKF3_core::FuseAirspeed()
             // restart the counter
             lastTasPassTime_ms = imuSampleTime_ms;
 
-            // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-            // the zero elements of H to reduce the number of operations.
-            for (unsigned i = 0; i<=stateIndexLim; i++) {
-                // j as the inner loop allows the compiler to hoist the KH product
-                // to save computation, and do the inner indexing more efficiently.
-                for (unsigned j = 0; j<=stateIndexLim; j++) {
-                    ftype res = 0;
-                    res += (Kfusion[i] * H_TAS[4]) * P[4][j];
-                    res += (Kfusion[i] * H_TAS[5]) * P[5][j];
-                    res += (Kfusion[i] * H_TAS[6]) * P[6][j];
-                    res += (Kfusion[i] * H_TAS[22]) * P[22][j];
-                    res += (Kfusion[i] * H_TAS[23]) * P[23][j];
-                    KHP[i][j] = res;
-                }
-            }
-
-            // finish fusion from KHP and Kfusion
-            FinishFusion(innovVtas, true); // forcing fusion is probably a bug
+            // finish fusion from H and Kfusion. H is nonzero for the velocity and wind states only
+            static const uint8_t Hidx[] { 4, 5, 6, 22, 23 };
+            FinishFusion(innovVtas, &H_TAS[0], Hidx, ARRAY_SIZE(Hidx), true); // forcing fusion is probably a bug
         }
     }
 }
@@ -346,28 +331,9 @@ void NavEKF3_core::FuseSideslip()
         // calculate predicted sideslip angle and innovation using small angle approximation
         innovBeta = constrain_ftype(vel_rel_wind.y / vel_rel_wind.x, -0.5f, 0.5f);
 
-        // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-        // the zero elements of H to reduce the number of operations.
-        for (unsigned i = 0; i<=stateIndexLim; i++) {
-            // j as the inner loop allows the compiler to hoist the KH product
-            // to save computation, and do the inner indexing more efficiently.
-            for (unsigned j = 0; j<=stateIndexLim; j++) {
-                ftype res = 0;
-                res += (Kfusion[i] * H_BETA[0]) * P[0][j];
-                res += (Kfusion[i] * H_BETA[1]) * P[1][j];
-                res += (Kfusion[i] * H_BETA[2]) * P[2][j];
-                res += (Kfusion[i] * H_BETA[3]) * P[3][j];
-                res += (Kfusion[i] * H_BETA[4]) * P[4][j];
-                res += (Kfusion[i] * H_BETA[5]) * P[5][j];
-                res += (Kfusion[i] * H_BETA[6]) * P[6][j];
-                res += (Kfusion[i] * H_BETA[22]) * P[22][j];
-                res += (Kfusion[i] * H_BETA[23]) * P[23][j];
-                KHP[i][j] = res;
-            }
-        }
-
-        // finish fusion from KHP and Kfusion
-        FinishFusion(innovBeta, true); // forcing fusion is probably a bug
+        // finish fusion from H and Kfusion. H is nonzero for the quaternion, velocity and wind states only
+        static const uint8_t Hidx[] { 0, 1, 2, 3, 4, 5, 6, 22, 23 };
+        FinishFusion(innovBeta, &H_BETA[0], Hidx, ARRAY_SIZE(Hidx), true); // forcing fusion is probably a bug
     }
 }
 
@@ -599,28 +565,9 @@ void NavEKF3_core::FuseDragForces()
             return;
         }
 
-        // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-        // the zero elements of H to reduce the number of operations.
-        for (unsigned i = 0; i<=stateIndexLim; i++) {
-            // j as the inner loop allows the compiler to hoist the KH product
-            // to save computation, and do the inner indexing more efficiently.
-            for (unsigned j = 0; j<=stateIndexLim; j++) {
-                ftype res = 0;
-                res += (Kfusion[i] * Hfusion[0]) * P[0][j];
-                res += (Kfusion[i] * Hfusion[1]) * P[1][j];
-                res += (Kfusion[i] * Hfusion[2]) * P[2][j];
-                res += (Kfusion[i] * Hfusion[3]) * P[3][j];
-                res += (Kfusion[i] * Hfusion[4]) * P[4][j];
-                res += (Kfusion[i] * Hfusion[5]) * P[5][j];
-                res += (Kfusion[i] * Hfusion[6]) * P[6][j];
-                res += (Kfusion[i] * Hfusion[22]) * P[22][j];
-                res += (Kfusion[i] * Hfusion[23]) * P[23][j];
-                KHP[i][j] = res;
-            }
-        }
-
-        // finish fusion from KHP and Kfusion
-        FinishFusion(innovDrag[axis_index], true); // forcing fusion is probably a bug
+        // finish fusion from H and Kfusion. H is nonzero for the quaternion, velocity and wind states only
+        static const uint8_t Hidx[] { 0, 1, 2, 3, 4, 5, 6, 22, 23 };
+        FinishFusion(innovDrag[axis_index], &Hfusion[0], Hidx, ARRAY_SIZE(Hidx), true); // forcing fusion is probably a bug
     }
 
     // record time of successful fusion
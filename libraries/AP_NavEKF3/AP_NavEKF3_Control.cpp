@@ -715,14 +715,38 @@ bool NavEKF3_core::setOriginLLH(const Location &loc)
 
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u origin set",(unsigned)imu_index);
 
+    if (frontend->lanes_running) {
+        // other lanes may be running, publish once they have all completed
+        publicOriginPending = true;
+    } else {
+        publishOrigin();
+    }
+
+    return true;
+}
+
+// make our origin the origin shared by all lanes if no lane has set it yet
+void NavEKF3_core::publishOrigin()
+{
     if (!frontend->common_origin_valid) {
         frontend->common_origin_valid = true;
         // put origin in frontend as well to ensure it stays in sync between lanes
         public_origin = EKF_origin;
     }
+}
 
-
-    return true;
+// publish an origin set and apply a takeoff expectation raised while
+// lanes were running
+void NavEKF3_core::publishPending()
+{
+    if (publicOriginPending) {
+        publicOriginPending = false;
+        publishOrigin();
+    }
+    if (takeoffExpectedPending) {
+        takeoffExpectedPending = false;
+        dal.set_takeoff_expected();
+    }
 }
 
 // record all requested yaw resets completed
@@ -0,0 +1,72 @@
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_NavEKF3_LanePool.h"
+
+#if EK3_FEATURE_PARALLEL_LANES
+
+#include "AP_NavEKF3.h"
+
+extern const AP_HAL::HAL& hal;
+
+#define LANE_WORKER_STACK_SIZE 16384
+
+// start up to num_workers threads, returns false if none could be started
+bool NavEKF3_LanePool::init(uint8_t _num_workers)
+{
+    static const char *names[] { "EK3Lane1", "EK3Lane2", "EK3Lane3", "EK3Lane4", "EK3Lane5" };
+    static_assert(ARRAY_SIZE(names) >= MAX_WORKERS, "need a name for each worker");
+
+    _num_workers = MIN(_num_workers, MAX_WORKERS);
+    for (uint8_t i = 0; i < _num_workers; i++) {
+        Worker &w = workers[i];
+        w.pool = this;
+        w.executor = i + 1;
+        if (!hal.scheduler->thread_create(FUNCTOR_BIND(&w, &NavEKF3_LanePool::Worker::thread_main, void),
+                                          names[i], LANE_WORKER_STACK_SIZE,
+                                          AP_HAL::Scheduler::PRIORITY_MAIN, 0)) {
+            break;
+        }
+        num_workers++;
+    }
+    return num_workers > 0;
+}
+
+/*
+  run all lanes. The calling thread runs its own share of the lanes
+  then waits for each worker to finish, so all lanes have completed
+  before the DAL frame can be ended
+ */
+void NavEKF3_LanePool::run(void)
+{
+    for (uint8_t i = 0; i < num_workers; i++) {
+        workers[i].start_sem.signal();
+    }
+    frontend.UpdateLanes(0, num_executors());
+    for (uint8_t i = 0; i < num_workers; i++) {
+        workers[i].done_sem.wait_blocking();
+    }
+}
+
+void NavEKF3_LanePool::Worker::thread_main(void)
+{
+    while (true) {
+        start_sem.wait_blocking();
+        pool->frontend.UpdateLanes(executor, pool->num_executors());
+        done_sem.signal();
+    }
+}
+
+#endif // EK3_FEATURE_PARALLEL_LANES
@@ -0,0 +1,65 @@
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_NavEKF3_feature.h"
+
+#if EK3_FEATURE_PARALLEL_LANES
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/Semaphores.h>
+#include <AP_NavEKF/AP_Nav_Common.h>
+
+class NavEKF3;
+
+/*
+  persistent pool of worker threads used to run the EKF3 lanes
+  concurrently within one UpdateFilter() call. The calling thread is
+  executor 0 and worker n is executor n+1. Lanes are handed out round
+  robin, each executor running its lanes in ascending order
+ */
+class NavEKF3_LanePool {
+public:
+    NavEKF3_LanePool(NavEKF3 &_frontend) :
+        frontend(_frontend) {}
+
+    CLASS_NO_COPY(NavEKF3_LanePool);
+
+    // start up to num_workers threads, returns false if none could be started
+    bool init(uint8_t num_workers);
+
+    // run all lanes, returning once every lane has completed
+    void run(void);
+
+    // number of threads lanes are spread over, including the caller
+    uint8_t num_executors(void) const { return num_workers + 1; }
+
+private:
+    static constexpr uint8_t MAX_WORKERS = MAX_EKF_CORES - 1;
+
+    struct Worker {
+        NavEKF3_LanePool *pool;
+        uint8_t executor;
+        HAL_BinarySemaphore start_sem;
+        HAL_BinarySemaphore done_sem;
+
+        void thread_main(void);
+    } workers[MAX_WORKERS];
+
+    NavEKF3 &frontend;
+    uint8_t num_workers;
+};
+
+#endif // EK3_FEATURE_PARALLEL_LANES
@@ -4,6 +4,7 @@
 
 #include "AP_NavEKF3.h"
 #include "AP_NavEKF3_core.h"
+#include "AP_NavEKF3_LanePool.h"
 
 #include <AP_HAL/HAL.h>
 #include <AP_Logger/AP_Logger.h>
@@ -392,9 +393,45 @@ void NavEKF3::Log_Write()
         core[i].Log_Write(time_us);
     }
 
+    Log_Write_LaneTiming(time_us);
+
     AP::dal().start_frame(AP_DAL::FrameType::LogWriteEKF3);
 }
 
+// log per lane update timing once a second
+void NavEKF3::Log_Write_LaneTiming(uint64_t time_us)
+{
+    const uint32_t now_ms = AP::dal().millis();
+    if (now_ms - lastLaneTimingLog_ms < 1000 || frame_timing.count == 0) {
+        return;
+    }
+    lastLaneTimingLog_ms = now_ms;
+
+    uint8_t num_executors = 1;
+#if EK3_FEATURE_PARALLEL_LANES
+    if (lane_pool != nullptr) {
+        num_executors = lane_pool->num_executors();
+    }
+#endif
+    for (uint8_t i=0; i<num_cores; i++) {
+        const LaneTiming &t = lane_timing[i];
+        const struct log_XKLT pkt{
+            LOG_PACKET_HEADER_INIT(LOG_XKLT_MSG),
+            time_us      : time_us,
+            core         : i,
+            executor     : uint8_t(i % num_executors),
+            count        : t.count,
+            avg_us       : uint16_t(t.count ? t.sum_us / t.count : 0),
+            max_us       : t.max_us,
+            frame_avg_us : uint16_t(frame_timing.sum_us / frame_timing.count),
+            frame_max_us : frame_timing.max_us,
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+    memset(lane_timing, 0, sizeof(lane_timing));
+    memset(&frame_timing, 0, sizeof(frame_timing));
+}
+
 void NavEKF3_core::Log_Write(uint64_t time_us)
 {
     const auto level = frontend->_log_level;
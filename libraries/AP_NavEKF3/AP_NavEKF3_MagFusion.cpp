@@ -770,29 +770,10 @@ void NavEKF3_core::FuseMagnetometer()
             // this can be used by other fusion processes to avoid fusing on the same frame as this expensive step
             magFusePerformed = true;
         }
-        // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-        // the zero elements of H to reduce the number of operations.
-        for (unsigned i = 0; i<=stateIndexLim; i++) {
-            // j as the inner loop allows the compiler to hoist the KH product
-            // to save computation, and do the inner indexing more efficiently.
-            for (unsigned j = 0; j<=stateIndexLim; j++) {
-                ftype res = 0;
-                res += (Kfusion[i] * H_MAG[0]) * P[0][j];
-                res += (Kfusion[i] * H_MAG[1]) * P[1][j];
-                res += (Kfusion[i] * H_MAG[2]) * P[2][j];
-                res += (Kfusion[i] * H_MAG[3]) * P[3][j];
-                res += (Kfusion[i] * H_MAG[16]) * P[16][j];
-                res += (Kfusion[i] * H_MAG[17]) * P[17][j];
-                res += (Kfusion[i] * H_MAG[18]) * P[18][j];
-                // one value in H is always 1, and the others not mentioned here
-                // are zero, so we can skip that H product to save an operation.
-                res += Kfusion[i] * P[H_MAG_unit_index][j];
-                KHP[i][j] = res;
-            }
-        }
-
-        // finish fusion from KHP and Kfusion
-        if (!FinishFusion(innovMag[obsIndex])) { // no fault?
+        // finish fusion from H and Kfusion. one value in H is always 1,
+        // and the others not listed here are zero
+        const uint8_t Hidx[] { 0, 1, 2, 3, 16, 17, 18, uint8_t(H_MAG_unit_index) };
+        if (!FinishFusion(innovMag[obsIndex], &H_MAG[0], Hidx, ARRAY_SIZE(Hidx))) { // no fault?
             // add table constraint here for faster convergence
             if (have_table_earth_field && frontend->_mag_ef_limit > 0) {
                 MagTableConstrain();
@@ -1097,24 +1078,10 @@ bool NavEKF3_core::fuseEulerYaw(yawFusionMethod method)
         magHealth = true;
     }
 
-    // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-    // the zero elements of H to reduce the number of operations.
-    for (unsigned i = 0; i<=stateIndexLim; i++) {
-        // j as the inner loop allows the compiler to hoist the KH product
-        // to save computation, and do the inner indexing more efficiently.
-        for (unsigned j = 0; j<=stateIndexLim; j++) {
-            ftype res = 0;
-            res += (Kfusion[i] * H_YAW[0]) * P[0][j];
-            res += (Kfusion[i] * H_YAW[1]) * P[1][j];
-            res += (Kfusion[i] * H_YAW[2]) * P[2][j];
-            res += (Kfusion[i] * H_YAW[3]) * P[3][j];
-            KHP[i][j] = res;
-        }
-    }
-
     const ftype innovFusion = constrain_ftype(innovYaw, -0.5f, 0.5f);
-    // finish fusion from KHP and Kfusion then record health status
-    faultStatus.bad_yaw = FinishFusion(innovFusion);
+    // finish fusion from H and Kfusion then record health status. H is nonzero for the quaternion states only
+    static const uint8_t Hidx[] { 0, 1, 2, 3 };
+    faultStatus.bad_yaw = FinishFusion(innovFusion, H_YAW, Hidx, ARRAY_SIZE(Hidx));
 
     return true;
 }
@@ -1205,21 +1172,9 @@ void NavEKF3_core::FuseDeclination(ftype declErr)
         innovation = -0.5f;
     }
 
-    // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-    // the zero elements of H to reduce the number of operations.
-    for (unsigned i = 0; i<=stateIndexLim; i++) {
-        // j as the inner loop allows the compiler to hoist the KH product
-        // to save computation, and do the inner indexing more efficiently.
-        for (unsigned j = 0; j<=stateIndexLim; j++) {
-            ftype res = 0;
-            res += (Kfusion[i] * Hfusion[16]) * P[16][j];
-            res += (Kfusion[i] * Hfusion[17]) * P[17][j];
-            KHP[i][j] = res;
-        }
-    }
-
-    // finish fusion from KHP and Kfusion then record health status
-    faultStatus.bad_decl = FinishFusion(innovation);
+    // finish fusion from H and Kfusion then record health status. H is nonzero for the NE earth field states only
+    static const uint8_t Hidx[] { 16, 17 };
+    faultStatus.bad_decl = FinishFusion(innovation, Hfusion, Hidx, ARRAY_SIZE(Hidx));
 }
 
 /********************************************************
@@ -691,26 +691,9 @@ void NavEKF3_core::FuseOptFlow(const of_elements &ofDataDelayed, bool really_fus
                 GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u fusing optical flow",(unsigned)imu_index);
             }
 
-            // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-            // the zero elements of H to reduce the number of operations.
-            for (unsigned i = 0; i<=stateIndexLim; i++) {
-                // j as the inner loop allows the compiler to hoist the KH product
-                // to save computation, and do the inner indexing more efficiently.
-                for (unsigned j = 0; j<=stateIndexLim; j++) {
-                    ftype res = 0;
-                    res += (Kfusion[i] * H_LOS[0]) * P[0][j];
-                    res += (Kfusion[i] * H_LOS[1]) * P[1][j];
-                    res += (Kfusion[i] * H_LOS[2]) * P[2][j];
-                    res += (Kfusion[i] * H_LOS[3]) * P[3][j];
-                    res += (Kfusion[i] * H_LOS[4]) * P[4][j];
-                    res += (Kfusion[i] * H_LOS[5]) * P[5][j];
-                    res += (Kfusion[i] * H_LOS[6]) * P[6][j];
-                    KHP[i][j] = res;
-                }
-            }
-
-            // finish fusion from KHP and Kfusion
-            if (FinishFusion(flowInnov[obsIndex])) {
+            // finish fusion from H and Kfusion. H is nonzero for the quaternion and velocity states only
+            static const uint8_t Hidx[] { 0, 1, 2, 3, 4, 5, 6 };
+            if (FinishFusion(flowInnov[obsIndex], &H_LOS[0], Hidx, ARRAY_SIZE(Hidx))) {
                 // fault, record bad axis
                 if (obsIndex == 0) {
                     faultStatus.bad_xflow = true;
@@ -1190,24 +1190,13 @@ void NavEKF3_core::FuseVelPosNED()
                     Kfusion[i] = res;
                 }
 
-                // one element of H is 1, compiler will optimize it away
+                // the only nonzero element of H is 1
                 Vector24 Hfusion;
                 Hfusion[stateIndex] = 1;
+                const uint8_t Hidx[] { stateIndex };
 
-                // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-                // the zero elements of H to reduce the number of operations.
-                for (unsigned i = 0; i<=stateIndexLim; i++) {
-                    // j as the inner loop allows the compiler to hoist the KH product
-                    // to save computation, and do the inner indexing more efficiently.
-                    for (unsigned j = 0; j<=stateIndexLim; j++) {
-                        ftype res = 0;
-                        res += (Kfusion[i] * Hfusion[stateIndex]) * P[stateIndex][j];
-                        KHP[i][j] = res;
-                    }
-                }
-
-                // finish fusion from KHP and Kfusion
-                const bool fault = FinishFusion(innovVelPos[obsIndex]);
+                // finish fusion from H and Kfusion
+                const bool fault = FinishFusion(innovVelPos[obsIndex], &Hfusion[0], Hidx, ARRAY_SIZE(Hidx));
                 // record health status
                 if (obsIndex == 0) {
                     faultStatus.bad_nvel = fault;
@@ -2011,26 +2000,9 @@ void NavEKF3_core::FuseBodyVel()
                 GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u fusing odometry",(unsigned)imu_index);
             }
 
-            // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-            // the zero elements of H to reduce the number of operations.
-            for (unsigned i = 0; i<=stateIndexLim; i++) {
-                // j as the inner loop allows the compiler to hoist the KH product
-                // to save computation, and do the inner indexing more efficiently.
-                for (unsigned j = 0; j<=stateIndexLim; j++) {
-                    ftype res = 0;
-                    res += (Kfusion[i] * H_VEL[0]) * P[0][j];
-                    res += (Kfusion[i] * H_VEL[1]) * P[1][j];
-                    res += (Kfusion[i] * H_VEL[2]) * P[2][j];
-                    res += (Kfusion[i] * H_VEL[3]) * P[3][j];
-                    res += (Kfusion[i] * H_VEL[4]) * P[4][j];
-                    res += (Kfusion[i] * H_VEL[5]) * P[5][j];
-                    res += (Kfusion[i] * H_VEL[6]) * P[6][j];
-                    KHP[i][j] = res;
-                }
-            }
-
-            // finish fusion from KHP and Kfusion
-            if (FinishFusion(innovBodyVel[obsIndex])) {
+            // finish fusion from H and Kfusion. H is nonzero for the quaternion and velocity states only
+            static const uint8_t Hidx[] { 0, 1, 2, 3, 4, 5, 6 };
+            if (FinishFusion(innovBodyVel[obsIndex], &H_VEL[0], Hidx, ARRAY_SIZE(Hidx))) {
                 // fault, record bad axis
                 if (obsIndex == 0) {
                     faultStatus.bad_xvel = true;
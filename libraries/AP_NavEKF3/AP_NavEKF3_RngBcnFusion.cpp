@@ -248,22 +248,9 @@ void NavEKF3_core::FuseRngBcn()
             // restart the counter
             rngBcn.lastPassTime_ms = imuSampleTime_ms;
 
-            // correct the covariance P = (I - K*H)*P = P - K*H*P. take advantage of
-            // the zero elements of H to reduce the number of operations.
-            for (unsigned i = 0; i<=stateIndexLim; i++) {
-                // j as the inner loop allows the compiler to hoist the KH product
-                // to save computation, and do the inner indexing more efficiently.
-                for (unsigned j = 0; j<=stateIndexLim; j++) {
-                    ftype res = 0;
-                    res += (Kfusion[i] * H_BCN[7]) * P[7][j];
-                    res += (Kfusion[i] * H_BCN[8]) * P[8][j];
-                    res += (Kfusion[i] * H_BCN[9]) * P[9][j];
-                    KHP[i][j] = res;
-                }
-            }
-
-            // finish fusion from KHP and Kfusion then record health status
-            faultStatus.bad_rngbcn = FinishFusion(rngBcn.innov);
+            // finish fusion from H and Kfusion then record health status. H is nonzero for the position states only
+            static const uint8_t Hidx[] { 7, 8, 9 };
+            faultStatus.bad_rngbcn = FinishFusion(rngBcn.innov, H_BCN, Hidx, ARRAY_SIZE(Hidx));
         }
 
         // Update the fusion report
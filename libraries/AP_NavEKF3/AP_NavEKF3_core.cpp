@@ -6,8 +6,22 @@
 #include <AP_VisualOdom/AP_VisualOdom.h>
 #include <AP_Logger/AP_Logger.h>
 #include <AP_DAL/AP_DAL.h>
+#include <AP_Common/ExpandingString.h>
 
 // constructor
+#if EK3_FEATURE_PARALLEL_LANES
+thread_local NavEKF3_core::Matrix24 NavEKF3_core::KHP;
+thread_local NavEKF3_core::Vector28 NavEKF3_core::Kfusion;
+
+void NavEKF3_core::fill_scratch_variables(void)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    fill_nanf(&KHP[0][0], sizeof(KHP)/sizeof(ftype));
+    fill_nanf(&Kfusion[0], sizeof(Kfusion)/sizeof(ftype));
+#endif
+}
+#endif  // EK3_FEATURE_PARALLEL_LANES
+
 NavEKF3_core::NavEKF3_core(NavEKF3 *_frontend, AP_DAL &_dal) :
     dal(_dal),
     frontend(_frontend),
@@ -46,6 +60,9 @@ bool NavEKF3_core::setup_core(uint8_t _imu_index, uint8_t _core_index)
                         (uint16_t)(EKF_TARGET_DT_MS)
                                   ))));
 
+    // smallest delay of any GPS, used to size the GPS buffers
+    uint16_t gps_delay_ms = 0;
+
     // GPS sensing can have large delays and should not be included if disabled
     if (frontend->sources.usingGPS(core_index)) {
         // Wait for the configuration of all GPS units to be confirmed. Until this has occurred the GPS driver cannot provide a correct time delay
@@ -69,6 +86,15 @@ bool NavEKF3_core::setup_core(uint8_t _imu_index, uint8_t _core_index)
         }
         // limit the time delay value from the GPS library to a max of 250 msec which is the max value the EKF has been tested for.
         maxTimeDelay_ms = MAX(maxTimeDelay_ms , MIN((uint16_t)(gps_delay_sec * 1000.0f),250));
+
+        // data from a GPS with less lag than the selected one waits longer to be fused
+        gps_delay_ms = MIN((uint16_t)(gps_delay_sec * 1000.0f),250);
+        for (uint8_t i=0; i<dal.gps().num_sensors(); i++) {
+            float lag_sec;
+            if (dal.gps().get_lag(i, lag_sec)) {
+                gps_delay_ms = MIN(gps_delay_ms, (uint16_t)(lag_sec * 1000.0f));
+            }
+        }
     }
 
     // airspeed sensing can have large delays and should not be included if disabled
@@ -96,6 +122,19 @@ bool NavEKF3_core::setup_core(uint8_t _imu_index, uint8_t _core_index)
     // limit to be no longer than the IMU buffer (we can't process data faster than the EKF prediction rate)
     obs_buffer_length = MIN(obs_buffer_length,imu_buffer_length);
 
+    /*
+      data is timestamped with the sensor delay removed, so it only
+      waits in its buffer until the fusion time horizon, which lags by
+      the largest sensor delay, catches up with it. Size the buffers of
+      sensors with a known delay for that wait rather than the whole
+      horizon delay. If this proves too short the buffer is grown
+      while disarmed, see growObsBuffers()
+     */
+    const auto obs_length = [&](uint16_t sensor_delay_ms) -> uint8_t {
+        const uint16_t wait_ms = ekf_delay_ms - MIN(sensor_delay_ms, maxTimeDelay_ms);
+        return constrain_int16(wait_ms / frontend->sensorIntervalMin_ms + 1, 2, obs_buffer_length);
+    };
+
     // calculate buffer size for optical flow data
     const uint8_t flow_buffer_length = MIN((ekf_delay_ms / frontend->flowIntervalMin_ms) + 1, imu_buffer_length);
 
@@ -104,16 +143,16 @@ bool NavEKF3_core::setup_core(uint8_t _imu_index, uint8_t _core_index)
     const uint8_t extnav_buffer_length = MIN((ekf_delay_ms / frontend->extNavIntervalMin_ms) + 1, imu_buffer_length);
 #endif // EK3_FEATURE_EXTERNAL_NAV
 
-    if(!storedGPS.init(obs_buffer_length)) {
+    if(!storedGPS.init(obs_length(gps_delay_ms))) {
         return false;
     }
-    if(!storedMag.init(obs_buffer_length)) {
+    if(!storedMag.init(obs_length(frontend->magDelay_ms))) {
         return false;
     }
-    if(!storedBaro.init(obs_buffer_length)) {
+    if(!storedBaro.init(obs_length(frontend->_hgtDelay_ms))) {
         return false;
     }
-    if(dal.airspeed() && !storedTAS.init(obs_buffer_length)) {
+    if(dal.airspeed() && !storedTAS.init(obs_length(frontend->tasDelay_ms))) {
         return false;
     }
     if(dal.opticalflow_enabled() && !storedOF.init(flow_buffer_length)) {
@@ -279,6 +318,8 @@ void NavEKF3_core::InitialiseVariables()
     inhibitDelAngBiasStates = true;
     gndOffsetValid =  false;
     validOrigin = false;
+    publicOriginPending = false;
+    takeoffExpectedPending = false;
     gpsSpdAccuracy = 0.0f;
     gpsPosAccuracy = 0.0f;
     gpsHgtAccuracy = 0.0f;
@@ -713,6 +754,9 @@ void NavEKF3_core::UpdateFilter(bool predict)
             last_oneHz_ms = imuSampleTime_ms;
             moveEKFOrigin();
             checkUpdateEarthField();
+            if (!motorsArmed) {
+                growObsBuffers();
+            }
         }
     }
 
@@ -915,7 +959,12 @@ void NavEKF3_core::calcOutputStates()
     if (!inFlight && !dal.get_takeoff_expected() && assume_zero_sideslip()) {
         const ftype launchDelVel = imuDataNew.delVel.x + GRAVITY_MSS * imuDataNew.delVelDT * Tbn_temp.c.x;
         if (launchDelVel > GRAVITY_MSS * imuDataNew.delVelDT) {
-            dal.set_takeoff_expected();
+            if (frontend->lanes_running) {
+                // AHRS is not safe to update from the lane pool
+                takeoffExpectedPending = true;
+            } else {
+                dal.set_takeoff_expected();
+            }
         }
     }
 
@@ -1991,15 +2040,29 @@ void NavEKF3_core::ConstrainVariances()
     }
 }
 
-// actually do fusion to update statesArray from Kfusion and P from KHP.
-// returns true and skips fusion if variances would be driven negative.
-// force skips this negative check; passing true is probably a bug!
-bool NavEKF3_core::FinishFusion(ftype innov, bool force /*= false*/)
+/*
+  actually do fusion of a scalar observation, updating statesArray from
+  Kfusion and P as P = P - K*H*P.
+
+  H is the observation Jacobian indexed by state. Only the Hnum states
+  listed in Hidx are read, all other elements of H are taken to be
+  zero. As the observation is scalar H*P is a single row and K*H*P is
+  the outer product of Kfusion with it, so only that row is formed and
+  the update is applied to one triangle of P and mirrored.
+
+  returns true and skips fusion if variances would be driven negative.
+  force skips this negative check; passing true is probably a bug!
+ */
+bool NavEKF3_core::FinishFusion(ftype innov, const ftype *H, const uint8_t *Hidx, uint8_t Hnum, bool force /*= false*/)
 {
+    // form H*P using the nonzero elements of H
+    Vector24 HP;
+    sparse_HP(P, H, Hidx, Hnum, stateIndexLim, &HP[0]);
+
     if (!force) {
         // Check that we are not going to drive any variances negative and skip the update if so
         for (auto s=0; s<=stateIndexLim; s++) {
-            if (KHP[s][s] > P[s][s]) {
+            if (Kfusion[s] * HP[s] > P[s][s]) {
                 return true;
             }
         }
@@ -2011,20 +2074,8 @@ bool NavEKF3_core::FinishFusion(ftype innov, bool force /*= false*/)
     }
     stateStruct.quat.normalize();
 
-    // update the covariance matrix as P = P - KHP (KHP was filled by caller)
-    for (auto r=0; r<=stateIndexLim; r++) {
-        for (auto c=0; c<=r; c++) {
-            // P must end up symmetric, so average the upper and lower
-            // differences, then store that result in both positions. it would
-            // be faster and more numerically stable to average the KHP entries
-            // instead, but we have no good proof P was symmetric before!
-            const ftype lower = P[r][c] - KHP[r][c];
-            const ftype upper = P[c][r] - KHP[c][r];
-            const ftype res = 0.5f*(lower + upper);
-            P[r][c] = res;
-            P[c][r] = res;
-        }
-    }
+    // update the covariance matrix as P = P - K*HP
+    symmetric_rank1_update(P, &Kfusion[0], &HP[0], stateIndexLim);
 
     // limit the variances to prevent ill-conditioning
     ConstrainVariances(); // can change statesArray!!
@@ -2292,3 +2343,79 @@ void NavEKF3_core::moveEKFOrigin(void)
         storedOutput[index].position.xy() += diffNE;
     }
 }
+
+/*
+  grow an observation buffer by one element if it has discarded data
+  before it could be fused, up to max_size
+ */
+template <typename T>
+static void grow_obs_buffer(EKF_obs_buffer_t<T> &buf, uint8_t max_size)
+{
+    if (buf.get_overflows() != 0 && buf.get_size() < max_size) {
+        buf.resize(buf.get_size() + 1);
+    }
+}
+
+/*
+  grow the observation buffers that were sized from the sensor delays
+  if they have turned out to be too short. This allocates memory so is
+  only called while disarmed
+ */
+void NavEKF3_core::growObsBuffers(void)
+{
+    grow_obs_buffer(storedGPS, obs_buffer_length);
+    grow_obs_buffer(storedMag, obs_buffer_length);
+    grow_obs_buffer(storedBaro, obs_buffer_length);
+    grow_obs_buffer(storedTAS, obs_buffer_length);
+}
+
+template <typename T>
+static void obs_buffer_info(ExpandingString &str, const char *name, const EKF_obs_buffer_t<T> &buf, uint32_t &total)
+{
+    if (buf.get_memory_used() == 0) {
+        return;
+    }
+    str.printf("  %-10s len=%-3u max=%-3u ovf=%-5u bytes=%u\n", name,
+               unsigned(buf.get_size()), unsigned(buf.get_max_count()),
+               unsigned(buf.get_overflows()), unsigned(buf.get_memory_used()));
+    total += buf.get_memory_used();
+}
+
+// report sizes, usage and memory of the data buffers
+void NavEKF3_core::buffer_info(ExpandingString &str) const
+{
+    str.printf("core %u IMU%u\n", unsigned(core_index), unsigned(imu_index));
+    uint32_t total = 0;
+    obs_buffer_info(str, "GPS", storedGPS, total);
+    obs_buffer_info(str, "Mag", storedMag, total);
+    obs_buffer_info(str, "Baro", storedBaro, total);
+    obs_buffer_info(str, "TAS", storedTAS, total);
+#if EK3_FEATURE_RANGEFINDER_MEASUREMENTS
+    obs_buffer_info(str, "Range", storedRange, total);
+#endif
+    obs_buffer_info(str, "OF", storedOF, total);
+    obs_buffer_info(str, "YawAng", storedYawAng, total);
+#if EK3_FEATURE_BODY_ODOM
+    obs_buffer_info(str, "BodyOdm", storedBodyOdm, total);
+    obs_buffer_info(str, "WheelOdm", storedWheelOdm, total);
+#endif
+#if EK3_FEATURE_BEACON_FUSION
+    obs_buffer_info(str, "RngBcn", rngBcn.storedRange, total);
+#endif
+#if EK3_FEATURE_EXTERNAL_NAV
+    obs_buffer_info(str, "ExtNav", storedExtNav, total);
+    obs_buffer_info(str, "ExtNavVel", storedExtNavVel, total);
+    obs_buffer_info(str, "ExtNavYaw", storedExtNavYawAng, total);
+#endif
+#if EK3_FEATURE_DRAG_FUSION
+    obs_buffer_info(str, "Drag", storedDrag, total);
+#endif
+    str.printf("  %-10s len=%-3u bytes=%u\n", "IMU", unsigned(imu_buffer_length), unsigned(storedIMU.get_memory_used()));
+    str.printf("  %-10s len=%-3u bytes=%u\n", "Output", unsigned(imu_buffer_length), unsigned(storedOutput.get_memory_used()));
+    total += storedIMU.get_memory_used() + storedOutput.get_memory_used();
+
+    const uint32_t gsf = yawEstimator != nullptr ? sizeof(EKFGSF_yaw) : 0;
+    str.printf("  buffers=%u core=%u gsf=%u total=%u\n",
+               unsigned(total), unsigned(sizeof(NavEKF3_core)), unsigned(gsf),
+               unsigned(total + sizeof(NavEKF3_core) + gsf));
+}
@@ -227,6 +227,10 @@ public:
     // returns false if the origin has already been set
     bool setOriginLLH(const Location &loc);
 
+    // publish the origin and takeoff expectation set while lanes were
+    // running in isolation
+    void publishPending();
+
     // Set the EKF's NE horizontal position states and their corresponding variances from a supplied WGS-84 location and uncertainty
     // The altitude element of the location is not used.
     // Returns true if the set was successful
@@ -492,6 +496,9 @@ public:
     // return true if states have been initialised by a bootstrap alignment
     bool isStatesInitialised(void) const { return statesInitialised; }
 
+    // report sizes, usage and memory of the data buffers
+    void buffer_info(class ExpandingString &str) const;
+
 private:
     EKFGSF_yaw *yawEstimator;
     AP_DAL &dal;
@@ -571,6 +578,17 @@ private:
     typedef uint32_t Vector_u32_50[50];
 #endif
 
+#if EK3_FEATURE_PARALLEL_LANES
+    // lanes may run concurrently on the lane pool, so each thread
+    // needs its own copy of the scratch variables. These hide the
+    // ones shared with EKF2 in NavEKF_core_common
+    static thread_local Matrix24 KHP;
+    static thread_local Vector28 Kfusion;
+
+    // fill this thread's scratch variables with NaN on SITL
+    void fill_scratch_variables(void);
+#endif
+
     // the states are available in two forms, either as a Vector24, or
     // broken down as individual elements. Both are equivalent (same
     // memory)
@@ -736,10 +754,12 @@ private:
     // constrain variances (diagonal terms) in the state covariance matrix
     void ConstrainVariances();
 
-    // actually do fusion to update statesArray from Kfusion and P from KHP.
+    // actually do fusion to update statesArray from Kfusion and P from
+    // the sparse observation Jacobian H, of which only the Hnum states
+    // listed in Hidx are nonzero.
     // returns true and skips fusion if variances would be driven negative.
     // force skips this negative check; passing true is probably a bug!
-    bool FinishFusion(ftype innov, bool force = false);
+    bool FinishFusion(ftype innov, const ftype *H, const uint8_t *Hidx, uint8_t Hnum, bool force = false);
 
     // constrain states
     void ConstrainStates();
@@ -788,6 +808,9 @@ private:
     // calculate the NED earth spin vector in rad/sec
     void calcEarthRateNED(Vector3F &omega, int32_t latitude) const;
 
+    // make our origin the origin shared by all lanes if no lane has set it yet
+    void publishOrigin();
+
     // initialise the covariance matrix
     void CovarianceInit();
 
@@ -1176,6 +1199,8 @@ private:
     Location EKF_origin;     // LLH origin of the NED axis system, internal only
     Location &public_origin; // LLH origin of the NED axis system, public functions
     bool validOrigin;               // true when the EKF origin is valid
+    bool publicOriginPending;       // true when the origin was set while lanes were running and is yet to be published
+    bool takeoffExpectedPending;    // true when a launch was detected while lanes were running and is yet to be passed to AHRS
     ftype gpsSpdAccuracy;           // estimated speed accuracy in m/s returned by the GPS receiver
     ftype gpsPosAccuracy;           // estimated position accuracy in m returned by the GPS receiver
     ftype gpsHgtAccuracy;           // estimated height accuracy in m returned by the GPS receiver
@@ -1594,6 +1619,9 @@ private:
     // handle earth field updates
     void getEarthFieldTable(const Location &loc);
     void checkUpdateEarthField(void);
+
+    // grow observation buffers that have discarded data before it could be fused
+    void growObsBuffers(void);
     
     // timing statistics
     struct ekf_timing timing;
@@ -56,3 +56,11 @@
 #ifndef EK3_FEATURE_OPTFLOW_AGL_KF
 #define EK3_FEATURE_OPTFLOW_AGL_KF EK3_FEATURE_OPTFLOW_FUSION
 #endif
+
+// run lanes concurrently on a pool of worker threads on multi-core
+// Linux boards and SITL. Replay always runs the lanes sequentially so
+// it checks the threaded result
+#ifndef EK3_FEATURE_PARALLEL_LANES
+#define EK3_FEATURE_PARALLEL_LANES ((CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL) && \
+                                    !APM_BUILD_TYPE(APM_BUILD_Replay) && !APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone))
+#endif
@@ -20,7 +20,8 @@
     LOG_XKV2_MSG, \
     LOG_XKY0_MSG, \
     LOG_XKY1_MSG, \
-    LOG_XKFA_MSG
+    LOG_XKFA_MSG, \
+    LOG_XKLT_MSG
 
 // @LoggerMessage: XKF0
 // @Description: EKF3 beacon sensor diagnostics
@@ -400,6 +401,28 @@ struct PACKED log_XKTV {
     float tvd;
 };
 
+// @LoggerMessage: XKLT
+// @Description: EKF3 per lane update timing
+// @Field: TimeUS: Time since system startup
+// @Field: C: EKF3 core this data is for
+// @Field: Ex: thread running this lane, 0 is the thread calling the EKF, 1 and above are lane worker threads
+// @Field: Cnt: number of updates in this period
+// @Field: Avg: average time taken to update this lane
+// @Field: Max: maximum time taken to update this lane
+// @Field: FAvg: average time taken to update all lanes
+// @Field: FMax: maximum time taken to update all lanes
+struct PACKED log_XKLT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t core;
+    uint8_t executor;
+    uint16_t count;
+    uint16_t avg_us;
+    uint16_t max_us;
+    uint16_t frame_avg_us;
+    uint16_t frame_max_us;
+};
+
 // @LoggerMessage: XKV1
 // @Description: EKF3 State variances (primary core)
 // @Field: TimeUS: Time since system startup
@@ -478,6 +501,8 @@ struct PACKED log_XKV {
       "XKT", "QBIffffffff", "TimeUS,C,Cnt,IMUMin,IMUMax,EKFMin,EKFMax,AngMin,AngMax,VMin,VMax", "s#sssssssss", "F-000000000", true }, \
     { LOG_XKTV_MSG, sizeof(log_XKTV),                         \
       "XKTV", "QBff", "TimeUS,C,TVS,TVD", "s#rr", "F-00", true }, \
+    { LOG_XKLT_MSG, sizeof(log_XKLT),                         \
+      "XKLT", "QBBHHHHH", "TimeUS,C,Ex,Cnt,Avg,Max,FAvg,FMax", "s#--ssss", "F---FFFF", true }, \
     { LOG_XKV1_MSG, sizeof(log_XKV), \
       "XKV1","QBffffffffffff","TimeUS,C,V00,V01,V02,V03,V04,V05,V06,V07,V08,V09,V10,V11", "s#------------", "F-------------" , true }, \
     { LOG_XKV2_MSG, sizeof(log_XKV), \
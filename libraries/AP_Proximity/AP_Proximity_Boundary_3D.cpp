@@ -23,30 +23,43 @@
 */
 AP_Proximity_Boundary_3D::AP_Proximity_Boundary_3D() 
 {
-    // initialise sector edge vector used for building the boundary fence
+    // initialise sector edge geometry used for building the boundary fence
     init();
 }
 
-// initialise the boundary and sector_edge_vector array used for object avoidance
-//   should be called if the sector_middle_deg or _sector_width_deg arrays are changed
+// initialise the boundary and sector edge geometry used for object avoidance
 void AP_Proximity_Boundary_3D::init()
 {
+    for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
+        const float edge_rad = radians(sector_middle_deg(sector) + (PROXIMITY_SECTOR_WIDTH_DEG/2.0f));
+        _sector_edge_unit[sector] = Vector2f{cosf(edge_rad), sinf(edge_rad)};
+    }
     for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        const float pitch = ((float)_pitch_middle_deg[layer]);
+        const float pitch_rad = radians(_pitch_middle_deg[layer]);
+        _layer_cos_pitch[layer] = cosf(pitch_rad);
+        _layer_sin_pitch[layer] = sinf(pitch_rad);
         for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            const float angle_rad = ((float)_sector_middle_deg[sector]+(PROXIMITY_SECTOR_WIDTH_DEG/2.0f));
-            _sector_edge_vector[layer][sector].offset_bearing(angle_rad, pitch, 100.0f);
-            _boundary_points[layer][sector] = _sector_edge_vector[layer][sector] * PROXIMITY_BOUNDARY_DIST_DEFAULT;
+            _boundary_cm[layer][sector] = distance_to_cm(PROXIMITY_BOUNDARY_DIST_DEFAULT);
         }
     }
 }
 
+// body frame vector (in cm) to the boundary point on the edge between sector and the next sector (CW)
+Vector3f AP_Proximity_Boundary_3D::boundary_point(uint8_t layer, uint8_t sector) const
+{
+    const float dist_cm = _boundary_cm[layer][sector];
+    const float horizontal_cm = _layer_cos_pitch[layer] * dist_cm;
+    return Vector3f{_sector_edge_unit[sector].x * horizontal_cm,
+                    _sector_edge_unit[sector].y * horizontal_cm,
+                    _layer_sin_pitch[layer] * dist_cm};
+}
+
 // returns face corresponding to the provided yaw and (optionally) pitch
 // pitch is the vertical body-frame angle (in degrees) to the obstacle (0=directly ahead, 90 is above the vehicle)
 // yaw is the horizontal body-frame angle (in degrees) to the obstacle (0=directly ahead of the vehicle, 90 is to the right of the vehicle)
 AP_Proximity_Boundary_3D::Face AP_Proximity_Boundary_3D::get_face(float pitch, float yaw) const
 {
-    const uint8_t sector = wrap_360(yaw + (PROXIMITY_SECTOR_WIDTH_DEG * 0.5f)) / 45.0f;
+    const uint8_t sector = MIN(wrap_360(yaw + (PROXIMITY_SECTOR_WIDTH_DEG * 0.5f)) / PROXIMITY_SECTOR_WIDTH_DEG, PROXIMITY_NUM_SECTORS - 1);
     const float pitch_limited = constrain_float(pitch, -75.0f, 74.9f);
     const uint8_t layer = (pitch_limited + 75.0f)/PROXIMITY_PITCH_WIDTH_DEG;
     return Face{layer, sector};
@@ -64,7 +77,7 @@ void AP_Proximity_Boundary_3D::set_face_attributes(const Face &face, float pitch
     }
 
     // ignore update if another instance has provided a shorter distance within the last 0.2 seconds
-    if ((prx_instance != _prx_instance[face.layer][face.sector]) && _distance_valid[face.layer][face.sector] && (_filtered_distance[face.layer][face.sector].get() < distance)) {
+    if ((prx_instance != _prx_instance[face.layer][face.sector]) && distance_valid(face.layer, face.sector) && (_filtered_distance[face.layer][face.sector] < distance)) {
         // check if recent
         const uint32_t now_ms = AP_HAL::millis();
         if (now_ms - _last_update_ms[face.layer][face.sector] < PROXIMITY_FACE_RESET_MS) {
@@ -72,10 +85,10 @@ void AP_Proximity_Boundary_3D::set_face_attributes(const Face &face, float pitch
         }
     }
 
-    _angle_deg[face.layer][face.sector] = angle;
-    _pitch_deg[face.layer][face.sector] = pitch;
-    _distance[face.layer][face.sector] = distance;
-    _distance_valid[face.layer][face.sector] = true;
+    _angle_cd[face.layer][face.sector] = uint16_t(wrap_360_cd(roundf(angle * 100.0f)));
+    _pitch_cd[face.layer][face.sector] = int16_t(roundf(constrain_float(pitch, -90.0f, 90.0f) * 100.0f));
+    _distance_cm[face.layer][face.sector] = distance_to_cm(distance);
+    set_distance_valid(face.layer, face.sector, true);
     _prx_instance[face.layer][face.sector] = prx_instance;
 
     // apply filter
@@ -85,13 +98,21 @@ void AP_Proximity_Boundary_3D::set_face_attributes(const Face &face, float pitch
     update_boundary(face);
 }
 
-// apply a new cutoff_freq to low-pass filter
-void AP_Proximity_Boundary_3D::apply_filter_freq(float cutoff_freq)
+// mark a face's distance valid or invalid. An obstacle is valid if
+// its sector or either of the next two sectors (CW) are valid, see
+// convert_obstacle_num_to_face, so up to three obstacles are updated
+void AP_Proximity_Boundary_3D::set_distance_valid(uint8_t layer, uint8_t sector, bool valid)
 {
-    for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            _filtered_distance[layer][sector].set_cutoff_frequency(cutoff_freq);
-        }
+    _distance_valid.setonoff(face_index(layer, sector), valid);
+
+    uint8_t obstacle_sector = sector;
+    for (uint8_t i=0; i < 3; i++) {
+        const uint8_t next_sector = get_next_sector(obstacle_sector);
+        const bool obstacle_valid = distance_valid(layer, obstacle_sector) ||
+                                    distance_valid(layer, next_sector) ||
+                                    distance_valid(layer, get_next_sector(next_sector));
+        _obstacle_valid.setonoff(face_index(layer, obstacle_sector), obstacle_valid);
+        obstacle_sector = get_prev_sector(obstacle_sector);
     }
 }
 
@@ -101,18 +122,15 @@ void AP_Proximity_Boundary_3D::set_filtered_distance(const Face &face, float dis
     if (!face.valid()) {
         return;
     }
-    if (!is_equal(_filtered_distance[face.layer][face.sector].get_cutoff_freq(), _filter_freq)) {
-        // cutoff freq has changed
-        apply_filter_freq(_filter_freq);
-    }
 
     const uint32_t now_ms = AP_HAL::millis();
     const uint32_t dt = now_ms - _last_update_ms[face.layer][face.sector];
-    if (dt < PROXIMITY_FILT_RESET_TIME) {
-        _filtered_distance[face.layer][face.sector].apply(distance, dt* 0.001f);
+    float &filtered_distance = _filtered_distance[face.layer][face.sector];
+    if (dt < PROXIMITY_FILT_RESET_TIME && _last_update_ms[face.layer][face.sector] != 0) {
+        filtered_distance += (distance - filtered_distance) * calc_lowpass_alpha_dt(dt * 0.001f, MAX(_filter_freq, 0.0f));
     } else {
         // reset filter since last distance was passed a long time back
-        _filtered_distance[face.layer][face.sector].reset(distance);
+        filtered_distance = distance;
     }
     _last_update_ms[face.layer][face.sector] = now_ms;
 }
@@ -135,50 +153,47 @@ void AP_Proximity_Boundary_3D::update_boundary(const Face &face)
 
     // boundary point lies on the line between the two sectors at the shorter distance found in the two sectors
     float shortest_distance = PROXIMITY_BOUNDARY_DIST_DEFAULT;
-    if (_distance_valid[layer][sector] && _distance_valid[layer][next_sector]) {
-        shortest_distance = MIN(_filtered_distance[layer][sector].get(), _filtered_distance[layer][next_sector].get());
-    } else if (_distance_valid[layer][sector]) {
-        shortest_distance = _filtered_distance[layer][sector].get();
-    } else if (_distance_valid[layer][next_sector]) {
-        shortest_distance = _filtered_distance[layer][next_sector].get();
+    if (distance_valid(layer, sector) && distance_valid(layer, next_sector)) {
+        shortest_distance = MIN(_filtered_distance[layer][sector], _filtered_distance[layer][next_sector]);
+    } else if (distance_valid(layer, sector)) {
+        shortest_distance = _filtered_distance[layer][sector];
+    } else if (distance_valid(layer, next_sector)) {
+        shortest_distance = _filtered_distance[layer][next_sector];
     }
     if (shortest_distance < PROXIMITY_BOUNDARY_DIST_MIN) {
         shortest_distance = PROXIMITY_BOUNDARY_DIST_MIN;
     }
-    _boundary_points[layer][sector] = _sector_edge_vector[layer][sector] * shortest_distance;
+    _boundary_cm[layer][sector] = distance_to_cm(shortest_distance);
 
     // if the next sector (clockwise) has an invalid distance, set boundary to create a cup like boundary
-    if (!_distance_valid[layer][next_sector]) {
-        _boundary_points[layer][next_sector] = _sector_edge_vector[layer][next_sector] * shortest_distance;
+    if (!distance_valid(layer, next_sector)) {
+        _boundary_cm[layer][next_sector] = distance_to_cm(shortest_distance);
     }
 
     // repeat for edge between sector and previous sector
     const uint8_t prev_sector = get_prev_sector(sector);
     shortest_distance = PROXIMITY_BOUNDARY_DIST_DEFAULT;
-    if (_distance_valid[layer][prev_sector] && _distance_valid[layer][sector]) {
-        shortest_distance = MIN(_filtered_distance[layer][prev_sector].get(), _filtered_distance[layer][sector].get());
-    } else if (_distance_valid[layer][prev_sector]) {
-        shortest_distance = _filtered_distance[layer][prev_sector].get();
-    } else if (_distance_valid[layer][sector]) {
-        shortest_distance = _filtered_distance[layer][sector].get();
+    if (distance_valid(layer, prev_sector) && distance_valid(layer, sector)) {
+        shortest_distance = MIN(_filtered_distance[layer][prev_sector], _filtered_distance[layer][sector]);
+    } else if (distance_valid(layer, prev_sector)) {
+        shortest_distance = _filtered_distance[layer][prev_sector];
+    } else if (distance_valid(layer, sector)) {
+        shortest_distance = _filtered_distance[layer][sector];
     }
-    _boundary_points[layer][prev_sector] = _sector_edge_vector[layer][prev_sector] * shortest_distance;
+    _boundary_cm[layer][prev_sector] = distance_to_cm(shortest_distance);
 
     // if the sector counter-clockwise from the previous sector has an invalid distance, set boundary to create a cup-like boundary
     const uint8_t prev_sector_ccw = get_prev_sector(prev_sector);
-    if (!_distance_valid[layer][prev_sector_ccw]) {
-        _boundary_points[layer][prev_sector_ccw] = _sector_edge_vector[layer][prev_sector_ccw] * shortest_distance;
+    if (!distance_valid(layer, prev_sector_ccw)) {
+        _boundary_cm[layer][prev_sector_ccw] = distance_to_cm(shortest_distance);
     }
 }
 
 // reset boundary.  marks all distances as invalid
 void AP_Proximity_Boundary_3D::reset()
 {
-    for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            _distance_valid[layer][sector] = false;
-        }
-    }
+    _distance_valid.clearall();
+    _obstacle_valid.clearall();
 }
 
 // Reset this location, specified by Face object, back to default
@@ -191,7 +206,7 @@ void AP_Proximity_Boundary_3D::reset_face(const Face &face, uint8_t prx_instance
     }
 
     // return immediately if face already has no valid distance
-    if (!_distance_valid[face.layer][face.sector]) {
+    if (!distance_valid(face.layer, face.sector)) {
         return;
     }
 
@@ -203,7 +218,7 @@ void AP_Proximity_Boundary_3D::reset_face(const Face &face, uint8_t prx_instance
         }
     }
 
-    _distance_valid[face.layer][face.sector] = false;
+    set_distance_valid(face.layer, face.sector, false);
 
     // update simple avoidance boundary
     update_boundary(face);
@@ -219,15 +234,14 @@ void AP_Proximity_Boundary_3D::check_face_timeout()
     }
     _last_check_face_timeout_ms = now_ms;
 
-    for (uint8_t layer=0; layer < PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            if (_distance_valid[layer][sector]) {
-                if ((now_ms - _last_update_ms[layer][sector]) > PROXIMITY_FACE_RESET_MS) {
-                    // this face has a valid distance but wasn't updated for a long time, reset it
-                    _distance_valid[layer][sector] = false;
-                    update_boundary(AP_Proximity_Boundary_3D::Face{layer, sector});
-                }
-            }
+    // only valid faces need checking
+    for (int16_t i = _distance_valid.next_set(0); i >= 0; i = _distance_valid.next_set(i+1)) {
+        const uint8_t layer = i / PROXIMITY_NUM_SECTORS;
+        const uint8_t sector = i % PROXIMITY_NUM_SECTORS;
+        if ((now_ms - _last_update_ms[layer][sector]) > PROXIMITY_FACE_RESET_MS) {
+            // this face has a valid distance but wasn't updated for a long time, reset it
+            set_distance_valid(layer, sector, false);
+            update_boundary(AP_Proximity_Boundary_3D::Face{layer, sector});
         }
     }
 }
@@ -238,8 +252,8 @@ bool AP_Proximity_Boundary_3D::get_distance(const Face &face, float &distance) c
     if (!face.valid()) {
         return false;
     }
-    if (_distance_valid[face.layer][face.sector]) {
-        distance = _distance[face.layer][face.sector];
+    if (distance_valid(face.layer, face.sector)) {
+        distance = _distance_cm[face.layer][face.sector] * 0.01f;
         return true;
     }
 
@@ -247,9 +261,9 @@ bool AP_Proximity_Boundary_3D::get_distance(const Face &face, float &distance) c
 }
 
 // get the total number of obstacles 
-uint8_t AP_Proximity_Boundary_3D::get_obstacle_count() const
+uint16_t AP_Proximity_Boundary_3D::get_obstacle_count() const
 {
-    return PROXIMITY_NUM_LAYERS * PROXIMITY_NUM_SECTORS;
+    return PROXIMITY_NUM_FACES;
 }
 
 // Converts obstacle_num passed from avoidance library into appropriate face of the boundary
@@ -257,26 +271,20 @@ uint8_t AP_Proximity_Boundary_3D::get_obstacle_count() const
 // "update_boundary" method manipulates two sectors ccw and one sector cw from any valid face.
 // Any boundary that does not fall into these manipulated faces are useless, and will be marked as false
 // The resultant is packed into a Boundary Location object and returned by reference as "face"
-bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint8_t obstacle_num, Face& face) const
+bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint16_t obstacle_num, Face& face) const
 {
-    // obstacle num is just "flattened layers, and sectors"
-    const uint8_t layer = obstacle_num / PROXIMITY_NUM_SECTORS;
-    const uint8_t sector = obstacle_num % PROXIMITY_NUM_SECTORS;
-    face.sector = sector;
-    face.layer = layer;
-
-    uint8_t valid_sector = sector;
-    // check for 3 adjacent sectors
-    for (uint8_t i=0; i < 3; i++) {
-        if (_distance_valid[layer][valid_sector]) {
-            // update boundary has manipulated this face
-            return true;
-        }
-        valid_sector = get_next_sector(valid_sector);
+    if (obstacle_num >= PROXIMITY_NUM_FACES) {
+        return false;
     }
 
-    // this face was not manipulated by "update_boundary" and is stale. Don't use it
-    return false;
+    // obstacle num is just "flattened layers, and sectors"
+    face.layer = obstacle_num / PROXIMITY_NUM_SECTORS;
+    face.sector = obstacle_num % PROXIMITY_NUM_SECTORS;
+
+    // _obstacle_valid is kept set for faces where any of 3 adjacent sectors
+    // are valid, i.e. the faces "update_boundary" has manipulated. Others are
+    // stale and not used
+    return _obstacle_valid.get(obstacle_num);
 }
 
 // Appropriate layer and sector are found from the passed obstacle_num
@@ -284,7 +292,7 @@ bool AP_Proximity_Boundary_3D::convert_obstacle_num_to_face(uint8_t obstacle_num
 // Then returns the closest point on this line from vehicle, in body-frame. 
 // Used by GPS based Simple Avoidance  
 // False is returned if the obstacle_num provided does not produce a valid obstacle 
-bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_obstacle) const
+bool AP_Proximity_Boundary_3D::get_obstacle(uint16_t obstacle_num, Vector3f& vec_to_obstacle) const
 {
     Face face;
     if (!convert_obstacle_num_to_face(obstacle_num, face)) {
@@ -294,12 +302,25 @@ bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_
     const uint8_t sector_end = face.sector;
     const uint8_t sector_start = get_next_sector(face.sector);
     
-    const Vector3f start = _boundary_points[face.layer][sector_start];
-    const Vector3f end = _boundary_points[face.layer][sector_end];
+    const Vector3f start = boundary_point(face.layer, sector_start);
+    const Vector3f end = boundary_point(face.layer, sector_end);
     vec_to_obstacle = Vector3f::point_on_line_closest_to_other_point(start, end, Vector3f{});
     return true;
 }
 
+// Finds the first valid obstacle numbered obstacle_num or higher and
+// returns the closest point on it from the vehicle, as get_obstacle() does
+// False is returned if there are no more valid obstacles
+bool AP_Proximity_Boundary_3D::get_next_obstacle(uint16_t &obstacle_num, Vector3f& vec_to_obstacle) const
+{
+    const int16_t next = _obstacle_valid.next_set(obstacle_num);
+    if (next < 0) {
+        return false;
+    }
+    obstacle_num = next;
+    return get_obstacle(obstacle_num, vec_to_obstacle);
+}
+
 // Appropriate layer and sector are found from the passed obstacle_num
 // This function then draws a line between this sector, and sector + 1 at the given layer
 // Then returns the closest point on this line from the segment that was passed, in body-frame.
@@ -308,7 +329,7 @@ bool AP_Proximity_Boundary_3D::get_obstacle(uint8_t obstacle_num, Vector3f& vec_
 // This helps us know if the passed line segment was in the direction of the boundary, or going in a different direction.
 // Used by GPS based Simple Avoidance  - for "brake mode"
 // False is returned if the obstacle_num provided does not produce a valid obstacle
-bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint8_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
+bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint16_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const
 {
     Face face;
     if (!convert_obstacle_num_to_face(obstacle_num, face)) {
@@ -318,8 +339,8 @@ bool AP_Proximity_Boundary_3D::closest_point_from_segment_to_obstacle(uint8_t ob
 
     const uint8_t sector_end = face.sector;
     const uint8_t sector_start = get_next_sector(face.sector);
-    const Vector3f start = _boundary_points[face.layer][sector_start];
-    const Vector3f end = _boundary_points[face.layer][sector_end];
+    const Vector3f start = boundary_point(face.layer, sector_start);
+    const Vector3f end = boundary_point(face.layer, sector_end);
 
     // closest point between passed line segment and boundary
     Vector3f::segment_to_segment_closest_point(seg_start, seg_end, start, end, closest_point);
@@ -342,21 +363,19 @@ bool AP_Proximity_Boundary_3D::get_closest_object(float& angle_deg, float &dista
     // check boundary for shortest distance
     // only check for middle layers and higher
     // lower layers might contain ground, which will give false pre-arm failure
-    for (uint8_t layer=PROXIMITY_MIDDLE_LAYER; layer<PROXIMITY_NUM_LAYERS; layer++) {
-        for (uint8_t sector=0; sector<PROXIMITY_NUM_SECTORS; sector++) {
-            if (_distance_valid[layer][sector]) {
-                if (!closest_found || (_distance[layer][sector] < _distance[closest_layer][closest_sector])) {
-                    closest_layer = layer;
-                    closest_sector = sector;
-                    closest_found = true;
-                }
-            }
+    for (int16_t i = _distance_valid.next_set(face_index(PROXIMITY_MIDDLE_LAYER, 0)); i >= 0; i = _distance_valid.next_set(i+1)) {
+        const uint8_t layer = i / PROXIMITY_NUM_SECTORS;
+        const uint8_t sector = i % PROXIMITY_NUM_SECTORS;
+        if (!closest_found || (_distance_cm[layer][sector] < _distance_cm[closest_layer][closest_sector])) {
+            closest_layer = layer;
+            closest_sector = sector;
+            closest_found = true;
         }
     }
 
     if (closest_found) {
-        angle_deg = _angle_deg[closest_layer][closest_sector];
-        distance = _distance[closest_layer][closest_sector];
+        angle_deg = _angle_cd[closest_layer][closest_sector] * 0.01f;
+        distance = _distance_cm[closest_layer][closest_sector] * 0.01f;
     }
     return closest_found;
 }
@@ -371,9 +390,9 @@ uint8_t AP_Proximity_Boundary_3D::get_horizontal_object_count() const
 // returns false if no angle or distance could be returned for some reason
 bool AP_Proximity_Boundary_3D::get_horizontal_object_angle_and_distance(uint8_t object_number, float &angle_deg, float &distance) const
 {
-    if ((object_number < PROXIMITY_NUM_SECTORS) && _distance_valid[PROXIMITY_MIDDLE_LAYER][object_number]) {
-        angle_deg = _angle_deg[PROXIMITY_MIDDLE_LAYER][object_number];
-        distance = _filtered_distance[PROXIMITY_MIDDLE_LAYER][object_number].get();
+    if ((object_number < PROXIMITY_NUM_SECTORS) && distance_valid(PROXIMITY_MIDDLE_LAYER, object_number)) {
+        angle_deg = _angle_cd[PROXIMITY_MIDDLE_LAYER][object_number] * 0.01f;
+        distance = _filtered_distance[PROXIMITY_MIDDLE_LAYER][object_number];
         return true;
     }
     return false;
@@ -381,15 +400,18 @@ bool AP_Proximity_Boundary_3D::get_horizontal_object_angle_and_distance(uint8_t
 
 // get an obstacle info for AP_Periph
 // returns false if no angle or distance could be returned for some reason
-bool AP_Proximity_Boundary_3D::get_obstacle_info(uint8_t obstacle_num, float &angle_deg, float &pitch_deg, float &distance) const
+bool AP_Proximity_Boundary_3D::get_obstacle_info(uint16_t obstacle_num, float &angle_deg, float &pitch_deg, float &distance) const
 {
+    if (obstacle_num >= PROXIMITY_NUM_FACES) {
+        return false;
+    }
     // obstacle num is just "flattened layers, and sectors"
     const uint8_t layer = obstacle_num / PROXIMITY_NUM_SECTORS;
     const uint8_t sector = obstacle_num % PROXIMITY_NUM_SECTORS;
-    if (_distance_valid[layer][sector]) {
-        angle_deg = _angle_deg[layer][sector];
-        pitch_deg = _pitch_deg[layer][sector];
-        distance = _filtered_distance[layer][sector].get();
+    if (distance_valid(layer, sector)) {
+        angle_deg = _angle_cd[layer][sector] * 0.01f;
+        pitch_deg = _pitch_cd[layer][sector] * 0.01f;
+        distance = _filtered_distance[layer][sector];
         return true;
     }
 
@@ -403,36 +425,52 @@ bool AP_Proximity_Boundary_3D::get_filtered_distance(const Face &face, float &di
         return false;
     }
 
-    if (!_distance_valid[face.layer][face.sector]) {
+    if (!distance_valid(face.layer, face.sector)) {
         // invalid distace
         return false;
     }
 
-    distance = _filtered_distance[face.layer][face.sector].get();
+    distance = _filtered_distance[face.layer][face.sector];
     return true;
 }
 
 // Get raw and filtered distances in 8 directions per layer
 bool AP_Proximity_Boundary_3D::get_layer_distances(uint8_t layer_number, float dist_max, Proximity_Distance_Array &prx_dist_array, Proximity_Distance_Array &prx_filt_dist_array) const
 {
-    // cycle through all sectors filling in distances and orientations
+    // cycle through all directions filling in distances and orientations
     // see MAV_SENSOR_ORIENTATION for orientations (0 = forward, 1 = 45 degree clockwise from north, etc)
+    // each direction covers the sectors within 22.5 degrees of it. The
+    // number of sectors per direction is always odd so this is centred
+    constexpr uint8_t sectors_per_direction = PROXIMITY_NUM_SECTORS / PROXIMITY_MAX_DIRECTION;
+    static_assert(sectors_per_direction % 2 == 1, "sectors per direction must be odd");
+    constexpr uint8_t half_width = sectors_per_direction / 2;
+
+    if (layer_number >= PROXIMITY_NUM_LAYERS) {
+        return false;
+    }
+
     bool valid_distances = false;
     prx_dist_array.offset_valid = 0;
     prx_filt_dist_array.offset_valid = 0;
     for (uint8_t i=0; i<PROXIMITY_MAX_DIRECTION; i++) {
         prx_dist_array.orientation[i] = i;
-        const AP_Proximity_Boundary_3D::Face face(layer_number, i);
-        if (!face.valid()) {
-            return false;
-        }
-        if (get_distance(face, prx_dist_array.distance[i]) && get_filtered_distance(face, prx_filt_dist_array.distance[i])) {
+        prx_dist_array.distance[i] = dist_max;
+        prx_filt_dist_array.distance[i] = dist_max;
+
+        uint8_t sector = (i * sectors_per_direction + PROXIMITY_NUM_SECTORS - half_width) % PROXIMITY_NUM_SECTORS;
+        for (uint8_t j=0; j<sectors_per_direction; j++, sector = get_next_sector(sector)) {
+            const AP_Proximity_Boundary_3D::Face face(layer_number, sector);
+            float distance, filt_distance;
+            if (!get_distance(face, distance) || !get_filtered_distance(face, filt_distance)) {
+                continue;
+            }
+            if (!(prx_dist_array.offset_valid & (1U << i)) || distance < prx_dist_array.distance[i]) {
+                prx_dist_array.distance[i] = distance;
+                prx_filt_dist_array.distance[i] = filt_distance;
+            }
             valid_distances = true;
             prx_dist_array.offset_valid |= (1U << i);
             prx_filt_dist_array.offset_valid |= (1U << i);
-        } else {
-            prx_dist_array.distance[i] = dist_max;
-            prx_filt_dist_array.distance[i] = dist_max;
         }
     }
 
@@ -15,11 +15,13 @@
 
 #pragma once
 
+#include "AP_Proximity_config.h"
+
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/Bitmask.h>
 #include <AP_Math/AP_Math.h>
-#include <Filter/LowPassFilter.h>
 
-#define PROXIMITY_NUM_SECTORS         8       // number of sectors
+#define PROXIMITY_NUM_SECTORS         AP_PROXIMITY_NUM_SECTORS  // number of sectors
 #define PROXIMITY_NUM_LAYERS          5       // num of layers in a sector
 #define PROXIMITY_MIDDLE_LAYER        2       // middle layer
 #define PROXIMITY_PITCH_WIDTH_DEG     30      // width between each layer in degrees
@@ -28,6 +30,7 @@
 #define PROXIMITY_BOUNDARY_DIST_DEFAULT 100   // if we have no data for a sector, boundary is placed 100m out
 #define PROXIMITY_FILT_RESET_TIME     1000    // reset filter if last distance was pushed more than this many ms away
 #define PROXIMITY_FACE_RESET_MS       1000    // face will be reset if not updated within this many ms
+#define PROXIMITY_NUM_FACES           (PROXIMITY_NUM_LAYERS * PROXIMITY_NUM_SECTORS)
 
 // structure holding distances in PROXIMITY_MAX_DIRECTION directions. used for sending distances to ground station
 #define PROXIMITY_MAX_DIRECTION 8
@@ -66,7 +69,7 @@ public:
 	    bool operator !=(const Face &other) const { return ((layer != other.layer) || (sector != other.sector)); }
 
         uint8_t layer;  // vertical "steps" on the 3D Boundary. 0th layer is the bottom most layer, 1st layer is 30 degrees above (in body frame) and so on
-        uint8_t sector; // horizontal "steps" on the 3D Boundary. 0th sector is directly in front of the vehicle. Each sector is 45 degrees wide.
+        uint8_t sector; // horizontal "steps" on the 3D Boundary. 0th sector is directly in front of the vehicle. Each sector is PROXIMITY_SECTOR_WIDTH_DEG wide.
     };
 
     // returns face corresponding to the provided yaw and (optionally) pitch
@@ -103,15 +106,22 @@ public:
     bool get_distance(const Face &face, float &distance) const;
 
     // Get the total number of obstacles
-    uint8_t get_obstacle_count() const;
+    uint16_t get_obstacle_count() const;
 
     // Returns a body frame vector (in cm) to an obstacle
     // False is returned if the obstacle_num provided does not produce a valid obstacle
-    bool get_obstacle(uint8_t obstacle_num, Vector3f& vec_to_boundary) const;
+    bool get_obstacle(uint16_t obstacle_num, Vector3f& vec_to_boundary) const;
+
+    // Finds the first valid obstacle numbered obstacle_num or higher, updating obstacle_num
+    // and returning a body frame vector (in cm) to it. Invalid obstacles are skipped a
+    // word of the validity bitmask at a time, so iterating over a sparse high resolution
+    // boundary only costs as much as the number of valid obstacles.
+    // False is returned if there are no more valid obstacles
+    bool get_next_obstacle(uint16_t &obstacle_num, Vector3f& vec_to_boundary) const;
 
     // Returns a body frame vector (in cm) nearest to obstacle, in betwen seg_start and seg_end
     // True is returned if the segment intersects a plane formed by considering the "closest point" as normal vector to the plane.
-    bool closest_point_from_segment_to_obstacle(uint8_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const;
+    bool closest_point_from_segment_to_obstacle(uint16_t obstacle_num, const Vector3f& seg_start, const Vector3f& seg_end, Vector3f& closest_point) const;
 
     // get distance and angle to closest object (used for pre-arm check)
     //   returns true on success, false if no valid readings
@@ -122,20 +132,23 @@ public:
     bool get_horizontal_object_angle_and_distance(uint8_t object_number, float& angle_deg, float &distance) const;
 
     // get obstacle info for AP_Periph
-    bool get_obstacle_info(uint8_t obstacle_num, float &angle_deg, float &pitch_deg, float &distance) const;
+    bool get_obstacle_info(uint16_t obstacle_num, float &angle_deg, float &pitch_deg, float &distance) const;
 
     // get number of layers
     uint8_t get_num_layers() const { return PROXIMITY_NUM_LAYERS; }
 
-    // get raw and filtered distances in 8 directions per layer.
+    // get raw and filtered distances in 8 directions per layer. With more than 8 sectors
+    // each direction is the shortest distance in the sectors within 22.5 degrees of it
     bool get_layer_distances(uint8_t layer_number, float dist_max, Proximity_Distance_Array &prx_dist_array, Proximity_Distance_Array &prx_filt_dist_array) const;
 
     // pass down filter cut-off freq from params
     void set_filter_freq(float filt_freq) { _filter_freq = filt_freq; }
 
     // sectors
-    static_assert(PROXIMITY_NUM_SECTORS == 8, "PROXIMITY_NUM_SECTOR must be 8");
-    const uint16_t _sector_middle_deg[PROXIMITY_NUM_SECTORS] {0, 45, 90, 135, 180, 225, 270, 315};    // middle angle of each sector
+    static_assert(PROXIMITY_NUM_SECTORS % PROXIMITY_MAX_DIRECTION == 0 && 360 % PROXIMITY_NUM_SECTORS == 0,
+                  "PROXIMITY_NUM_SECTORS must be a multiple of 8 that divides 360");
+    static_assert(PROXIMITY_NUM_SECTORS <= UINT8_MAX, "PROXIMITY_NUM_SECTORS must fit in a uint8_t");
+    static float sector_middle_deg(uint8_t sector) { return sector * PROXIMITY_SECTOR_WIDTH_DEG; }   // middle angle of each sector
     // layers
     static_assert(PROXIMITY_NUM_LAYERS == 5, "PROXIMITY_NUM_LAYERS must be 5");
     const int16_t _pitch_middle_deg[PROXIMITY_NUM_LAYERS] {-60, -30, 0, 30, 60};
@@ -156,10 +169,19 @@ private:
     // "update_boundary" method manipulates two sectors ccw and one sector cw from any valid face.
     // Any boundary that does not fall into these manipulated faces are useless, and will be marked as false
     // The resultant is packed into a Boundary Location object and returned by reference as "face"
-    bool convert_obstacle_num_to_face(uint8_t obstacle_num, Face& face) const WARN_IF_UNUSED;
+    bool convert_obstacle_num_to_face(uint16_t obstacle_num, Face& face) const WARN_IF_UNUSED;
+
+    // index of a face in the flattened boundary, this is also its obstacle_num
+    static uint16_t face_index(uint8_t layer, uint8_t sector) { return layer * PROXIMITY_NUM_SECTORS + sector; }
+
+    // return true if a face has a valid distance
+    bool distance_valid(uint8_t layer, uint8_t sector) const { return _distance_valid.get(face_index(layer, sector)); }
+
+    // mark a face's distance valid or invalid, keeping the obstacle bitmask consistent
+    void set_distance_valid(uint8_t layer, uint8_t sector, bool valid);
 
-    // Apply a new cutoff_freq to low-pass filter
-    void apply_filter_freq(float cutoff_freq);
+    // body frame vector (in cm) to the boundary point on the edge between sector and the next sector (CW)
+    Vector3f boundary_point(uint8_t layer, uint8_t sector) const;
 
     // Apply low pass filter on the raw distance
     void set_filtered_distance(const Face &face, float distance);
@@ -167,18 +189,28 @@ private:
     // Return filtered distance for the passed in face
     bool get_filtered_distance(const Face &face, float &distance) const;
 
-    Vector3f _sector_edge_vector[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];
-    Vector3f _boundary_points[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];
-
-    float _angle_deg[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];          // yaw angle in degrees to closest object within each sector and layer
-    float _pitch_deg[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];          // pitch angle in degrees to the closest object within each sector and layer
-    float _distance[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];       // distance to closest object within each sector and layer
-    bool _distance_valid[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];  // true if a valid distance received for each sector and layer
-    uint32_t _last_update_ms[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS]; // time when distance was last updated
-    uint8_t _prx_instance[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS]; // proximity sensor backend instance that provided the distance
-    LowPassFilterFloat _filtered_distance[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS]; // low pass filter
-    float _filter_freq;                                                 // cutoff freq of low pass filter
-    uint32_t _last_check_face_timeout_ms;                               // system time to throttle check_face_timeout method
+    // distances are stored in cm in a uint16_t, about 655m. This is well
+    // beyond the range of any supported sensor
+    static uint16_t distance_to_cm(float distance_m) { return uint16_t(constrain_float(roundf(distance_m * 100.0f), 0, UINT16_MAX)); }
+
+    // geometry of the boundary, the edge between each sector and the next is
+    // split into a horizontal unit vector per sector and the pitch of each layer
+    Vector2f _sector_edge_unit[PROXIMITY_NUM_SECTORS];
+    float _layer_cos_pitch[PROXIMITY_NUM_LAYERS];
+    float _layer_sin_pitch[PROXIMITY_NUM_LAYERS];
+
+    uint16_t _boundary_cm[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];     // distance in cm to the boundary point on the edge between each sector and the next
+
+    uint16_t _angle_cd[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];        // yaw angle in centi-degrees (0 ~ 36000) to closest object within each sector and layer
+    int16_t _pitch_cd[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];         // pitch angle in centi-degrees to the closest object within each sector and layer
+    uint16_t _distance_cm[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];     // distance in cm to closest object within each sector and layer
+    float _filtered_distance[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];  // low pass filtered distance in meters
+    Bitmask<PROXIMITY_NUM_FACES> _distance_valid;                           // true if a valid distance received for each face
+    Bitmask<PROXIMITY_NUM_FACES> _obstacle_valid;                           // true for each obstacle_num that convert_obstacle_num_to_face accepts
+    uint32_t _last_update_ms[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];  // time when distance was last updated
+    uint8_t _prx_instance[PROXIMITY_NUM_LAYERS][PROXIMITY_NUM_SECTORS];     // proximity sensor backend instance that provided the distance
+    float _filter_freq;                                                     // cutoff freq of low pass filter
+    uint32_t _last_check_face_timeout_ms;                                   // system time to throttle check_face_timeout method
 };
 
 // This class gives an easy way of making a temporary boundary, used for "sorting" distances.
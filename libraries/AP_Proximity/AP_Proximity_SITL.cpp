@@ -60,7 +60,7 @@ void AP_Proximity_SITL::update(void)
         set_status(AP_Proximity::Status::Good);
         // update distance in each sector
         for (uint8_t sector=0; sector < PROXIMITY_NUM_SECTORS; sector++) {
-            const float yaw_angle_deg = sector * 45.0f;
+            const float yaw_angle_deg = AP_Proximity_Boundary_3D::sector_middle_deg(sector);
             AP_Proximity_Boundary_3D::Face face = frontend.boundary.get_face(yaw_angle_deg);
             float fence_distance;
             if (get_distance_to_fence(yaw_angle_deg, fence_distance)) {
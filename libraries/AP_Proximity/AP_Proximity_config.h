@@ -85,3 +85,10 @@
 #ifndef AP_PROXIMITY_MR72_DRIVER_ENABLED
 #define AP_PROXIMITY_MR72_DRIVER_ENABLED (AP_PROXIMITY_MR72_ENABLED  || AP_PROXIMITY_HEXSOONRADAR_ENABLED)
 #endif  // AP_PROXIMITY_MR72_DRIVER_ENABLED
+
+// number of horizontal sectors in the proximity boundary. Must be a
+// multiple of 8 that divides 360 (8, 24, 40, 72 or 120). Boards with
+// a 360 degree lidar and memory to spare may use 72 (5 degree sectors)
+#ifndef AP_PROXIMITY_NUM_SECTORS
+#define AP_PROXIMITY_NUM_SECTORS 8
+#endif
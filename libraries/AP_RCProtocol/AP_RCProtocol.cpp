@@ -124,6 +124,9 @@ void AP_RCProtocol::init()
 #if AP_RCPROTOCOL_EMLID_RCIO_ENABLED
     backend[AP_RCProtocol::EMLID_RCIO] = NEW_NOTHROW AP_RCProtocol_Emlid_RCIO(*this);
 #endif
+
+    // recalculate the byte search candidates with the new backends
+    _byte_search.valid = false;
 }
 
 AP_RCProtocol::~AP_RCProtocol()
@@ -244,6 +247,18 @@ void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool
 
 bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
 {
+    return process_bytes(&byte, 1, baudrate);
+}
+
+/*
+  process a block of bytes received together from a uart
+ */
+bool AP_RCProtocol::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    if (n == 0) {
+        return false;
+    }
+
     uint32_t now = AP_HAL::millis();
     bool searching = should_search(now);
 
@@ -263,7 +278,7 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
 
     // first try current protocol
     if (_detected_protocol != AP_RCProtocol::NONE && !searching) {
-        backend[_detected_protocol]->process_byte(byte, baudrate);
+        backend[_detected_protocol]->process_bytes(bytes, n, baudrate);
         if (backend[_detected_protocol]->new_input()) {
             _new_input = true;
             _last_input_ms = now;
@@ -271,36 +286,81 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
         return true;
     }
 
-    // otherwise scan all protocols
+    // otherwise scan the protocols which can decode this baudrate. If
+    // more than one becomes detectable within the block, the one whose
+    // frame completed first wins, as it would have byte by byte
+    const uint32_t candidates = byte_candidates(baudrate);
+    rcprotocol_t found = AP_RCProtocol::NONE;
+    uint16_t found_ofs = UINT16_MAX;
+    bool found_new_input = false;
     for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
-        if (backend[i] != nullptr) {
-            if (!protocol_enabled(rcprotocol_t(i))) {
-                continue;
-            }
-            const uint32_t frame_count = backend[i]->get_rc_frame_count();
-            const uint32_t input_count = backend[i]->get_rc_input_count();
-            backend[i]->process_byte(byte, baudrate);
-            const uint32_t frame_count2 = backend[i]->get_rc_frame_count();
-            if (frame_count2 > frame_count) {
-                if (requires_3_frames((rcprotocol_t)i) && frame_count2 < 3) {
-                    continue;
-                }
-                _new_input = (input_count != backend[i]->get_rc_input_count());
-                _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
-                _last_input_ms = now;
-                _detected_with_bytes = true;
-                for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
-                    if (backend[j]) {
-                        backend[j]->reset_rc_frame_count();
-                    }
-                }
-                // stop decoding pulses to save CPU
-                hal.rcin->pulse_input_enable(false);
-                return true;
-            }
+        if ((candidates & (1U<<i)) == 0) {
+            continue;
+        }
+        const uint32_t frame_count = backend[i]->get_rc_frame_count();
+        const uint32_t input_count = backend[i]->get_rc_input_count();
+        backend[i]->start_block();
+        backend[i]->process_bytes(bytes, n, baudrate);
+        const uint32_t frame_count2 = backend[i]->get_rc_frame_count();
+        const uint32_t frames_needed = requires_3_frames((rcprotocol_t)i) ? 3 : 1;
+        if (frame_count2 == frame_count || frame_count2 < frames_needed) {
+            continue;
+        }
+        // the frame in this block which made the protocol detectable
+        const uint8_t nth = frame_count >= frames_needed ? 0 : frames_needed - frame_count - 1;
+        const uint16_t ofs = backend[i]->get_block_frame_ofs(nth);
+        if (found == AP_RCProtocol::NONE || ofs < found_ofs) {
+            found = (enum AP_RCProtocol::rcprotocol_t)i;
+            found_ofs = ofs;
+            found_new_input = (input_count != backend[i]->get_rc_input_count());
+        }
+    }
+    if (found == AP_RCProtocol::NONE) {
+        return false;
+    }
+    _new_input = found_new_input;
+    // this input has been reported, don't report it again on the next block
+    backend[found]->new_input();
+    _detected_protocol = found;
+    _last_input_ms = now;
+    _detected_with_bytes = true;
+    for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
+        if (backend[j]) {
+            backend[j]->reset_rc_frame_count();
+        }
+    }
+    // stop decoding pulses to save CPU
+    hal.rcin->pulse_input_enable(false);
+    return true;
+}
+
+/*
+  return a mask of the backends to search for byte input at a
+  baudrate. Most backends only decode one or two baudrates, so this
+  saves feeding every byte to every backend while searching
+ */
+static_assert(AP_RCProtocol::NONE <= 32, "byte search candidates must fit in 32 bits");
+
+uint32_t AP_RCProtocol::byte_candidates(uint32_t baudrate)
+{
+    if (_byte_search.valid &&
+        _byte_search.baudrate == baudrate &&
+        _byte_search.protocols_mask == rc_protocols_mask) {
+        return _byte_search.candidates;
+    }
+    uint32_t candidates = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
+        if (backend[i] != nullptr &&
+            protocol_enabled(rcprotocol_t(i)) &&
+            backend[i]->accepts_baudrate(baudrate)) {
+            candidates |= 1U<<i;
         }
     }
-    return false;
+    _byte_search.valid = true;
+    _byte_search.baudrate = baudrate;
+    _byte_search.protocols_mask = rc_protocols_mask;
+    _byte_search.candidates = candidates;
+    return candidates;
 }
 
 // handshake if nothing else has succeeded so far
@@ -378,13 +438,16 @@ void AP_RCProtocol::check_added_uart(void)
     const uint32_t current_baud = serial_configs[added.config_num].baud;
     process_handshake(current_baud);
 
+    uint8_t buf[64];
     uint32_t n = added.uart->available();
     n = MIN(n, 255U);
-    for (uint8_t i=0; i<n; i++) {
-        int16_t b = added.uart->read();
-        if (b >= 0) {
-            process_byte(uint8_t(b), current_baud);
+    while (n > 0) {
+        const ssize_t nread = added.uart->read(buf, MIN(n, sizeof(buf)));
+        if (nread <= 0) {
+            break;
         }
+        process_bytes(buf, uint16_t(nread), current_baud);
+        n -= nread;
     }
     if (searching) {
         if (now - added.last_config_change_ms > 1000) {
@@ -120,6 +120,7 @@ public:
     void process_pulse(uint32_t width_s0, uint32_t width_s1);
     void process_pulse_list(const uint32_t *widths, uint16_t n, bool need_swap);
     bool process_byte(uint8_t byte, uint32_t baudrate);
+    bool process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate);
     void process_handshake(uint32_t baudrate);
     void update(void);
 
@@ -292,6 +293,9 @@ private:
     // having them make an "add_input" callback):
     bool detect_async_protocol(rcprotocol_t protocol);
 
+    // return mask of backends which can decode bytes at baudrate
+    uint32_t byte_candidates(uint32_t baudrate);
+
     enum rcprotocol_t _detected_protocol = NONE;
     uint16_t _disabled_for_pulses;
     bool _detected_with_bytes;
@@ -312,6 +316,14 @@ private:
     // allowed RC protocols mask (first bit means "all")
     uint32_t rc_protocols_mask;
 
+    // cached byte_candidates() result
+    struct {
+        bool valid;
+        uint32_t baudrate;
+        uint32_t protocols_mask;
+        uint32_t candidates;
+    } _byte_search;
+
     rcprotocol_t _last_detected_protocol;
     bool _last_detected_using_uart;
     void announce_detected();
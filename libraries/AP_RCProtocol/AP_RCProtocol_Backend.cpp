@@ -74,6 +74,9 @@ void AP_RCProtocol_Backend::add_input(uint8_t num_values, uint16_t *values, bool
     memcpy(_pwm_values, values, num_values*sizeof(uint16_t));
     _num_channels = num_values;
     rc_frame_count++;
+    if (block_frames < ARRAY_SIZE(block_frame_ofs)) {
+        block_frame_ofs[block_frames++] = block_ofs;
+    }
     frontend.set_failsafe_active(in_failsafe);
 #if !AP_RC_CHANNEL_ENABLED
     // failsafed is sorted out in AP_IOMCU.cpp
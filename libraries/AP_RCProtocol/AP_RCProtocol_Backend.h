@@ -33,6 +33,31 @@ public:
     virtual void process_pulse(uint32_t width_s0, uint32_t width_s1) {}
     virtual void process_byte(uint8_t byte, uint32_t baudrate) {}
     virtual void process_handshake(uint32_t baudrate) {}
+
+    // process a block of bytes received together. Backends which can
+    // skip over bytes that can't start a frame override this
+    virtual void process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate) {
+        for (uint16_t i=0; i<n; i++) {
+            block_ofs = i;
+            process_byte(bytes[i], baudrate);
+        }
+    }
+
+    // start recording where frames complete in the next block passed
+    // to process_bytes()
+    void start_block(void) {
+        block_ofs = 0;
+        block_frames = 0;
+    }
+
+    // offset in the block of the byte which completed the nth frame
+    // since start_block(), or UINT16_MAX if there weren't that many
+    uint16_t get_block_frame_ofs(uint8_t nth) const {
+        return nth < block_frames ? block_frame_ofs[nth] : UINT16_MAX;
+    }
+
+    // return true if this backend decodes bytes at baudrate
+    virtual bool accepts_baudrate(uint32_t baudrate) const { return false; }
     uint16_t read(uint8_t chan);
     void read(uint16_t *pwm, uint8_t n);
     bool new_input();
@@ -128,6 +153,10 @@ protected:
     void add_input(uint8_t num_channels, uint16_t *values, bool in_failsafe, int16_t rssi=-1, int16_t rx_link_quality=-1);
     AP_RCProtocol &frontend;
 
+    // offset in the block of the byte being processed, set by
+    // process_bytes() implementations
+    uint16_t block_ofs;
+
     void log_data(AP_RCProtocol::rcprotocol_t prot, uint32_t timestamp, const uint8_t *data, uint8_t len) const;
 
     // decode channels from the standard 11bit format (used by CRSF and SBUS)
@@ -138,6 +167,11 @@ private:
     uint32_t last_rc_input_count;
     uint32_t rc_frame_count;
 
+    // where the first frames in the current block completed, so the
+    // frontend's search can tell which protocol completed a frame first
+    uint16_t block_frame_ofs[3];
+    uint8_t block_frames;
+
     uint16_t _pwm_values[MAX_RCIN_CHANNELS];
     uint8_t  _num_channels;
     int16_t rssi = -1;
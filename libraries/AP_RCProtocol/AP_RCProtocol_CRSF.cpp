@@ -165,12 +165,17 @@ uint16_t AP_RCProtocol_CRSF::get_link_rate(ProtocolType protocol) const {
 void AP_RCProtocol_CRSF::process_byte(uint8_t byte, uint32_t baudrate)
 {
     // reject RC data if we have been configured for standalone mode
-    if ((baudrate != CRSF_BAUDRATE && baudrate != CRSF_BAUDRATE_1MBIT && baudrate != CRSF_BAUDRATE_2MBIT) || _uart) {
+    if (!accepts_baudrate(baudrate) || _uart) {
         return;
     }
     _process_byte(byte);
 }
 
+bool AP_RCProtocol_CRSF::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == CRSF_BAUDRATE || baudrate == CRSF_BAUDRATE_1MBIT || baudrate == CRSF_BAUDRATE_2MBIT;
+}
+
 // process a byte provided by a uart
 void AP_RCProtocol_CRSF::_process_byte(uint8_t byte)
 {
@@ -313,10 +313,35 @@ bool AP_RCProtocol_FPort::check_checksum(void)
 // support byte input
 void AP_RCProtocol_FPort::process_byte(uint8_t b, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), b);
 }
 
+// support block input, skipping to the next header byte when between frames
+void AP_RCProtocol_FPort::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    if (!accepts_baudrate(baudrate)) {
+        return;
+    }
+    const uint32_t timestamp_us = AP_HAL::micros();
+    for (uint16_t i=0; i<n; i++) {
+        if (i > 0 && byte_input.ofs == 0) {
+            const uint8_t *head = (const uint8_t *)memchr(&bytes[i], FRAME_HEAD, n - i);
+            if (head == nullptr) {
+                return;
+            }
+            i = head - bytes;
+        }
+        block_ofs = i;
+        _process_byte(timestamp_us, bytes[i]);
+    }
+}
+
+bool AP_RCProtocol_FPort::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == 115200;
+}
+
 #endif  // AP_RCPROTOCOL_FPORT_ENABLED
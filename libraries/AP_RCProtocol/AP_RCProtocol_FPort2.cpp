@@ -292,10 +292,15 @@ bool AP_RCProtocol_FPort2::check_checksum(void)
 // support byte input
 void AP_RCProtocol_FPort2::process_byte(uint8_t b, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), b);
 }
 
+bool AP_RCProtocol_FPort2::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == 115200;
+}
+
 #endif  // AP_RCPROTOCOL_FPORT2_ENABLED
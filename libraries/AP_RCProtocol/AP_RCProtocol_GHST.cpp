@@ -428,12 +428,17 @@ bool AP_RCProtocol_GHST::is_telemetry_supported() const
 void AP_RCProtocol_GHST::process_byte(uint8_t byte, uint32_t baudrate)
 {
     // reject RC data if we have been configured for standalone mode
-    if (baudrate != CRSF_BAUDRATE && baudrate != GHST_BAUDRATE) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), byte);
 }
 
+bool AP_RCProtocol_GHST::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == CRSF_BAUDRATE || baudrate == GHST_BAUDRATE;
+}
+
 // change the bootstrap baud rate to Ghost standard if configured
 void AP_RCProtocol_GHST::process_handshake(uint32_t baudrate)
 {
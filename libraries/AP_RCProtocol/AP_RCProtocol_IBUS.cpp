@@ -99,10 +99,33 @@ void AP_RCProtocol_IBUS::_process_byte(uint32_t timestamp_us, uint8_t b)
 // support byte input
 void AP_RCProtocol_IBUS::process_byte(uint8_t b, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), b);
 }
 
+// support block input. A frame must start after a frame gap, and
+// bytes read together have no gap between them, so once we are
+// between frames the rest of the block can be skipped
+void AP_RCProtocol_IBUS::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    if (!accepts_baudrate(baudrate)) {
+        return;
+    }
+    const uint32_t timestamp_us = AP_HAL::micros();
+    for (uint16_t i=0; i<n; i++) {
+        if (i > 0 && byte_input.ofs == 0) {
+            return;
+        }
+        block_ofs = i;
+        _process_byte(timestamp_us, bytes[i]);
+    }
+}
+
+bool AP_RCProtocol_IBUS::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == 115200;
+}
+
 #endif  // AP_RCPROTOCOL_IBUS_ENABLED
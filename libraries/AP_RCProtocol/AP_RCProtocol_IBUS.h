@@ -34,6 +34,8 @@ public:
 
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    void process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override;
 private:
     void _process_byte(uint32_t timestamp_us, uint8_t byte);
     bool ibus_decode(const uint8_t frame[IBUS_FRAME_SIZE], uint16_t *values, bool *ibus_failsafe);
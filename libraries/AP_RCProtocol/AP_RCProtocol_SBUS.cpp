@@ -205,12 +205,35 @@ void AP_RCProtocol_SBUS::_process_byte(uint32_t timestamp_us, uint8_t b)
 // support byte input
 void AP_RCProtocol_SBUS::process_byte(uint8_t b, uint32_t baudrate)
 {
-    // note that if we're here we're not actually using SoftSerial,
-    // but it does record our configured baud rate:
-    if (baudrate != ss.baud()) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), b);
 }
 
+// support block input. A frame must start after a frame gap, and
+// bytes read together have no gap between them, so once we are
+// between frames the rest of the block can be skipped
+void AP_RCProtocol_SBUS::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    if (!accepts_baudrate(baudrate)) {
+        return;
+    }
+    const uint32_t timestamp_us = AP_HAL::micros();
+    for (uint16_t i=0; i<n; i++) {
+        if (i > 0 && byte_input.ofs == 0) {
+            return;
+        }
+        block_ofs = i;
+        _process_byte(timestamp_us, bytes[i]);
+    }
+}
+
+bool AP_RCProtocol_SBUS::accepts_baudrate(uint32_t baudrate) const
+{
+    // SoftSerial isn't used for byte input, but it does record our
+    // configured baud rate:
+    return baudrate == ss.baud();
+}
+
 #endif  // AP_RCPROTOCOL_SBUS_ENABLED
@@ -29,6 +29,8 @@ public:
     AP_RCProtocol_SBUS(AP_RCProtocol &_frontend, bool inverted, uint32_t configured_baud);
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    void process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override;
 
     static bool sbus_decode(const uint8_t frame[25], uint16_t *values, uint16_t *num_values,
                             bool &sbus_failsafe, uint16_t max_values);
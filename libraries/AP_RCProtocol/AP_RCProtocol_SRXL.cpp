@@ -280,10 +280,15 @@ void AP_RCProtocol_SRXL::_process_byte(uint32_t timestamp_us, uint8_t byte)
  */
 void AP_RCProtocol_SRXL::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), byte);
 }
 
+bool AP_RCProtocol_SRXL::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == 115200;
+}
+
 #endif  // AP_RCPROTOCOL_SRXL_ENABLED
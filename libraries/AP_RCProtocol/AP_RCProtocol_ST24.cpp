@@ -234,10 +234,34 @@ void AP_RCProtocol_ST24::_process_byte(uint8_t byte)
 
 void AP_RCProtocol_ST24::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(byte);
 }
 
+// support block input, skipping to the next start byte when unsynced
+void AP_RCProtocol_ST24::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    if (!accepts_baudrate(baudrate)) {
+        return;
+    }
+    for (uint16_t i=0; i<n; i++) {
+        if (_decode_state == ST24_DECODE_STATE_UNSYNCED) {
+            const uint8_t *stx = (const uint8_t *)memchr(&bytes[i], ST24_STX1, n - i);
+            if (stx == nullptr) {
+                return;
+            }
+            i = stx - bytes;
+        }
+        block_ofs = i;
+        _process_byte(bytes[i]);
+    }
+}
+
+bool AP_RCProtocol_ST24::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == 115200;
+}
+
 #endif  // AP_RCPROTOCOL_ST24_ENABLED
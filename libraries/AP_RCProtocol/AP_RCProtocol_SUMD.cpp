@@ -201,10 +201,35 @@ void AP_RCProtocol_SUMD::_process_byte(uint32_t timestamp_us, uint8_t byte)
 
 void AP_RCProtocol_SUMD::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), byte);
 }
 
+// support block input, skipping to the next header byte when unsynced
+void AP_RCProtocol_SUMD::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    if (!accepts_baudrate(baudrate)) {
+        return;
+    }
+    const uint32_t timestamp_us = AP_HAL::micros();
+    for (uint16_t i=0; i<n; i++) {
+        if (_decode_state == SUMD_DECODE_STATE_UNSYNCED) {
+            const uint8_t *header = (const uint8_t *)memchr(&bytes[i], SUMD_HEADER_ID, n - i);
+            if (header == nullptr) {
+                return;
+            }
+            i = header - bytes;
+        }
+        block_ofs = i;
+        _process_byte(timestamp_us, bytes[i]);
+    }
+}
+
+bool AP_RCProtocol_SUMD::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == 115200;
+}
+
 #endif  // AP_RCPROTOCOL_SUMD_ENABLED
@@ -0,0 +1,263 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  benchmarks for RC protocol detection and decoding. Frames captured
+  from receivers are replayed through the frontend with a frame gap
+  after each frame, either a byte at a time through process_byte() or
+  as a block of bytes read together through process_bytes().
+
+  BM_RCProtocolDetect times detection of each protocol from a new
+  frontend, BM_RCProtocolDecode times decoding frames once the
+  protocol has been detected, and BM_RCProtocolSearch times the search
+  through telemetry bytes that never lock, as seen on a uart shared
+  with telemetry or after a loss of signal, at each search baudrate.
+
+  On SITL the clock is stopped so the frame gaps take no time.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <RC_Channel/RC_Channel.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class RC_Channel_Benchmark : public RC_Channel {};
+
+class RC_Channels_Benchmark : public RC_Channels
+{
+public:
+    RC_Channel_Benchmark obj_channels[NUM_RC_CHANNELS];
+
+    const RC_Channel_Benchmark *channel(const uint8_t chan) const override {
+        if (chan >= NUM_RC_CHANNELS) {
+            return nullptr;
+        }
+        return &obj_channels[chan];
+    }
+    RC_Channel_Benchmark *channel(const uint8_t chan) override {
+        if (chan >= NUM_RC_CHANNELS) {
+            return nullptr;
+        }
+        return &obj_channels[chan];
+    }
+
+protected:
+    int8_t flight_mode_channel_number() const override { return 5; }
+};
+
+#define RC_CHANNELS_SUBCLASS RC_Channels_Benchmark
+#define RC_CHANNEL_SUBCLASS RC_Channel_Benchmark
+
+#include <RC_Channel/RC_Channels_VarInfo.h>
+
+// backends check the failsafe options when adding input
+static RC_Channels_Benchmark rchannels;
+
+static const uint32_t frame_gap_us = 5000;
+
+// frames captured from receivers, as used by the RCProtocolTest example
+static const uint8_t sbus_bytes[] = {0x0F, 0x4C, 0x1C, 0x5F, 0x32, 0x34, 0x38, 0xDD, 0x89,
+                                     0x83, 0x0F, 0x7C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const uint8_t ibus_bytes[] = {0x20, 0x40, 0xdc, 0x05, 0xdc, 0x05, 0xe8, 0x03, 0xdc, 0x05,
+                                     0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05,
+                                     0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05, 0xdc, 0x05,
+                                     0x47, 0xf3};
+static const uint8_t sumd_bytes[] = {0xA8, 0x01, 0x08, 0x2F, 0x50, 0x31, 0xE8, 0x21, 0xA0,
+                                     0x2F, 0x50, 0x22, 0x60, 0x22, 0x60, 0x2E, 0xE0, 0x2E,
+                                     0xE0, 0x87, 0xC6};
+static const uint8_t srxl_bytes[] = {0xa5, 0x03, 0x0c, 0x04, 0x2f, 0x6c, 0x10, 0xb4, 0x26,
+                                     0x16, 0x34, 0x01, 0x04, 0x76, 0x1c, 0x40, 0xf5, 0x3b};
+static const uint8_t dsm_bytes[] = {0x00, 0xab, 0x00, 0xae, 0x08, 0xbf, 0x10, 0xd0, 0x18,
+                                    0xe1, 0x20, 0xf2, 0x29, 0x03, 0x31, 0x14, 0x00, 0xab,
+                                    0x39, 0x25, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                    0xff, 0xff, 0xff, 0xff, 0xff};
+static const uint8_t fport_bytes[] = {0x7e, 0x19, 0x00, 0xe7, 0x3b, 0xdf, 0x5a, 0xce,
+                                      0x07, 0x10, 0x75, 0x49, 0x9c, 0x15, 0xe0, 0x03,
+                                      0x1f, 0xf8, 0xc0, 0x07, 0x3e, 0xf0, 0x81, 0x0f,
+                                      0x7c, 0x00, 0x38, 0xfa, 0x7e};
+static const uint8_t fport2_bytes[] = {0x18, 0xff,
+                                       0xac, 0x00, 0x5f, 0xf8, 0xc0, 0x07, 0x3e, 0xf0, 0x81, 0x0f, 0x7c,
+                                       0xe0, 0x03, 0x1f, 0xf8, 0xc0, 0x07, 0x3e, 0xf0, 0x81, 0x0f, 0x7c,
+                                       0x00, 0x5e, 0x98};
+static const uint8_t crsf_bytes[] = {0xC8, 0x14, 0x17, 0x20, 0x03, 0x0C, 0xA0, 0x00, 0xF6, 0xB7, 0x6E,
+                                     0x94, 0xFC, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0x0F, 0x6E};
+
+static const struct {
+    const char *name;
+    uint32_t baudrate;
+    const uint8_t *bytes;
+    uint8_t len;
+} streams[] = {
+    { "SBUS", 100000, sbus_bytes, sizeof(sbus_bytes) },
+    { "IBUS", 115200, ibus_bytes, sizeof(ibus_bytes) },
+    { "SUMD", 115200, sumd_bytes, sizeof(sumd_bytes) },
+    { "SRXL", 115200, srxl_bytes, sizeof(srxl_bytes) },
+    { "DSM", 115200, dsm_bytes, sizeof(dsm_bytes) },
+    { "FPORT", 115200, fport_bytes, sizeof(fport_bytes) },
+    { "FPORT2", 115200, fport2_bytes, sizeof(fport2_bytes) },
+    { "CRSF", 416666, crsf_bytes, sizeof(crsf_bytes) },
+};
+
+// baudrates searched on a uart added with SERIALn_PROTOCOL
+static const uint32_t search_baudrates[] = { 115200, 100000, 416666 };
+
+static AP_RCProtocol *rcprot;
+
+static void advance_clock(uint32_t us)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    hal.scheduler->stop_clock(AP_HAL::micros64() + us);
+#else
+    hal.scheduler->delay_microseconds(us);
+#endif
+}
+
+static void new_frontend(void)
+{
+    delete rcprot;
+    rcprot = NEW_NOTHROW AP_RCProtocol();
+    rcprot->init();
+}
+
+// replay bytes as a single uart read, or a byte at a time
+static void replay(const uint8_t *bytes, uint16_t len, uint32_t baudrate, bool blocks)
+{
+    if (blocks) {
+        rcprot->process_bytes(bytes, len, baudrate);
+        return;
+    }
+    for (uint16_t i=0; i<len; i++) {
+        rcprot->process_byte(bytes[i], baudrate);
+    }
+}
+
+static void detect(benchmark::State& state, bool blocks)
+{
+    const auto &s = streams[state.range(0)];
+    uint8_t frames = 0;
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        new_frontend();
+        advance_clock(frame_gap_us);
+        state.ResumeTiming();
+        // DSM needs up to 8 frames to guess the format and lock
+        for (frames=1; frames<=12; frames++) {
+            replay(s.bytes, s.len, s.baudrate, blocks);
+            advance_clock(frame_gap_us);
+            if (rcprot->protocol_detected() != AP_RCProtocol::NONE) {
+                break;
+            }
+        }
+    }
+
+    char label[64];
+    const char *name = rcprot->detected_protocol_name();
+    snprintf(label, sizeof(label), "%s: %s after %u frames",
+             s.name, name != nullptr ? name : "none", unsigned(frames));
+    state.SetLabel(label);
+}
+
+static void decode(benchmark::State& state, bool blocks)
+{
+    const auto &s = streams[state.range(0)];
+    new_frontend();
+    for (uint8_t i=0; i<12 && rcprot->protocol_detected() == AP_RCProtocol::NONE; i++) {
+        replay(s.bytes, s.len, s.baudrate, blocks);
+        advance_clock(frame_gap_us);
+    }
+    const char *name = rcprot->detected_protocol_name();
+    state.SetLabel(name != nullptr ? name : "none");
+
+    while (state.KeepRunning()) {
+        replay(s.bytes, s.len, s.baudrate, blocks);
+        advance_clock(frame_gap_us);
+        gbenchmark_escape(rcprot);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * s.len);
+}
+
+static void search(benchmark::State& state, bool blocks)
+{
+    const uint32_t baudrate = search_baudrates[state.range(0)];
+
+    // telemetry bytes, read from the uart in 32 byte blocks
+    uint8_t telem[256];
+    for (uint16_t i=0; i<sizeof(telem); i++) {
+        telem[i] = get_random16();
+    }
+    const uint8_t block_size = 32;
+
+    new_frontend();
+    uint32_t false_detections = 0;
+
+    while (state.KeepRunning()) {
+        for (uint16_t ofs=0; ofs<sizeof(telem); ofs += block_size) {
+            replay(&telem[ofs], block_size, baudrate, blocks);
+            advance_clock(block_size * 10 * 1000000ULL / baudrate);
+        }
+        if (rcprot->protocol_detected() != AP_RCProtocol::NONE) {
+            state.PauseTiming();
+            false_detections++;
+            new_frontend();
+            state.ResumeTiming();
+        }
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%u baud: %u false detections",
+             unsigned(baudrate), unsigned(false_detections));
+    state.SetLabel(label);
+    state.SetBytesProcessed(int64_t(state.iterations()) * sizeof(telem));
+}
+
+static void BM_RCProtocolDetectBytes(benchmark::State& state)
+{
+    detect(state, false);
+}
+
+static void BM_RCProtocolDetectBlocks(benchmark::State& state)
+{
+    detect(state, true);
+}
+
+static void BM_RCProtocolDecodeBytes(benchmark::State& state)
+{
+    decode(state, false);
+}
+
+static void BM_RCProtocolDecodeBlocks(benchmark::State& state)
+{
+    decode(state, true);
+}
+
+static void BM_RCProtocolSearchBytes(benchmark::State& state)
+{
+    search(state, false);
+}
+
+static void BM_RCProtocolSearchBlocks(benchmark::State& state)
+{
+    search(state, true);
+}
+
+BENCHMARK(BM_RCProtocolDetectBytes)->DenseRange(0, ARRAY_SIZE(streams)-1);
+BENCHMARK(BM_RCProtocolDetectBlocks)->DenseRange(0, ARRAY_SIZE(streams)-1);
+BENCHMARK(BM_RCProtocolDecodeBytes)->DenseRange(0, ARRAY_SIZE(streams)-1);
+BENCHMARK(BM_RCProtocolDecodeBlocks)->DenseRange(0, ARRAY_SIZE(streams)-1);
+BENCHMARK(BM_RCProtocolSearchBytes)->DenseRange(0, ARRAY_SIZE(search_baudrates)-1);
+BENCHMARK(BM_RCProtocolSearchBlocks)->DenseRange(0, ARRAY_SIZE(search_baudrates)-1);
+
+BENCHMARK_MAIN();
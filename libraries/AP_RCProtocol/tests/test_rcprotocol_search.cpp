@@ -0,0 +1,135 @@
+/*
+  test that when searching for a protocol, the protocol whose frame
+  completes first in the byte stream is detected, whether the bytes
+  arrive one at a time or as a block read together from a uart
+ */
+#include <AP_gtest.h>
+
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <RC_Channel/RC_Channel.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_RCPROTOCOL_SUMD_ENABLED && AP_RCPROTOCOL_SRXL_ENABLED && AP_RCPROTOCOL_FPORT_ENABLED
+
+class RC_Channel_Test : public RC_Channel {};
+
+class RC_Channels_Test : public RC_Channels
+{
+public:
+    RC_Channel_Test obj_channels[NUM_RC_CHANNELS];
+
+    const RC_Channel_Test *channel(const uint8_t chan) const override {
+        if (chan >= NUM_RC_CHANNELS) {
+            return nullptr;
+        }
+        return &obj_channels[chan];
+    }
+    RC_Channel_Test *channel(const uint8_t chan) override {
+        if (chan >= NUM_RC_CHANNELS) {
+            return nullptr;
+        }
+        return &obj_channels[chan];
+    }
+
+protected:
+    int8_t flight_mode_channel_number() const override { return 5; }
+};
+
+#define RC_CHANNELS_SUBCLASS RC_Channels_Test
+#define RC_CHANNEL_SUBCLASS RC_Channel_Test
+
+#include <RC_Channel/RC_Channels_VarInfo.h>
+
+// backends check the failsafe options when adding input
+static RC_Channels_Test rchannels;
+
+// frames captured from receivers, as used by the RCProtocolTest example
+static const uint8_t sumd_bytes[] = {0xA8, 0x01, 0x08, 0x2F, 0x50, 0x31, 0xE8, 0x21, 0xA0,
+                                     0x2F, 0x50, 0x22, 0x60, 0x22, 0x60, 0x2E, 0xE0, 0x2E,
+                                     0xE0, 0x87, 0xC6};
+static const uint8_t srxl_bytes[] = {0xa5, 0x03, 0x0c, 0x04, 0x2f, 0x6c, 0x10, 0xb4, 0x26,
+                                     0x16, 0x34, 0x01, 0x04, 0x76, 0x1c, 0x40, 0xf5, 0x3b};
+static const uint8_t fport_bytes[] = {0x7e, 0x19, 0x00, 0xe7, 0x3b, 0xdf, 0x5a, 0xce,
+                                      0x07, 0x10, 0x75, 0x49, 0x9c, 0x15, 0xe0, 0x03,
+                                      0x1f, 0xf8, 0xc0, 0x07, 0x3e, 0xf0, 0x81, 0x0f,
+                                      0x7c, 0x00, 0x38, 0xfa, 0x7e};
+
+class Stream {
+public:
+    void add(const uint8_t *frame, uint8_t len) {
+        memcpy(&bytes[n], frame, len);
+        n += len;
+    }
+
+    // replay the stream into a new frontend after a frame gap, as a
+    // single uart read or a byte at a time, and return the protocol
+    // detected
+    AP_RCProtocol::rcprotocol_t detect(bool blocks) const {
+        AP_RCProtocol *rcprot = NEW_NOTHROW AP_RCProtocol();
+        rcprot->init();
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+        hal.scheduler->stop_clock(AP_HAL::micros64() + 10000);
+#else
+        hal.scheduler->delay_microseconds(10000);
+#endif
+        if (blocks) {
+            rcprot->process_bytes(bytes, n, 115200);
+        } else {
+            for (uint16_t i=0; i<n; i++) {
+                rcprot->process_byte(bytes[i], 115200);
+            }
+        }
+        const AP_RCProtocol::rcprotocol_t detected = rcprot->protocol_detected();
+        delete rcprot;
+        return detected;
+    }
+
+private:
+    uint8_t bytes[256];
+    uint16_t n = 0;
+};
+
+static void check_detect(const Stream &s, AP_RCProtocol::rcprotocol_t expected)
+{
+    EXPECT_EQ(s.detect(false), expected) << "by byte";
+    EXPECT_EQ(s.detect(true), expected) << "by block";
+}
+
+TEST(AP_RCProtocol, FirstFrameWins)
+{
+    // SUMD has a lower protocol number than SRXL, but only wins if its
+    // frame comes first
+    Stream srxl_first;
+    srxl_first.add(srxl_bytes, sizeof(srxl_bytes));
+    srxl_first.add(sumd_bytes, sizeof(sumd_bytes));
+    check_detect(srxl_first, AP_RCProtocol::SRXL);
+
+    Stream sumd_first;
+    sumd_first.add(sumd_bytes, sizeof(sumd_bytes));
+    sumd_first.add(srxl_bytes, sizeof(srxl_bytes));
+    check_detect(sumd_first, AP_RCProtocol::SUMD);
+}
+
+TEST(AP_RCProtocol, FirstFrameWinsThreeFrames)
+{
+    // FPort is detected on its third frame, which is what has to come
+    // before the SUMD frame
+    Stream fport_first;
+    fport_first.add(fport_bytes, sizeof(fport_bytes));
+    fport_first.add(fport_bytes, sizeof(fport_bytes));
+    fport_first.add(fport_bytes, sizeof(fport_bytes));
+    fport_first.add(sumd_bytes, sizeof(sumd_bytes));
+    check_detect(fport_first, AP_RCProtocol::FPORT);
+
+    Stream sumd_first;
+    sumd_first.add(fport_bytes, sizeof(fport_bytes));
+    sumd_first.add(fport_bytes, sizeof(fport_bytes));
+    sumd_first.add(sumd_bytes, sizeof(sumd_bytes));
+    sumd_first.add(fport_bytes, sizeof(fport_bytes));
+    check_detect(sumd_first, AP_RCProtocol::SUMD);
+}
+
+#endif  // AP_RCPROTOCOL_SUMD_ENABLED && AP_RCPROTOCOL_SRXL_ENABLED && AP_RCPROTOCOL_FPORT_ENABLED
+
+AP_GTEST_MAIN()
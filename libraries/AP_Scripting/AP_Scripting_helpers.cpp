@@ -271,6 +271,7 @@ int DroneCAN_Handle::request(lua_State *L)
     
     h->subscriber = NEW_NOTHROW Subscriber(*h, CanardTransferTypeResponse);
     bool ok = h->subscriber != nullptr;
+    iface.handlers_changed();
 
     if (ok) {
         h->subscriber->node_id = target_node;
@@ -292,6 +293,7 @@ bool DroneCAN_Handle::subscribe(void)
         delete subscriber;
     }
     subscriber = NEW_NOTHROW Subscriber(*this, CanardTransferTypeBroadcast);
+    dc->get_canard_iface().handlers_changed();
     return subscriber != nullptr;
 }
 
@@ -30,8 +30,8 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 
     // @Param: POINTS
     // @DisplayName: SmartRTL maximum number of points on path
-    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 3k of memory.
-    // @Range: 0 500
+    // @Description: SmartRTL maximum number of points on path. Set to 0 to disable SmartRTL.  100 points consumes about 1.5k of memory, each additional 100 points about 1k.
+    // @Range: 0 5000
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("POINTS", 1, AP_SmartRTL, _points_max, SMARTRTL_POINTS_DEFAULT),
@@ -67,6 +67,14 @@ const AP_Param::GroupInfo AP_SmartRTL::var_info[] = {
 *    2. Simplification uses the Ramer-Douglas-Peucker algorithm. See Wikipedia
 *    for a more complete description.
 *
+*    Pruning keeps an index of the path's segments sorted by position along the
+*    horizontal axis the path is most spread out on, so each new segment is only
+*    compared against segments that overlap it along that axis, rather than
+*    against every earlier segment.
+*
+*    Points are stored quantized (see AP_SmartRTL_Path) so that long paths fit
+*    in a modest amount of memory.
+*
 *    The simplification and pruning algorithms run in the background and do not
 *    alter the path in memory.  Two definitions, SMARTRTL_SIMPLIFY_TIME_US and
 *    SMARTRTL_PRUNING_LOOP_TIME_US are used to limit how long each algorithm will
@@ -87,7 +95,6 @@ AP_SmartRTL::AP_SmartRTL(bool example_mode) :
     _example_mode(example_mode)
 {
     AP_Param::setup_object_defaults(this, var_info);
-    _simplify.bitmask.setall();
 }
 
 // Return true if SmartRTL is enabled
@@ -100,7 +107,7 @@ bool AP_SmartRTL::enabled() const
 void AP_SmartRTL::init()
 {
     // protect against repeated call to init
-    if (_path != nullptr) {
+    if (_path.size() != 0) {
         return;
     }
 
@@ -113,25 +120,34 @@ void AP_SmartRTL::init()
     }
 
     // allocate arrays
-    _path = (Vector3f*)calloc(_points_max, sizeof(Vector3f));
+    const bool path_ok = _path.init(_points_max);
 
-    _prune.loops_max = _points_max * SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT;
+    _prune.loops_max = MIN(_points_max * SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT, SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MAX);
     _prune.loops = (prune_loop_t*)calloc(_prune.loops_max, sizeof(prune_loop_t));
+    _prune.index = (uint16_t*)calloc(_points_max, sizeof(uint16_t));
 
-    _simplify.stack_max = _points_max * SMARTRTL_SIMPLIFY_STACK_LEN_MULT;
+    _simplify.stack_max = SMARTRTL_SIMPLIFY_STACK_LEN;
     _simplify.stack = (simplify_start_finish_t*)calloc(_simplify.stack_max, sizeof(simplify_start_finish_t));
+    _simplify.bitmask = (uint32_t*)calloc((_points_max + 31) / 32, sizeof(uint32_t));
 
     // check if memory allocation failed
-    if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr) {
+    if (!path_ok || _prune.loops == nullptr || _prune.index == nullptr || _simplify.stack == nullptr || _simplify.bitmask == nullptr) {
         log_action(Action::DEACTIVATED_INIT_FAILED);
         GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "SmartRTL deactivated: init failed");
-        free(_path);
+        _path.free_storage();
         free(_prune.loops);
+        free(_prune.index);
         free(_simplify.stack);
+        free(_simplify.bitmask);
+        _prune.loops = nullptr;
+        _prune.index = nullptr;
+        _simplify.stack = nullptr;
+        _simplify.bitmask = nullptr;
         return;
     }
 
     _path_points_max = _points_max;
+    simplify_setall();
 
     // when running the example sketch, we want the cleanup tasks to run when we tell them to, not in the background (so that they can be timed.)
     if (!_example_mode){
@@ -167,7 +183,7 @@ bool AP_SmartRTL::pop_point(Vector3p& point)
     }
 
     // return last point and remove from path
-    point = _path[--_path_points_count].topostype();
+    point = _path.get(--_path_points_count).topostype();
 
     // record count of last point popped
     _path_points_completed_limit = _path_points_count;
@@ -197,7 +213,7 @@ bool AP_SmartRTL::peek_point(Vector3p& point)
     }
 
     // return last point
-    point = _path[_path_points_count-1].topostype();
+    point = _path.get(_path_points_count-1).topostype();
 
     _path_sem.give();
     return true;
@@ -213,7 +229,7 @@ void AP_SmartRTL::set_home(bool position_ok)
 
 void AP_SmartRTL::set_home(bool position_ok, const Vector3p& current_pos)
 {
-    if (_path == nullptr) {
+    if (_path.size() == 0) {
         return;
     }
 
@@ -334,7 +350,7 @@ bool AP_SmartRTL::add_point(const Vector3p& point)
 
     // check if we have traveled far enough
     if (_path_points_count > 0) {
-        const Vector3p& last_pos = _path[_path_points_count-1].topostype();
+        const Vector3p last_pos = _path.get(_path_points_count-1).topostype();
         if (last_pos.distance_squared(point) < sq(_accuracy.get())) {
             _path_sem.give();
             return true;
@@ -349,7 +365,7 @@ bool AP_SmartRTL::add_point(const Vector3p& point)
     }
 
     // add point to path
-    _path[_path_points_count++] = point.tofloat();
+    _path.set(_path_points_count++, point.tofloat(), true);
     log_action(Action::POINT_ADD, point.tofloat());
 
     _path_sem.give();
@@ -523,6 +539,9 @@ void AP_SmartRTL::detect_simplifications()
             return;
         }
 
+        // the main thread may re-encode points while appending to the path
+        WITH_SEMAPHORE(_path_sem);
+
         // pop last item off the simplify stack
         const simplify_start_finish_t tmp = _simplify.stack[--_simplify.stack_count];
         const uint16_t start_index = tmp.start;
@@ -531,10 +550,12 @@ void AP_SmartRTL::detect_simplifications()
         // find the point between start and end points that is farthest from the start-end line segment
         float max_dist = 0.0f;
         uint16_t farthest_point_index = start_index;
+        const Vector3f start_point = _path.get(start_index);
+        const Vector3f end_point = _path.get(end_index);
         for (uint16_t i = start_index + 1; i < end_index; i++) {
             // only check points that have not already been flagged for simplification
-            if (_simplify.bitmask.get(i)) {
-                const float dist = _path[i].distance_to_segment(_path[start_index], _path[end_index]);
+            if (simplify_keep(i)) {
+                const float dist = _path.get(i).distance_to_segment(start_point, end_point);
                 if (dist > max_dist) {
                     farthest_point_index = i;
                     max_dist = dist;
@@ -542,20 +563,33 @@ void AP_SmartRTL::detect_simplifications()
             }
         }
 
-        // if the farthest point is more than ACCURACY * 0.5 add two new elements to the _simplification_stack
-        // so that on the next iteration we will check between start-to-farthestpoint and farthestpoint-to-end
+        // if the farthest point is more than ACCURACY * 0.5 add new elements to the _simplification_stack
+        // so that on later iterations we will check between start-to-farthestpoint and farthestpoint-to-end.
+        // Ranges without points between their ends are not added. The smaller range is pushed last so
+        // that it is checked first, which keeps the stack no deeper than log2 of the number of points
         if (max_dist > SMARTRTL_SIMPLIFY_EPSILON) {
             // if the to-do list is full, give up on simplifying. This should never happen.
-            if (_simplify.stack_count >= _simplify.stack_max) {
+            if (_simplify.stack_count + 2 > _simplify.stack_max) {
                 _simplify.complete = true;
                 return;
             }
-            _simplify.stack[_simplify.stack_count++] = simplify_start_finish_t {start_index, farthest_point_index};
-            _simplify.stack[_simplify.stack_count++] = simplify_start_finish_t {farthest_point_index, end_index};
+            simplify_start_finish_t first {start_index, farthest_point_index};
+            simplify_start_finish_t second {farthest_point_index, end_index};
+            if (first.finish - first.start < second.finish - second.start) {
+                const simplify_start_finish_t tmp_range = first;
+                first = second;
+                second = tmp_range;
+            }
+            if (first.finish - first.start > 1) {
+                _simplify.stack[_simplify.stack_count++] = first;
+            }
+            if (second.finish - second.start > 1) {
+                _simplify.stack[_simplify.stack_count++] = second;
+            }
         } else {
             // if the farthest point was closer than ACCURACY * 0.5 we can simplify all points between start and end
             for (uint16_t i = start_index + 1; i < end_index; i++) {
-                _simplify.bitmask.clear(i);
+                simplify_clear(i);
                 _simplify.removal_required = true;
             }
         }
@@ -568,6 +602,7 @@ void AP_SmartRTL::detect_simplifications()
 *   This method runs for the allotted time, and detects loops in a path. Any detected loops are added to _prune.loops,
 *   this function does not alter the path in memory. It works by comparing the line segment between any two sequential points
 *   to the line segment between any other two sequential points. If they get close enough, anything between them could be pruned.
+*   Only segments which overlap along the index axis are compared (see build_prune_index).
 *
 *   reset_pruning should have been called at least once before this function is called to setup the indexes (_prune.i, etc)
 */
@@ -582,36 +617,244 @@ void AP_SmartRTL::detect_loops()
     // capture start time
     const uint32_t start_time_us = AP_HAL::micros();
 
+    // make sure the segment index is up to date
+    if (!build_prune_index(start_time_us)) {
+        return;
+    }
+
     // run for defined amount of time
     while (AP_HAL::micros() - start_time_us < SMARTRTL_PRUNING_LOOP_TIME_US) {
 
-        // advance inner loop
-        _prune.j++;
-        if (_prune.j > _prune.i - 2) {
-            // set inner loop back to first point
-            _prune.j = 1;
-            // reduce outer loop
-            _prune.i--;
-            // complete when outer loop has run out of new points to check
-            if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
-                _prune.complete = true;
-                _prune.path_points_completed = _prune.path_points_count;
-                return;
+        // look for a loop ending at the segment which ends at point i
+        {
+            WITH_SEMAPHORE(_path_sem);
+            find_loop(_prune.i);
+        }
+
+        // reduce outer loop
+        _prune.i--;
+        // complete when outer loop has run out of new points to check
+        if (_prune.i < 4 || _prune.i < _prune.path_points_completed) {
+            _prune.complete = true;
+            _prune.path_points_completed = _prune.path_points_count;
+            return;
+        }
+    }
+}
+
+/*
+  find the oldest segment (by end point index j, j <= i-2) which comes
+  within SMARTRTL_PRUNING_DELTA of the segment ending at point i and
+  add the loop between them. Must be called holding _path_sem
+ */
+void AP_SmartRTL::find_loop(uint16_t i)
+{
+    const Vector3f p_i = _path.get(i);
+    const Vector3f p_i_prev = _path.get(i-1);
+    const float delta = SMARTRTL_PRUNING_DELTA;
+
+    // bounding box of the segment expanded by the pruning distance
+    Vector3f box_min {MIN(p_i.x, p_i_prev.x) - delta, MIN(p_i.y, p_i_prev.y) - delta, MIN(p_i.z, p_i_prev.z) - delta};
+    Vector3f box_max {MAX(p_i.x, p_i_prev.x) + delta, MAX(p_i.y, p_i_prev.y) + delta, MAX(p_i.z, p_i_prev.z) + delta};
+
+    uint16_t best_j = 0;
+    Vector3f best_midpoint;
+
+    // checks segment j against segment i, keeping the oldest close segment
+    auto check_segment = [&](uint16_t j) {
+        if (j > i - 2 || (best_j != 0 && j >= best_j)) {
+            return;
+        }
+        const Vector3f p_j_prev = _path.get(j-1);
+        const Vector3f p_j = _path.get(j);
+        if (MAX(p_j.x, p_j_prev.x) < box_min.x || MIN(p_j.x, p_j_prev.x) > box_max.x ||
+            MAX(p_j.y, p_j_prev.y) < box_min.y || MIN(p_j.y, p_j_prev.y) > box_max.y ||
+            MAX(p_j.z, p_j_prev.z) < box_min.z || MIN(p_j.z, p_j_prev.z) > box_max.z) {
+            return;
+        }
+        const dist_point dp = segment_segment_dist(p_i, p_i_prev, p_j_prev, p_j);
+        if (dp.distance < delta) {
+            best_j = j;
+            best_midpoint = dp.midpoint;
+        }
+    };
+
+    // sorted segments can only overlap if their lowest position is within this window
+    const float window_lo = box_min[_prune.axis] - _prune.short_extent_max;
+    const float window_hi = box_max[_prune.axis];
+
+    // binary search for the first sorted segment in the window
+    uint16_t lo = 0;
+    uint16_t hi = _prune.index_short_count;
+    while (lo < hi) {
+        const uint16_t mid = lo + (hi - lo) / 2;
+        if (segment_lo(_prune.index[mid]) < window_lo) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (uint16_t k = lo; k < _prune.index_short_count; k++) {
+        const uint16_t j = _prune.index[k];
+        if (segment_lo(j) > window_hi) {
+            break;
+        }
+        check_segment(j);
+    }
+
+    // long segments are always checked
+    const uint16_t index_count = _prune.path_points_count - 1;
+    for (uint16_t k = _prune.index_short_count; k < index_count; k++) {
+        check_segment(_prune.index[k]);
+    }
+
+    if (best_j != 0) {
+        // if there is a loop here, add to loop array
+        if (!add_loop(best_j, i-1, best_midpoint)) {
+            // if the buffer is full, stop trying to prune
+            _prune.complete = true;
+        }
+    }
+}
+
+/*
+  build the index of the segments of the first _prune.path_points_count
+  points. Segment j runs from point j-1 to point j. Runs until the
+  index is complete or out of time, returning true once it is ready
+ */
+bool AP_SmartRTL::build_prune_index(uint32_t start_time_us)
+{
+    const uint16_t index_count = _prune.path_points_count - 1;
+
+    while (_prune.index_state != PruneIndexState::READY) {
+        if (AP_HAL::micros() - start_time_us > SMARTRTL_PRUNING_LOOP_TIME_US) {
+            return false;
+        }
+
+        WITH_SEMAPHORE(_path_sem);
+
+        switch (_prune.index_state) {
+        case PruneIndexState::NONE:
+            for (uint8_t a = 0; a < 2; a++) {
+                _prune.extent_sum[a] = 0.0f;
+                _prune.pos_min[a] = FLT_MAX;
+                _prune.pos_max[a] = -FLT_MAX;
+            }
+            _prune.index_step = 1;
+            _prune.index_state = PruneIndexState::STATS;
+            break;
+
+        case PruneIndexState::STATS: {
+            // accumulate path bounds and segment extents along north and east
+            const uint16_t j = _prune.index_step++;
+            const Vector3f p = _path.get(j);
+            const Vector3f p_prev = _path.get(j-1);
+            for (uint8_t a = 0; a < 2; a++) {
+                _prune.extent_sum[a] += fabsf(p[a] - p_prev[a]);
+                _prune.pos_min[a] = MIN(_prune.pos_min[a], MIN(p[a], p_prev[a]));
+                _prune.pos_max[a] = MAX(_prune.pos_max[a], MAX(p[a], p_prev[a]));
+            }
+            if (_prune.index_step > index_count) {
+                // index along the axis the path is most spread out on
+                _prune.axis = (_prune.pos_max[1] - _prune.pos_min[1] > _prune.pos_max[0] - _prune.pos_min[0]) ? 1 : 0;
+                _prune.long_extent = MAX(SMARTRTL_PRUNING_LONG_SEGMENT_MULT * _prune.extent_sum[_prune.axis] / index_count, _accuracy.get());
+                _prune.short_extent_max = 0.0f;
+                _prune.index_short_count = 0;
+                _prune.index_step = 0;
+                _prune.index_state = PruneIndexState::PARTITION;
             }
+            break;
         }
 
-        // find the closest distance between two line segments and the mid-point
-        dist_point dp = segment_segment_dist(_path[_prune.i], _path[_prune.i-1], _path[_prune.j-1], _path[_prune.j]);
-        if (dp.distance < SMARTRTL_PRUNING_DELTA) {
-            // if there is a loop here, add to loop array
-            if (!add_loop(_prune.j, _prune.i-1, dp.midpoint)) {
-                // if the buffer is full, stop trying to prune
-                _prune.complete = true;
+        case PruneIndexState::PARTITION: {
+            // short segments go to the start of the index, long ones to the end
+            const uint16_t j = _prune.index_step + 1;
+            float seg_lo, seg_hi;
+            segment_extent(j, seg_lo, seg_hi);
+            const float extent = seg_hi - seg_lo;
+            const uint16_t long_count = _prune.index_step - _prune.index_short_count;
+            if (extent <= _prune.long_extent) {
+                _prune.index[_prune.index_short_count++] = j;
+                _prune.short_extent_max = MAX(_prune.short_extent_max, extent);
+            } else {
+                _prune.index[index_count - 1 - long_count] = j;
+            }
+            if (++_prune.index_step >= index_count) {
+                _prune.index_step = _prune.index_short_count / 2;
+                _prune.index_state = PruneIndexState::HEAPIFY;
             }
-            // set inner loop forward to trigger outer loop move to next segment
-            _prune.j = _prune.i;
+            break;
+        }
+
+        case PruneIndexState::HEAPIFY:
+            if (_prune.index_step == 0) {
+                _prune.index_step = _prune.index_short_count;
+                _prune.index_state = PruneIndexState::SORT;
+                break;
+            }
+            prune_index_sift_down(--_prune.index_step, _prune.index_short_count);
+            break;
+
+        case PruneIndexState::SORT: {
+            if (_prune.index_step <= 1) {
+                _prune.index_state = PruneIndexState::READY;
+                break;
+            }
+            // move the largest remaining segment to the end of the sorted part
+            const uint16_t end = --_prune.index_step;
+            const uint16_t tmp = _prune.index[0];
+            _prune.index[0] = _prune.index[end];
+            _prune.index[end] = tmp;
+            prune_index_sift_down(0, end);
+            break;
+        }
+
+        case PruneIndexState::READY:
+            break;
         }
     }
+
+    return true;
+}
+
+// lowest and highest position along the index axis of the segment ending at point seg
+void AP_SmartRTL::segment_extent(uint16_t seg, float &lo, float &hi) const
+{
+    const float a = _path.get_axis(seg-1, _prune.axis);
+    const float b = _path.get_axis(seg, _prune.axis);
+    lo = MIN(a, b);
+    hi = MAX(a, b);
+}
+
+float AP_SmartRTL::segment_lo(uint16_t seg) const
+{
+    return MIN(_path.get_axis(seg-1, _prune.axis), _path.get_axis(seg, _prune.axis));
+}
+
+// heap sort helper for build_prune_index, sorts by segment_lo()
+void AP_SmartRTL::prune_index_sift_down(uint16_t root, uint16_t end)
+{
+    while (true) {
+        uint32_t child = 2U * root + 1;
+        if (child >= end) {
+            return;
+        }
+        float child_lo = segment_lo(_prune.index[child]);
+        if (child + 1 < end) {
+            const float right_lo = segment_lo(_prune.index[child+1]);
+            if (right_lo > child_lo) {
+                child++;
+                child_lo = right_lo;
+            }
+        }
+        if (segment_lo(_prune.index[root]) >= child_lo) {
+            return;
+        }
+        const uint16_t tmp = _prune.index[root];
+        _prune.index[root] = _prune.index[child];
+        _prune.index[child] = tmp;
+        root = child;
+    }
 }
 
 // restart simplify if new points have been added to path
@@ -638,7 +881,7 @@ void AP_SmartRTL::restart_simplification(uint16_t path_points_count)
 {
     _simplify.complete = false;
     _simplify.removal_required = false;
-    _simplify.bitmask.setall();
+    simplify_setall();
     _simplify.stack_count = 0;
     _simplify.path_points_count = path_points_count;
 }
@@ -655,8 +898,8 @@ void AP_SmartRTL::restart_pruning(uint16_t path_points_count)
 {
     _prune.complete = false;
     _prune.i = (path_points_count > 0) ? path_points_count - 1 : 0;
-    _prune.j = 0;
     _prune.path_points_count = path_points_count;
+    _prune.index_state = PruneIndexState::NONE;
 }
 
 // reset pruning algorithm so that it will re-check all points in the path
@@ -677,15 +920,20 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
     uint16_t dest = 1;
     uint16_t removed = 0;
     for (uint16_t src = 1; src < _path_points_count; src++) {
-        if (!_simplify.bitmask.get(src)) {
-            log_action(Action::POINT_SIMPLIFY, _path[src]);
+        if (!simplify_keep(src)) {
+            log_action(Action::POINT_SIMPLIFY, _path.get(src));
             removed++;
         } else {
-            _path[dest] = _path[src];
+            if (dest != src) {
+                _path.set(dest, _path.get(src));
+            }
             dest++;
         }
     }
 
+    // the path has changed so the loop search index must be rebuilt
+    _prune.index_state = PruneIndexState::NONE;
+
     // reduce count of the number of points simplified
     if (_path_points_count > removed && _simplify.path_points_count > removed) {
         _path_points_count -= removed;
@@ -699,7 +947,7 @@ void AP_SmartRTL::remove_points_by_simplify_bitmask()
     _path_sem.give();
 
     // flag point removal is complete
-    _simplify.bitmask.setall();
+    simplify_setall();
     _simplify.removal_required = false;
 }
 
@@ -725,13 +973,13 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
         prune_loop_t loop = _prune.loops[i];
 
         // midpoint goes into start_index (this is the end point of the first segment)
-        _path[loop.start_index] = loop.midpoint;
+        _path.set(loop.start_index, loop.midpoint);
 
         // shift points after the end of the loop down by the number of points in the loop
         uint16_t loop_num_points_to_remove = loop.end_index - loop.start_index;
         for (uint16_t dest = loop.start_index + 1; dest < _path_points_count - loop_num_points_to_remove; dest++) {
-            log_action(Action::POINT_PRUNE, _path[dest]);
-            _path[dest] = _path[dest + loop_num_points_to_remove];
+            log_action(Action::POINT_PRUNE, _path.get(dest));
+            _path.set(dest, _path.get(dest + loop_num_points_to_remove));
         }
 
         if (_path_points_count > loop_num_points_to_remove) {
@@ -760,6 +1008,11 @@ bool AP_SmartRTL::remove_points_by_loops(uint16_t num_points_to_remove)
         _prune.loops_count--;
     }
 
+    // the path has changed so the loop search index must be rebuilt
+    if (removed_points > 0) {
+        _prune.index_state = PruneIndexState::NONE;
+    }
+
     _path_sem.give();
     return true;
 }
@@ -781,9 +1034,12 @@ bool AP_SmartRTL::add_loop(uint16_t start_index, uint16_t end_index, const Vecto
 
     // create new loop structure and calculate length squared of loop
     prune_loop_t new_loop = {start_index, end_index, midpoint, 0.0f};
-    new_loop.length_squared = midpoint.distance_squared(_path[start_index]) + midpoint.distance_squared(_path[end_index]);
+    new_loop.length_squared = midpoint.distance_squared(_path.get(start_index)) + midpoint.distance_squared(_path.get(end_index));
+    Vector3f prev_point = _path.get(start_index);
     for (uint16_t i = start_index; i < end_index; i++) {
-        new_loop.length_squared += _path[i].distance_squared(_path[i+1]);
+        const Vector3f next_point = _path.get(i+1);
+        new_loop.length_squared += prev_point.distance_squared(next_point);
+        prev_point = next_point;
     }
 
     // look for overlapping loops and find their combined length
@@ -906,6 +1162,14 @@ bool AP_SmartRTL::loops_overlap(const prune_loop_t &loop1, const prune_loop_t &l
     return false;
 }
 
+// set all bits in the simplify bitmask, marking every point as kept
+void AP_SmartRTL::simplify_setall()
+{
+    if (_simplify.bitmask != nullptr) {
+        memset(_simplify.bitmask, 0xff, ((_path_points_max + 31) / 32) * sizeof(uint32_t));
+    }
+}
+
 // returns true if pilot's yaw input should be used to adjust vehicle's heading
 bool AP_SmartRTL::use_pilot_yaw(void) const
 {
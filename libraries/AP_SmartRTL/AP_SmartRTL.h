@@ -1,25 +1,25 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
-#include <AP_Common/Bitmask.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Logger/AP_Logger_config.h>
+#include "AP_SmartRTL_Path.h"
 
 // definitions and macros
 #define SMARTRTL_ACCURACY_DEFAULT        2.0f   // default _ACCURACY parameter value.  Points will be no closer than this distance (in meters) together.
-#define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be 20bytes * this number.
-#define SMARTRTL_POINTS_MAX              500    // the absolute maximum number of points this library can support.
+#define SMARTRTL_POINTS_DEFAULT          300    // default _POINTS parameter value.  High numbers improve path pruning but use more memory and CPU for cleanup. Memory used will be about 10bytes * this number plus the prune loop buffer.
+#define SMARTRTL_POINTS_MAX              5000   // the absolute maximum number of points this library can support.
 #define SMARTRTL_TIMEOUT                 15000  // the time in milliseconds with no points saved to the path (for whatever reason), before SmartRTL is disabled for the flight
 #define SMARTRTL_CLEANUP_POINT_TRIGGER   50     // simplification will trigger when this many points are added to the path
 #define SMARTRTL_CLEANUP_START_MARGIN    10     // routine cleanup algorithms begin when the path array has only this many empty slots remaining
 #define SMARTRTL_CLEANUP_POINT_MIN       10     // cleanup algorithms will remove points if they remove at least this many points
 #define SMARTRTL_SIMPLIFY_EPSILON (_accuracy * 0.5f)
-#define SMARTRTL_SIMPLIFY_STACK_LEN_MULT (2.0f/3.0f)+1  // simplify buffer size as compared to maximum number of points.
-                                                // The minimum is int((s/2-1)+min(s/2, SMARTRTL_POINTS_MAX-s)), where s = pow(2, floor(log(SMARTRTL_POINTS_MAX)/log(2)))
-                                                // To avoid this annoying math, a good-enough overestimate is ceil(SMARTRTL_POINTS_MAX*2.0f/3.0f)
+#define SMARTRTL_SIMPLIFY_STACK_LEN      32     // simplify buffer size. The smaller half of each split is simplified first so at most log2(SMARTRTL_POINTS_MAX)+1 elements are needed
 #define SMARTRTL_SIMPLIFY_TIME_US        200    // maximum time (in microseconds) the simplification algorithm will run before returning
 #define SMARTRTL_PRUNING_DELTA (_accuracy * 0.99)   // How many meters apart must two points be, such that we can assume that there is no obstacle between them.  must be smaller than _ACCURACY parameter
 #define SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT 0.25f // pruning loop buffer size as compared to maximum number of points
+#define SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MAX 250    // pruning loop buffer maximum size, larger paths find the same loops over several cleanups
+#define SMARTRTL_PRUNING_LONG_SEGMENT_MULT 4.0f     // segments longer than this many times the mean segment length are checked without the sorted index
 #define SMARTRTL_PRUNING_LOOP_TIME_US    200    // maximum time (in microseconds) that the loop finding algorithm will run before returning
 
 class AP_SmartRTL {
@@ -42,7 +42,7 @@ public:
     uint16_t get_num_points() const;
 
     // get a point on the path
-    const Vector3f& get_point(uint16_t index) const { return _path[index]; }
+    Vector3f get_point(uint16_t index) const { return _path.get(index); }
 
     // add point to end of path. returns true on success, false on failure (due to failure to take the semaphore)
     bool add_point(const Vector3p& point);
@@ -173,6 +173,26 @@ private:
     // get the closest distance between 2 line segments and the point midway between the closest points
     static dist_point segment_segment_dist(const Vector3f& p1, const Vector3f& p2, const Vector3f& p3, const Vector3f& p4);
 
+    // build the index of path segments used by detect_loops, runs until complete or out of time
+    // returns true once the index is ready
+    bool build_prune_index(uint32_t start_time_us);
+
+    // lowest and highest position along the index axis of the segment ending at point seg
+    void segment_extent(uint16_t seg, float &lo, float &hi) const;
+    float segment_lo(uint16_t seg) const;
+
+    // heap sort helper for build_prune_index, sorts by segment_lo()
+    void prune_index_sift_down(uint16_t root, uint16_t end);
+
+    // find the oldest segment that comes within SMARTRTL_PRUNING_DELTA of the segment ending at point i
+    // and add the loop between them to the loops array
+    void find_loop(uint16_t i);
+
+    // simplify bitmask accessors, a set bit means the point is kept
+    bool simplify_keep(uint16_t i) const { return (_simplify.bitmask[i >> 5] & (1U << (i & 31))) != 0; }
+    void simplify_clear(uint16_t i) { _simplify.bitmask[i >> 5] &= ~(1U << (i & 31)); }
+    void simplify_setall();
+
     // de-activate SmartRTL, send warning to GCS and logger
     void deactivate(Action action, const char *reason);
 
@@ -200,7 +220,7 @@ private:
     ThoroughCleanupType _thorough_clean_type;   // used by example sketch to test simplify and prune separately
 
     // path variables
-    Vector3f* _path;    // points are stored in meters from EKF origin in NED
+    AP_SmartRTL_Path _path;    // points are stored in meters from EKF origin in NED
     uint16_t _path_points_max;  // after the array has been allocated, we will need to know how big it is. We can't use the parameter, because a user could change the parameter in-flight
     uint16_t _path_points_count;// number of points in the path array
     uint16_t _path_points_completed_limit;  // set by main thread to the path_point_count when a point is popped.  used by simplify and prune algorithms to detect path shrinking
@@ -220,7 +240,7 @@ private:
         simplify_start_finish_t* stack;
         uint16_t stack_max;     // maximum number of elements in the _simplify_stack array
         uint16_t stack_count;   // number of elements in _simplify_stack array
-        Bitmask<SMARTRTL_POINTS_MAX> bitmask;  // simplify algorithm clears bits for each point that can be removed
+        uint32_t* bitmask;      // simplify algorithm clears bits for each point that can be removed
     } _simplify;
 
     // Pruning
@@ -230,15 +250,37 @@ private:
         Vector3f midpoint;      // midpoint which should replace the first point when the loop is removed
         float length_squared;   // length squared (in meters) of the loop (used so we can remove the longest loops)
     } prune_loop_t;
+    // the loop search compares each new segment only against segments whose extent along the
+    // horizontal axis of greatest spread overlaps it. Segments are sorted by their lowest position
+    // along that axis, with unusually long segments kept unsorted at the end of the index
+    enum class PruneIndexState : uint8_t {
+        NONE = 0,   // index must be rebuilt before use
+        STATS,      // finding the index axis and segment length statistics
+        PARTITION,  // separating short and long segments
+        HEAPIFY,    // heap sorting the short segments
+        SORT,
+        READY
+    };
     struct {
         bool complete;
         uint16_t path_points_count;  // copy of _path_points_count taken when the prune algorithm started
         uint16_t path_points_completed; // number of points in that path that have already been checked for loops and should be ignored
         uint16_t i;     // loop search's outer loop index
-        uint16_t j;     // loop search's inner loop index
         prune_loop_t* loops;// the result of the pruning algorithm
         uint16_t loops_max; // maximum number of elements in the _prunable_loops array
         uint16_t loops_count;   // number of elements in the _prunable_loops array
+
+        // index of path segments, each identified by the index of its end point
+        uint16_t* index;
+        PruneIndexState index_state;
+        uint16_t index_step;        // progress through the current index build state
+        uint16_t index_short_count; // number of sorted segments at the start of the index
+        uint8_t axis;               // 0 for north, 1 for east
+        float extent_sum[2];        // sum of segment extents along each axis
+        float pos_min[2];           // bounds of the path along each axis
+        float pos_max[2];
+        float long_extent;          // segments with a larger extent are not sorted
+        float short_extent_max;     // largest extent of the sorted segments
     } _prune;
 
     // returns true if the two loops overlap (used within add_loop to determine which loops to keep or throw away)
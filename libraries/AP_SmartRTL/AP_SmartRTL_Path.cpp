@@ -0,0 +1,158 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AP_SmartRTL_Path.h"
+
+#include <stdlib.h>
+
+// allocate storage for num_points points, returns false on failure
+bool AP_SmartRTL_Path::init(uint16_t num_points)
+{
+    free_storage();
+
+    const uint16_t num_blocks = (uint32_t(num_points) + BLOCK_SIZE - 1) >> BLOCK_SHIFT;
+    _anchors = (Anchor*)calloc(num_blocks, sizeof(Anchor));
+    // offsets are allocated in whole blocks so reanchor() can always re-encode a full block
+    _offsets = (Offset*)calloc(uint32_t(num_blocks) << BLOCK_SHIFT, sizeof(Offset));
+    if (_anchors == nullptr || _offsets == nullptr) {
+        free_storage();
+        return false;
+    }
+    _size = num_points;
+    return true;
+}
+
+// release all storage
+void AP_SmartRTL_Path::free_storage()
+{
+    free(_anchors);
+    free(_offsets);
+    _anchors = nullptr;
+    _offsets = nullptr;
+    _size = 0;
+}
+
+// return the point at index
+Vector3f AP_SmartRTL_Path::get(uint16_t index) const
+{
+    const Anchor &anchor = _anchors[index >> BLOCK_SHIFT];
+    const Offset &ofs = _offsets[index];
+    const float res = resolution(anchor.exponent);
+    return Vector3f{anchor.origin.x + ofs.x * res,
+                    anchor.origin.y + ofs.y * res,
+                    anchor.origin.z + ofs.z * res};
+}
+
+// return one axis of the point at index
+float AP_SmartRTL_Path::get_axis(uint16_t index, uint8_t axis) const
+{
+    const Anchor &anchor = _anchors[index >> BLOCK_SHIFT];
+    const Offset &ofs = _offsets[index];
+    const int16_t q = (axis == 0) ? ofs.x : ((axis == 1) ? ofs.y : ofs.z);
+    return anchor.origin[axis] + q * resolution(anchor.exponent);
+}
+
+// set the point at index. If tail is true the points after index are
+// unused and need not be preserved
+void AP_SmartRTL_Path::set(uint16_t index, const Vector3f &point, bool tail)
+{
+    Anchor &anchor = _anchors[index >> BLOCK_SHIFT];
+
+    // first point of a block with nothing after it, start the block afresh
+    if (tail && (index & (BLOCK_SIZE-1)) == 0) {
+        anchor.origin = point;
+        anchor.exponent = 0;
+        _offsets[index] = Offset {};
+        return;
+    }
+
+    Offset ofs;
+    if (encode(anchor, point, ofs)) {
+        _offsets[index] = ofs;
+        return;
+    }
+
+    reanchor(index, point, tail);
+}
+
+// encode point relative to anchor, returns false if it is out of range
+bool AP_SmartRTL_Path::encode(const Anchor &anchor, const Vector3f &point, Offset &ofs)
+{
+    // resolution is a power of two so the inverse is exact
+    const float inv_res = 1.0f / resolution(anchor.exponent);
+    const Vector3f d = (point - anchor.origin) * inv_res;
+    if (fabsf(d.x) > OFFSET_MAX || fabsf(d.y) > OFFSET_MAX || fabsf(d.z) > OFFSET_MAX || d.is_nan()) {
+        return false;
+    }
+    ofs.x = int16_t(lroundf(d.x));
+    ofs.y = int16_t(lroundf(d.y));
+    ofs.z = int16_t(lroundf(d.z));
+    return true;
+}
+
+/*
+  choose a new anchor and the finest resolution that can hold the
+  block's existing points and the new point, then re-encode the block.
+  Points after index are only kept if tail is false
+ */
+void AP_SmartRTL_Path::reanchor(uint16_t index, const Vector3f &point, bool tail)
+{
+    const uint16_t block_start = index & ~uint16_t(BLOCK_SIZE-1);
+    const uint16_t block_end = tail ? index + 1 : block_start + BLOCK_SIZE;
+
+    // decode the block
+    Vector3f points[BLOCK_SIZE];
+    for (uint16_t i = block_start; i < block_end; i++) {
+        points[i - block_start] = (i == index) ? point : get(i);
+    }
+
+    // find the bounding box of the points that must be preserved
+    Vector3f pmin = points[0];
+    Vector3f pmax = points[0];
+    for (uint16_t i = 1; i < block_end - block_start; i++) {
+        const Vector3f &p = points[i];
+        pmin.x = MIN(pmin.x, p.x);
+        pmin.y = MIN(pmin.y, p.y);
+        pmin.z = MIN(pmin.z, p.z);
+        pmax.x = MAX(pmax.x, p.x);
+        pmax.y = MAX(pmax.y, p.y);
+        pmax.z = MAX(pmax.z, p.z);
+    }
+    const Vector3f half_range = (pmax - pmin) * 0.5f;
+    const float half_range_max = MAX(MAX(half_range.x, half_range.y), half_range.z);
+
+    // the anchor is rounded to the resolution so leave some margin
+    Anchor &anchor = _anchors[index >> BLOCK_SHIFT];
+    anchor.exponent = 0;
+    while (anchor.exponent < EXPONENT_MAX && half_range_max > (OFFSET_MAX - 1) * resolution(anchor.exponent)) {
+        anchor.exponent++;
+    }
+    const float res = resolution(anchor.exponent);
+    const Vector3f centre = (pmin + pmax) * 0.5f;
+    anchor.origin = Vector3f{roundf(centre.x / res) * res,
+                             roundf(centre.y / res) * res,
+                             roundf(centre.z / res) * res};
+
+    // re-encode the block, clamping anything still out of range
+    for (uint16_t i = block_start; i < block_start + BLOCK_SIZE; i++) {
+        Offset &ofs = _offsets[i];
+        if (i >= block_end) {
+            ofs = Offset {};
+            continue;
+        }
+        const Vector3f d = (points[i - block_start] - anchor.origin) / res;
+        ofs.x = int16_t(constrain_float(roundf(d.x), -OFFSET_MAX, OFFSET_MAX));
+        ofs.y = int16_t(constrain_float(roundf(d.y), -OFFSET_MAX, OFFSET_MAX));
+        ofs.z = int16_t(constrain_float(roundf(d.z), -OFFSET_MAX, OFFSET_MAX));
+    }
+}
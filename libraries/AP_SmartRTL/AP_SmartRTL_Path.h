@@ -0,0 +1,89 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+
+/*
+  compact storage for the SmartRTL path.
+
+  Points are held as int16 offsets from an anchor shared by a block of
+  consecutive points. Each block has its own power of two resolution,
+  starting at 2^-6m (about 1.6cm) and only coarsening when the points
+  in the block are spread further apart than +-512m. Points which lie
+  on a 2^-6m grid relative to the anchor are stored exactly.
+
+  Points are expected to be written in ascending index order from the
+  first modified point (appending, or shifting the path down after
+  removing points), which is how the SmartRTL cleanup modifies the path.
+
+  A point which does not fit its block re-encodes the block's earlier
+  points at the coarser resolution, moving them by up to half of it.
+  Readers on another thread must hold the writer's lock while decoding.
+ */
+class AP_SmartRTL_Path {
+public:
+
+    // allocate storage for num_points points, returns false on failure
+    bool init(uint16_t num_points);
+
+    // release all storage
+    void free_storage();
+
+    // number of points that can be stored
+    uint16_t size() const { return _size; }
+
+    // return the point at index
+    Vector3f get(uint16_t index) const;
+
+    // return one axis of the point at index, cheaper than get()
+    float get_axis(uint16_t index, uint8_t axis) const;
+
+    // set the point at index. If tail is true the points after index
+    // are unused and need not be preserved
+    void set(uint16_t index, const Vector3f &point, bool tail = false);
+
+    // memory used per point in bytes (rounded up)
+    static constexpr uint8_t bytes_per_point() { return (sizeof(Offset) * BLOCK_SIZE + sizeof(Anchor) + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+private:
+
+    static constexpr uint8_t BLOCK_SHIFT = 4;
+    static constexpr uint8_t BLOCK_SIZE = 1U << BLOCK_SHIFT;
+    static constexpr int8_t RESOLUTION_SHIFT = -6;  // finest resolution is 2^-6 m
+    static constexpr uint8_t EXPONENT_MAX = 24;     // coarsest resolution is 2^18 m
+    static constexpr int16_t OFFSET_MAX = INT16_MAX;
+
+    struct Anchor {
+        Vector3f origin;        // meters from EKF origin in NED
+        uint8_t exponent;       // resolution is 2^(exponent+RESOLUTION_SHIFT) meters
+    };
+
+    struct Offset {
+        int16_t x, y, z;
+    };
+
+    // resolution in meters for an exponent
+    static float resolution(uint8_t exponent) { return ldexpf(1.0f, int(exponent) + RESOLUTION_SHIFT); }
+
+    // encode point relative to anchor, returns false if it is out of range
+    static bool encode(const Anchor &anchor, const Vector3f &point, Offset &ofs);
+
+    // choose a new anchor for the block holding index so that point
+    // and the block's other points can all be represented
+    void reanchor(uint16_t index, const Vector3f &point, bool tail);
+
+    Anchor *_anchors = nullptr;
+    Offset *_offsets = nullptr;
+    uint16_t _size;
+};
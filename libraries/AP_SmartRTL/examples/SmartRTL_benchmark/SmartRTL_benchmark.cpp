@@ -0,0 +1,191 @@
+/*
+  SmartRTL benchmark
+
+  flies a long synthetic survey (back and forth lanes, crossing
+  transits and orbits) through SmartRTL with the background cleanup
+  run as the IO thread would, for several path sizes, and reports
+  cleanup times and the final path length
+ */
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Baro/AP_Baro.h>
+#include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_Compass/AP_Compass.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <AP_SmartRTL/AP_SmartRTL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static Compass compass;
+static AP_GPS gps;
+static AP_Baro barometer;
+static AP_SerialManager serial_manager;
+
+class DummyVehicle {
+public:
+    AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+};
+
+static DummyVehicle vehicle;
+
+AP_AHRS &ahrs(vehicle.ahrs);
+AP_BoardConfig board_config;
+
+void setup();
+void loop();
+
+// path sizes to benchmark
+static const uint16_t points_max[] { 300, 1000, 3000, 5000 };
+
+#define SURVEY_LANES            40      // number of survey lanes
+#define SURVEY_LANE_LENGTH      2000.0f // length of each lane in meters
+#define SURVEY_LANE_SPACING     40.0f   // distance between lanes in meters
+#define SURVEY_STEP             3.0f    // distance flown between position updates in meters
+#define CLEANUP_CALLS_PER_STEP  10      // background cleanup calls per position update
+
+struct BenchResult {
+    uint32_t positions;         // positions passed to SmartRTL
+    uint32_t cleanup_calls;
+    uint64_t cleanup_total_us;
+    uint32_t cleanup_max_us;
+    uint32_t thorough_us;       // time for the thorough cleanup at the end
+    uint16_t points_before;     // points on the path before the thorough cleanup
+    uint16_t points_after;
+    bool active;
+};
+
+class PathGenerator {
+public:
+    // returns false once the whole path has been flown
+    bool next(Vector3p &pos)
+    {
+        switch (stage) {
+        case 0: {
+            // survey lanes, flying alternate directions
+            const float lane_pos = (lane % 2 == 0) ? dist : SURVEY_LANE_LENGTH - dist;
+            pos = Vector3p{lane_pos, lane * SURVEY_LANE_SPACING, -50.0f + 5.0f * sinf(dist * 0.01f)};
+            dist += SURVEY_STEP;
+            if (dist > SURVEY_LANE_LENGTH) {
+                dist = 0.0f;
+                lane++;
+                if (lane >= SURVEY_LANES) {
+                    lane = 0;
+                    stage++;
+                }
+            }
+            return true;
+        }
+        case 1: {
+            // diagonal transit back across the survey, crossing every lane
+            const float len = norm(SURVEY_LANE_LENGTH, SURVEY_LANES * SURVEY_LANE_SPACING);
+            const float t = dist / len;
+            pos = Vector3p{SURVEY_LANE_LENGTH * (1.0f - t), SURVEY_LANES * SURVEY_LANE_SPACING * (1.0f - t), -60.0f};
+            dist += SURVEY_STEP;
+            if (dist > len) {
+                dist = 0.0f;
+                stage++;
+            }
+            return true;
+        }
+        case 2: {
+            // orbits around a point of interest
+            const float radius = 80.0f;
+            const float angle = dist / radius;
+            pos = Vector3p{500.0f + radius * cosf(angle), 500.0f + radius * sinf(angle), -40.0f};
+            dist += SURVEY_STEP;
+            if (angle > 10 * M_2PI) {
+                dist = 0.0f;
+                stage++;
+            }
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+private:
+    uint8_t stage;
+    uint16_t lane;
+    float dist;
+};
+
+static void run_benchmark(uint16_t num_points, BenchResult &res)
+{
+    // allocated so that it starts zeroed like a vehicle's SmartRTL object
+    AP_SmartRTL *srtl = NEW_NOTHROW AP_SmartRTL(true);
+    if (srtl == nullptr) {
+        AP_HAL::panic("out of memory");
+    }
+    AP_SmartRTL &smart_rtl = *srtl;
+    AP_Param::set_object_value(&smart_rtl, AP_SmartRTL::var_info, "POINTS", num_points);
+    smart_rtl.init();
+    smart_rtl.set_home(true, Vector3p{});
+
+    res = {};
+    PathGenerator path;
+    Vector3p pos;
+    while (path.next(pos)) {
+        smart_rtl.update(true, pos);
+        res.positions++;
+        for (uint8_t i = 0; i < CLEANUP_CALLS_PER_STEP; i++) {
+            const uint32_t start_us = AP_HAL::micros();
+            smart_rtl.run_background_cleanup();
+            const uint32_t dt_us = AP_HAL::micros() - start_us;
+            res.cleanup_calls++;
+            res.cleanup_total_us += dt_us;
+            res.cleanup_max_us = MAX(res.cleanup_max_us, dt_us);
+        }
+    }
+
+    res.points_before = smart_rtl.get_num_points();
+    res.active = smart_rtl.is_active();
+    if (res.active) {
+        const uint32_t start_us = AP_HAL::micros();
+        while (!smart_rtl.request_thorough_cleanup()) {
+            smart_rtl.run_background_cleanup();
+        }
+        res.thorough_us = AP_HAL::micros() - start_us;
+    }
+    res.points_after = smart_rtl.get_num_points();
+}
+
+void setup()
+{
+    hal.console->printf("SmartRTL benchmark\n");
+    board_config.init();
+}
+
+void loop()
+{
+    // SmartRTL does not free its path so only run once
+    static bool done;
+    if (!hal.console->is_initialized() || done) {
+        hal.scheduler->delay(100);
+        return;
+    }
+    done = true;
+
+    hal.console->printf("--------------------\n");
+    hal.console->printf("%6s %8s %6s %10s %8s %10s %7s %7s\n",
+                        "points", "positions", "active", "clean_avg", "clean_max", "thorough", "before", "after");
+    for (const uint16_t num_points : points_max) {
+        BenchResult res;
+        run_benchmark(num_points, res);
+        hal.console->printf("%6u %8u %6s %8.1fus %7uus %8uus %7u %7u\n",
+                            unsigned(num_points),
+                            unsigned(res.positions),
+                            res.active ? "yes" : "no",
+                            res.cleanup_calls > 0 ? double(res.cleanup_total_us) / res.cleanup_calls : 0.0,
+                            unsigned(res.cleanup_max_us),
+                            unsigned(res.thorough_us),
+                            unsigned(res.points_before),
+                            unsigned(res.points_after));
+    }
+}
+
+AP_HAL_MAIN();
@@ -28,6 +28,7 @@
 #include <AP_Filesystem/AP_Filesystem.h>
 #include <AP_HAL/utility/sparse-endian.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_Common/ExpandingString.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -40,6 +41,18 @@ GCS_FTP *GCS_FTP::ftp;
 // timeout for session inactivity, when we will kill an idle session
 #define FTP_SESSION_KILL_TIMEOUT 20000
 
+// packets sent in each burst; enough for a full parameter file with max parameters
+#define FTP_BURST_PACKETS 2000
+
+// longest the worker sleeps before checking for new requests, and the
+// retry delay when a burst packet did not fit in the link (us)
+#define FTP_WORKER_POLL_US 2000
+#define FTP_BURST_LINK_FULL_US 100
+
+// burst reads refill the read-ahead buffer from a 512 byte boundary
+static_assert(AP_MAVLINK_FTP_READ_AHEAD_SIZE >= 512 + sizeof(mavlink_file_transfer_protocol_t::payload),
+              "AP_MAVLINK_FTP_READ_AHEAD_SIZE too small");
+
 bool GCS_FTP::init(void)
 {
     if (initialised) {
@@ -299,6 +312,11 @@ int GCS_FTP::Session::close(void)
     }
     last_send_ms = 0;
 
+    memset(&burst, 0, sizeof(burst));
+    delete[] read_ahead.data;
+    read_ahead.data = nullptr;
+    read_ahead.len = 0;
+
     return result;
 }
 
@@ -374,6 +392,8 @@ bool GCS_FTP::Session::handle_request(Transaction &request, Transaction &reply)
             break;
         }
         mode = FTP_FILE_MODE::Read;
+        memset(&stats, 0, sizeof(stats));
+        stats.start_ms = now;
 
         reply.opcode = FTP_OP::Ack;
         reply.size = sizeof(uint32_t);
@@ -402,6 +422,13 @@ bool GCS_FTP::Session::handle_request(Transaction &request, Transaction &reply)
             break;
         }
 
+        if (request.offset < burst.offset) {
+            // the client is filling a gap in a burst read; packets
+            // are being lost so send them more slowly
+            stats.gaps++;
+            burst_slow_down();
+        }
+
         // seek to requested offset
         if (AP::FS().lseek(fd, request.offset, SEEK_SET) == -1) {
             GCS_FTP::error(reply, FTP_ERROR::FailErrno);
@@ -553,7 +580,6 @@ bool GCS_FTP::Session::handle_request(Transaction &request, Transaction &reply)
     }
     case FTP_OP::BurstReadFile:
     {
-        const uint16_t max_read = (request.size == 0?sizeof(reply.data):request.size);
         // must actually be working on a file
         if (fd == -1) {
             GCS_FTP::error(reply, FTP_ERROR::FileNotFound);
@@ -566,76 +592,9 @@ bool GCS_FTP::Session::handle_request(Transaction &request, Transaction &reply)
             break;
         }
 
-        // seek to requested offset
-        if (AP::FS().lseek(fd, request.offset, SEEK_SET) == -1) {
-            GCS_FTP::error(reply, FTP_ERROR::FailErrno);
-            break;
-        }
-
-        /*
-          calculate a burst delay so that FTP burst
-          transfer doesn't use more than 1/3 of
-          available bandwidth on links that don't have
-          flow control. This reduces the chance of
-          lost packets a lot, which results in overall
-          faster transfers
-        */
-        uint32_t burst_delay_ms = 0;
-        if (valid_channel(request.chan)) {
-            auto *port = mavlink_comm_port[request.chan];
-            if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
-                const uint32_t bw = port->bw_in_bytes_per_second();
-                const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
-                burst_delay_ms = 3000 * pkt_size / bw;
-            }
-        }
-
-        // this transfer size is enough for a full parameter file with max parameters
-        const uint32_t transfer_size = 2000;
-        reply.offset = request.offset;
-        for (uint32_t i = 0; (i < transfer_size); i++) {
-            // fill the buffer
-            const ssize_t read_bytes = AP::FS().read(fd, reply.data, MIN(sizeof(reply.data), max_read));
-            if (read_bytes == -1) {
-                reply.burst_complete = true;
-                GCS_FTP::error(reply, FTP_ERROR::FailErrno);
-                break;
-            }
-
-            if (read_bytes != sizeof(reply.data)) {
-                // don't send any old data
-                memset(reply.data + read_bytes, 0, sizeof(reply.data) - read_bytes);
-            }
-
-            if (read_bytes == 0) {
-                reply.burst_complete = true;
-                GCS_FTP::error(reply, FTP_ERROR::EndOfFile);
-                break;
-            }
-
-            reply.opcode = FTP_OP::Ack;
-            // Signal to the client that they need to request another burst read to get more data
-            reply.burst_complete = (i == (transfer_size - 1));
-            reply.size = (uint8_t)read_bytes;
-
-            push_reply(reply);
-
-            // update the offset for the next read
-            reply.offset += read_bytes;
-
-            // prep the reply to be used again
-            reply.seq_number++;
-
-            if (burst_delay_ms > 0) {
-                hal.scheduler->delay(burst_delay_ms);
-            }
-        }
-
-        if (reply.opcode != FTP_OP::Nack) {
-            // prevent a duplicate packet send for
-            // normal replies of burst reads
-            skip_push_reply = true;
-        }
+        // the packets are sent by the worker as link space allows
+        burst_start(request, reply);
+        skip_push_reply = true;
         break;
     }
 
@@ -672,6 +631,233 @@ bool GCS_FTP::Session::handle_request(Transaction &request, Transaction &reply)
     return skip_push_reply;
 }
 
+/*
+  start a burst read of the file from the requested offset
+ */
+void GCS_FTP::Session::burst_start(const Transaction &request, Transaction &reply)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (burst.complete_ms != 0) {
+        stats.rtt_ms = now_ms - burst.complete_ms;
+        burst.complete_ms = 0;
+    }
+
+    if (read_ahead.data == nullptr) {
+        // if this fails we read directly from the file
+        read_ahead.data = NEW_NOTHROW uint8_t[AP_MAVLINK_FTP_READ_AHEAD_SIZE];
+        read_ahead.len = 0;
+    }
+
+    const uint8_t max_read = (request.size == 0?sizeof(reply.data):request.size);
+
+    /*
+      on links that don't have flow control start the burst at 1/3
+      of the available bandwidth, which reduces the chance of lost
+      packets a lot and results in overall faster transfers. The
+      pacing then adapts to the packets the client has to ask for
+      again and to the space in the link
+    */
+    if (burst.link_interval_us == 0 && valid_channel(chan)) {
+        auto *port = mavlink_comm_port[chan];
+        if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
+            const uint32_t bw = MAX(port->bw_in_bytes_per_second(), 1U);
+            const uint16_t pkt_size = PAYLOAD_SIZE(chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
+            burst.link_interval_us = 1000000ULL * pkt_size / bw;
+            burst.interval_us = 3 * burst.link_interval_us;
+        }
+    }
+
+    burst.active = true;
+    burst.max_read = max_read;
+    burst.seq_number = reply.seq_number;
+    burst.remaining = FTP_BURST_PACKETS;
+    burst.offset = request.offset;
+    burst.last_send_us = AP_HAL::micros() - burst.interval_us;
+}
+
+/*
+  read burst data through the read-ahead buffer
+ */
+ssize_t GCS_FTP::Session::burst_read(uint32_t offset, uint8_t *data, uint8_t len)
+{
+    if (read_ahead.data == nullptr) {
+        if (AP::FS().lseek(fd, offset, SEEK_SET) == -1) {
+            return -1;
+        }
+        return AP::FS().read(fd, data, len);
+    }
+
+    const uint32_t end = read_ahead.offset + read_ahead.len;
+    if (offset < read_ahead.offset || offset >= end ||
+        (offset + len > end && read_ahead.len == AP_MAVLINK_FTP_READ_AHEAD_SIZE)) {
+        // refill from a 512 byte boundary to keep filesystem reads aligned
+        const uint32_t start = offset & ~511U;
+        read_ahead.len = 0;
+        if (AP::FS().lseek(fd, start, SEEK_SET) == -1) {
+            return -1;
+        }
+        const int32_t ret = AP::FS().read(fd, read_ahead.data, AP_MAVLINK_FTP_READ_AHEAD_SIZE);
+        if (ret == -1) {
+            return -1;
+        }
+        read_ahead.offset = start;
+        read_ahead.len = ret;
+    }
+
+    if (offset >= read_ahead.offset + read_ahead.len) {
+        // end of file
+        return 0;
+    }
+    const uint8_t n = MIN(uint32_t(len), read_ahead.offset + read_ahead.len - offset);
+    memcpy(data, &read_ahead.data[offset - read_ahead.offset], n);
+    return n;
+}
+
+/*
+  send the next packet of a burst read, returning false if the link
+  has no space or pacing holds the packet back
+ */
+bool GCS_FTP::Session::burst_send(void)
+{
+    const uint32_t now_us = AP_HAL::micros();
+    if (burst.interval_us != 0 && now_us - burst.last_send_us < burst.interval_us) {
+        return false;
+    }
+
+    Transaction reply {};
+    reply.chan = chan;
+    reply.sysid = sysid;
+    reply.compid = compid;
+    reply.session = session_id;
+    reply.seq_number = burst.seq_number;
+    reply.req_opcode = FTP_OP::BurstReadFile;
+    reply.offset = burst.offset;
+
+    const ssize_t read_bytes = burst_read(burst.offset, reply.data, burst.max_read);
+    if (read_bytes == -1) {
+        reply.burst_complete = true;
+        GCS_FTP::error(reply, FTP_ERROR::FailErrno);
+    } else if (read_bytes == 0) {
+        reply.burst_complete = true;
+        GCS_FTP::error(reply, FTP_ERROR::EndOfFile);
+    } else {
+        reply.opcode = FTP_OP::Ack;
+        // Signal to the client that they need to request another burst read to get more data
+        reply.burst_complete = (burst.remaining == 1);
+        reply.size = (uint8_t)read_bytes;
+    }
+
+    if (!send_reply(reply)) {
+        stats.stalls++;
+        if (burst.interval_us != 0) {
+            // sending faster than the link can carry
+            burst_slow_down();
+            burst.last_send_us = now_us;
+        }
+        return false;
+    }
+
+    last_send_ms = AP_HAL::millis();
+    burst.last_send_us = now_us;
+    stats.last_ms = last_send_ms;
+    stats.packets++;
+
+    if (reply.burst_complete) {
+        burst.active = false;
+        burst.complete_ms = last_send_ms;
+        return true;
+    }
+
+    stats.bytes += read_bytes;
+    burst.offset += read_bytes;
+    burst.seq_number++;
+    burst.remaining--;
+
+    if (burst.interval_us > burst.link_interval_us) {
+        // probe back towards the link bandwidth while packets get through
+        burst.interval_us = MAX(burst.interval_us - MAX(burst.link_interval_us / 64, 1U),
+                                burst.link_interval_us);
+    }
+    return true;
+}
+
+/*
+  increase the interval between burst packets on a link without flow control
+ */
+void GCS_FTP::Session::burst_slow_down(void)
+{
+    burst.interval_us = MIN(burst.interval_us + burst.interval_us / 2,
+                            8 * burst.link_interval_us);
+}
+
+/*
+  send packets for the burst reads in progress, taking turns between
+  sessions. Returns true if any burst is still in progress, with
+  wait_us set to the time until the next packet is due
+ */
+bool GCS_FTP::send_bursts(uint32_t &wait_us)
+{
+    bool active = false;
+    wait_us = FTP_WORKER_POLL_US;
+    for (uint8_t i=0; i<ARRAY_SIZE(sessions); i++) {
+        auto &s = sessions[(next_burst_session + i) % ARRAY_SIZE(sessions)];
+        // send until the link is full or pacing holds the burst back
+        uint8_t n = 0;
+        while (n<8 && s.burst.active && s.burst_send()) {
+            n++;
+        }
+        if (!s.burst.active) {
+            continue;
+        }
+        active = true;
+        if (n == 8) {
+            // more to send now
+            wait_us = 0;
+        } else if (s.burst.interval_us == 0) {
+            // no pacing so the link had no space, retry shortly
+            wait_us = MIN(wait_us, uint32_t(FTP_BURST_LINK_FULL_US));
+        } else {
+            // paced, sleep until the next packet is due
+            const uint32_t since_us = AP_HAL::micros() - s.burst.last_send_us;
+            if (since_us >= s.burst.interval_us) {
+                wait_us = 0;
+            } else {
+                wait_us = MIN(wait_us, s.burst.interval_us - since_us);
+            }
+        }
+    }
+    next_burst_session = (next_burst_session + 1) % ARRAY_SIZE(sessions);
+    return active;
+}
+
+/*
+  report burst read throughput for each session
+ */
+void GCS_FTP::ftp_info(ExpandingString &str)
+{
+    if (ftp == nullptr) {
+        return;
+    }
+    for (uint8_t i=0; i<ARRAY_SIZE(ftp->sessions); i++) {
+        const auto &s = ftp->sessions[i];
+        if (s.stats.packets == 0) {
+            continue;
+        }
+        const uint32_t dt_ms = MAX(s.stats.last_ms - s.stats.start_ms, 1U);
+        str.printf("FTP%u: chan=%u bytes=%u packets=%u rate=%ukB/s stalls=%u gaps=%u rtt=%ums interval=%uus%s\n",
+                   unsigned(i),
+                   unsigned(s.chan),
+                   unsigned(s.stats.bytes),
+                   unsigned(s.stats.packets),
+                   unsigned(s.stats.bytes / dt_ms),
+                   unsigned(s.stats.stalls),
+                   unsigned(s.stats.gaps),
+                   unsigned(s.stats.rtt_ms),
+                   unsigned(s.burst.interval_us),
+                   s.burst.active ? " active" : "");
+    }
+}
+
 /*
   get the time of the last send for a channel
  */
@@ -744,9 +930,6 @@ void GCS_FTP::worker(void)
 
     while (true) {
         while (!requests.pop(request)) {
-            // nothing to handle, delay ourselves a bit then check again. Ideally we'd use conditional waits here
-            hal.scheduler->delay(2);
-
             // kill any dead sessions
             const uint32_t now = AP_HAL::millis();
             for (auto &s : sessions) {
@@ -755,6 +938,18 @@ void GCS_FTP::worker(void)
                     s.close();   // error code ignored
                 }
             }
+
+            uint32_t wait_us;
+            if (send_bursts(wait_us)) {
+                // come back when the next burst packet is due
+                if (wait_us > 0) {
+                    hal.scheduler->delay_microseconds(wait_us);
+                }
+                continue;
+            }
+
+            // nothing to handle, delay ourselves a bit then check again. Ideally we'd use conditional waits here
+            hal.scheduler->delay(2);
         }
 
         if (request.opcode == FTP_OP::ResetSessions) {
@@ -834,6 +1029,9 @@ void GCS_FTP::worker(void)
 
         if (!skip_push_reply) {
             session->push_reply(reply);
+        } else {
+            // nothing was sent, so this is not a reply to re-send
+            reply.session = -1;
         }
     }
 }
@@ -14,11 +14,24 @@
 #define AP_MAVLINK_FTP_MAX_SESSIONS 5
 #endif
 
+// size of the buffer each session reads ahead into for burst reads,
+// allocated while a file is being burst read
+#ifndef AP_MAVLINK_FTP_READ_AHEAD_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define AP_MAVLINK_FTP_READ_AHEAD_SIZE 4096
+#else
+#define AP_MAVLINK_FTP_READ_AHEAD_SIZE 1024
+#endif
+#endif
+
 class GCS_FTP {
 public:
     static void handle_file_transfer_protocol(const mavlink_message_t &msg, mavlink_channel_t chan);
     static uint32_t get_last_send_ms(mavlink_channel_t chan);
 
+    // report burst read throughput for each session
+    static void ftp_info(class ExpandingString &str);
+
 private:
     enum class FTP_OP : uint8_t {
         None = MAV_FTP_OPCODE_NONE,
@@ -96,8 +109,51 @@ private:
         bool handle_request(Transaction &request, Transaction &reply);
 
         int close(void);
+
+        // burst read in progress. Packets are sent by the worker
+        // between requests, so bursts on several sessions run
+        // concurrently rather than one after another
+        struct {
+            bool active;
+            uint8_t max_read;
+            uint16_t seq_number;    // sequence number of the next packet
+            uint16_t remaining;     // packets left in this burst
+            uint32_t offset;        // file offset of the next packet
+            uint32_t last_send_us;
+            // pacing on links without flow control, adapted between
+            // link_interval_us and 8 times that
+            uint32_t interval_us;
+            uint32_t link_interval_us;
+            uint32_t complete_ms;   // time the last burst completed
+        } burst;
+
+        // data read ahead of a burst read
+        struct {
+            uint8_t *data;
+            uint32_t offset;        // file offset of data[0]
+            uint16_t len;
+        } read_ahead;
+
+        // burst read throughput
+        struct {
+            uint32_t start_ms;
+            uint32_t last_ms;
+            uint32_t bytes;
+            uint32_t packets;
+            uint32_t stalls;        // packets delayed for lack of link space
+            uint32_t gaps;          // reads of data lost from a burst
+            uint32_t rtt_ms;        // burst complete to next burst request
+        } stats;
+
+        void burst_start(const Transaction &request, Transaction &reply);
+        bool burst_send(void);
+        ssize_t burst_read(uint32_t offset, uint8_t *data, uint8_t len);
+        void burst_slow_down(void);
     };
     Session sessions[AP_MAVLINK_FTP_MAX_SESSIONS];
+    uint8_t next_burst_session;
+
+    bool send_bursts(uint32_t &wait_us);
 
     bool init(void);
 
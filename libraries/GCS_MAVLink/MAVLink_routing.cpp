@@ -27,13 +27,17 @@
 #include "MAVLink_routing.h"
 
 #include <AP_ADSB/AP_ADSB.h>
+#include <AP_Common/ExpandingString.h>
 
 extern const AP_HAL::HAL& hal;
 
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) : num_routes(0)
+{
+    memset(bucket_head, ROUTE_NONE, sizeof(bucket_head));
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -208,39 +212,67 @@ bool MAVLink_routing::forward(GCS_MAVLINK &in_link,
     bool forwarded = false;
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
     memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
 
-        // Skip if channel is private and the target system or component IDs do not match
-        GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
-        if (out_link == nullptr) {
-            // this is bad
-            continue;
-        }
-        if (out_link->is_private() &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
-            continue;
+    if (broadcast_system) {
+        // every channel with a route, other than private channels
+        // which only take messages targeted at their routes
+        for (uint8_t chan=0; chan<MAVLINK_COMM_NUM_BUFFERS; chan++) {
+            if (!(route_chan_mask & (1U<<chan))) {
+                continue;
+            }
+            GCS_MAVLINK *out_link = gcs().chan(chan);
+            if (out_link == nullptr || out_link->is_private() || &in_link == out_link) {
+                continue;
+            }
+            if (out_link->check_payload_size(msg.len)) {
+#if ROUTING_DEBUG
+                ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                         msg.msgid,
+                         (unsigned)in_link.get_chan(),
+                         (unsigned)chan,
+                         (int)target_system,
+                         (int)target_component);
+#endif
+                _mavlink_resend_uart((mavlink_channel_t)chan, &msg);
+            }
+            forwarded = true;
         }
+    } else {
+        for (uint8_t i=first_route(target_system); i != ROUTE_NONE; i=routes[i].next) {
+            if (routes[i].sysid != target_system) {
+                continue;
+            }
+
+            // Skip if channel is private and the target system or component IDs do not match
+            GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
+            if (out_link == nullptr) {
+                // this is bad
+                continue;
+            }
+            if (out_link->is_private() &&
+                target_component != routes[i].compid) {
+                continue;
+            }
 
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
+            if (broadcast_component ||
+                target_component == routes[i].compid ||
+                !match_system) {
 
-            if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
-                if (out_link->check_payload_size(msg.len)) {
+                if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
+                    if (out_link->check_payload_size(msg.len)) {
 #if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_link.get_chan(),
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
+                        ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                                 msg.msgid,
+                                 (unsigned)in_link.get_chan(),
+                                 (unsigned)routes[i].channel,
+                                 (int)target_system,
+                                 (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
+                        _mavlink_resend_uart(routes[i].channel, &msg);
+                    }
+                    sent_to_chan[routes[i].channel] = true;
+                    forwarded = true;
                 }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
             }
         }
     }
@@ -272,7 +304,7 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
 
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=first_route(mavlink_system.sysid); i != ROUTE_NONE; i=routes[i].next) {
         if (routes[i].sysid != mavlink_system.sysid) {
             // our system ID hasn't been seen on this link
             continue;
@@ -350,7 +382,6 @@ bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid
 */
 void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0) {
         // don't learn routes to the broadcast system
         return;
@@ -368,24 +399,22 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
         return;
     }
     const mavlink_channel_t in_channel = in_link.get_chan();
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-            }
-            break;
+    const uint32_t now_ms = AP_HAL::millis();
+    uint8_t i = find_route(msg.sysid, msg.compid, in_channel);
+    if (i == ROUTE_NONE) {
+        i = alloc_route(now_ms);
+        if (i == ROUTE_NONE) {
+            // the table is full
+            return;
         }
-    }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-        }
-        num_routes++;
+        route &r = routes[i];
+        memset(&r, 0, sizeof(r));
+        r.sysid = msg.sysid;
+        r.compid = msg.compid;
+        r.channel = in_channel;
+        r.next = bucket_head[bucket(msg.sysid)];
+        bucket_head[bucket(msg.sysid)] = i;
+        route_chan_mask |= 1U<<in_channel;
 #if ROUTING_DEBUG
         ::printf("learned route %u %u via %u\n",
                  (unsigned)msg.sysid,
@@ -393,6 +422,101 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
                  (unsigned)in_channel);
 #endif
     }
+    route &r = routes[i];
+    if (r.mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        r.mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+    r.packets++;
+    r.bytes += msg.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    r.last_seen_ms = now_ms;
+}
+
+/*
+  find the route to a sysid/compid on a channel
+*/
+uint8_t MAVLink_routing::find_route(uint8_t sysid, uint8_t compid, mavlink_channel_t channel) const
+{
+    for (uint8_t i=first_route(sysid); i != ROUTE_NONE; i=routes[i].next) {
+        if (routes[i].sysid == sysid &&
+            routes[i].compid == compid &&
+            routes[i].channel == channel) {
+            return i;
+        }
+    }
+    return ROUTE_NONE;
+}
+
+/*
+  get a free route, replacing the route heard from least recently if
+  the table is full and that route has gone stale
+*/
+uint8_t MAVLink_routing::alloc_route(uint32_t now_ms)
+{
+    if (num_routes < MAVLINK_MAX_ROUTES) {
+        return num_routes++;
+    }
+    // don't search the full table for every message from a new source
+    if (now_ms - last_evict_check_ms < 1000) {
+        return ROUTE_NONE;
+    }
+    last_evict_check_ms = now_ms;
+
+    uint8_t oldest = 0;
+    for (uint8_t i=1; i<num_routes; i++) {
+        if (now_ms - routes[i].last_seen_ms > now_ms - routes[oldest].last_seen_ms) {
+            oldest = i;
+        }
+    }
+    if (now_ms - routes[oldest].last_seen_ms < MAVLINK_ROUTE_STALE_MS) {
+        return ROUTE_NONE;
+    }
+    unlink_route(oldest);
+    evictions++;
+    return oldest;
+}
+
+/*
+  remove a route from its bucket and from the channel mask
+*/
+void MAVLink_routing::unlink_route(uint8_t idx)
+{
+    uint8_t *link = &bucket_head[bucket(routes[idx].sysid)];
+    while (*link != ROUTE_NONE) {
+        if (*link == idx) {
+            *link = routes[idx].next;
+            break;
+        }
+        link = &routes[*link].next;
+    }
+    route_chan_mask = 0;
+    for (uint8_t i=0; i<num_routes; i++) {
+        if (i != idx) {
+            route_chan_mask |= 1U<<routes[i].channel;
+        }
+    }
+}
+
+/*
+  report the routing table and the traffic on each route
+*/
+void MAVLink_routing::routing_info(ExpandingString &str) const
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    str.printf("routes=%u/%u evictions=%u\n",
+               unsigned(num_routes),
+               unsigned(MAVLINK_MAX_ROUTES),
+               unsigned(evictions));
+    for (uint8_t i=0; i<num_routes; i++) {
+        const route &r = routes[i];
+        str.printf("%3u/%-3u chan=%u type=%u packets=%u bytes=%u age=%ums\n",
+                   unsigned(r.sysid),
+                   unsigned(r.compid),
+                   unsigned(r.channel),
+                   unsigned(r.mavtype),
+                   unsigned(r.packets),
+                   unsigned(r.bytes),
+                   unsigned(now_ms - r.last_seen_ms));
+    }
 }
 
 
@@ -415,7 +539,7 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=first_route(msg.sysid); i != ROUTE_NONE; i=routes[i].next) {
         if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
             mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
         }
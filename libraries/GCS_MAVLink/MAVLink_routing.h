@@ -5,9 +5,24 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+// number of routes that can be learned. Vehicles relaying for a swarm
+// and ground stations bridging several vehicles see many more
+// systems and components than a single vehicle
+#ifndef MAVLINK_MAX_ROUTES
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define MAVLINK_MAX_ROUTES 128
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define MAVLINK_MAX_ROUTES 64
+#else
 #define MAVLINK_MAX_ROUTES 20
+#endif
+#endif
+
+// once the table is full, a route not heard from for this long is
+// replaced by a new route
+#ifndef MAVLINK_ROUTE_STALE_MS
+#define MAVLINK_ROUTE_STALE_MS 10000
+#endif
 
 /*
   object to handle MAVLink packet routing
@@ -51,16 +66,42 @@ public:
      */
     bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const;
 
+    // report the routing table and the traffic on each route
+    void routing_info(class ExpandingString &str) const;
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    // routes are chained from a hash of their sysid so the routes to
+    // a system are found without scanning the table
+    static constexpr uint8_t ROUTE_BUCKETS = 32;
+    static constexpr uint8_t ROUTE_NONE = 0xFF;
+    static_assert(MAVLINK_MAX_ROUTES < ROUTE_NONE, "too many routes");
+
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
         mavlink_channel_t channel;
         uint8_t mavtype;
+        uint8_t next;           // next route in the same bucket
+        uint32_t packets;
+        uint32_t bytes;
+        uint32_t last_seen_ms;
     } routes[MAVLINK_MAX_ROUTES];
+    uint8_t bucket_head[ROUTE_BUCKETS];
+
+    // channels with at least one route
+    uint32_t route_chan_mask;
+
+    // routes replaced once the table was full, and the last time
+    // the table was searched for a stale route
+    uint32_t evictions;
+    uint32_t last_evict_check_ms;
+
+    static uint8_t bucket(uint8_t sysid) { return sysid % ROUTE_BUCKETS; }
+    uint8_t first_route(uint8_t sysid) const { return bucket_head[bucket(sysid)]; }
+    uint8_t find_route(uint8_t sysid, uint8_t compid, mavlink_channel_t channel) const;
+    uint8_t alloc_route(uint32_t now_ms);
+    void unlink_route(uint8_t idx);
     
     // a channel mask to block routing as required
     uint8_t no_route_mask;
@@ -0,0 +1,220 @@
+//
+// Benchmark of MAVLink routing for a swarm of vehicles
+//
+// Feeds traffic through MAVLink_routing::check_and_forward() and
+// reports the time per message as the number of routes grows. Each
+// vehicle has an autopilot, camera, gimbal and companion computer
+// sending telemetry, with half the vehicles heard on a second link,
+// and a GCS sending targeted commands to them.
+//
+// If ROUTING_TLOG is set in the environment the messages from that
+// tlog are replayed instead, with odd and even system IDs arriving on
+// different links as they would on a relay.
+//
+
+#include <AP_HAL/AP_HAL.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <AP_Common/AP_FWVersion.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <stdio.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+AP_SerialManager _serialmanager;
+GCS_Dummy _gcs;
+
+// passes over the traffic for each swarm size
+static const uint32_t passes = 200;
+
+// components of each vehicle in the swarm
+static const struct {
+    uint8_t compid;
+    uint8_t mavtype;
+} components[] = {
+    { MAV_COMP_ID_AUTOPILOT1, MAV_TYPE_QUADROTOR },
+    { MAV_COMP_ID_CAMERA, MAV_TYPE_CAMERA },
+    { MAV_COMP_ID_GIMBAL, MAV_TYPE_GIMBAL },
+    { MAV_COMP_ID_ONBOARD_COMPUTER, MAV_TYPE_ONBOARD_CONTROLLER },
+};
+
+static const uint8_t gcs_sysid = 255;
+
+struct Packet {
+    mavlink_message_t msg;
+    uint8_t link;
+};
+
+static Packet *packets;
+static uint32_t num_packets;
+static uint32_t max_packets;
+
+static bool add_packet(const mavlink_message_t &msg, uint8_t link)
+{
+    if (num_packets >= max_packets) {
+        return false;
+    }
+    packets[num_packets].msg = msg;
+    packets[num_packets].link = link;
+    num_packets++;
+    return true;
+}
+
+// one second of traffic from a swarm of vehicles
+static void make_swarm_traffic(uint8_t num_vehicles)
+{
+    mavlink_status_t status {};
+    mavlink_message_t msg;
+    num_packets = 0;
+
+    for (uint8_t v=0; v<num_vehicles; v++) {
+        // our own sysid is 1, so the swarm starts at 2
+        const uint8_t sysid = 2 + v;
+        const uint8_t link = v & 1;
+        for (const auto &c : components) {
+            mavlink_heartbeat_t heartbeat {};
+            heartbeat.type = c.mavtype;
+            mavlink_msg_heartbeat_encode_status(sysid, c.compid, &status, &msg, &heartbeat);
+            add_packet(msg, link);
+        }
+        for (uint8_t i=0; i<10; i++) {
+            mavlink_attitude_t attitude {};
+            mavlink_msg_attitude_encode_status(sysid, MAV_COMP_ID_AUTOPILOT1, &status, &msg, &attitude);
+            add_packet(msg, link);
+            mavlink_global_position_int_t pos {};
+            mavlink_msg_global_position_int_encode_status(sysid, MAV_COMP_ID_AUTOPILOT1, &status, &msg, &pos);
+            add_packet(msg, link);
+        }
+        mavlink_mount_orientation_t mount {};
+        mavlink_msg_mount_orientation_encode_status(sysid, MAV_COMP_ID_GIMBAL, &status, &msg, &mount);
+        add_packet(msg, link);
+
+        // commands from the GCS on link 0
+        mavlink_command_long_t cmd {};
+        cmd.target_system = sysid;
+        cmd.target_component = MAV_COMP_ID_CAMERA;
+        cmd.command = MAV_CMD_IMAGE_START_CAPTURE;
+        mavlink_msg_command_long_encode_status(gcs_sysid, MAV_COMP_ID_MISSIONPLANNER, &status, &msg, &cmd);
+        add_packet(msg, 0);
+        mavlink_param_request_read_t param {};
+        param.target_system = sysid;
+        param.target_component = MAV_COMP_ID_AUTOPILOT1;
+        param.param_index = 1;
+        mavlink_msg_param_request_read_encode_status(gcs_sysid, MAV_COMP_ID_MISSIONPLANNER, &status, &msg, &param);
+        add_packet(msg, 0);
+    }
+    mavlink_heartbeat_t heartbeat {};
+    heartbeat.type = MAV_TYPE_GCS;
+    mavlink_msg_heartbeat_encode_status(gcs_sysid, MAV_COMP_ID_MISSIONPLANNER, &status, &msg, &heartbeat);
+    add_packet(msg, 0);
+}
+
+// messages from a tlog, each preceded by a 64 bit timestamp
+static bool load_tlog(const char *filename)
+{
+    FILE *f = ::fopen(filename, "rb");
+    if (f == nullptr) {
+        hal.console->printf("Failed to open %s\n", filename);
+        return false;
+    }
+    mavlink_message_t rxmsg {};
+    mavlink_status_t rxstatus {};
+    num_packets = 0;
+    int c;
+    while ((c = ::fgetc(f)) != EOF) {
+        mavlink_message_t msg;
+        mavlink_status_t status;
+        if (mavlink_frame_char_buffer(&rxmsg, &rxstatus, c, &msg, &status) == MAVLINK_FRAMING_OK) {
+            if (!add_packet(msg, msg.sysid & 1)) {
+                break;
+            }
+        }
+    }
+    ::fclose(f);
+    hal.console->printf("Loaded %u messages from %s\n", unsigned(num_packets), filename);
+    return num_packets > 0;
+}
+
+static void run(const char *name)
+{
+    MAVLink_routing *routing = NEW_NOTHROW MAVLink_routing();
+    GCS_MAVLINK *links[2] { gcs().chan(0), gcs().chan(1) };
+    if (routing == nullptr || links[0] == nullptr) {
+        AP_HAL::panic("FATAL: setup failed");
+    }
+    if (links[1] == nullptr) {
+        links[1] = links[0];
+    }
+
+    // learn the routes before timing
+    for (uint32_t i=0; i<num_packets; i++) {
+        routing->check_and_forward(MAVLINK_FRAMING_OK, *links[packets[i].link], packets[i].msg);
+    }
+
+    uint32_t local = 0;
+    const uint64_t t0 = AP_HAL::micros64();
+    for (uint32_t p=0; p<passes; p++) {
+        for (uint32_t i=0; i<num_packets; i++) {
+            if (routing->check_and_forward(MAVLINK_FRAMING_OK, *links[packets[i].link], packets[i].msg)) {
+                local++;
+            }
+        }
+    }
+    const uint64_t dt_us = AP_HAL::micros64() - t0;
+
+    ExpandingString info;
+    routing->routing_info(info);
+    const char *s = info.get_string();
+    hal.console->printf("%s: %u messages %.1fns/message %u local, %.*s",
+                        name,
+                        unsigned(num_packets),
+                        dt_us * 1000.0 / (uint64_t(num_packets) * passes),
+                        unsigned(local / passes),
+                        int(strcspn(s, "\n") + 1), s);
+
+    delete routing;
+}
+
+void setup(void)
+{
+    hal.console->printf("MAVLink routing benchmark\n");
+    gcs().init();
+    gcs().setup_console();
+    gcs().setup_uarts();
+
+    max_packets = 100000;
+    packets = NEW_NOTHROW Packet[max_packets];
+    if (packets == nullptr) {
+        AP_HAL::panic("FATAL: out of memory");
+    }
+}
+
+void loop(void)
+{
+    const char *tlog = getenv("ROUTING_TLOG");
+    if (tlog != nullptr) {
+        if (load_tlog(tlog)) {
+            run(tlog);
+        }
+    } else {
+        static const uint8_t swarm_sizes[] { 1, 4, 8, 16, 32, 64 };
+        for (const uint8_t n : swarm_sizes) {
+            make_swarm_traffic(n);
+            char name[32];
+            hal.util->snprintf(name, sizeof(name), "%u vehicles", unsigned(n));
+            run(name);
+        }
+    }
+
+    while (true) {
+        hal.console->printf("TEST PASSED\n");
+        hal.scheduler->delay(20000);
+    }
+}
+
+AP_HAL_MAIN();
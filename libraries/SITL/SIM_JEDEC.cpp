@@ -14,6 +14,14 @@ using namespace SITL;
 
 extern const HAL_SITL& hal_sitl;
 
+/*
+  typical W25Q program and erase times, so that drivers see the chip
+  busy for as long as it would be on real hardware
+ */
+static const uint32_t JEDEC_PAGE_PROGRAM_US = 700;
+static const uint32_t JEDEC_SECTOR4_ERASE_US = 45000;
+static const uint32_t JEDEC_BLOCK64_ERASE_US = 150000;
+
 void JEDEC::open_storage_fd()
 {
     if (storage_fd != -1) {
@@ -78,6 +86,11 @@ uint32_t JEDEC::parse_addr (uint8_t* buffer, uint32_t len)
     return buffer[1] << 16 | buffer[2] << 8 | buffer[3];
 }
 
+void JEDEC::set_busy(uint32_t busy_us)
+{
+    busy_until_us = AP_HAL::micros64() + busy_us;
+}
+
 void JEDEC::assert_writes_enabled()
 {
     if (!write_enabled) {
@@ -110,6 +123,9 @@ int JEDEC::rdwr(uint8_t count, SPI::spi_ioc_transfer *&tfrs)
         case State::WAITING: {
             // find a command
             uint8_t command = tx_buf[0];
+            if (command != JEDEC_RDSR && AP_HAL::micros64() < busy_until_us) {
+                AP_HAL::panic("JEDEC: command 0x%02x while busy", unsigned(command));
+            }
             switch (command) {
             case JEDEC_RDID:
                 state = State::READING_RDID;
@@ -132,12 +148,14 @@ int JEDEC::rdwr(uint8_t count, SPI::spi_ioc_transfer *&tfrs)
                 xfr_addr = parse_addr(tx_buf, tfr.len);
                 assert_writes_enabled();
                 sector4k_erase(xfr_addr);
+                set_busy(JEDEC_SECTOR4_ERASE_US);
                 write_enabled = false;
                 break;
             }
             case JEDEC_BULK_ERASE:  {
                 assert_writes_enabled();
                 bulk_erase();
+                set_busy(JEDEC_BLOCK64_ERASE_US * get_num_blocks());
                 write_enabled = false;
                 break;
             }
@@ -145,6 +163,7 @@ int JEDEC::rdwr(uint8_t count, SPI::spi_ioc_transfer *&tfrs)
                 xfr_addr = parse_addr(tx_buf, tfr.len);
                 assert_writes_enabled();
                 block64k_erase(xfr_addr);
+                set_busy(JEDEC_BLOCK64_ERASE_US);
                 write_enabled = false;
                 break;
             }
@@ -159,6 +178,9 @@ int JEDEC::rdwr(uint8_t count, SPI::spi_ioc_transfer *&tfrs)
             break;
         case State::READING_RDSR:
             fill_rdsr(rx_buf, tfr.len);
+            if (AP_HAL::micros64() < busy_until_us) {
+                rx_buf[0] |= 0x01;  // WIP
+            }
             state = State::WAITING;
             break;
         case State::READING: {
@@ -187,6 +209,7 @@ int JEDEC::rdwr(uint8_t count, SPI::spi_ioc_transfer *&tfrs)
             if (write_ret != tfr.len) {
                 AP_HAL::panic("write(): %s (%d/%u)", strerror(errno), (signed)write_ret, (unsigned)tfr.len);
             }
+            set_busy(JEDEC_PAGE_PROGRAM_US);
             state = State::WAITING;
             write_enabled = false;
             break;
@@ -39,6 +39,10 @@ private:
     bool write_enabled;
     uint32_t xfr_addr;
 
+    // the chip ignores everything but status reads until this time
+    uint64_t busy_until_us;
+    void set_busy(uint32_t busy_us);
+
     void sector4k_erase(uint32_t addr);
     void block64k_erase(uint32_t addr);
     void page_erase(uint32_t addr);
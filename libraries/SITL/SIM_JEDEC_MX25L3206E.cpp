@@ -15,8 +15,7 @@ void JEDEC_MX25L3206E::fill_rdid(uint8_t *buffer, uint8_t len)
 
 void JEDEC_MX25L3206E::fill_rdsr(uint8_t *buffer, uint8_t len)
 {
-    // we never allow multiple operations at a time
-    // hence we can never be busy while reading the status register
+    // the busy bit is added by JEDEC while an operation is in progress
     buffer[0] = 0x00;
 }
 